@@ -24,6 +24,7 @@
 #include <cmath>
 #include <QPainter>
 #include <QPaintEvent>
+#include <QResizeEvent>
 #include <QtMath>
 #include <QApplication>
 #include <QToolTip>
@@ -81,6 +82,8 @@ BoardAreaWidget::BoardAreaWidget(BoardWidget& board, QWidget* parent) :
   m_mouseMoveTileRotate{TileRotate::Deg0}
   , m_mouseMoveTileWidth{1}
   , m_mouseMoveTileHeight{1}
+  , m_viewportTopLeft{TileLocation::invalid}
+  , m_viewportBottomRight{TileLocation::invalid}
 {
   setSizePolicy(QSizePolicy::MinimumExpanding, QSizePolicy::MinimumExpanding);
   setFocusPolicy(Qt::StrongFocus);
@@ -837,6 +840,31 @@ void BoardAreaWidget::paintEvent(QPaintEvent* event)
   }
 }
 
+void BoardAreaWidget::resizeEvent(QResizeEvent* event)
+{
+  QWidget::resizeEvent(event);
+  updateViewport();
+}
+
+void BoardAreaWidget::updateViewport()
+{
+  // visible part of the widget, the parent is the scroll area viewport:
+  QRect visible = rect();
+  if(const auto* parent = parentWidget())
+    visible &= QRect(-pos(), parent->size());
+  if(visible.isEmpty())
+    return;
+
+  const TileLocation topLeft = pointToTileLocation(visible.topLeft());
+  const TileLocation bottomRight = pointToTileLocation(visible.bottomRight());
+  if(topLeft != m_viewportTopLeft || bottomRight != m_viewportBottomRight)
+  {
+    m_viewportTopLeft = topLeft;
+    m_viewportBottomRight = bottomRight;
+    m_board.board().setViewport(topLeft, bottomRight);
+  }
+}
+
 void BoardAreaWidget::settingsChanged()
 {
   const auto& s = BoardSettings::instance();
@@ -854,4 +882,5 @@ void BoardAreaWidget::updateMinimumSize()
 
   setMinimumSize(width, height);
   update();
+  updateViewport();
 }
@@ -86,6 +86,8 @@ class BoardAreaWidget : public QWidget
     uint8_t m_mouseMoveTileWidth;
     uint8_t m_mouseMoveTileHeight;
     TileLocation m_mouseMoveHideTileLocation;
+    TileLocation m_viewportTopLeft;
+    TileLocation m_viewportBottomRight;
     uint8_t m_mouseMoveTileWidthMax;
     uint8_t m_mouseMoveTileHeightMax;
 
@@ -115,6 +117,7 @@ class BoardAreaWidget : public QWidget
     void mouseMoveEvent(QMouseEvent* event) final;
     void wheelEvent(QWheelEvent* event) final;
     void paintEvent(QPaintEvent* event) final;
+    void resizeEvent(QResizeEvent* event) final;
 
   protected slots:
     void settingsChanged();
@@ -147,6 +150,7 @@ class BoardAreaWidget : public QWidget
     void setZoomLevel(int value);
     void zoomIn() { setZoomLevel(zoomLevel() + 1); }
     void zoomOut() { setZoomLevel(zoomLevel() - 1); }
+    void updateViewport();
 
   signals:
     void gridChanged(Grid);
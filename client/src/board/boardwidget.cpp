@@ -29,6 +29,7 @@
 #include <QAction>
 #include <QActionGroup>
 #include <QScrollArea>
+#include <QScrollBar>
 #include <QStatusBar>
 #include <QLabel>
 #include <QApplication>
@@ -354,6 +355,11 @@ BoardWidget::BoardWidget(std::shared_ptr<Board> object, QWidget* parent) :
   sa->setWidgetResizable(true);
   sa->setWidget(m_boardArea);
   l->addWidget(sa);
+  for(auto* scrollBar : {sa->horizontalScrollBar(), sa->verticalScrollBar()})
+  {
+    connect(scrollBar, &QScrollBar::valueChanged, m_boardArea, &BoardAreaWidget::updateViewport);
+    connect(scrollBar, &QScrollBar::rangeChanged, m_boardArea, &BoardAreaWidget::updateViewport);
+  }
 
   m_statusBar->addWidget(m_statusBarMessage, 1);
   m_statusBar->addWidget(m_statusBarCoords, 0);
@@ -367,8 +373,6 @@ BoardWidget::BoardWidget(std::shared_ptr<Board> object, QWidget* parent) :
 
   setLayout(l);
 
-  m_object->getTileData();
-
   m_nxManagerRequestId = m_object->connection()->getObject("world.nx_manager",
     [this](const ObjectPtr& nxManager, std::optional<const Error> /*error*/)
     {
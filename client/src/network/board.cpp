@@ -3,7 +3,7 @@
  *
  * This file is part of the traintastic source code.
  *
- * Copyright (C) 2020-2023 Reinder Feenstra
+ * Copyright (C) 2020-2024 Reinder Feenstra
  *
  * This program is free software; you can redistribute it and/or
  * modify it under the terms of the GNU General Public License
@@ -44,6 +44,11 @@ void Board::getTileData()
   m_getTileDataRequestId = m_connection->getTileData(*this);
 }
 
+void Board::setViewport(TileLocation topLeft, TileLocation bottomRight)
+{
+  m_connection->setBoardViewport(*this, topLeft, bottomRight);
+}
+
 bool Board::getTileOrigin(TileLocation& l) const
 {
   if(auto it = m_tileData.find(l); it != m_tileData.end())
@@ -111,19 +116,22 @@ int Board::deleteTile(int16_t x, int16_t y, std::function<void(const bool&, std:
   return ::callMethod(*m_connection, *getMethod("delete_tile"), std::move(callback), x, y);
 }
 
-void Board::getTileDataResponse(const Message& response)
+void Board::readTileData(const Message& message)
 {
-  m_getTileDataRequestId = Connection::invalidRequestId;
-
-  while(!response.endOfMessage())
+  while(!message.endOfMessage())
   {
-    TileLocation l = response.read<TileLocation>();
-    TileData data = response.read<TileData>();
+    TileLocation l = message.read<TileLocation>();
+    TileData data = message.read<TileData>();
     m_tileData.emplace(l, data);
     if(data.isActive())
-      emit tileObjectAdded(l.x, l.y, m_tileObjects.emplace(l, m_connection->readObject(response)).first->second);
+      emit tileObjectAdded(l.x, l.y, m_tileObjects.emplace(l, m_connection->readObject(message)).first->second);
   }
+}
 
+void Board::getTileDataResponse(const Message& response)
+{
+  m_getTileDataRequestId = Connection::invalidRequestId;
+  readTileData(response);
   emit tileDataChanged();
 }
 
@@ -159,6 +167,31 @@ void Board::processMessage(const Message& message)
       emit tileDataChanged();
       break;
     }
+    case Message::Command::BoardTileDataRegion:
+    {
+      const TileLocation topLeft = message.read<TileLocation>();
+      const TileLocation bottomRight = message.read<TileLocation>();
+
+      // drop tiles outside the new area, releases their objects:
+      for(auto it = m_tileData.begin(); it != m_tileData.end();)
+      {
+        const TileLocation l = it->first;
+        if(l.x + it->second.width() - 1 < topLeft.x || l.x > bottomRight.x ||
+            l.y + it->second.height() - 1 < topLeft.y || l.y > bottomRight.y)
+        {
+          m_tileObjects.erase(l);
+          it = m_tileData.erase(it);
+        }
+        else
+          it++;
+      }
+
+      // the server only sends tiles that weren't within the previous area:
+      readTileData(message);
+
+      emit tileDataChanged();
+      break;
+    }
     default:
       Object::processMessage(message);
       break;
@@ -3,7 +3,7 @@
  *
  * This file is part of the traintastic source code.
  *
- * Copyright (C) 2020-2023 Reinder Feenstra
+ * Copyright (C) 2020-2024 Reinder Feenstra
  *
  * This program is free software; you can redistribute it and/or
  * modify it under the terms of the GNU General Public License
@@ -59,6 +59,7 @@ class Board final : public Object
     TileObjectMap m_tileObjects;
     int m_getTileDataRequestId;
 
+    void readTileData(const Message& message);
     void getTileDataResponse(const Message& response);
     void processMessage(const Message& message) final;
 
@@ -69,6 +70,8 @@ class Board final : public Object
     ~Board() final;
 
     void getTileData();
+    //! \brief Only receive tiles within (and around) the visible area, instead of all tiles
+    void setViewport(TileLocation topLeft, TileLocation bottomRight);
     const TileDataMap& tileData() const { return m_tileData; }
 
     const TileObjectMap& tileObjects() const { return m_tileObjects; }
@@ -428,6 +428,15 @@ void Connection::setTableModelRegion(TableModel* tableModel, int columnMin, int
   send(event);
 }
 
+void Connection::setBoardViewport(Board& object, TileLocation topLeft, TileLocation bottomRight)
+{
+  auto event = Message::newEvent(Message::Command::BoardSetViewport);
+  event->write(object.handle());
+  event->write(topLeft);
+  event->write(bottomRight);
+  send(event);
+}
+
 int Connection::getTileData(Board& object)
 {
   auto request = Message::newRequest(Message::Command::BoardGetTileData);
@@ -970,6 +979,7 @@ void Connection::processMessage(const std::shared_ptr<Message> message)
       case Message::Command::InputMonitorInputIdChanged:
       case Message::Command::InputMonitorInputValueChanged:
       case Message::Command::BoardTileDataChanged:
+      case Message::Command::BoardTileDataRegion:
       {
         const auto handle = message->read<Handle>();
         if(auto object = m_objects.value(handle).lock())
@@ -3,7 +3,7 @@
  *
  * This file is part of the traintastic source code.
  *
- * Copyright (C) 2019-2021,2023 Reinder Feenstra
+ * Copyright (C) 2019-2021,2023-2024 Reinder Feenstra
  *
  * This program is free software; you can redistribute it and/or
  * modify it under the terms of the GNU General Public License
@@ -46,6 +46,7 @@ class InputMonitor;
 class OutputKeyboard;
 class Board;
 struct Error;
+struct TileLocation;
 
 class Connection : public QObject, public std::enable_shared_from_this<Connection>
 {
@@ -156,6 +157,7 @@ class Connection : public QObject, public std::enable_shared_from_this<Connectio
     void setTableModelRegion(TableModel* tableModel, int columnMin, int columnMax, int rowMin, int rowMax);
 
     [[nodiscard]] int getTileData(Board& object);
+    void setBoardViewport(Board& object, TileLocation topLeft, TileLocation bottomRight);
 
   signals:
     void stateChanged();
@@ -34,6 +34,8 @@
 #include "../../network/method.hpp"
 #include "../propertylineedit.hpp"
 #include "../propertycheckbox.hpp"
+#include "../propertyspinbox.hpp"
+#include "../propertyvaluelabel.hpp"
 #include "../propertyluacodeedit.hpp"
 #include "../../theme/theme.hpp"
 
@@ -42,8 +44,10 @@ LuaScriptEditWidget::LuaScriptEditWidget(const ObjectPtr& object, QWidget* paren
   m_propertyState{nullptr},
   m_methodStart{nullptr},
   m_methodStop{nullptr},
+  m_methodReload{nullptr},
   m_start{nullptr},
-  m_stop{nullptr}
+  m_stop{nullptr},
+  m_reload{nullptr}
 {
   buildForm();
 }
@@ -53,8 +57,10 @@ LuaScriptEditWidget::LuaScriptEditWidget(const QString& id, QWidget* parent) :
   m_propertyState{nullptr},
   m_methodStart{nullptr},
   m_methodStop{nullptr},
+  m_methodReload{nullptr},
   m_start{nullptr},
-  m_stop{nullptr}
+  m_stop{nullptr},
+  m_reload{nullptr}
 {
 }
 
@@ -66,6 +72,7 @@ void LuaScriptEditWidget::buildForm()
   m_propertyState = dynamic_cast<Property*>(m_object->getProperty("state"));
   m_methodStart = m_object->getMethod("start");
   m_methodStop = m_object->getMethod("stop");
+  m_methodReload = m_object->getMethod("reload");
 
   if(Q_UNLIKELY(!m_propertyState || !m_methodStart || !m_methodStop))
     return;
@@ -78,8 +85,17 @@ void LuaScriptEditWidget::buildForm()
     if(Property* property = dynamic_cast<Property*>(m_object->getProperty(name)))
       form->addRow(property->displayName(), new PropertyLineEdit(*property, this));
 
-  if(Property* property = dynamic_cast<Property*>(m_object->getProperty("disabled")))
-    form->addRow(property->displayName(), new PropertyCheckBox(*property, this));
+  for(const char* name : {"disabled", "worker", "profiling"})
+    if(Property* property = dynamic_cast<Property*>(m_object->getProperty(name)))
+      form->addRow(property->displayName(), new PropertyCheckBox(*property, this));
+
+  for(const char* name : {"worker_interval", "memory_limit"})
+    if(Property* property = dynamic_cast<Property*>(m_object->getProperty(name)))
+      form->addRow(property->displayName(), new PropertySpinBox(*property, this));
+
+  for(const char* name : {"memory_usage", "memory_peak", "memory_allocations"})
+    if(Property* property = dynamic_cast<Property*>(m_object->getProperty(name)))
+      form->addRow(property->displayName(), new PropertyValueLabel(*property, this));
 
   QToolBar* toolbar = new QToolBar(this);
   m_start = toolbar->addAction(Theme::getIcon("run"), m_methodStart->displayName(),
@@ -108,6 +124,22 @@ void LuaScriptEditWidget::buildForm()
         m_stop->setEnabled(value.toBool());
     });
 
+  if(m_methodReload)
+  {
+    m_reload = toolbar->addAction(Theme::getIcon("update"), m_methodReload->displayName(),
+      [this]()
+      {
+        m_methodReload->call();
+      });
+    m_reload->setEnabled(m_methodReload->getAttributeBool(AttributeName::Enabled, true));
+    connect(m_methodReload, &Method::attributeChanged, this,
+      [this](AttributeName name, const QVariant& value)
+      {
+        if(name == AttributeName::Enabled)
+          m_reload->setEnabled(value.toBool());
+      });
+  }
+
   QWidget* spacer = new QWidget(this);
   spacer->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Preferred);
   spacer->show();
@@ -130,5 +162,21 @@ void LuaScriptEditWidget::buildForm()
   if(Property* property = dynamic_cast<Property*>(m_object->getProperty("code")))
     l->addWidget(new PropertyLuaCodeEdit(*property, this));
 
+  if(Property* property = dynamic_cast<Property*>(m_object->getProperty("profile")))
+  {
+    QPlainTextEdit* profile = new QPlainTextEdit(this);
+    profile->setReadOnly(true);
+    profile->setPlainText(property->toString());
+    profile->setVisible(property->getAttributeBool(AttributeName::Visible, true));
+    connect(property, &Property::valueChangedString, profile, &QPlainTextEdit::setPlainText);
+    connect(property, &Property::attributeChanged, profile,
+      [profile](AttributeName name, const QVariant& value)
+      {
+        if(name == AttributeName::Visible)
+          profile->setVisible(value.toBool());
+      });
+    l->addWidget(profile);
+  }
+
   setLayout(l);
 }
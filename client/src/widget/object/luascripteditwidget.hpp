@@ -36,8 +36,10 @@ class LuaScriptEditWidget final : public AbstractEditWidget
     Property* m_propertyState;
     Method* m_methodStart;
     Method* m_methodStop;
+    Method* m_methodReload;
     QAction* m_start;
     QAction* m_stop;
+    QAction* m_reload;
 
   protected:
     void buildForm() final;
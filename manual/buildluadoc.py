@@ -256,6 +256,45 @@ class LuaDoc:
             'lua_name': name,
             'items': items}
 
+        # timer lib:
+        name = 'timer'
+        items = []
+        timers_cpp = LuaDoc._read_file(os.path.join(project_root, 'server', 'src', 'lua', 'timers.cpp'))
+        push = re.search(r'void\s+Timers::push\(lua_State\s*\*\s*L\)\s*{(.+?)\n}', timers_cpp, flags=re.DOTALL)
+        for item_name in re.findall(r'lua_setfield\(\s*L\s*,\s*-2\s*,\s*"([a-z_]+)"\s*\);', push.group(1)):
+            items.append(item_name)
+        libs[name] = {
+            'filename': name + '.html',
+            'name': name + ':title',
+            'lua_name': name,
+            'items': items}
+
+        # command lib (worker scripts only):
+        name = 'command'
+        items = []
+        worker_cpp = LuaDoc._read_file(os.path.join(project_root, 'server', 'src', 'lua', 'worker.cpp'))
+        push = re.search(r'void\s+Worker::pushCommand\(lua_State\s*\*\s*L\)\s*{(.+?)\n}', worker_cpp, flags=re.DOTALL)
+        for item_name in re.findall(r'lua_setfield\(\s*L\s*,\s*-2\s*,\s*"([a-z_]+)"\s*\);', push.group(1)):
+            items.append(item_name)
+        libs[name] = {
+            'filename': name + '.html',
+            'name': name + ':title',
+            'lua_name': name,
+            'items': items}
+
+        # route lib:
+        name = 'route'
+        items = []
+        route_cpp = LuaDoc._read_file(os.path.join(project_root, 'server', 'src', 'lua', 'route.cpp'))
+        push = re.search(r'void\s+Route::push\(lua_State\s*\*\s*L\)\s*{(.+?)\n}', route_cpp, flags=re.DOTALL)
+        for item_name in re.findall(r'lua_setfield\(\s*L\s*,\s*-2\s*,\s*"([a-z_]+)"\s*\);', push.group(1)):
+            items.append(item_name)
+        libs[name] = {
+            'filename': name + '.html',
+            'name': name + ':title',
+            'lua_name': name,
+            'items': items}
+
         # class lib:
         name = 'class'
         items = []
@@ -3,7 +3,7 @@
  *
  * This file is part of the traintastic source code.
  *
- * Copyright (C) 2020-2023 Reinder Feenstra
+ * Copyright (C) 2020-2024 Reinder Feenstra
  *
  * This program is free software; you can redistribute it and/or
  * modify it under the terms of the GNU General Public License
@@ -24,7 +24,10 @@
 #include "boardlist.hpp"
 #include "boardlisttablemodel.hpp"
 #include "map/link.hpp"
+#include "map/node.hpp"
 #include "tile/tiles.hpp"
+#include "tile/rail/linkrailtile.hpp"
+#include "tile/rail/signal/signalrailtile.hpp"
 #include "../core/method.tpp"
 #include "../core/objectproperty.tpp"
 #include "../world/world.hpp"
@@ -32,6 +35,7 @@
 #include "../core/attributes.hpp"
 #include "../utils/displayname.hpp"
 #include <cassert>
+#include <unordered_map>
 
 CREATE_IMPL(Board)
 
@@ -47,13 +51,13 @@ Board::Board(World& world, std::string_view _id) :
     {
       const TileLocation l{x, y};
 
-      if(auto it = m_tiles.find(l); it != m_tiles.end())
+      if(auto existing = getTile(l))
       {
         if(!replace)
         {
-          const TileRotate tileRotate = it->second->rotate;
+          const TileRotate tileRotate = existing->rotate;
 
-          if(it->second->tileId() == TileId::RailStraight && tileClassId == StraightRailTile::classId) // merge to bridge
+          if(existing->tileId() == TileId::RailStraight && tileClassId == StraightRailTile::classId) // merge to bridge
           {
             if((tileRotate == rotate + TileRotate::Deg90 || tileRotate == rotate - TileRotate::Deg90) && deleteTile(x, y))
             {
@@ -73,7 +77,7 @@ Board::Board(World& world, std::string_view _id) :
             else
               return false;
           }
-          else if(it->second->tileId() == TileId::RailStraight && // replace straight by a straight with something extra
+          else if(existing->tileId() == TileId::RailStraight && // replace straight by a straight with something extra
                   Tiles::canUpgradeStraightRail(tileClassId) &&
                   (tileRotate == rotate || (tileRotate + TileRotate::Deg180) == rotate) &&
                   deleteTile(x, y))
@@ -103,13 +107,11 @@ Board::Board(World& world, std::string_view _id) :
         tile->destroy();
         return false;
       }
-      for(int16_t xx = tile->location().x; xx < x2; xx++)
-        for(int16_t yy = tile->location().y; yy < y2; yy++)
-          m_tiles[TileLocation{xx, yy}] = tile;
+      m_tiles.add(tile);
 
       tileDataChanged(*this, tile->location(), tile->data());
       updateSize();
-      m_modified = true;
+      setModified(tile->location(), tile->width, tile->height);
       return true;
     }},
   moveTile{*this, "move_tile",
@@ -171,17 +173,11 @@ Board::Board(World& world, std::string_view _id) :
       tile->rotate.setValueInternal(rotate);
 
       // place tile at <To>
-      for(int16_t x = xTo; x < xTo2; x++)
-        for(int16_t y = yTo; y < yTo2; y++)
-        {
-          const TileLocation l{x, y};
-          assert(m_tiles.find(l) == m_tiles.end());
-          m_tiles[l] = tile;
-        }
+      m_tiles.add(tile);
       tileDataChanged(*this, tile->location(), tile->data());
 
       updateSize();
-      m_modified = true;
+      setModified(tile->location(), width, height);
       return true;
     }},
   resizeTile{*this, "resize_tile",
@@ -214,23 +210,10 @@ Board::Board(World& world, std::string_view _id) :
       if(!tile->resize(width, height))
         return false;
 
-      // update m_tiles
-      {
-        const int16_t x2 = x + std::max(width, oldWidth);
-        const int16_t y2 = y + std::max(height, oldHeight);
-        const int16_t xNew = x + width;
-        const int16_t yNew = y + height;
-
-        for(int16_t xx = x; xx < x2; xx++)
-          for(int16_t yy = y; yy < y2; yy++)
-            if(xx < xNew && yy < yNew)
-              m_tiles[{xx, yy}] = tile;
-            else
-              m_tiles.erase({xx, yy});
-      }
+      m_tiles.resize(*tile, oldWidth, oldHeight);
 
       tileDataChanged(*this, tile->location(), tile->data());
-      m_modified = true;
+      setModified(tile->location(), std::max(width, oldWidth), std::max(height, oldHeight));
       return true;
     }},
   deleteTile{*this, "delete_tile",
@@ -239,10 +222,9 @@ Board::Board(World& world, std::string_view _id) :
       auto tile = getTile({x, y});
       if(tile)
       {
-        removeTile(x, y);
+        removeTile(x, y); // marks the tile location as modified
         tile->destroy();
         updateSize();
-        m_modified = true;
       }
       return true;
     }},
@@ -292,9 +274,9 @@ void Board::addToWorld()
 
 void Board::destroying()
 {
-  for(auto& it : m_tiles)
-    if(it.first == it.second->location()) // only on origin
-      it.second->destroy();
+  const auto tiles = m_tiles.tiles(); // copy, m_tiles must stay valid while destroying
+  for(const auto& tile : tiles)
+    tile->destroy();
   m_tiles.clear();
   m_world.boards->removeObject(shared_ptr<Board>());
   IdObject::destroying();
@@ -311,21 +293,7 @@ void Board::load(WorldLoader& loader, const nlohmann::json& data)
   {
     static_cast<void>(_); // silence unused warning
     if(auto tile = std::dynamic_pointer_cast<Tile>(loader.getObject(tileId.get<std::string_view>())))
-    {
-      if(tile->width > 1 || tile->height > 1)
-      {
-        const int16_t x2 = tile->location().x + tile->width;
-        const int16_t y2 = tile->location().y + tile->height;
-        for(int16_t x = tile->location().x; x < x2; x++)
-          for(int16_t y = tile->location().y; y < y2; y++)
-            m_tiles.emplace(TileLocation{x, y}, tile);
-      }
-      else
-      {
-        const TileLocation l = tile->location();
-        m_tiles.emplace(l, std::move(tile));
-      }
-    }
+      m_tiles.add(std::move(tile));
   }
 }
 
@@ -334,9 +302,8 @@ void Board::save(WorldSaver& saver, nlohmann::json& data, nlohmann::json& state)
   IdObject::save(saver, data, state);
 
   nlohmann::json tiles = nlohmann::json::array();
-  for(const auto& it : m_tiles)
-    if(it.first == it.second->location())
-      tiles.push_back(it.second->id);
+  for(const auto& tile : m_tiles.tiles())
+    tiles.push_back(tile->id);
   std::sort(tiles.begin(), tiles.end(),
     [](const nlohmann::json& a, const nlohmann::json& b)
     {
@@ -365,91 +332,241 @@ void Board::loaded()
   IdObject::loaded();
 
   m_modified = true;
-  modified();
+  m_modifiedAll = true;
+  Blocks blocks;
+  modified(blocks);
+  updateBlocks(blocks);
+  notifyModified();
 }
 
-void Board::modified()
+void Board::setModified(TileLocation origin, uint8_t width, uint8_t height)
 {
-  if(!m_modified)
-    return;
+  for(int16_t x = 0; x < width; x++)
+    for(int16_t y = 0; y < height; y++)
+      m_modifiedLocations.emplace(origin.adjusted(x, y));
+  m_modified = true;
+}
+
+void Board::updateLink(const std::shared_ptr<Tile>& startTile, const Connector& startConnector)
+{
+  assert(startTile->node());
 
-  auto updateLink =
-    [this](const std::shared_ptr<Tile>& startTile, const Connector& startConnector)
+  std::vector<std::shared_ptr<Tile>> tiles;
+  std::vector<Connector> connectors;
+  connectors.reserve(2);
+
+  Connector connector{startConnector.opposite()};
+  while(auto nextTile = getTile(connector.location))
+  {
+    if(nextTile->node())
+    {
+      auto link = std::make_shared<Link>(std::move(tiles));
+      link->connect(*startTile->node(), startConnector, *nextTile->node(), connector);
+      return;
+    }
+    tiles.emplace_back(nextTile);
+    connectors.clear();
+    nextTile->getConnectors(connectors);
+    if(connectors.size() == 2)
+    {
+      assert(connectors[0] == connector || connectors[1] == connector);
+      connector = connectors[connectors[0] == connector ? 1 : 0].opposite();
+    }
+    else
     {
-      assert(startTile->node());
+      assert(connectors.size() == 1);
+      assert(connectors[0] == connector);
+      break;
+    }
+  }
+
+  startTile->node()->get().disconnect(startConnector);
+}
+
+void Board::getModifiedNodes(std::vector<std::shared_ptr<Tile>>& nodes)
+{
+  if(m_modifiedAll)
+  {
+    for(const auto& tile : m_tiles.tiles())
+      if(tile->node())
+        nodes.emplace_back(tile);
+    return;
+  }
 
-      std::vector<std::shared_ptr<Tile>> tiles;
-      std::vector<Connector> connectors;
-      connectors.reserve(2);
+  // A modified location can only affect links passing through it or ending next to it,
+  // so follow the passive tiles from all neighbours to the nodes at both ends.
+  std::unordered_set<const Tile*> visited;
+  std::vector<Connector> connectors;
 
-      Connector connector{startConnector.opposite()};
-      while(auto nextTile = getTile(connector.location))
+  auto addNode =
+    [&nodes, &visited](const std::shared_ptr<Tile>& tile)
+    {
+      if(visited.emplace(tile.get()).second)
+        nodes.emplace_back(tile);
+    };
+
+  for(auto modifiedLocation : m_modifiedLocations)
+  {
+    for(int16_t dx = -1; dx <= 1; dx++)
+    {
+      for(int16_t dy = -1; dy <= 1; dy++)
       {
-        if(nextTile->node())
-        {
-          auto link = std::make_shared<Link>(std::move(tiles));
-          link->connect(*startTile->node(), startConnector, *nextTile->node(), connector);
-          return;
-        }
-        tiles.emplace_back(nextTile);
-        connectors.clear();
-        nextTile->getConnectors(connectors);
-        if(connectors.size() == 2)
+        auto tile = getTile(modifiedLocation.adjusted(dx, dy));
+        if(!tile)
+          continue;
+        if(tile->node())
         {
-          assert(connectors[0] == connector || connectors[1] == connector);
-          connector = connectors[connectors[0] == connector ? 1 : 0].opposite();
+          addNode(tile);
+          continue;
         }
-        else
+        if(!visited.emplace(tile.get()).second)
+          continue; // already followed
+
+        std::vector<Connector> startConnectors;
+        tile->getConnectors(startConnectors);
+        for(const auto& startConnector : startConnectors)
         {
-          assert(connectors.size() == 1);
-          assert(connectors[0] == connector);
-          break;
+          Connector connector{startConnector.opposite()};
+          while(auto nextTile = getTile(connector.location))
+          {
+            if(nextTile->node())
+            {
+              addNode(nextTile);
+              break;
+            }
+            if(!visited.emplace(nextTile.get()).second)
+              break;
+            connectors.clear();
+            nextTile->getConnectors(connectors);
+            auto it = std::find(connectors.begin(), connectors.end(), connector);
+            if(it == connectors.end() || connectors.size() != 2)
+              break; // not connected or dead end
+            connector = connectors[it == connectors.begin() ? 1 : 0].opposite();
+          }
         }
       }
+    }
+  }
+}
 
-      startTile->node()->get().disconnect(startConnector);
+void Board::findBlocks(Node& start, Blocks& blocks, std::unordered_set<Tile*>* tiles)
+{
+  // Paths of a block end at the next block, so a block path can only be affected by a changed node
+  // if that node can be reached without passing another block.
+  // Signal paths can look further ahead, when collecting tiles the search continues past blocks
+  // for signals only, depth is the number of blocks passed.
+  const size_t depthMax = tiles ? SignalRailTile::blocksAheadMax : 1;
+  std::unordered_map<const Node*, size_t> visited{{&start, 0}};
+  std::vector<std::pair<Node*, size_t>> todo{{&start, 0}};
+
+  const auto add =
+    [&visited, &todo](Node& next, size_t depth)
+    {
+      // visit again if reached by passing less blocks:
+      if(auto [it, inserted] = visited.emplace(&next, depth); inserted || it->second > depth)
+      {
+        it->second = depth;
+        todo.emplace_back(&next, depth);
+      }
     };
 
-  // check/rebuild links:
+  while(!todo.empty())
+  {
+    auto [nodePtr, depth] = todo.back();
+    todo.pop_back();
+    Node& node = *nodePtr;
+
+    auto& tile = node.tile();
+    if(tile.tileId() == TileId::RailBlock)
+    {
+      if(depth == 0)
+        blocks.emplace(&tile);
+      if(&node != &start && ++depth >= depthMax)
+        continue; // don't pass block
+    }
+    else if(tiles && !tile.dying() && (depth == 0 || isRailSignal(tile.tileId())))
+      tiles->emplace(&tile);
+
+    for(const auto& link : node.links())
+    {
+      if(link)
+        add(link->getNext(node), depth);
+    }
+
+    if(tile.tileId() == TileId::RailLink) // connection to another board
+    {
+      if(const auto& other = static_cast<LinkRailTile&>(tile).link.value())
+        add(other->node()->get(), depth);
+    }
+  }
+}
+
+void Board::modified(Blocks& blocks)
+{
+  if(!m_modified)
+    return;
+
+  std::vector<std::shared_ptr<Tile>> nodes;
+  getModifiedNodes(nodes);
+
+  // blocks that could reach a modified node before the change, the tiles found on the way are notified:
+  for(const auto& tile : nodes)
+    findBlocks(tile->node()->get(), blocks, &m_modifiedTiles);
+
+  // rebuild links of modified nodes:
   {
     std::vector<Connector> connectors;
 
-    for(auto& [l, tile] : m_tiles)
+    for(const auto& tile : nodes)
     {
-      if(auto node = tile->node(); node && l == tile->location())
-      {
-        connectors.clear();
+      if(tile->dying())
+        continue;
 
-        tile->getConnectors(connectors);
+      connectors.clear();
+      tile->getConnectors(connectors);
 
-        assert(!connectors.empty());
-        for(const auto connector : connectors)
-        {
-          updateLink(tile, connector);
-        }
+      assert(!connectors.empty());
+      for(const auto& connector : connectors)
+      {
+        updateLink(tile, connector);
       }
     }
   }
 
-  // notify board changed:
-  for(auto& [l, tile] : m_tiles)
-    if(l == tile->location()) // check origin to notify each tile once
-      tile->boardModified();
+  // blocks that can reach a modified node after the change, the tiles found on the way are notified:
+  for(const auto& tile : nodes)
+    if(!tile->dying())
+      findBlocks(tile->node()->get(), blocks, &m_modifiedTiles);
 
+  m_modifiedLocations.clear();
+  m_modifiedAll = false;
   m_modified = false;
 }
 
+void Board::updateBlocks(const Blocks& blocks)
+{
+  for(auto* block : blocks)
+    if(!block->dying())
+      block->boardModified();
+}
+
+void Board::notifyModified()
+{
+  // blocks are handled by updateBlocks()
+  for(auto* tile : m_modifiedTiles)
+    if(!tile->dying())
+      tile->boardModified();
+  m_modifiedTiles.clear();
+}
+
 void Board::removeTile(const int16_t x, const int16_t y)
 {
   auto tile = getTile({x, y});
   if(!tile)
     return;
   const auto l = tile->location();
-  const int16_t x2 = l.x + tile->width;
-  const int16_t y2 = l.y + tile->height;
-  for(int16_t xx = l.x; xx < x2; xx++)
-    for(int16_t yy = l.y; yy < y2; yy++)
-      m_tiles.erase(TileLocation{xx, yy});
+  m_tiles.remove(*tile);
+  setModified(l, tile->width, tile->height);
   tileDataChanged(*this, l, TileData());
 }
 
@@ -457,23 +574,20 @@ void Board::updateSize(bool allowShrink)
 {
   if(!m_tiles.empty())
   {
-    auto it = m_tiles.cbegin();
-    int16_t xMin = it->first.x;
-    int16_t xMax = it->first.x;
-    int16_t yMin = it->first.y;
-    int16_t yMax = it->first.y;
-
-    while(++it != m_tiles.cend())
+    // tile extents, a larger tile occupies multiple locations:
+    const auto& tiles = m_tiles.tiles();
+    int16_t xMin = tiles.front()->location().x;
+    int16_t xMax = xMin;
+    int16_t yMin = tiles.front()->location().y;
+    int16_t yMax = yMin;
+
+    for(const auto& tile : tiles)
     {
-      if(it->first.x < xMin)
-        xMin = it->first.x;
-      else if(it->first.x > xMax)
-        xMax = it->first.x;
-
-      if(it->first.y < yMin)
-        yMin = it->first.y;
-      else if(it->first.y > yMax)
-        yMax = it->first.y;
+      const TileLocation l = tile->location();
+      xMin = std::min(xMin, l.x);
+      yMin = std::min(yMin, l.y);
+      xMax = std::max<int16_t>(xMax, l.x + tile->width - 1);
+      yMax = std::max<int16_t>(yMax, l.y + tile->height - 1);
     }
 
     xMin = std::clamp(xMin, sizeMin, sizeMax);
@@ -3,7 +3,7 @@
  *
  * This file is part of the traintastic source code.
  *
- * Copyright (C) 2020-2023 Reinder Feenstra
+ * Copyright (C) 2020-2024 Reinder Feenstra
  *
  * This program is free software; you can redistribute it and/or
  * modify it under the terms of the GNU General Public License
@@ -25,29 +25,50 @@
 
 #include "../core/idobject.hpp"
 #include <unordered_map>
+#include <unordered_set>
 #include "../core/method.hpp"
+#include "tilegrid.hpp"
 #include <traintastic/board/tilelocation.hpp>
 #include <traintastic/enum/tilerotate.hpp>
 
 class Tile;
+class Node;
+struct Connector;
 struct TileData;
 
 class Board : public IdObject
 {
   friend class BoardList;
-
-  public:
-    using TileMap = std::unordered_map<TileLocation, std::shared_ptr<Tile>, TileLocationHash>;
+  friend class LinkRailTile;
 
   private:
-    bool m_modified = false;
+    using Blocks = std::unordered_set<Tile*>;
 
-    void modified();
+    bool m_modified = false;
+    bool m_modifiedAll = false; //!< all links must be rebuild, e.g. after loading
+    std::unordered_set<TileLocation, TileLocationHash> m_modifiedLocations; //!< tile locations changed since the last update
+    std::unordered_set<Tile*> m_modifiedTiles; //!< tiles to notify, see notifyModified()
+
+    //! \param[out] tiles If set, the (non block) tiles of the visited nodes are added
+    static void findBlocks(Node& start, Blocks& blocks, std::unordered_set<Tile*>* tiles = nullptr);
+    static void updateBlocks(const Blocks& blocks);
+
+    void setModified(TileLocation origin, uint8_t width, uint8_t height);
+    void updateLink(const std::shared_ptr<Tile>& startTile, const Connector& startConnector);
+    void getModifiedNodes(std::vector<std::shared_ptr<Tile>>& nodes);
+
+    /**
+     * \brief Rebuild links touching modified tile locations
+     * \param[in,out] blocks Blocks which paths might be changed are added, paths are updated by updateBlocks()
+     */
+    void modified(Blocks& blocks);
+    //! \brief Notify tiles (except blocks) that can reach a modified node without passing a block
+    void notifyModified();
     void removeTile(int16_t x, int16_t y);
     void updateSize(bool allowShrink = false);
 
   protected:
-    TileMap m_tiles;
+    TileGrid m_tiles;
 
     void addToWorld() final;
     void destroying() final;
@@ -78,28 +99,21 @@ class Board : public IdObject
 
     Board(World& world, std::string_view _id);
 
-    const TileMap& tileMap() const { return m_tiles; }
+    const TileGrid& tileGrid() const { return m_tiles; }
 
     bool isTile(TileLocation l)
     {
-      auto it = m_tiles.find(l);
-      return it != m_tiles.end();
+      return static_cast<bool>(m_tiles.get(l));
     }
 
     std::shared_ptr<const Tile> getTile(TileLocation l) const
     {
-      if(auto it = m_tiles.find(l); it != m_tiles.end())
-        return it->second;
-
-      return {};
+      return m_tiles.get(l);
     }
 
     std::shared_ptr<Tile> getTile(TileLocation l)
     {
-      if(auto it = m_tiles.find(l); it != m_tiles.end())
-        return it->second;
-
-      return {};
+      return m_tiles.get(l);
     }
 };
 
@@ -3,7 +3,7 @@
  *
  * This file is part of the traintastic source code.
  *
- * Copyright (C) 2020-2021,2023 Reinder Feenstra
+ * Copyright (C) 2020-2021,2023-2024 Reinder Feenstra
  *
  * This program is free software; you can redistribute it and/or
  * modify it under the terms of the GNU General Public License
@@ -33,6 +33,8 @@
 
 BoardList::BoardList(Object& _parent, std::string_view parentPropertyName) :
   ObjectList<Board>(_parent, parentPropertyName),
+  m_signalEngine(*this),
+  m_routeSetter(*this),
   create{*this, "create",
     [this]()
     {
@@ -73,24 +75,22 @@ void BoardList::worldEvent(WorldState state, WorldEvent event)
     const auto start = std::chrono::steady_clock::now();
 #endif
 
-    // due to link tile a change on one board might require an update on another board.
-    // for now update all board if one board is changed (should be improved!)
+    // only links touching modified tiles are rebuild, due to link tiles blocks on other boards can be affected too:
+    Board::Blocks blocks;
     bool boardModified = false;
     for(auto& board : m_items)
     {
       if(board->m_modified)
       {
+        board->modified(blocks);
         boardModified = true;
-        break;
       }
     }
     if(boardModified)
     {
+      Board::updateBlocks(blocks);
       for(auto& board : m_items)
-      {
-        board->m_modified = true;
-        board->modified();
-      }
+        board->notifyModified();
     }
 
 #ifdef ENABLE_LOG_DEBUG
@@ -3,7 +3,7 @@
  *
  * This file is part of the traintastic source code.
  *
- * Copyright (C) 2020-2021,2023 Reinder Feenstra
+ * Copyright (C) 2020-2021,2023-2024 Reinder Feenstra
  *
  * This program is free software; you can redistribute it and/or
  * modify it under the terms of the GNU General Public License
@@ -25,11 +25,21 @@
 
 #include "../core/objectlist.hpp"
 #include "../core/method.hpp"
+#include "map/routegraph.hpp"
+#include "map/blockpathconflicts.hpp"
+#include "map/signalengine.hpp"
+#include "map/routesetter.hpp"
 
 class Board;
 
 class BoardList : public ObjectList<Board>
 {
+  private:
+    RouteGraph m_routeGraph;
+    BlockPathConflicts m_blockPathConflicts;
+    SignalEngine m_signalEngine;
+    RouteSetter m_routeSetter;
+
   protected:
     void worldEvent(WorldState state, WorldEvent event) final;
     bool isListedProperty(std::string_view name) final;
@@ -43,6 +53,35 @@ class BoardList : public ObjectList<Board>
     BoardList(Object& _parent, std::string_view parentPropertyName);
 
     TableModelPtr getModel() final;
+
+    //! \brief Route graph of all blocks on all boards
+    RouteGraph& routeGraph()
+    {
+      return m_routeGraph;
+    }
+
+    const RouteGraph& routeGraph() const
+    {
+      return m_routeGraph;
+    }
+
+    //! \brief Conflicts between all block paths on all boards
+    BlockPathConflicts& blockPathConflicts()
+    {
+      return m_blockPathConflicts;
+    }
+
+    //! \brief Signal aspect evaluation of all signals on all boards
+    SignalEngine& signalEngine()
+    {
+      return m_signalEngine;
+    }
+
+    //! \brief Sets turnouts of reserved block paths on all boards
+    RouteSetter& routeSetter()
+    {
+      return m_routeSetter;
+    }
 };
 
 #endif
@@ -3,7 +3,7 @@
  *
  * This file is part of the traintastic source code.
  *
- * Copyright (C) 2022-2023 Reinder Feenstra
+ * Copyright (C) 2022-2024 Reinder Feenstra
  *
  * This program is free software; you can redistribute it and/or
  * modify it under the terms of the GNU General Public License
@@ -29,7 +29,8 @@
 #include "../tile/rail/onewayrailtile.hpp"
 #include "../tile/rail/linkrailtile.hpp"
 #include "../tile/rail/signal/signalrailtile.hpp"
-#include "../map/abstractsignalpath.hpp"
+#include "../boardlist.hpp"
+#include "../../world/world.hpp"
 #include "../../train/train.hpp" // FIXME: required due to forward declaration
 
 AbstractSignalPath::AbstractSignalPath(SignalRailTile& signal)
@@ -62,13 +63,15 @@ AbstractSignalPath::AbstractSignalPath(SignalRailTile& signal, size_t blocksAhea
       item = item->next().get();
     }
   }
+
+  signal.world().boards->signalEngine().add(*this);
 }
 
 AbstractSignalPath::~AbstractSignalPath()
 {
-  for(auto& connection : m_connections)
+  if(auto& world = m_signal.world(); world.boards)
   {
-    connection.disconnect();
+    world.boards->signalEngine().remove(*this);
   }
 }
 
@@ -159,11 +162,7 @@ std::unique_ptr<const AbstractSignalPath::Item> AbstractSignalPath::findBlocks(c
 
   if(auto block = std::dynamic_pointer_cast<BlockRailTile>(tile))
   {
-    m_connections.emplace_back(block->stateChanged.connect(
-      [this](const BlockRailTile& /*tile*/, BlockState /*state*/)
-      {
-        evaluate();
-      }));
+    m_dependencies.emplace_back(block);
 
     const auto enterSide = (nextNode.getLink(0).get() == &link) ? BlockSide::A : BlockSide::B;
     std::unique_ptr<const Item> next;
@@ -176,11 +175,7 @@ std::unique_ptr<const AbstractSignalPath::Item> AbstractSignalPath::findBlocks(c
   {
     if(const auto& nextLink = otherLink(nextNode, link))
     {
-      m_connections.emplace_back(signal->aspectChanged.connect(
-        [this](const SignalRailTile& /*tile*/, SignalAspect /*aspect*/)
-        {
-          evaluate();
-        }));
+      m_dependencies.emplace_back(signal);
 
       return std::unique_ptr<const AbstractSignalPath::Item>{
         new SignalItem(
@@ -190,11 +185,7 @@ std::unique_ptr<const AbstractSignalPath::Item> AbstractSignalPath::findBlocks(c
   }
   else if(auto turnout = std::dynamic_pointer_cast<TurnoutRailTile>(tile))
   {
-    m_connections.emplace_back(turnout->positionChanged.connect(
-      [this](const TurnoutRailTile& /*tile*/, TurnoutPosition /*position*/)
-      {
-        evaluate();
-      }));
+    m_dependencies.emplace_back(turnout);
 
     std::map<TurnoutPosition, std::unique_ptr<const Item>> next;
     for (const auto& tpl : getTurnoutLinks(*turnout, link))
@@ -214,11 +205,7 @@ std::unique_ptr<const AbstractSignalPath::Item> AbstractSignalPath::findBlocks(c
       //  ( )
       //   |
       //  0 A
-      m_connections.emplace_back(direction->stateChanged.connect(
-        [this](const DirectionControlRailTile& /*tile*/, DirectionControlState /*state*/)
-        {
-          evaluate();
-        }));
+      m_dependencies.emplace_back(direction);
 
       return std::unique_ptr<const AbstractSignalPath::Item>{
         new DirectionControlItem(
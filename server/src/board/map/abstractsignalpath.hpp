@@ -3,7 +3,7 @@
  *
  * This file is part of the traintastic source code.
  *
- * Copyright (C) 2022-2023 Reinder Feenstra
+ * Copyright (C) 2022-2024 Reinder Feenstra
  *
  * This program is free software; you can redistribute it and/or
  * modify it under the terms of the GNU General Public License
@@ -26,7 +26,6 @@
 #include "path.hpp"
 #include "link.hpp"
 #include <map>
-#include <boost/signals2/connection.hpp>
 #include <traintastic/enum/blockstate.hpp>
 
 class BlockRailTile;
@@ -40,6 +39,8 @@ enum class SignalAspect : uint8_t;
 
 class AbstractSignalPath : public Path
 {
+  friend class SignalEngine;
+
   private:
     SignalRailTile& m_signal;
 
@@ -155,7 +156,7 @@ class AbstractSignalPath : public Path
   private:
     std::unique_ptr<const Item> m_root;
     bool m_requireReservation = false;
-    std::vector<boost::signals2::connection> m_connections;
+    std::vector<std::weak_ptr<Tile>> m_dependencies; //!< tiles affecting the aspect, see SignalEngine
 
     std::unique_ptr<const Item> findBlocks(const Node& node, const Link& link, size_t blocksAhead);
 
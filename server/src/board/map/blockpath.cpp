@@ -3,7 +3,7 @@
  *
  * This file is part of the traintastic source code.
  *
- * Copyright (C) 2023 Reinder Feenstra
+ * Copyright (C) 2023-2024 Reinder Feenstra
  *
  * This program is free software; you can redistribute it and/or
  * modify it under the terms of the GNU General Public License
@@ -21,6 +21,7 @@
  */
 
 #include "blockpath.hpp"
+#include <limits>
 #include <queue>
 #include <traintastic/enum/crossstate.hpp>
 #include "node.hpp"
@@ -33,19 +34,10 @@
 #include "../tile/rail/turnout/turnoutrailtile.hpp"
 #include "../tile/rail/linkrailtile.hpp"
 #include "../tile/rail/nxbuttonrailtile.hpp"
+#include "../boardlist.hpp"
 #include "../../core/objectproperty.tpp"
 #include "../../enum/bridgepath.hpp"
-
-template<class T1, typename T2>
-static bool contains(const std::vector<std::pair<std::weak_ptr<T1>, T2>>& values, const std::shared_ptr<T1>& value)
-{
-  const auto it = std::find_if(values.begin(), values.end(),
-    [&value](const auto& item)
-    {
-      return item.first.lock() == value;
-    });
-  return it != values.end();
-}
+#include "../../world/world.hpp"
 
 template <typename T>
 static inline bool operator ==(const std::weak_ptr<T>& a, const std::weak_ptr<T>& b)
@@ -53,8 +45,37 @@ static inline bool operator ==(const std::weak_ptr<T>& a, const std::weak_ptr<T>
     return !a.owner_before(b) && !b.owner_before(a);
 }
 
+namespace
+{
+  //! \brief Search step of BlockPath::find(), paths forked at a turnout share the steps before it
+  struct Step
+  {
+    enum class Type : uint8_t
+    {
+      Tile,
+      Turnout,
+      DirectionControl,
+      Cross,
+      Bridge,
+      Signal,
+      NXButtonFrom,
+    };
+
+    static constexpr uint32_t none = std::numeric_limits<uint32_t>::max();
+
+    uint32_t previous; //!< index of the previous step, \ref none if first
+    Type type;
+    uint8_t value; //!< turnout position, direction control state, cross state or bridge path
+    Tile* tile;
+  };
+}
+
 std::vector<std::shared_ptr<BlockPath>> BlockPath::find(BlockRailTile& startBlock)
 {
+#ifdef TRAINTASTIC_TEST
+  findCount++;
+#endif
+
   const auto& node = startBlock.node()->get();
   const auto& linkA = node.getLink(0);
   const auto& linkB = node.getLink(1);
@@ -64,23 +85,99 @@ std::vector<std::shared_ptr<BlockPath>> BlockPath::find(BlockRailTile& startBloc
     return {};
   }
 
+  // The search only records steps, a BlockPath is created when a path reaches a block.
+  // A fork at a turnout only adds a position, the steps before the turnout are shared.
   struct Position
   {
-    std::shared_ptr<BlockPath> path;
+    BlockSide side;
+    uint32_t last; //!< index of the last step
     const Node* node;
     const Link* link;
   };
 
+  std::vector<Step> steps;
+  auto addStep =
+    [&steps](Position& position, Step::Type type, Tile& tile, uint8_t value = 0)
+    {
+      steps.emplace_back(Step{position.last, type, value, &tile});
+      position.last = static_cast<uint32_t>(steps.size() - 1);
+    };
+  auto hasStep =
+    [&steps](const Position& position, Step::Type type, const Tile& tile)
+    {
+      for(uint32_t i = position.last; i != Step::none; i = steps[i].previous)
+      {
+        if(steps[i].type == type && steps[i].tile == &tile)
+        {
+          return true;
+        }
+      }
+      return false;
+    };
+
   std::vector<std::shared_ptr<BlockPath>> paths;
+  std::vector<uint32_t> chain;
+  auto complete =
+    [&startBlock, &steps, &paths, &chain](const Position& position, BlockRailTile& block, BlockSide toSide, Tile* nxButtonTo)
+    {
+      chain.clear();
+      for(uint32_t i = position.last; i != Step::none; i = steps[i].previous)
+      {
+        chain.emplace_back(i);
+      }
+
+      auto path = std::make_shared<BlockPath>(startBlock, position.side);
+      for(auto it = chain.rbegin(); it != chain.rend(); ++it)
+      {
+        const auto& step = steps[*it];
+        switch(step.type)
+        {
+          case Step::Type::Tile:
+            path->m_tiles.emplace_back(step.tile->shared_ptr<RailTile>());
+            break;
+
+          case Step::Type::Turnout:
+            path->m_turnouts.emplace_back(step.tile->shared_ptr<TurnoutRailTile>(), static_cast<TurnoutPosition>(step.value));
+            break;
+
+          case Step::Type::DirectionControl:
+            path->m_directionControls.emplace_back(step.tile->shared_ptr<DirectionControlRailTile>(), static_cast<DirectionControlState>(step.value));
+            break;
+
+          case Step::Type::Cross:
+            path->m_crossings.emplace_back(step.tile->shared_ptr<CrossRailTile>(), static_cast<CrossState>(step.value));
+            break;
+
+          case Step::Type::Bridge:
+            path->m_bridges.emplace_back(step.tile->shared_ptr<BridgeRailTile>(), static_cast<BridgePath>(step.value));
+            break;
+
+          case Step::Type::Signal:
+            path->m_signals.emplace_back(step.tile->shared_ptr<SignalRailTile>());
+            break;
+
+          case Step::Type::NXButtonFrom:
+            path->m_nxButtonFrom = step.tile->shared_ptr<NXButtonRailTile>();
+            break;
+        }
+      }
+      if(nxButtonTo)
+      {
+        path->m_nxButtonTo = nxButtonTo->shared_ptr<NXButtonRailTile>();
+      }
+      path->m_toBlock = block.shared_ptr<BlockRailTile>();
+      path->m_toSide = toSide;
+      paths.emplace_back(std::move(path));
+    };
 
   std::queue<Position> todo;
   if(linkA)
   {
-    todo.emplace(Position{std::make_shared<BlockPath>(startBlock, BlockSide::A), &node, linkA.get()});
+    todo.emplace(Position{BlockSide::A, Step::none, &node, linkA.get()});
   }
   if(linkB)
   {
-    todo.emplace(Position{std::make_shared<BlockPath>(startBlock, BlockSide::B), &node, linkB.get()});
+    todo.emplace(Position{BlockSide::B, Step::none, &node, linkB.get()});
   }
 
   while(!todo.empty())
@@ -94,7 +191,7 @@ std::vector<std::shared_ptr<BlockPath>> BlockPath::find(BlockRailTile& startBloc
 
     for(const auto& tile : current.link->tiles()) // add passive tiles to reserve
     {
-      current.path->m_tiles.emplace_back(std::static_pointer_cast<RailTile>(tile));
+      addStep(current, Step::Type::Tile, *tile);
     }
 
     assert(current.node);
@@ -105,15 +202,8 @@ std::vector<std::shared_ptr<BlockPath>> BlockPath::find(BlockRailTile& startBloc
     {
       case TileId::RailBlock:
       {
-        if(current.node->tile().tileId() == TileId::RailNXButton)
-        {
-          current.path->m_nxButtonTo = current.node->tile().shared_ptr<NXButtonRailTile>();
-        }
-
-        auto& block = static_cast<BlockRailTile&>(tile);
-        current.path->m_toBlock = block.shared_ptr<BlockRailTile>();
-        current.path->m_toSide = nextNode.getLink(0).get() == current.link ? BlockSide::A : BlockSide::B;
-        paths.emplace_back(std::move(current.path));
+        Tile* nxButtonTo = (current.node->tile().tileId() == TileId::RailNXButton) ? &current.node->tile() : nullptr;
+        complete(current, static_cast<BlockRailTile&>(tile), nextNode.getLink(0).get() == current.link ? BlockSide::A : BlockSide::B, nxButtonTo);
         todo.pop(); // complete
         break;
       }
@@ -128,28 +218,24 @@ std::vector<std::shared_ptr<BlockPath>> BlockPath::find(BlockRailTile& startBloc
       case TileId::RailTurnoutSingleSlip:
       case TileId::RailTurnoutDoubleSlip:
       {
-        auto turnout = tile.shared_ptr<TurnoutRailTile>();
-        if(contains(current.path->m_turnouts, turnout))
+        if(hasStep(current, Step::Type::Turnout, tile))
         {
           todo.pop(); // drop it, can't pass turnout twice
           break;
         }
-        auto links = getTurnoutLinks(*turnout, *current.link);
+        auto links = getTurnoutLinks(static_cast<TurnoutRailTile&>(tile), *current.link);
         assert(!links.empty());
 
-        if(links.size() > 1)
+        for(size_t i = 1; i < links.size(); ++i) // "fork" path
         {
-          for(size_t i = 1; i < links.size(); ++i)
-          {
-            auto path = std::make_shared<BlockPath>(*current.path); // "fork" path
-            path->m_turnouts.emplace_back(turnout, links[i].turnoutPosition);
-            todo.emplace(Position{std::move(path), &nextNode, nextNode.getLink(links[i].linkIndex).get()});
-          }
+          Position fork{current.side, current.last, &nextNode, nextNode.getLink(links[i].linkIndex).get()};
+          addStep(fork, Step::Type::Turnout, tile, static_cast<uint8_t>(links[i].turnoutPosition));
+          todo.emplace(fork);
         }
 
         current.node = &nextNode;
         current.link = nextNode.getLink(links[0].linkIndex).get();
-        current.path->m_turnouts.emplace_back(turnout, links[0].turnoutPosition);
+        addStep(current, Step::Type::Turnout, tile, static_cast<uint8_t>(links[0].turnoutPosition));
         break;
       }
       case TileId::RailOneWay:
@@ -160,7 +246,7 @@ std::vector<std::shared_ptr<BlockPath>> BlockPath::find(BlockRailTile& startBloc
         //  0
         if(nextNode.getLink(0).get() == current.link) // 0 -> 1 = allowed
         {
-          current.path->m_tiles.emplace_back(tile.shared_ptr<RailTile>());
+          addStep(current, Step::Type::Tile, tile);
           current.node = &nextNode;
           current.link = nextNode.getLink(1).get();
         }
@@ -180,7 +266,7 @@ std::vector<std::shared_ptr<BlockPath>> BlockPath::find(BlockRailTile& startBloc
         const bool sideA = nextNode.getLink(0).get() == current.link;
         current.node = &nextNode;
         current.link = nextNode.getLink(sideA ? 1 : 0).get();
-        current.path->m_directionControls.emplace_back(tile.shared_ptr<DirectionControlRailTile>(), sideA ? DirectionControlState::AtoB : DirectionControlState::BtoA);
+        addStep(current, Step::Type::DirectionControl, tile, static_cast<uint8_t>(sideA ? DirectionControlState::AtoB : DirectionControlState::BtoA));
         break;
       }
       case TileId::RailBridge45Left:
@@ -197,7 +283,7 @@ std::vector<std::shared_ptr<BlockPath>> BlockPath::find(BlockRailTile& startBloc
           {
             current.node = &nextNode;
             current.link = nextNode.getLink((i + 2) % 4).get(); // opposite
-            current.path->m_bridges.emplace_back(tile.shared_ptr<BridgeRailTile>(), i % 2 == 0 ? BridgePath::AC : BridgePath::BD);
+            addStep(current, Step::Type::Bridge, tile, static_cast<uint8_t>(i % 2 == 0 ? BridgePath::AC : BridgePath::BD));
             break;
           }
         }
@@ -211,8 +297,7 @@ std::vector<std::shared_ptr<BlockPath>> BlockPath::find(BlockRailTile& startBloc
         // 1 --+-- 3    |
         //     |       /|
         //     0      1 0
-        auto cross = tile.shared_ptr<CrossRailTile>();
-        if(contains(current.path->m_crossings, cross))
+        if(hasStep(current, Step::Type::Cross, tile))
         {
           todo.pop(); // drop it, can't pass crossing twice
           break;
@@ -224,7 +309,7 @@ std::vector<std::shared_ptr<BlockPath>> BlockPath::find(BlockRailTile& startBloc
           {
             current.node = &nextNode;
             current.link = nextNode.getLink((i + 2) % 4).get(); // opposite
-            current.path->m_crossings.emplace_back(cross, i % 2 == 0 ? CrossState::AC : CrossState::BD);
+            addStep(current, Step::Type::Cross, tile, static_cast<uint8_t>(i % 2 == 0 ? CrossState::AC : CrossState::BD));
             break;
           }
         }
@@ -235,8 +320,8 @@ std::vector<std::shared_ptr<BlockPath>> BlockPath::find(BlockRailTile& startBloc
         auto& linkTile = static_cast<LinkRailTile&>(tile);
         if(linkTile.link) // is connected to another link
         {
-          current.path->m_tiles.emplace_back(linkTile.shared_ptr<RailTile>());
-          current.path->m_tiles.emplace_back(linkTile.link->shared_ptr<RailTile>());
+          addStep(current, Step::Type::Tile, linkTile);
+          addStep(current, Step::Type::Tile, *linkTile.link.value());
           assert(linkTile.link->node());
           auto& linkNode = linkTile.link->node()->get();
           current.node = &linkNode;
@@ -254,17 +339,17 @@ std::vector<std::shared_ptr<BlockPath>> BlockPath::find(BlockRailTile& startBloc
         if(nextNode.getLink(0).get() == current.link) // 0 -> 1 = frontside of signal
         {
           current.link = nextNode.getLink(1).get();
-          current.path->m_signals.emplace_back(tile.shared_ptr<SignalRailTile>());
+          addStep(current, Step::Type::Signal, tile);
         }
         else // 1 -> 0 = backside of signal, just pass
         {
           current.link = nextNode.getLink(0).get();
-          current.path->m_tiles.emplace_back(tile.shared_ptr<RailTile>());
+          addStep(current, Step::Type::Tile, tile);
         }
         break;
 
       case TileId::RailDecoupler:
-        current.path->m_tiles.emplace_back(tile.shared_ptr<RailTile>());
+        addStep(current, Step::Type::Tile, tile);
         current.node = &nextNode;
         current.link = otherLink(nextNode, *current.link).get();
         break;
@@ -272,11 +357,11 @@ std::vector<std::shared_ptr<BlockPath>> BlockPath::find(BlockRailTile& startBloc
       case TileId::RailNXButton:
         if(&current.node->tile() == &startBlock)
         {
-          current.path->m_nxButtonFrom = tile.shared_ptr<NXButtonRailTile>();
+          addStep(current, Step::Type::NXButtonFrom, tile);
         }
         else
         {
-          current.path->m_tiles.emplace_back(tile.shared_ptr<RailTile>());
+          addStep(current, Step::Type::Tile, tile);
         }
         current.node = &nextNode;
         current.link = otherLink(nextNode, *current.link).get();
@@ -291,7 +376,6 @@ std::vector<std::shared_ptr<BlockPath>> BlockPath::find(BlockRailTile& startBloc
   return paths;
 }
 
-
 BlockPath::BlockPath(BlockRailTile& block, BlockSide side)
   : m_fromBlock{block}
   , m_fromSide{side}
@@ -347,6 +431,31 @@ bool BlockPath::isReady() const
   return true;
 }
 
+bool BlockPath::isSet() const
+{
+  for(const auto& [turnoutWeak, position] : m_turnouts)
+  {
+    auto turnout = turnoutWeak.lock();
+    if(!turnout || turnout->position != position)
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+uint32_t BlockPath::length() const
+{
+  return static_cast<uint32_t>(
+    m_tiles.size() +
+    m_turnouts.size() +
+    m_directionControls.size() +
+    m_crossings.size() +
+    m_bridges.size() +
+    m_signals.size() +
+    (m_nxButtonFrom.expired() ? 0 : 1)); // NX button at the end is in m_tiles
+}
+
 std::shared_ptr<NXButtonRailTile> BlockPath::nxButtonFrom() const
 {
   return m_nxButtonFrom.lock();
@@ -364,6 +473,12 @@ bool BlockPath::reserve(const std::shared_ptr<Train>& train, bool dryRun)
     return false;
   }
 
+  auto& conflicts = m_fromBlock.world().boards->blockPathConflicts();
+  if(dryRun && !conflicts.isFree(*this)) // fast check: a tile is in use by another reserved path
+  {
+    return false;
+  }
+
   if(!m_fromBlock.reserve(shared_from_this(), train, m_fromSide, dryRun))
   {
     assert(dryRun);
@@ -487,6 +602,19 @@ bool BlockPath::reserve(const std::shared_ptr<Train>& train, bool dryRun)
     {
       nxButton->reserve();
     }
+
+    conflicts.reserve(*this);
+
+    std::vector<std::pair<std::shared_ptr<TurnoutRailTile>, TurnoutPosition>> turnouts;
+    turnouts.reserve(m_turnouts.size());
+    for(const auto& [turnoutWeak, position] : m_turnouts)
+    {
+      if(auto turnout = turnoutWeak.lock()) /*[[likely]]*/
+      {
+        turnouts.emplace_back(std::move(turnout), position);
+      }
+    }
+    m_fromBlock.world().boards->routeSetter().set(shared_from_this(), turnouts);
   }
 
   return true;
@@ -595,6 +723,9 @@ bool BlockPath::release(bool dryRun)
     {
       nxButton->release();
     }
+
+    m_fromBlock.world().boards->blockPathConflicts().release(*this);
+    m_fromBlock.world().boards->routeSetter().cancel(*this); // turnouts aren't needed anymore
   }
 
   return true;
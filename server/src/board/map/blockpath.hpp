@@ -3,7 +3,7 @@
  *
  * This file is part of the traintastic source code.
  *
- * Copyright (C) 2023 Reinder Feenstra
+ * Copyright (C) 2023-2024 Reinder Feenstra
  *
  * This program is free software; you can redistribute it and/or
  * modify it under the terms of the GNU General Public License
@@ -29,6 +29,7 @@
 #include <array>
 #include <vector>
 #include <utility>
+#include "blockpathconflicts.hpp"
 #include "../../enum/blockside.hpp"
 
 class RailTile;
@@ -50,6 +51,8 @@ class Train;
  */
 class BlockPath : public Path, public std::enable_shared_from_this<BlockPath>
 {
+  friend class BlockPathConflicts;
+
   private:
     BlockRailTile& m_fromBlock;
     const BlockSide m_fromSide;
@@ -63,8 +66,13 @@ class BlockPath : public Path, public std::enable_shared_from_this<BlockPath>
     std::vector<std::weak_ptr<SignalRailTile>> m_signals; //!< signals in path
     std::weak_ptr<NXButtonRailTile> m_nxButtonFrom;
     std::weak_ptr<NXButtonRailTile> m_nxButtonTo;
+    uint32_t m_conflictIndex = BlockPathConflicts::noIndex;
 
   public:
+#ifdef TRAINTASTIC_TEST
+    inline static size_t findCount = 0; //!< number of find() calls
+#endif
+
     static std::vector<std::shared_ptr<BlockPath>> find(BlockRailTile& block);
 
     BlockPath(BlockRailTile& block, BlockSide side);
@@ -74,6 +82,9 @@ class BlockPath : public Path, public std::enable_shared_from_this<BlockPath>
     //! \return \c true if all turnouts are in position and direction controls are allowed to pass.
     bool isReady() const;
 
+    //! \return \c true if all turnouts are in position, a train leaving the block at \ref fromSide() follows this path.
+    bool isSet() const;
+
     bool hasNXButtons() const
     {
       return !m_nxButtonFrom.expired() && !m_nxButtonTo.expired();
@@ -99,6 +110,14 @@ class BlockPath : public Path, public std::enable_shared_from_this<BlockPath>
       return m_toSide;
     }
 
+    //! \return Number of tiles in the path, excluding the blocks
+    uint32_t length() const;
+
+    uint32_t turnoutCount() const
+    {
+      return static_cast<uint32_t>(m_turnouts.size());
+    }
+
     std::shared_ptr<NXButtonRailTile> nxButtonFrom() const;
     std::shared_ptr<NXButtonRailTile> nxButtonTo() const;
 
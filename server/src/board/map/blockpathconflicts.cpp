@@ -0,0 +1,329 @@
+/**
+ * server/src/board/map/blockpathconflicts.cpp
+ *
+ * This file is part of the traintastic source code.
+ *
+ * Copyright (C) 2024 Reinder Feenstra
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+#include "blockpathconflicts.hpp"
+#include <algorithm>
+#include <cassert>
+#include "blockpath.hpp"
+#include "../tile/rail/blockrailtile.hpp"
+#include "../tile/rail/bridgerailtile.hpp"
+#include "../tile/rail/crossrailtile.hpp"
+#include "../tile/rail/directioncontrolrailtile.hpp"
+#include "../tile/rail/nxbuttonrailtile.hpp"
+#include "../tile/rail/signal/signalrailtile.hpp"
+#include "../tile/rail/turnout/turnoutrailtile.hpp"
+#include "../../enum/bridgepath.hpp"
+
+inline void BlockPathConflicts::set(Bits& bits, uint32_t index, bool value)
+{
+  const uint32_t word = index / wordBits;
+  if(word >= bits.size())
+  {
+    if(!value)
+    {
+      return;
+    }
+    bits.resize(word + 1, 0);
+  }
+  const Word mask = Word(1) << (index % wordBits);
+  if(value)
+  {
+    bits[word] |= mask;
+  }
+  else
+  {
+    bits[word] &= ~mask;
+  }
+}
+
+std::vector<BlockPathConflicts::Resource> BlockPathConflicts::getResources(const BlockPath& path)
+{
+  std::vector<Resource> resources;
+
+  auto addTile =
+    [&resources](const auto& tileWeak, uint8_t track = 0)
+    {
+      if(auto tile = tileWeak.lock())
+      {
+        resources.emplace_back(static_cast<const RailTile*>(tile.get()), track);
+      }
+    };
+
+  for(const auto& tile : path.m_tiles)
+  {
+    addTile(tile);
+  }
+  for(const auto& [turnout, position] : path.m_turnouts)
+  {
+    addTile(turnout); // a turnout can only be used by one path, independent of its position
+  }
+  for(const auto& [directionControl, state] : path.m_directionControls)
+  {
+    addTile(directionControl);
+  }
+  for(const auto& [cross, state] : path.m_crossings)
+  {
+    addTile(cross); // a crossing can only be used by one path, see CrossRailTile::reserve
+  }
+  for(const auto& [bridge, bridgePath] : path.m_bridges)
+  {
+    addTile(bridge, 1 + static_cast<uint8_t>(bridgePath)); // both tracks of a bridge can be used at the same time
+  }
+  for(const auto& signal : path.m_signals)
+  {
+    addTile(signal);
+  }
+  addTile(path.m_nxButtonFrom); // NX button at the end is in m_tiles
+
+  return resources;
+}
+
+uint32_t BlockPathConflicts::addResource(const Resource& resource, uint32_t pathIndex)
+{
+  uint32_t index;
+  if(auto it = m_resources.find(resource); it != m_resources.end())
+  {
+    index = it->second;
+  }
+  else
+  {
+    if(!m_freeResources.empty())
+    {
+      index = m_freeResources.back();
+      m_freeResources.pop_back();
+      m_resourceKeys[index] = resource;
+    }
+    else
+    {
+      index = static_cast<uint32_t>(m_resourceKeys.size());
+      m_resourceKeys.emplace_back(resource);
+      m_resourceUsers.emplace_back();
+    }
+    m_resources.emplace(resource, index);
+  }
+
+  auto& users = m_resourceUsers[index];
+  if(std::find(users.begin(), users.end(), pathIndex) == users.end())
+  {
+    users.emplace_back(pathIndex);
+  }
+  return index;
+}
+
+void BlockPathConflicts::removeResource(uint32_t resourceIndex, uint32_t pathIndex)
+{
+  auto& users = m_resourceUsers[resourceIndex];
+  users.erase(std::remove(users.begin(), users.end(), pathIndex), users.end());
+  if(users.empty())
+  {
+    m_resources.erase(m_resourceKeys[resourceIndex]);
+    m_resourceKeys[resourceIndex] = {nullptr, 0};
+    set(m_occupied, resourceIndex, false);
+    m_freeResources.emplace_back(resourceIndex);
+  }
+}
+
+void BlockPathConflicts::add(BlockPath& path)
+{
+  assert(path.m_conflictIndex == noIndex);
+
+  uint32_t index;
+  if(!m_freePaths.empty())
+  {
+    index = m_freePaths.back();
+    m_freePaths.pop_back();
+  }
+  else
+  {
+    index = static_cast<uint32_t>(m_paths.size());
+    m_paths.emplace_back();
+  }
+
+  path.m_conflictIndex = index;
+  m_paths[index].path = &path;
+
+  for(const auto& resource : getResources(path))
+  {
+    const uint32_t resourceIndex = addResource(resource, index);
+
+    auto& data = m_paths[index];
+    if(std::find(data.resources.begin(), data.resources.end(), resourceIndex) != data.resources.end())
+    {
+      continue; // path uses tile twice, e.g. both tracks of a bridge
+    }
+    data.resources.emplace_back(resourceIndex);
+
+    const uint32_t word = resourceIndex / wordBits;
+    const Word mask = Word(1) << (resourceIndex % wordBits);
+    if(auto it = std::find_if(data.resourceMask.begin(), data.resourceMask.end(), [word](const auto& item) { return item.first == word; }); it != data.resourceMask.end())
+    {
+      it->second |= mask;
+    }
+    else
+    {
+      data.resourceMask.emplace_back(word, mask);
+    }
+
+    for(uint32_t other : m_resourceUsers[resourceIndex])
+    {
+      if(other != index)
+      {
+        set(data.conflicts, other, true);
+        set(m_paths[other].conflicts, index, true);
+      }
+    }
+  }
+}
+
+void BlockPathConflicts::remove(BlockPath& path)
+{
+  const uint32_t index = path.m_conflictIndex;
+  if(index == noIndex)
+  {
+    return;
+  }
+
+  if(test(m_reserved, index))
+  {
+    release(path);
+  }
+
+  auto& data = m_paths[index];
+  for(uint32_t resourceIndex : data.resources) // all conflicting paths share a resource
+  {
+    for(uint32_t other : m_resourceUsers[resourceIndex])
+    {
+      if(other != index)
+      {
+        set(m_paths[other].conflicts, index, false);
+      }
+    }
+  }
+  for(uint32_t resourceIndex : data.resources)
+  {
+    removeResource(resourceIndex, index);
+  }
+
+  data = PathData();
+  m_freePaths.emplace_back(index);
+  path.m_conflictIndex = noIndex;
+}
+
+void BlockPathConflicts::update(const BlockRailTile& block, const std::vector<std::shared_ptr<BlockPath>>& removed)
+{
+  for(const auto& path : removed)
+  {
+    remove(*path);
+  }
+  for(const auto& path : block.paths())
+  {
+    if(path->m_conflictIndex == noIndex)
+    {
+      add(*path);
+    }
+  }
+}
+
+void BlockPathConflicts::remove(const BlockRailTile& block)
+{
+  for(const auto& path : block.paths())
+  {
+    remove(*path);
+  }
+}
+
+bool BlockPathConflicts::conflicts(const BlockPath& a, const BlockPath& b) const
+{
+  if(a.m_conflictIndex == noIndex || b.m_conflictIndex == noIndex)
+  {
+    return false;
+  }
+  return test(m_paths[a.m_conflictIndex].conflicts, b.m_conflictIndex);
+}
+
+bool BlockPathConflicts::conflictsWithReserved(const BlockPath& path) const
+{
+  if(path.m_conflictIndex == noIndex)
+  {
+    return false;
+  }
+  const auto& conflicts = m_paths[path.m_conflictIndex].conflicts;
+  const size_t n = std::min(conflicts.size(), m_reserved.size());
+  for(size_t i = 0; i < n; ++i)
+  {
+    if(conflicts[i] & m_reserved[i])
+    {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool BlockPathConflicts::isFree(const BlockPath& path) const
+{
+  if(path.m_conflictIndex == noIndex)
+  {
+    return true; // unknown path, e.g. not yet added
+  }
+  for(const auto& [word, mask] : m_paths[path.m_conflictIndex].resourceMask)
+  {
+    if(word < m_occupied.size() && (m_occupied[word] & mask))
+    {
+      return false;
+    }
+  }
+  return true;
+}
+
+void BlockPathConflicts::reserve(const BlockPath& path)
+{
+  if(path.m_conflictIndex == noIndex)
+  {
+    return;
+  }
+  for(const auto& [word, mask] : m_paths[path.m_conflictIndex].resourceMask)
+  {
+    if(word >= m_occupied.size())
+    {
+      m_occupied.resize(word + 1, 0);
+    }
+    m_occupied[word] |= mask;
+  }
+  set(m_reserved, path.m_conflictIndex, true);
+}
+
+void BlockPathConflicts::release(const BlockPath& path)
+{
+  if(path.m_conflictIndex == noIndex)
+  {
+    return;
+  }
+  for(const auto& [word, mask] : m_paths[path.m_conflictIndex].resourceMask)
+  {
+    if(word < m_occupied.size())
+    {
+      m_occupied[word] &= ~mask;
+    }
+  }
+  set(m_reserved, path.m_conflictIndex, false);
+}
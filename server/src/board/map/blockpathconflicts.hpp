@@ -0,0 +1,131 @@
+/**
+ * server/src/board/map/blockpathconflicts.hpp
+ *
+ * This file is part of the traintastic source code.
+ *
+ * Copyright (C) 2024 Reinder Feenstra
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+#ifndef TRAINTASTIC_SERVER_BOARD_MAP_BLOCKPATHCONFLICTS_HPP
+#define TRAINTASTIC_SERVER_BOARD_MAP_BLOCKPATHCONFLICTS_HPP
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+#include <utility>
+#include <unordered_map>
+
+class RailTile;
+class BlockPath;
+class BlockRailTile;
+
+/**
+ * \brief Precomputed conflicts between all block paths and the resources in use by reserved paths
+ *
+ * A resource is a tile a path needs, for bridges each of the two tracks is a resource.
+ * Two paths conflict if they share a resource. Each path and each resource has a bit index,
+ * so checking if a path can be reserved is an AND of a few words of the occupied resources bitset.
+ *
+ * Blocks aren't a resource, their sides are reserved by the block itself.
+ */
+class BlockPathConflicts
+{
+  public:
+    using Word = uint64_t;
+    using Bits = std::vector<Word>;
+
+    static constexpr uint32_t noIndex = std::numeric_limits<uint32_t>::max();
+    static constexpr uint32_t wordBits = 64;
+
+  private:
+    using Resource = std::pair<const RailTile*, uint8_t>;
+
+    struct ResourceHash
+    {
+      size_t operator()(const Resource& resource) const
+      {
+        return std::hash<const void*>{}(resource.first) ^ resource.second;
+      }
+    };
+
+    struct PathData
+    {
+      const BlockPath* path = nullptr; //!< \c nullptr if index is unused
+      std::vector<uint32_t> resources;
+      std::vector<std::pair<uint32_t, Word>> resourceMask; //!< word index and mask in the resource bitset
+      Bits conflicts; //!< paths sharing a resource
+    };
+
+    std::vector<PathData> m_paths; //!< index is path index
+    std::vector<uint32_t> m_freePaths;
+    std::unordered_map<Resource, uint32_t, ResourceHash> m_resources;
+    std::vector<Resource> m_resourceKeys; //!< index is resource index
+    std::vector<std::vector<uint32_t>> m_resourceUsers; //!< paths using a resource, index is resource index
+    std::vector<uint32_t> m_freeResources;
+    Bits m_occupied; //!< resources in use by reserved paths
+    Bits m_reserved; //!< reserved paths
+
+    static inline bool test(const Bits& bits, uint32_t index)
+    {
+      return (index / wordBits) < bits.size() && (bits[index / wordBits] & (Word(1) << (index % wordBits)));
+    }
+
+    static inline void set(Bits& bits, uint32_t index, bool value);
+
+    static std::vector<Resource> getResources(const BlockPath& path);
+
+    uint32_t addResource(const Resource& resource, uint32_t pathIndex);
+    void removeResource(uint32_t resourceIndex, uint32_t pathIndex);
+    void add(BlockPath& path);
+    void remove(BlockPath& path);
+
+  public:
+    BlockPathConflicts() = default;
+    BlockPathConflicts(const BlockPathConflicts&) = delete;
+    BlockPathConflicts& operator =(const BlockPathConflicts&) = delete;
+
+    //! \brief Number of paths
+    size_t size() const
+    {
+      return m_paths.size() - m_freePaths.size();
+    }
+
+    //! \brief Update the paths of \a block, paths in \a removed are no longer a path of the block
+    void update(const BlockRailTile& block, const std::vector<std::shared_ptr<BlockPath>>& removed);
+
+    //! \brief Remove all paths of \a block
+    void remove(const BlockRailTile& block);
+
+    //! \return \c true if \a a and \a b share a resource
+    bool conflicts(const BlockPath& a, const BlockPath& b) const;
+
+    //! \return \c true if \a path conflicts with a reserved path
+    bool conflictsWithReserved(const BlockPath& path) const;
+
+    //! \return \c true if none of the resources of \a path are in use
+    bool isFree(const BlockPath& path) const;
+
+    //! \brief Mark resources of \a path in use
+    void reserve(const BlockPath& path);
+
+    //! \brief Mark resources of \a path free
+    void release(const BlockPath& path);
+};
+
+#endif
@@ -0,0 +1,290 @@
+/**
+ * server/src/board/map/routegraph.cpp
+ *
+ * This file is part of the traintastic source code.
+ *
+ * Copyright (C) 2024 Reinder Feenstra
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "routegraph.hpp"
+#include <queue>
+#include <algorithm>
+#include "blockpath.hpp"
+#include "../tile/rail/blockrailtile.hpp"
+
+namespace {
+
+struct State
+{
+  const BlockRailTile* block;
+  BlockSide side; //!< side to leave the block
+
+  bool operator ==(const State& other) const
+  {
+    return block == other.block && side == other.side;
+  }
+};
+
+struct StateHash
+{
+  size_t operator()(const State& state) const
+  {
+    return std::hash<const void*>{}(state.block) ^ static_cast<size_t>(state.side);
+  }
+};
+
+struct QueueItem
+{
+  uint32_t cost;
+  State state;
+
+  bool operator >(const QueueItem& other) const
+  {
+    return cost > other.cost;
+  }
+};
+
+}
+
+uint32_t RouteGraph::cost(const BlockPath& path)
+{
+  return path.length() + 1 + turnoutCost * path.turnoutCount(); // +1 for the block
+}
+
+void RouteGraph::updateTotals(Route& route)
+{
+  route.length = 0;
+  route.turnouts = 0;
+  route.cost = 0;
+  for(const auto& path : route.paths)
+  {
+    route.length += path->length();
+    route.turnouts += path->turnoutCount();
+    route.cost += cost(*path);
+  }
+}
+
+void RouteGraph::update(const BlockRailTile& block)
+{
+  auto& vertices = m_blocks[&block];
+  for(auto& edges : vertices)
+  {
+    edges.clear();
+  }
+  for(const auto& path : block.paths())
+  {
+    vertices[static_cast<uint8_t>(path->fromSide())].emplace_back(Edge{path, cost(*path)});
+  }
+}
+
+void RouteGraph::remove(const BlockRailTile& block)
+{
+  m_blocks.erase(&block);
+}
+
+std::optional<RouteGraph::Route> RouteGraph::shortest(const BlockRailTile& from, const BlockRailTile& to, std::optional<BlockSide> fromSide) const
+{
+  return search(from, fromSide, to, {}, {});
+}
+
+std::vector<RouteGraph::Route> RouteGraph::kShortest(const BlockRailTile& from, const BlockRailTile& to, size_t k, std::optional<BlockSide> fromSide) const
+{
+  std::vector<Route> routes;
+  if(k == 0)
+  {
+    return routes;
+  }
+
+  if(auto route = search(from, fromSide, to, {}, {}))
+  {
+    routes.emplace_back(std::move(*route));
+  }
+  else
+  {
+    return routes;
+  }
+
+  std::vector<Route> candidates;
+
+  auto isKnown =
+    [&routes, &candidates](const Route& route)
+    {
+      auto samePaths =
+        [&route](const Route& other)
+        {
+          return other.paths == route.paths;
+        };
+      return
+        std::any_of(routes.begin(), routes.end(), samePaths) ||
+        std::any_of(candidates.begin(), candidates.end(), samePaths);
+    };
+
+  while(routes.size() < k)
+  {
+    const std::vector<std::shared_ptr<BlockPath>> last = routes.back().paths;
+
+    // deviate from the last found route at every block on it:
+    for(size_t i = 0; i < last.size(); ++i)
+    {
+      ExcludedPaths excludedPaths;
+      for(const auto& route : routes)
+      {
+        if(route.paths.size() > i && std::equal(last.begin(), last.begin() + i, route.paths.begin()))
+        {
+          excludedPaths.emplace(route.paths[i].get()); // don't take the same path from here again
+        }
+      }
+
+      ExcludedBlocks excludedBlocks;
+      for(size_t j = 0; j < i; ++j)
+      {
+        excludedBlocks.emplace(&last[j]->fromBlock()); // don't pass a block twice
+      }
+
+      const auto& spurBlock = last[i]->fromBlock();
+      const auto spurSide = (i == 0) ? fromSide : std::optional<BlockSide>(last[i]->fromSide());
+
+      if(auto spur = search(spurBlock, spurSide, to, excludedBlocks, excludedPaths))
+      {
+        Route route;
+        route.paths.reserve(i + spur->paths.size());
+        route.paths.assign(last.begin(), last.begin() + i);
+        route.paths.insert(route.paths.end(), spur->paths.begin(), spur->paths.end());
+        if(!isKnown(route))
+        {
+          updateTotals(route);
+          candidates.emplace_back(std::move(route));
+        }
+      }
+    }
+
+    if(candidates.empty())
+    {
+      break; // no more routes
+    }
+
+    auto it = std::min_element(candidates.begin(), candidates.end(),
+      [](const Route& a, const Route& b)
+      {
+        return a.cost < b.cost;
+      });
+    routes.emplace_back(std::move(*it));
+    candidates.erase(it);
+  }
+
+  return routes;
+}
+
+std::optional<RouteGraph::Route> RouteGraph::search(const BlockRailTile& from, std::optional<BlockSide> fromSide, const BlockRailTile& to,
+  const ExcludedBlocks& excludedBlocks, const ExcludedPaths& excludedPaths) const
+{
+  if(&from == &to || m_blocks.count(&from) == 0 || m_blocks.count(&to) == 0)
+  {
+    return std::nullopt;
+  }
+
+  std::unordered_map<State, uint32_t, StateHash> costs;
+  std::unordered_map<State, std::shared_ptr<BlockPath>, StateHash> previous; //!< path used to reach the state
+  std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue;
+
+  for(auto side : {BlockSide::A, BlockSide::B})
+  {
+    if(!fromSide || *fromSide == side)
+    {
+      costs.emplace(State{&from, side}, 0);
+      queue.emplace(QueueItem{0, State{&from, side}});
+    }
+  }
+
+  // check if block is already passed to reach state:
+  auto isPassed =
+    [&previous](State state, const BlockRailTile* block)
+    {
+      for(auto it = previous.find(state); it != previous.end(); it = previous.find(state))
+      {
+        const auto& path = it->second;
+        if(&path->fromBlock() == block)
+        {
+          return true;
+        }
+        state = State{&path->fromBlock(), path->fromSide()};
+      }
+      return false;
+    };
+
+  while(!queue.empty())
+  {
+    const auto item = queue.top();
+    queue.pop();
+
+    if(item.cost > costs[item.state])
+    {
+      continue; // already reached with lower cost
+    }
+
+    if(item.state.block == &to) // found
+    {
+      Route route;
+      State state = item.state;
+      for(auto it = previous.find(state); it != previous.end(); it = previous.find(state))
+      {
+        route.paths.emplace_back(it->second);
+        state = State{&it->second->fromBlock(), it->second->fromSide()};
+      }
+      std::reverse(route.paths.begin(), route.paths.end());
+      updateTotals(route);
+      return route;
+    }
+
+    auto vertices = m_blocks.find(item.state.block);
+    if(vertices == m_blocks.end())
+    {
+      continue;
+    }
+
+    for(const auto& edge : vertices->second[static_cast<uint8_t>(item.state.side)])
+    {
+      auto path = edge.path.lock();
+      if(!path || excludedPaths.count(path.get()) != 0)
+      {
+        continue;
+      }
+
+      auto toBlock = path->toBlock();
+      if(!toBlock || toBlock.get() == &from || m_blocks.count(toBlock.get()) == 0 || excludedBlocks.count(toBlock.get()) != 0)
+      {
+        continue;
+      }
+
+      if(isPassed(item.state, toBlock.get()))
+      {
+        continue; // don't pass a block twice
+      }
+
+      const State next{toBlock.get(), ~path->toSide()}; // train enters at toSide and leaves at the opposite side
+      const uint32_t cost = item.cost + edge.cost;
+      if(auto it = costs.find(next); it == costs.end() || cost < it->second)
+      {
+        costs[next] = cost;
+        previous[next] = path;
+        queue.emplace(QueueItem{cost, next});
+      }
+    }
+  }
+
+  return std::nullopt;
+}
@@ -0,0 +1,109 @@
+/**
+ * server/src/board/map/routegraph.hpp
+ *
+ * This file is part of the traintastic source code.
+ *
+ * Copyright (C) 2024 Reinder Feenstra
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef TRAINTASTIC_SERVER_BOARD_MAP_ROUTEGRAPH_HPP
+#define TRAINTASTIC_SERVER_BOARD_MAP_ROUTEGRAPH_HPP
+
+#include <memory>
+#include <array>
+#include <vector>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+#include "../../enum/blockside.hpp"
+
+class BlockRailTile;
+class BlockPath;
+
+/**
+ * \brief Graph of all blocks in the world connected by their block paths
+ *
+ * A vertex is a block and the side a train leaves it, a block path from that side is an edge to the
+ * opposite side of the block it ends in. The outgoing edges of a block are updated when its paths are
+ * updated, so the graph follows board modifications.
+ */
+class RouteGraph
+{
+  public:
+    //! \brief Consecutive block paths from one block to another
+    struct Route
+    {
+      std::vector<std::shared_ptr<BlockPath>> paths;
+      uint32_t length = 0; //!< number of tiles, excluding the blocks
+      uint32_t turnouts = 0; //!< number of turnouts
+      uint32_t cost = 0; //!< used to order routes, see turnoutCost
+    };
+
+    static constexpr uint32_t turnoutCost = 4; //!< extra cost of passing a turnout, in tiles, prefers routes with less turnouts
+
+  private:
+    using ExcludedBlocks = std::unordered_set<const BlockRailTile*>;
+    using ExcludedPaths = std::unordered_set<const BlockPath*>;
+
+    struct Edge
+    {
+      std::weak_ptr<BlockPath> path;
+      uint32_t cost;
+    };
+
+    using Vertices = std::array<std::vector<Edge>, 2>; //!< outgoing edges per block side
+
+    std::unordered_map<const BlockRailTile*, Vertices> m_blocks;
+
+    static uint32_t cost(const BlockPath& path);
+    static void updateTotals(Route& route);
+
+    std::optional<Route> search(const BlockRailTile& from, std::optional<BlockSide> fromSide, const BlockRailTile& to,
+      const ExcludedBlocks& excludedBlocks, const ExcludedPaths& excludedPaths) const;
+
+  public:
+    RouteGraph() = default;
+    RouteGraph(const RouteGraph&) = delete;
+    RouteGraph& operator =(const RouteGraph&) = delete;
+
+    //! \brief Number of blocks in the graph
+    size_t size() const
+    {
+      return m_blocks.size();
+    }
+
+    //! \brief Update outgoing edges of \a block, call after its paths are changed
+    void update(const BlockRailTile& block);
+
+    //! \brief Remove \a block from the graph
+    void remove(const BlockRailTile& block);
+
+    /**
+     * \brief Find the route with the lowest cost from block \a from to block \a to
+     * \param[in] fromSide Side to leave block \a from, any side if not set
+     */
+    std::optional<Route> shortest(const BlockRailTile& from, const BlockRailTile& to, std::optional<BlockSide> fromSide = std::nullopt) const;
+
+    /**
+     * \brief Find up to \a k routes from block \a from to block \a to ordered by cost
+     *
+     * Uses Yen's algorithm, routes don't pass a block more than once.
+     */
+    std::vector<Route> kShortest(const BlockRailTile& from, const BlockRailTile& to, size_t k, std::optional<BlockSide> fromSide = std::nullopt) const;
+};
+
+#endif
@@ -0,0 +1,261 @@
+/**
+ * server/src/board/map/routesetter.cpp
+ *
+ * This file is part of the traintastic source code.
+ *
+ * Copyright (C) 2024 Reinder Feenstra
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "routesetter.hpp"
+#include <algorithm>
+#include "blockpath.hpp"
+#include "../boardlist.hpp"
+#include "../tile/rail/turnout/turnoutrailtile.hpp"
+#include "../../core/eventloop.hpp"
+#include "../../core/method.tpp"
+#include "../../core/objectproperty.tpp"
+#include "../../hardware/output/map/outputmapitem.hpp"
+
+RouteSetter::RouteSetter(BoardList& boardList)
+  : m_boardList{boardList}
+  , m_timer{EventLoop::ioContext}
+{
+}
+
+RouteSetter::~RouteSetter() = default;
+
+void RouteSetter::set(const std::shared_ptr<BlockPath>& path, const std::vector<std::pair<std::shared_ptr<TurnoutRailTile>, TurnoutPosition>>& turnouts)
+{
+  auto& job = m_jobs.emplace_back(Job{path, {}});
+  const auto jobIt = std::prev(m_jobs.end());
+
+  job.turnouts.reserve(turnouts.size());
+  for(const auto& [turnout, position] : turnouts)
+  {
+    auto& item = job.turnouts.emplace_back(Turnout{turnout, position, std::nullopt, false});
+    if(turnout->position == position)
+    {
+      item.done = true;
+      m_skippedCount++;
+    }
+    else
+    {
+      m_queues[turnout->outputMap->interface.value().get()].emplace_back(Command{jobIt, job.turnouts.size() - 1});
+    }
+  }
+
+  // commands of all paths reserved in this event loop iteration are sent together in the next one:
+  schedule(std::chrono::milliseconds(0));
+}
+
+void RouteSetter::cancel(const BlockPath& path)
+{
+  for(auto it = m_jobs.begin(); it != m_jobs.end();)
+  {
+    if(it->path.lock().get() == &path)
+    {
+      it = remove(it);
+    }
+    else
+    {
+      ++it;
+    }
+  }
+}
+
+bool RouteSetter::isPending(const BlockPath& path) const
+{
+  return std::any_of(m_jobs.begin(), m_jobs.end(),
+    [&path](const Job& job)
+    {
+      return job.path.lock().get() == &path;
+    });
+}
+
+void RouteSetter::process()
+{
+  m_scheduled = false;
+
+  send();
+  update();
+
+  if(!m_jobs.empty())
+  {
+    schedule(tickInterval);
+  }
+}
+
+void RouteSetter::schedule(std::chrono::milliseconds delay)
+{
+  if(m_scheduled)
+  {
+    return;
+  }
+
+  m_scheduled = true;
+  if(delay.count() == 0)
+  {
+    EventLoop::call(
+      [weak = m_boardList.weak_from_this()]()
+      {
+        if(auto boardList = std::static_pointer_cast<BoardList>(weak.lock()))
+          boardList->routeSetter().process();
+      });
+  }
+  else
+  {
+    m_timer.expires_after(delay);
+    m_timer.async_wait(
+      [weak = m_boardList.weak_from_this()](const boost::system::error_code& ec)
+      {
+        if(ec)
+          return;
+        if(auto boardList = std::static_pointer_cast<BoardList>(weak.lock()))
+          boardList->routeSetter().process();
+      });
+  }
+}
+
+void RouteSetter::send()
+{
+  const auto now = std::chrono::steady_clock::now();
+
+  for(auto it = m_queues.begin(); it != m_queues.end();)
+  {
+    auto& queue = it->second;
+    size_t count = 0;
+    while(count < commandsPerTick && !queue.empty())
+    {
+      auto& job = *queue.front().job;
+      auto& item = job.turnouts[queue.front().index];
+      queue.pop_front();
+
+      auto turnout = item.turnout.lock();
+      if(job.failed || !turnout || turnout->position == item.position)
+      {
+        item.done = true; // path failed, gone or already in position
+        continue;
+      }
+
+      if(!turnout->setPosition(item.position))
+      {
+        job.failed = true; // reported by update()
+        item.done = true;
+        continue;
+      }
+      item.sent = now;
+      m_commandCount++;
+      count++;
+
+      if((*turnout->outputMap)[item.position]->outputActions.empty())
+      {
+        item.done = true; // no outputs, no feedback to wait for
+      }
+    }
+
+    if(queue.empty())
+    {
+      it = m_queues.erase(it);
+    }
+    else
+    {
+      ++it;
+    }
+  }
+}
+
+void RouteSetter::update()
+{
+  const auto now = std::chrono::steady_clock::now();
+
+  // signals are emitted after the jobs are updated, handlers can release paths which cancels jobs:
+  std::vector<std::shared_ptr<BlockPath>> set;
+  std::vector<std::shared_ptr<BlockPath>> failed;
+
+  for(auto it = m_jobs.begin(); it != m_jobs.end();)
+  {
+    if(it->failed)
+    {
+      if(auto path = it->path.lock())
+      {
+        failed.emplace_back(std::move(path));
+      }
+      it = remove(it);
+      continue;
+    }
+
+    bool done = true;
+    for(auto& item : it->turnouts)
+    {
+      if(!item.done && item.sent)
+      {
+        auto turnout = item.turnout.lock();
+        item.done =
+          !turnout ||
+          (*turnout->outputMap)[item.position]->matchesCurrentOutputState() == OutputMapItem::MatchResult::FullMatch ||
+          now - *item.sent >= settleTime;
+      }
+      done &= item.done;
+    }
+
+    if(done)
+    {
+      if(auto path = it->path.lock())
+      {
+        set.emplace_back(std::move(path));
+      }
+      it = remove(it);
+    }
+    else
+    {
+      ++it;
+    }
+  }
+
+  for(const auto& path : set)
+  {
+    routeSet(path);
+  }
+  for(const auto& path : failed)
+  {
+    routeFailed(path);
+  }
+}
+
+RouteSetter::Jobs::iterator RouteSetter::remove(Jobs::iterator job)
+{
+  // queued commands refer to the job:
+  for(auto it = m_queues.begin(); it != m_queues.end();)
+  {
+    auto& queue = it->second;
+    queue.erase(std::remove_if(queue.begin(), queue.end(),
+      [job](const Command& command)
+      {
+        return command.job == job;
+      }), queue.end());
+
+    if(queue.empty())
+    {
+      it = m_queues.erase(it);
+    }
+    else
+    {
+      ++it;
+    }
+  }
+  return m_jobs.erase(job);
+}
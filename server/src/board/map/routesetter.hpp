@@ -0,0 +1,143 @@
+/**
+ * server/src/board/map/routesetter.hpp
+ *
+ * This file is part of the traintastic source code.
+ *
+ * Copyright (C) 2024 Reinder Feenstra
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef TRAINTASTIC_SERVER_BOARD_MAP_ROUTESETTER_HPP
+#define TRAINTASTIC_SERVER_BOARD_MAP_ROUTESETTER_HPP
+
+#include <memory>
+#include <vector>
+#include <deque>
+#include <list>
+#include <chrono>
+#include <optional>
+#include <unordered_map>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/signals2/signal.hpp>
+#include "../../enum/turnoutposition.hpp"
+
+class BoardList;
+class BlockPath;
+class TurnoutRailTile;
+class OutputController;
+
+/**
+ * \brief Sets the turnouts of reserved block paths
+ *
+ * Turnout commands of all paths reserved in the same event loop iteration are collected and sent
+ * together in the next one, turnouts already in position are skipped. Commands are queued per
+ * interface and at most \ref commandsPerTick are sent per interface every \ref tickInterval, so a
+ * long route doesn't flood the command station. A turnout is in position when the output feedback
+ * matches or \ref settleTime after its command was sent, when all turnouts of a path are in position
+ * \ref routeSet is emitted. If a turnout refuses its position \ref routeFailed is emitted instead,
+ * the path stays reserved, releasing it is up to the one that reserved it.
+ */
+class RouteSetter
+{
+  public:
+    static constexpr std::chrono::milliseconds tickInterval{20};
+    static constexpr size_t commandsPerTick = 2; //!< per interface
+    static constexpr std::chrono::milliseconds settleTime{500}; //!< turnout without feedback is assumed in position after this time
+
+  private:
+    struct Turnout
+    {
+      std::weak_ptr<TurnoutRailTile> turnout;
+      TurnoutPosition position;
+      std::optional<std::chrono::steady_clock::time_point> sent;
+      bool done = false;
+    };
+
+    struct Job
+    {
+      std::weak_ptr<BlockPath> path;
+      std::vector<Turnout> turnouts;
+      bool failed = false; //!< a turnout couldn't be set
+    };
+
+    using Jobs = std::list<Job>;
+
+    struct Command
+    {
+      Jobs::iterator job;
+      size_t index;
+    };
+
+    BoardList& m_boardList;
+    boost::asio::steady_timer m_timer;
+    Jobs m_jobs;
+    std::unordered_map<const OutputController*, std::deque<Command>> m_queues;
+    bool m_scheduled = false;
+    uint64_t m_commandCount = 0;
+    uint64_t m_skippedCount = 0;
+
+    void schedule(std::chrono::milliseconds delay);
+    void send();
+    void update();
+    Jobs::iterator remove(Jobs::iterator job);
+
+  public:
+    //! \brief All turnouts of the path are in position
+    boost::signals2::signal<void(const std::shared_ptr<BlockPath>&)> routeSet;
+
+    //! \brief A turnout of the path couldn't be set, remaining commands of the path are dropped
+    boost::signals2::signal<void(const std::shared_ptr<BlockPath>&)> routeFailed;
+
+    RouteSetter(BoardList& boardList);
+    RouteSetter(const RouteSetter&) = delete;
+    RouteSetter& operator =(const RouteSetter&) = delete;
+    ~RouteSetter();
+
+    /**
+     * \brief Set turnouts of \a path, called after it is reserved
+     * \param[in] turnouts Turnouts with the position required by the path
+     */
+    void set(const std::shared_ptr<BlockPath>& path, const std::vector<std::pair<std::shared_ptr<TurnoutRailTile>, TurnoutPosition>>& turnouts);
+
+    //! \brief Drop the commands of \a path that aren't sent yet, called when it is released
+    void cancel(const BlockPath& path);
+
+    //! \brief \c true if the turnouts of \a path are being set
+    bool isPending(const BlockPath& path) const;
+
+    //! \brief Send queued commands and check turnout positions now
+    void process();
+
+    //! \brief Number of paths waiting for their turnouts
+    size_t pendingCount() const
+    {
+      return m_jobs.size();
+    }
+
+    //! \brief Total number of turnout commands sent
+    uint64_t commandCount() const
+    {
+      return m_commandCount;
+    }
+
+    //! \brief Total number of turnouts that were already in position
+    uint64_t skippedCount() const
+    {
+      return m_skippedCount;
+    }
+};
+
+#endif
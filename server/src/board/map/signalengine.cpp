@@ -0,0 +1,214 @@
+/**
+ * server/src/board/map/signalengine.cpp
+ *
+ * This file is part of the traintastic source code.
+ *
+ * Copyright (C) 2024 Reinder Feenstra
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+#include "signalengine.hpp"
+#include <algorithm>
+#include <functional>
+#include "abstractsignalpath.hpp"
+#include "../boardlist.hpp"
+#include "../tile/rail/blockrailtile.hpp"
+#include "../tile/rail/turnout/turnoutrailtile.hpp"
+#include "../tile/rail/directioncontrolrailtile.hpp"
+#include "../tile/rail/signal/signalrailtile.hpp"
+#include "../../core/eventloop.hpp"
+
+SignalEngine::SignalEngine(BoardList& boardList)
+  : m_boardList{boardList}
+{
+}
+
+void SignalEngine::add(AbstractSignalPath& path)
+{
+  auto& info = m_paths[&path];
+
+  for(const auto& weak : path.m_dependencies)
+  {
+    auto tile = weak.lock();
+    if(!tile)
+      continue;
+
+    auto& resource = m_resources[tile.get()];
+    if(resource.tile.lock() != tile) // new resource (or a new tile at the address of a removed one)
+    {
+      const Tile* key = tile.get();
+      auto changed =
+        [this, key](const auto&, auto)
+        {
+          resourceChanged(*key);
+        };
+
+      resource.tile = tile;
+      resource.paths.clear();
+      if(auto* block = dynamic_cast<BlockRailTile*>(tile.get()))
+        resource.connection = block->stateChanged.connect(changed);
+      else if(auto* turnout = dynamic_cast<TurnoutRailTile*>(tile.get()))
+        resource.connection = turnout->positionChanged.connect(changed);
+      else if(auto* directionControl = dynamic_cast<DirectionControlRailTile*>(tile.get()))
+        resource.connection = directionControl->stateChanged.connect(changed);
+      else if(auto* signal = dynamic_cast<SignalRailTile*>(tile.get()))
+        resource.connection = signal->aspectChanged.connect(changed);
+      else
+        assert(false);
+    }
+
+    if(std::find(resource.paths.begin(), resource.paths.end(), &path) == resource.paths.end())
+    {
+      resource.paths.emplace_back(&path);
+      info.resources.emplace_back(tile.get());
+      if(const auto* signal = dynamic_cast<const SignalRailTile*>(tile.get()))
+        info.signals.emplace_back(signal);
+    }
+  }
+
+  m_signalPaths[&path.signal()] = &path;
+  m_ranksValid = false;
+
+  invalidate(path);
+}
+
+void SignalEngine::remove(AbstractSignalPath& path)
+{
+  auto it = m_paths.find(&path);
+  if(it == m_paths.end())
+    return;
+
+  for(const auto* key : it->second.resources)
+  {
+    if(auto resource = m_resources.find(key); resource != m_resources.end())
+    {
+      auto& paths = resource->second.paths;
+      paths.erase(std::remove(paths.begin(), paths.end(), &path), paths.end());
+      if(paths.empty())
+        m_resources.erase(resource); // disconnects
+    }
+  }
+
+  if(it->second.dirty)
+    m_dirty.erase(std::remove(m_dirty.begin(), m_dirty.end(), &path), m_dirty.end());
+
+  m_paths.erase(it);
+
+  if(auto signal = m_signalPaths.find(&path.signal()); signal != m_signalPaths.end() && signal->second == &path)
+    m_signalPaths.erase(signal);
+
+  m_ranksValid = false;
+}
+
+void SignalEngine::invalidate(AbstractSignalPath& path)
+{
+  auto it = m_paths.find(&path);
+  if(it == m_paths.end() || it->second.dirty)
+    return;
+
+  it->second.dirty = true;
+  m_dirty.emplace_back(&path);
+
+  if(!m_scheduled)
+  {
+    m_scheduled = true;
+    EventLoop::call(
+      [weak = m_boardList.weak_from_this()]()
+      {
+        if(auto boardList = std::static_pointer_cast<BoardList>(weak.lock()))
+          boardList->signalEngine().process();
+      });
+  }
+}
+
+void SignalEngine::process()
+{
+  m_scheduled = false;
+
+  if(m_dirty.empty())
+    return;
+
+  if(!m_ranksValid)
+    updateRanks();
+
+  std::vector<AbstractSignalPath*> batch;
+  std::swap(batch, m_dirty);
+  std::stable_sort(batch.begin(), batch.end(),
+    [this](AbstractSignalPath* a, AbstractSignalPath* b)
+    {
+      return m_paths[a].rank < m_paths[b].rank;
+    });
+
+  // A path marked dirty during this batch that isn't evaluated yet stays in the batch,
+  // a path that is already evaluated is added to m_dirty and evaluated in the next iteration.
+  for(auto* path : batch)
+  {
+    auto it = m_paths.find(path);
+    if(it == m_paths.end() || !it->second.dirty) // removed while processing
+      continue;
+
+    it->second.dirty = false;
+    m_evaluationCount++;
+    path->evaluate();
+  }
+}
+
+void SignalEngine::resourceChanged(const Tile& tile)
+{
+  if(auto it = m_resources.find(&tile); it != m_resources.end())
+  {
+    for(auto* path : it->second.paths)
+      invalidate(*path);
+  }
+}
+
+void SignalEngine::updateRanks()
+{
+  // rank = longest chain of signals ahead, signal loops are cut where they are detected
+  enum class State : uint8_t
+  {
+    Unvisited,
+    Visiting,
+    Done,
+  };
+  std::unordered_map<AbstractSignalPath*, State> states;
+
+  std::function<uint32_t(AbstractSignalPath*)> rank =
+    [this, &states, &rank](AbstractSignalPath* path) -> uint32_t
+    {
+      auto& state = states[path];
+      auto& info = m_paths[path];
+      if(state == State::Done)
+        return info.rank;
+      if(state == State::Visiting)
+        return 0; // loop
+
+      state = State::Visiting;
+      uint32_t value = 0;
+      for(const auto* signal : info.signals)
+        if(auto it = m_signalPaths.find(signal); it != m_signalPaths.end())
+          value = std::max(value, rank(it->second) + 1);
+      states[path] = State::Done;
+      info.rank = value;
+      return value;
+    };
+
+  for(auto& it : m_paths)
+    rank(it.first);
+
+  m_ranksValid = true;
+}
@@ -0,0 +1,103 @@
+/**
+ * server/src/board/map/signalengine.hpp
+ *
+ * This file is part of the traintastic source code.
+ *
+ * Copyright (C) 2024 Reinder Feenstra
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+#ifndef TRAINTASTIC_SERVER_BOARD_MAP_SIGNALENGINE_HPP
+#define TRAINTASTIC_SERVER_BOARD_MAP_SIGNALENGINE_HPP
+
+#include <memory>
+#include <vector>
+#include <unordered_map>
+#include <boost/signals2/connection.hpp>
+
+class BoardList;
+class Tile;
+class SignalRailTile;
+class AbstractSignalPath;
+
+/**
+ * \brief Central signal aspect evaluation
+ *
+ * Keeps a dependency graph from resources (blocks, turnouts, direction controls and signals) to the signal paths
+ * depending on them. A resource change marks the dependent signal paths dirty, dirty paths are evaluated once
+ * in the next event loop iteration, signals ahead before the signals depending on their aspect.
+ */
+class SignalEngine
+{
+  private:
+    struct Resource
+    {
+      std::weak_ptr<const Tile> tile;
+      boost::signals2::scoped_connection connection;
+      std::vector<AbstractSignalPath*> paths;
+    };
+
+    struct PathInfo
+    {
+      std::vector<const Tile*> resources;
+      std::vector<const SignalRailTile*> signals; //!< signals ahead, their aspect is used
+      uint32_t rank = 0; //!< evaluation order, signals ahead have a lower rank
+      bool dirty = false;
+    };
+
+    BoardList& m_boardList;
+    std::unordered_map<const Tile*, Resource> m_resources;
+    std::unordered_map<AbstractSignalPath*, PathInfo> m_paths;
+    std::unordered_map<const SignalRailTile*, AbstractSignalPath*> m_signalPaths;
+    std::vector<AbstractSignalPath*> m_dirty;
+    bool m_scheduled = false;
+    bool m_ranksValid = false;
+    uint64_t m_evaluationCount = 0;
+
+    void resourceChanged(const Tile& tile);
+    void updateRanks();
+
+  public:
+    SignalEngine(BoardList& boardList);
+    SignalEngine(const SignalEngine&) = delete;
+    SignalEngine& operator =(const SignalEngine&) = delete;
+
+    //! \brief Add signal path and connect to the resources it depends on, the path is evaluated in the next event loop iteration
+    void add(AbstractSignalPath& path);
+
+    void remove(AbstractSignalPath& path);
+
+    //! \brief Evaluate \a path in the next event loop iteration
+    void invalidate(AbstractSignalPath& path);
+
+    //! \brief Evaluate all dirty signal paths now
+    void process();
+
+    //! \brief Number of signal paths waiting for evaluation
+    size_t pendingCount() const
+    {
+      return m_dirty.size();
+    }
+
+    //! \brief Total number of signal path evaluations
+    uint64_t evaluationCount() const
+    {
+      return m_evaluationCount;
+    }
+};
+
+#endif
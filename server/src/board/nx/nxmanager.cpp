@@ -3,7 +3,7 @@
  *
  * This file is part of the traintastic source code.
  *
- * Copyright (C) 2023 Reinder Feenstra
+ * Copyright (C) 2023-2024 Reinder Feenstra
  *
  * This program is free software; you can redistribute it and/or
  * modify it under the terms of the GNU General Public License
@@ -21,6 +21,7 @@
  */
 
 #include "nxmanager.hpp"
+#include "../boardlist.hpp"
 #include "../map/blockpath.hpp"
 #include "../tile/rail/blockrailtile.hpp"
 #include "../tile/rail/nxbuttonrailtile.hpp"
@@ -49,6 +50,13 @@ NXManager::NXManager(Object& parent_, std::string_view parentPropertyName)
   m_interfaceItems.add(select);
 }
 
+void NXManager::destroying()
+{
+  m_routeSet.disconnect();
+  m_routeFailed.disconnect();
+  SubObject::destroying();
+}
+
 void NXManager::pressed(NXButtonRailTile& button)
 {
   if(!contains(getWorld(this).state, WorldState::Run))
@@ -114,8 +122,162 @@ bool NXManager::selectPath(const NXButtonRailTile& from, const NXButtonRailTile&
         continue; // can't reserve path
       }
 
+      addRoute({path});
       return true;
     }
   }
-  return false; // no path found
+  return selectRoute(from, to); // no direct path, try via other blocks
+}
+
+bool NXManager::selectRoute(const NXButtonRailTile& from, const NXButtonRailTile& to)
+{
+  const auto fromBlock = from.block.value();
+  const auto toBlock = to.block.value();
+  if(!fromBlock || !toBlock || fromBlock->trains.empty())
+  {
+    return false;
+  }
+
+  // the from button determines the side to leave the block:
+  std::optional<BlockSide> fromSide;
+  for(const auto& path : fromBlock->paths())
+  {
+    if(path->nxButtonFrom().get() == &from)
+    {
+      fromSide = path->fromSide();
+      break;
+    }
+  }
+  if(!fromSide)
+  {
+    return false;
+  }
+
+  const auto& status = *fromSide == BlockSide::A ? fromBlock->trains.front() : fromBlock->trains.back();
+  if(!status->train)
+  {
+    return false; // no train assigned in from block
+  }
+  const auto train = status->train.value();
+
+  for(const auto& route : getWorld(this).boards->routeGraph().kShortest(*fromBlock, *toBlock, routeCount, fromSide))
+  {
+    if(route.paths.back()->nxButtonTo().get() != &to)
+    {
+      continue; // route ends at other side of block
+    }
+
+    const bool canReserve = std::all_of(route.paths.begin(), route.paths.end(),
+      [&train](const auto& path)
+      {
+        return path->reserve(train, true);
+      });
+    if(!canReserve)
+    {
+      continue;
+    }
+
+    LOG_DEBUG("Route found:", fromBlock->name.value(), "->", toBlock->name.value(), "via", route.paths.size(), "paths");
+
+    for(auto it = route.paths.begin(); it != route.paths.end(); ++it)
+    {
+      if(!(*it)->reserve(train)) // the dry runs are done per path, so a path can still conflict with a previous one
+      {
+        // release the paths already reserved, the route is all or nothing:
+        while(it != route.paths.begin())
+        {
+          --it;
+          (*it)->release();
+        }
+        return false;
+      }
+    }
+    addRoute({route.paths.begin(), route.paths.end()});
+    return true;
+  }
+  return false; // no route found
+}
+
+void NXManager::addRoute(std::vector<std::weak_ptr<BlockPath>> paths)
+{
+  if(!m_routeSet.connected())
+  {
+    auto& routeSetter = getWorld(this).boards->routeSetter();
+    m_routeSet = routeSetter.routeSet.connect(std::bind(&NXManager::routeSet, this, std::placeholders::_1));
+    m_routeFailed = routeSetter.routeFailed.connect(std::bind(&NXManager::routeFailed, this, std::placeholders::_1));
+  }
+
+  // forget routes that are released before their turnouts were set:
+  m_routes.remove_if(
+    [this](const Route& route)
+    {
+      return !isPending(route);
+    });
+
+  m_routes.emplace_back(Route{std::move(paths)});
+}
+
+size_t NXManager::pendingCount() const
+{
+  return static_cast<size_t>(std::count_if(m_routes.begin(), m_routes.end(),
+    [this](const Route& route)
+    {
+      return isPending(route);
+    }));
+}
+
+void NXManager::routeSet(const std::shared_ptr<BlockPath>& path)
+{
+  auto it = findRoute(*path);
+  if(it != m_routes.end() && !isPending(*it))
+  {
+    LOG_DEBUG("Route set:", path->fromBlock().name.value());
+    m_routes.erase(it);
+  }
+}
+
+void NXManager::routeFailed(const std::shared_ptr<BlockPath>& path)
+{
+  auto it = findRoute(*path);
+  if(it == m_routes.end())
+  {
+    return;
+  }
+
+  LOG_DEBUG("Route failed:", path->fromBlock().name.value());
+
+  // a route is all or nothing, release it, last path first:
+  const auto paths = std::move(it->paths);
+  m_routes.erase(it);
+  for(auto item = paths.rbegin(); item != paths.rend(); ++item)
+  {
+    if(auto p = item->lock())
+    {
+      p->release();
+    }
+  }
+}
+
+std::list<NXManager::Route>::iterator NXManager::findRoute(const BlockPath& path)
+{
+  return std::find_if(m_routes.begin(), m_routes.end(),
+    [&path](const Route& route)
+    {
+      return std::any_of(route.paths.begin(), route.paths.end(),
+        [&path](const auto& item)
+        {
+          return item.lock().get() == &path;
+        });
+    });
+}
+
+bool NXManager::isPending(const Route& route) const
+{
+  const auto& routeSetter = getWorld(parent()).boards->routeSetter();
+  return std::any_of(route.paths.begin(), route.paths.end(),
+    [&routeSetter](const auto& item)
+    {
+      const auto path = item.lock();
+      return path && routeSetter.isPending(*path);
+    });
 }
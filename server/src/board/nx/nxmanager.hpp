@@ -3,7 +3,7 @@
  *
  * This file is part of the traintastic source code.
  *
- * Copyright (C) 2023 Reinder Feenstra
+ * Copyright (C) 2023-2024 Reinder Feenstra
  *
  * This program is free software; you can redistribute it and/or
  * modify it under the terms of the GNU General Public License
@@ -23,6 +23,10 @@
 #ifndef TRAINTASTIC_SERVER_BOARD_NX_NXMANAGER_HPP
 #define TRAINTASTIC_SERVER_BOARD_NX_NXMANAGER_HPP
 
+#include <list>
+#include <memory>
+#include <vector>
+#include <boost/signals2/connection.hpp>
 #include "../../core/subobject.hpp"
 #include "../../core/method.hpp"
 
@@ -35,9 +39,30 @@ class NXManager : public SubObject
   CLASS_ID("nx_manager")
 
   private:
+    static constexpr size_t routeCount = 4; //!< number of alternative routes to try if there is no direct path
+
+    //! \brief Selected route, its turnouts are being set by the route setter
+    struct Route
+    {
+      std::vector<std::weak_ptr<BlockPath>> paths;
+    };
+
     std::list<std::weak_ptr<NXButtonRailTile>> m_pressedButtons;
+    std::list<Route> m_routes;
+    boost::signals2::connection m_routeSet;
+    boost::signals2::connection m_routeFailed;
 
+    //! \return \c true if the path(s) are reserved, turnouts are set later, see \ref m_routes
     bool selectPath(const NXButtonRailTile& from, const NXButtonRailTile& to);
+    bool selectRoute(const NXButtonRailTile& from, const NXButtonRailTile& to);
+    void addRoute(std::vector<std::weak_ptr<BlockPath>> paths);
+    void routeSet(const std::shared_ptr<BlockPath>& path);
+    void routeFailed(const std::shared_ptr<BlockPath>& path);
+    std::list<Route>::iterator findRoute(const BlockPath& path);
+    bool isPending(const Route& route) const;
+
+  protected:
+    void destroying() final;
 
   public:
     Method<void(const std::shared_ptr<NXButtonRailTile>&, const std::shared_ptr<NXButtonRailTile>&)> select;
@@ -46,6 +71,9 @@ class NXManager : public SubObject
 
     void pressed(NXButtonRailTile& tile);
     void released(NXButtonRailTile& tile);
+
+    //! \brief Number of selected routes with turnouts not in position yet
+    size_t pendingCount() const;
 };
 
 #endif
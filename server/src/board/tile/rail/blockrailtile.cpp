@@ -25,10 +25,12 @@
 #include "../../../core/objectproperty.tpp"
 #include "../../../core/objectvectorproperty.tpp"
 #include "../../../world/world.hpp"
+#include "../../boardlist.hpp"
 #include "../../../core/attributes.hpp"
 #include "../../../log/log.hpp"
 #include "../../../train/train.hpp"
 #include "../../../train/trainblockstatus.hpp"
+#include "../../../train/trainlist.hpp"
 #include "../../../train/traintracking.hpp"
 #include "../../../utils/displayname.hpp"
 #include "../../map/blockpath.hpp"
@@ -515,6 +517,9 @@ void BlockRailTile::setState(BlockState value)
 
   state.setValueInternal(value);
   stateChanged(*this, value);
+
+  if(value == BlockState::Free && m_world.trains)
+    m_world.trains->dispatcher().blockFreed();
 }
 
 void BlockRailTile::worldEvent(WorldState worldState, WorldEvent worldEvent)
@@ -540,6 +545,11 @@ void BlockRailTile::destroying()
   {
     trains.back()->destroy();
   }
+  if(m_world.boards)
+  {
+    m_world.boards->routeGraph().remove(*this);
+    m_world.boards->blockPathConflicts().remove(*this);
+  }
   RailTile::destroying();
 }
 
@@ -578,7 +588,7 @@ void BlockRailTile::setRotate(TileRotate value)
 
 void BlockRailTile::boardModified()
 {
-  updatePaths(); //! \todo improvement: only update if a connected tile is changed
+  updatePaths(); // only called if a connected tile is changed, see Board::modified()
 }
 
 void BlockRailTile::updatePaths()
@@ -587,10 +597,11 @@ void BlockRailTile::updatePaths()
   m_paths.clear(); // make sure it is empty, it problably is after the move
   auto found = BlockPath::find(*this);
 
-  while(!current.empty()) // handle existing paths
+  Paths removed;
+  for(auto& path : current) // handle existing paths
   {
     auto it = std::find_if(found.begin(), found.end(),
-      [&currentPath=*current.front()](const auto& foundPath)
+      [&currentPath=*path](const auto& foundPath)
       {
         return currentPath == *foundPath;
       });
@@ -598,17 +609,23 @@ void BlockRailTile::updatePaths()
     if(it != found.end())
     {
       found.erase(it);
-      m_paths.emplace_back(std::move(current.front()));
+      m_paths.emplace_back(std::move(path));
+    }
+    else
+    {
+      removed.emplace_back(std::move(path));
     }
-    current.erase(current.begin());
   }
 
-  for(auto& path : current) // no longer existing paths
+  for(auto& path : removed) // no longer existing paths
   {
-    auto& pathsIn = path->toBlock()->m_pathsIn;
-    if(auto it = std::find(pathsIn.begin(), pathsIn.end(), path); it != pathsIn.end())
+    if(auto toBlock = path->toBlock())
     {
-      pathsIn.erase(it);
+      auto& pathsIn = toBlock->m_pathsIn;
+      if(auto it = std::find(pathsIn.begin(), pathsIn.end(), path); it != pathsIn.end())
+      {
+        pathsIn.erase(it);
+      }
     }
   }
 
@@ -617,6 +634,12 @@ void BlockRailTile::updatePaths()
     path->toBlock()->m_pathsIn.emplace_back(path);
     m_paths.emplace_back(std::move(path));
   }
+
+  if(m_world.boards)
+  {
+    m_world.boards->routeGraph().update(*this);
+    m_world.boards->blockPathConflicts().update(*this, removed);
+  }
 }
 
 void BlockRailTile::updateHeightWidthMax()
@@ -3,7 +3,7 @@
  *
  * This file is part of the traintastic source code.
  *
- * Copyright (C) 2022 Reinder Feenstra
+ * Copyright (C) 2022-2024 Reinder Feenstra
  *
  * This program is free software; you can redistribute it and/or
  * modify it under the terms of the GNU General Public License
@@ -21,6 +21,7 @@
  */
 
 #include "linkrailtile.hpp"
+#include "../../board.hpp"
 #include "../../list/linkrailtilelist.hpp"
 #include "../../../core/attributes.hpp"
 #include "../../../core/objectlisttablemodel.hpp"
@@ -38,10 +39,14 @@ LinkRailTile::LinkRailTile(World& world, std::string_view _id)
         if(newValue.get() == this)
           return false;
 
+        // both ends of a changed connection must be updated, see Board::modified():
+        setModified();
+
         if(link)
         {
           assert(link->link.value().get() == this);
           link->link.setValueInternal(nullptr);
+          link->setModified();
         }
 
         if(newValue)
@@ -50,8 +55,10 @@ LinkRailTile::LinkRailTile(World& world, std::string_view _id)
           {
             assert(newValue->link->link.value() == newValue);
             newValue->link->link.setValueInternal(nullptr);
+            newValue->link->setModified();
           }
           newValue->link.setValueInternal(shared_ptr<LinkRailTile>());
+          newValue->setModified();
         }
 
         return true;
@@ -70,6 +77,11 @@ LinkRailTile::LinkRailTile(World& world, std::string_view _id)
   m_interfaceItems.add(link);
 }
 
+void LinkRailTile::setModified()
+{
+  getBoard().setModified(location(), width, height);
+}
+
 void LinkRailTile::getConnectors(std::vector<Connector>& connectors) const
 {
   connectors.emplace_back(location(), rotate, Connector::Type::Rail);
@@ -3,7 +3,7 @@
  *
  * This file is part of the traintastic source code.
  *
- * Copyright (C) 2022 Reinder Feenstra
+ * Copyright (C) 2022-2024 Reinder Feenstra
  *
  * This program is free software; you can redistribute it and/or
  * modify it under the terms of the GNU General Public License
@@ -36,6 +36,9 @@ class LinkRailTile : public RailTile
   private:
     Node m_node;
 
+    //! \brief Mark the tile modified, so the links of both boards are updated
+    void setModified();
+
   protected:
     void addToWorld() final;
     void loaded() final;
@@ -22,6 +22,7 @@
 
 #include "signalrailtile.hpp"
 #include "../../../map/abstractsignalpath.hpp"
+#include "../../../boardlist.hpp"
 #include "../../../../core/attributes.hpp"
 #include "../../../../core/method.tpp"
 #include "../../../../core/objectproperty.tpp"
@@ -149,11 +150,17 @@ void SignalRailTile::worldEvent(WorldState state, WorldEvent event)
   }
 }
 
+void SignalRailTile::destroying()
+{
+  m_signalPath.reset(); // unregister from the signal engine while the world is still valid
+  StraightRailTile::destroying();
+}
+
 void SignalRailTile::boardModified()
 {
   if(m_signalPath)
   {
-    m_signalPath->evaluate();
+    evaluate();
   }
   StraightRailTile::boardModified();
 }
@@ -179,7 +186,7 @@ void SignalRailTile::evaluate()
 {
   if(m_signalPath) /*[[likely]]*/
   {
-    m_signalPath->evaluate();
+    m_world.boards->signalEngine().invalidate(*m_signalPath);
   }
   else
   {
@@ -47,6 +47,7 @@ class SignalRailTile : public StraightRailTile
     SignalRailTile(World& world, std::string_view _id, TileId tileId);
 
     void worldEvent(WorldState state, WorldEvent event) override;
+    void destroying() override;
 
     void boardModified() override;
 
@@ -57,6 +58,8 @@ class SignalRailTile : public StraightRailTile
     void connectOutputMap();
 
   public:
+    static constexpr size_t blocksAheadMax = 2; //!< maximum number of blocks a signal path looks ahead, see Signal3AspectRailTile
+
     static std::optional<OutputActionValue> getDefaultActionValue(SignalAspect signalAspect, OutputType outputType, size_t outputIndex);
 
     boost::signals2::signal<void (const SignalRailTile&, SignalAspect)> aspectChanged;
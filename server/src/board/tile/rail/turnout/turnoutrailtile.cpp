@@ -62,11 +62,7 @@ bool TurnoutRailTile::reserve(TurnoutPosition turnoutPosition, bool dryRun)
   }
   if(!dryRun)
   {
-    if(!doSetPosition(turnoutPosition)) /*[[unlikely]]*/
-    {
-      return false;
-    }
-
+    // position is set by the route setter, see BlockPath::reserve
     RailTile::setReservedState(static_cast<uint8_t>(turnoutPosition));
   }
   return true;
@@ -3,7 +3,7 @@
  *
  * This file is part of the traintastic source code.
  *
- * Copyright (C) 2020-2023 Reinder Feenstra
+ * Copyright (C) 2020-2024 Reinder Feenstra
  *
  * This program is free software; you can redistribute it and/or
  * modify it under the terms of the GNU General Public License
@@ -58,6 +58,7 @@ class TurnoutRailTile : public RailTile
     std::optional<std::reference_wrapper<const Node>> node() const final { return m_node; }
     std::optional<std::reference_wrapper<Node>> node() final { return m_node; }
 
+    //! \brief Reserve the turnout for \a turnoutPosition, doesn't change the position, that is done by the \ref RouteSetter
     virtual bool reserve(TurnoutPosition turnoutPosition, bool dryRun = false);
     bool release(bool dryRun = false);
 };
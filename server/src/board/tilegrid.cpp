@@ -0,0 +1,160 @@
+/**
+ * server/src/board/tilegrid.cpp
+ *
+ * This file is part of the traintastic source code.
+ *
+ * Copyright (C) 2024 Reinder Feenstra
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+#include "tilegrid.hpp"
+#include <algorithm>
+#include <cassert>
+#include "tile/tile.hpp"
+
+TileGrid::Slot TileGrid::getSlot(TileLocation l) const
+{
+  if(auto it = m_chunks.find(chunkKey(chunkIndex(l.x), chunkIndex(l.y))); it != m_chunks.end())
+  {
+    return it->second->slots[slotIndex(l)];
+  }
+  return 0;
+}
+
+void TileGrid::setSlots(TileLocation origin, uint8_t width, uint8_t height, Slot slot)
+{
+  for(int16_t y = origin.y; y < origin.y + height; y++)
+  {
+    for(int16_t x = origin.x; x < origin.x + width; x++)
+    {
+      const TileLocation l{x, y};
+      const uint32_t key = chunkKey(chunkIndex(x), chunkIndex(y));
+      auto it = m_chunks.find(key);
+      if(it == m_chunks.end())
+      {
+        if(slot == 0)
+        {
+          continue; // already empty
+        }
+        it = m_chunks.emplace(key, std::make_unique<Chunk>()).first;
+      }
+
+      auto& chunk = *it->second;
+      auto& current = chunk.slots[slotIndex(l)];
+      if(current == 0 && slot != 0)
+      {
+        chunk.used++;
+      }
+      else if(current != 0 && slot == 0)
+      {
+        chunk.used--;
+      }
+      current = slot;
+
+      if(chunk.used == 0)
+      {
+        m_chunks.erase(it);
+      }
+    }
+  }
+}
+
+void TileGrid::add(std::shared_ptr<Tile> tile)
+{
+  assert(tile);
+  m_tiles.emplace_back(std::move(tile));
+  const auto& t = *m_tiles.back();
+  setSlots(t.location(), t.width, t.height, static_cast<Slot>(m_tiles.size()));
+}
+
+void TileGrid::remove(const Tile& tile)
+{
+  const Slot slot = getSlot(tile.location());
+  if(slot == 0 || m_tiles[slot - 1].get() != &tile)
+  {
+    assert(false);
+    return;
+  }
+
+  setSlots(tile.location(), tile.width, tile.height, 0);
+
+  if(slot != m_tiles.size()) // move last tile to the free slot, keeps the list dense
+  {
+    m_tiles[slot - 1] = std::move(m_tiles.back());
+    const auto& moved = *m_tiles[slot - 1];
+    setSlots(moved.location(), moved.width, moved.height, slot);
+  }
+  m_tiles.pop_back();
+}
+
+void TileGrid::resize(const Tile& tile, uint8_t oldWidth, uint8_t oldHeight)
+{
+  const Slot slot = getSlot(tile.location());
+  assert(slot != 0 && m_tiles[slot - 1].get() == &tile);
+  setSlots(tile.location(), oldWidth, oldHeight, 0);
+  setSlots(tile.location(), tile.width, tile.height, slot);
+}
+
+void TileGrid::clear()
+{
+  m_chunks.clear();
+  m_tiles.clear();
+}
+
+void TileGrid::getTiles(TileLocation topLeft, TileLocation bottomRight, Tiles& tiles) const
+{
+  std::vector<Slot> slots;
+
+  for(int16_t chunkY = chunkIndex(topLeft.y); chunkY <= chunkIndex(bottomRight.y); chunkY++)
+  {
+    for(int16_t chunkX = chunkIndex(topLeft.x); chunkX <= chunkIndex(bottomRight.x); chunkX++)
+    {
+      auto it = m_chunks.find(chunkKey(chunkX, chunkY));
+      if(it == m_chunks.end())
+      {
+        continue;
+      }
+
+      const auto& chunk = *it->second;
+      const int16_t x1 = std::max<int16_t>(topLeft.x, chunkX * chunkSize);
+      const int16_t x2 = std::min<int16_t>(bottomRight.x, chunkX * chunkSize + chunkSize - 1);
+      const int16_t y1 = std::max<int16_t>(topLeft.y, chunkY * chunkSize);
+      const int16_t y2 = std::min<int16_t>(bottomRight.y, chunkY * chunkSize + chunkSize - 1);
+
+      for(int16_t y = y1; y <= y2; y++)
+      {
+        for(int16_t x = x1; x <= x2; x++)
+        {
+          if(const Slot slot = chunk.slots[slotIndex({x, y})]; slot != 0)
+          {
+            slots.emplace_back(slot);
+          }
+        }
+      }
+    }
+  }
+
+  // larger tiles occupy multiple locations:
+  std::sort(slots.begin(), slots.end());
+  slots.erase(std::unique(slots.begin(), slots.end()), slots.end());
+
+  tiles.reserve(tiles.size() + slots.size());
+  for(const Slot slot : slots)
+  {
+    tiles.emplace_back(m_tiles[slot - 1]);
+  }
+}
@@ -0,0 +1,123 @@
+/**
+ * server/src/board/tilegrid.hpp
+ *
+ * This file is part of the traintastic source code.
+ *
+ * Copyright (C) 2024 Reinder Feenstra
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+#ifndef TRAINTASTIC_SERVER_BOARD_TILEGRID_HPP
+#define TRAINTASTIC_SERVER_BOARD_TILEGRID_HPP
+
+#include <array>
+#include <memory>
+#include <vector>
+#include <unordered_map>
+#include <traintastic/board/tilelocation.hpp>
+
+class Tile;
+
+/**
+ * \brief Tile storage of a board
+ *
+ * Origin tiles are stored in a dense list, a 2D grid of chunks maps each location to a slot in that list.
+ * A tile larger than 1x1 occupies multiple grid locations but only one slot.
+ */
+class TileGrid
+{
+  public:
+    using Tiles = std::vector<std::shared_ptr<Tile>>;
+
+    static constexpr int16_t chunkSize = 32;
+
+  private:
+    using Slot = uint32_t; //!< index in m_tiles plus one, zero if empty
+
+    struct Chunk
+    {
+      std::array<Slot, chunkSize * chunkSize> slots = {};
+      uint16_t used = 0; //!< number of non empty slots
+    };
+
+    std::unordered_map<uint32_t, std::unique_ptr<Chunk>> m_chunks;
+    Tiles m_tiles;
+
+    static constexpr int16_t chunkIndex(int16_t value)
+    {
+      return static_cast<int16_t>(value >= 0 ? value / chunkSize : -((-value + chunkSize - 1) / chunkSize));
+    }
+
+    static constexpr uint32_t chunkKey(int16_t chunkX, int16_t chunkY)
+    {
+      return (static_cast<uint32_t>(static_cast<uint16_t>(chunkX)) << 16) | static_cast<uint16_t>(chunkY);
+    }
+
+    static constexpr size_t slotIndex(TileLocation l)
+    {
+      return static_cast<size_t>(l.y - chunkIndex(l.y) * chunkSize) * chunkSize + static_cast<size_t>(l.x - chunkIndex(l.x) * chunkSize);
+    }
+
+    Slot getSlot(TileLocation l) const;
+    void setSlots(TileLocation origin, uint8_t width, uint8_t height, Slot slot);
+
+  public:
+    bool empty() const
+    {
+      return m_tiles.empty();
+    }
+
+    //! \brief Number of tiles
+    size_t size() const
+    {
+      return m_tiles.size();
+    }
+
+    //! \brief All tiles, each tile once
+    const Tiles& tiles() const
+    {
+      return m_tiles;
+    }
+
+    void reserve(size_t count)
+    {
+      m_tiles.reserve(count);
+    }
+
+    //! \brief Get tile occupying location \a l
+    std::shared_ptr<Tile> get(TileLocation l) const
+    {
+      const Slot slot = getSlot(l);
+      return slot != 0 ? m_tiles[slot - 1] : std::shared_ptr<Tile>();
+    }
+
+    //! \brief Add \a tile at its location using its size, the locations must be free
+    void add(std::shared_ptr<Tile> tile);
+
+    //! \brief Remove \a tile from its location using its size
+    void remove(const Tile& tile);
+
+    //! \brief Update the occupied locations of \a tile after it is resized
+    void resize(const Tile& tile, uint8_t oldWidth, uint8_t oldHeight);
+
+    void clear();
+
+    //! \brief Get all tiles occupying a location in the area \a topLeft to \a bottomRight (inclusive), each tile once
+    void getTiles(TileLocation topLeft, TileLocation bottomRight, Tiles& tiles) const;
+};
+
+#endif
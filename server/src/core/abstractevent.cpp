@@ -23,32 +23,38 @@
 #include "abstractevent.hpp"
 #include "abstracteventhandler.hpp"
 #include "object.hpp"
+#include <algorithm>
 
 AbstractEvent::AbstractEvent(Object& object, std::string_view name, EventFlags flags)
   : InterfaceItem(object, name)
   , m_flags{flags}
+  , m_handlers{std::make_shared<const Handlers>()}
 {
 }
 
 AbstractEvent::~AbstractEvent()
 {
-  while(!m_handlers.empty())
-    m_handlers.front()->disconnect();
+  while(!m_handlers->empty())
+    m_handlers->front()->disconnect();
 }
 
 void AbstractEvent::connect(std::shared_ptr<AbstractEventHandler> handler)
 {
   assert(handler);
   assert(&handler->event() == this);
-  m_handlers.emplace_back(std::move(handler));
+  auto handlers = std::make_shared<Handlers>(*m_handlers);
+  handlers->emplace_back(std::move(handler));
+  m_handlers = std::move(handlers);
 }
 
 bool AbstractEvent::disconnect(const std::shared_ptr<AbstractEventHandler>& handler)
 {
-  auto it = std::find(m_handlers.begin(), m_handlers.end(), handler);
-  if(it != m_handlers.end())
+  auto it = std::find(m_handlers->begin(), m_handlers->end(), handler);
+  if(it != m_handlers->end())
   {
-    m_handlers.erase(it);
+    auto handlers = std::make_shared<Handlers>(*m_handlers);
+    handlers->erase(handlers->begin() + (it - m_handlers->begin()));
+    m_handlers = std::move(handlers);
     return true;
   }
   return false;
@@ -56,8 +62,8 @@ bool AbstractEvent::disconnect(const std::shared_ptr<AbstractEventHandler>& hand
 
 void AbstractEvent::fire(const Arguments& args)
 {
-  const auto handlers{m_handlers}; // copy, list can be modified while iterating
-  for(const auto& handler : handlers)
+  const auto handlers = m_handlers; // keep a reference, connect/disconnect replace the list
+  for(const auto& handler : *handlers)
     handler->execute(args);
 
   m_object.onEventFired(*this, args);
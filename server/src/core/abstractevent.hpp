@@ -24,7 +24,8 @@
 #define TRAINTASTIC_SERVER_CORE_ABSTRACTEVENT_HPP
 
 #include "interfaceitem.hpp"
-#include <list>
+#include <vector>
+#include <memory>
 #include <tcb/span.hpp>
 #include "eventflags.hpp"
 #include "argument.hpp"
@@ -35,8 +36,10 @@ class AbstractEventHandler;
 class AbstractEvent : public InterfaceItem
 {
   private:
+    using Handlers = std::vector<std::shared_ptr<AbstractEventHandler>>;
+
     const EventFlags m_flags;
-    std::list<std::shared_ptr<AbstractEventHandler>> m_handlers;
+    std::shared_ptr<const Handlers> m_handlers; //!< copy-on-write, fire() keeps a reference while iterating
 
   protected:
     void fire(const Arguments& args);
@@ -206,9 +206,10 @@ void ClientKernel::receive(const Message& message)
               // This has the potential of ignoring genuine user changes for this decoder
               // (made by a physical throttle or other hardware connected to Z21) but
               // being the timeout short it should rarely happen.
-              // Theoretically the timeout should only be of Train::updateSpeed() timer timeout
-              // (100ms) because values will be refreshed and timeout restarted by Train itself
-              // but we need to accout also for network trasmission and Z21 processing time.
+              // The timeout is restarted each time we send a command, which only happens when
+              // the speed step changes, not on every MotionScheduler tick. So while accelerating
+              // it is restarted at most once per step; at constant speed it expires 1 second
+              // after the last step, long enough to cover network transmission and Z21 processing time.
 
               if((std::chrono::steady_clock::now() - cache.lastSetTime) > std::chrono::milliseconds(1000))
               {
@@ -0,0 +1,229 @@
+/**
+ * server/src/log/binarylogger.cpp
+ *
+ * This file is part of the traintastic source code.
+ *
+ * Copyright (C) 2024 Reinder Feenstra
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "binarylogger.hpp"
+#include "binarylogrecord.hpp"
+#include <cstring>
+#include <istream>
+#include <ostream>
+#include "../utils/endian.hpp"
+#include "../utils/setthreadname.hpp"
+
+namespace {
+
+template<class T>
+bool read(std::string_view& record, T& value)
+{
+  if(record.size() < sizeof(value))
+    return false;
+  memcpy(&value, record.data(), sizeof(value));
+  if constexpr(sizeof(T) > 1)
+    value = le_to_host(value);
+  record.remove_prefix(sizeof(value));
+  return true;
+}
+
+bool read(std::string_view& record, size_t length, std::string& value)
+{
+  if(record.size() < length)
+    return false;
+  value.assign(record.data(), length);
+  record.remove_prefix(length);
+  return true;
+}
+
+bool readArgument(std::string_view& record, uint8_t fileVersion, std::string& value)
+{
+  using BinaryLogRecord::ArgType;
+
+  uint8_t type = static_cast<uint8_t>(ArgType::String);
+  if(fileVersion >= 2 && !read(record, type))
+    return false;
+
+  switch(static_cast<ArgType>(type))
+  {
+    case ArgType::String:
+    {
+      uint32_t length;
+      return read(record, length) && read(record, length, value);
+    }
+    case ArgType::Int:
+    {
+      int64_t n;
+      if(!read(record, n))
+        return false;
+      value = std::to_string(n);
+      return true;
+    }
+    case ArgType::UInt:
+    {
+      uint64_t n;
+      if(!read(record, n))
+        return false;
+      value = std::to_string(n);
+      return true;
+    }
+    case ArgType::Double:
+    {
+      uint64_t bits;
+      if(!read(record, bits))
+        return false;
+      double d;
+      memcpy(&d, &bits, sizeof(d));
+      value = std::to_string(d);
+      return true;
+    }
+  }
+  return false;
+}
+
+}
+
+bool BinaryLogger::format(std::istream& in, std::ostream& out)
+{
+  char header[8];
+  if(!in.read(header, sizeof(header)) || std::string_view(header, magic.size()) != magic)
+    return false;
+  const uint8_t fileVersion = static_cast<uint8_t>(header[magic.size()]);
+  if(fileVersion < 1 || fileVersion > version)
+    return false;
+
+  std::string buffer;
+  std::string text;
+  std::string objectId;
+  std::vector<std::string> args;
+
+  while(true)
+  {
+    uint32_t size;
+    if(!in.read(reinterpret_cast<char*>(&size), sizeof(size)))
+      return in.eof() && in.gcount() == 0;
+    size = le_to_host(size);
+
+    buffer.resize(size);
+    if(!in.read(buffer.data(), size))
+      return false; // truncated
+
+    std::string_view record{buffer};
+    int64_t time;
+    uint32_t message;
+    uint16_t objectIdLength;
+    uint8_t argCount;
+    if(!read(record, time) || !read(record, message) || !read(record, objectIdLength) || !read(record, objectIdLength, objectId) || !read(record, argCount))
+      return false;
+
+    args.resize(argCount);
+    for(auto& arg : args)
+      if(!readArgument(record, fileVersion, arg))
+        return false;
+
+    text.clear();
+    appendText(text, std::chrono::system_clock::time_point(std::chrono::duration_cast<std::chrono::system_clock::duration>(std::chrono::microseconds(time))), objectId, static_cast<LogMessage>(message), args);
+    out << text;
+  }
+}
+
+BinaryLogger::BinaryLogger(const std::filesystem::path& filename)
+  : m_filename{filename}
+  , m_stop{false}
+  , m_flushRequested{false}
+{
+  // try create directory if it doesn't exist
+  const auto path = m_filename.parent_path();
+  if(!std::filesystem::is_directory(path))
+    std::filesystem::create_directories(path);
+
+  const bool writeHeader = !std::filesystem::exists(m_filename) || std::filesystem::file_size(m_filename) == 0;
+  m_file.open(m_filename, std::ios::app | std::ios::binary);
+  if(writeHeader)
+  {
+    const char header[8] = {magic[0], magic[1], magic[2], magic[3], magic[4], magic[5], static_cast<char>(version), 0};
+    m_file.write(header, sizeof(header));
+    m_file.flush();
+  }
+
+  m_thread = std::thread(
+    [this]()
+    {
+      setThreadName("binarylogger");
+      run();
+    });
+}
+
+BinaryLogger::~BinaryLogger()
+{
+  m_stop = true;
+  m_wake.notify_one();
+  m_thread.join();
+}
+
+void BinaryLogger::log(const std::chrono::system_clock::time_point& time, std::string_view objectId, LogMessage message)
+{
+  log(BinaryLogRecord::encode(time, objectId, message), message);
+}
+
+void BinaryLogger::log(const std::chrono::system_clock::time_point& time, std::string_view objectId, LogMessage message, const std::vector<std::string>& args)
+{
+  log(BinaryLogRecord::encode(time, objectId, message, args), message);
+}
+
+void BinaryLogger::log(std::string record, LogMessage message)
+{
+  m_queue.push(std::move(record));
+  if(message >= static_cast<LogMessage>(LogMessageOffset::error))
+  {
+    m_flushRequested = true;
+    m_wake.notify_one();
+  }
+}
+
+void BinaryLogger::run()
+{
+  std::string buffer;
+
+  while(true)
+  {
+    {
+      std::unique_lock<std::mutex> lock(m_wakeMutex);
+      m_wake.wait_for(lock, flushInterval, [this]() { return m_stop || m_flushRequested; });
+    }
+    m_flushRequested = false;
+
+    const bool stop = m_stop;
+
+    buffer.clear();
+    m_queue.consume(
+      [&buffer](std::string&& record)
+      {
+        buffer.append(record);
+      });
+
+    if(!buffer.empty())
+    {
+      m_file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+      m_file.flush();
+    }
+
+    if(stop)
+      break;
+  }
+}
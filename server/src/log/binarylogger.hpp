@@ -0,0 +1,88 @@
+/**
+ * server/src/log/binarylogger.hpp
+ *
+ * This file is part of the traintastic source code.
+ *
+ * Copyright (C) 2024 Reinder Feenstra
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef TRAINTASTIC_SERVER_LOG_BINARYLOGGER_HPP
+#define TRAINTASTIC_SERVER_LOG_BINARYLOGGER_HPP
+
+#include "logger.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <fstream>
+#include <traintastic/utils/stdfilesystem.hpp>
+#include "../utils/mpscqueue.hpp"
+
+/**
+ * \brief Logger writing unformatted log records to a binary file
+ *
+ * Only the message code, timestamp, object id and arguments are stored, messages aren't localised or formatted.
+ * This makes it cheap enough to keep enabled permanently, use \ref format to convert a log to text.
+ *
+ * File format (all integers are little endian):
+ * - header: "TTBLOG", uint8 version, uint8 reserved
+ * - record: uint32 size (excluding this field), int64 time (us since epoch), uint32 message,
+ *   uint16 object id length, object id, uint8 argument count,
+ *   for each argument: uint8 type, followed by:
+ *   - string: uint32 length, characters
+ *   - int/uint: int64/uint64
+ *   - double: IEEE 754 binary64
+ *
+ * Version 1 logs have no argument type, all arguments are strings.
+ * Records are encoded by \ref Log at the call site using \ref BinaryLogRecord, so numeric arguments aren't
+ * converted to text when only the binary logger is enabled.
+ */
+class BinaryLogger : public Logger
+{
+  public:
+    static constexpr std::string_view magic = "TTBLOG";
+    static constexpr uint8_t version = 2;
+    static constexpr auto flushInterval = std::chrono::seconds(1);
+
+  private:
+    const std::filesystem::path m_filename;
+    std::ofstream m_file;
+    MPSCQueue<std::string> m_queue;
+    std::atomic_bool m_stop;
+    std::atomic_bool m_flushRequested;
+    std::mutex m_wakeMutex;
+    std::condition_variable m_wake;
+    std::thread m_thread;
+
+    void run();
+
+  public:
+    //! \brief Convert a binary log to text, same format as the \ref FileLogger
+    //! \return \c true on success, \c false if the input isn't a valid binary log
+    static bool format(std::istream& in, std::ostream& out);
+
+    BinaryLogger(const std::filesystem::path& filename);
+    ~BinaryLogger() final;
+
+    void log(const std::chrono::system_clock::time_point& time, std::string_view objectId, LogMessage message) final;
+    void log(const std::chrono::system_clock::time_point& time, std::string_view objectId, LogMessage message, const std::vector<std::string>& args) final;
+
+    //! \brief Write an encoded record, see \ref BinaryLogRecord
+    void log(std::string record, LogMessage message);
+};
+
+#endif
@@ -0,0 +1,156 @@
+/**
+ * server/src/log/binarylogrecord.hpp
+ *
+ * This file is part of the traintastic source code.
+ *
+ * Copyright (C) 2024 Reinder Feenstra
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef TRAINTASTIC_SERVER_LOG_BINARYLOGRECORD_HPP
+#define TRAINTASTIC_SERVER_LOG_BINARYLOGRECORD_HPP
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <chrono>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+#include <traintastic/enum/logmessage.hpp>
+#include "appendarguments.hpp"
+#include "../utils/endian.hpp"
+
+/**
+ * \brief Encoding of a binary log record, see \ref BinaryLogger for the file format
+ *
+ * Numeric arguments are stored as typed values, they are only converted to text when the log is formatted.
+ * Object ids longer than \ref objectIdLengthMax are truncated, arguments beyond \ref argCountMax are dropped.
+ */
+namespace BinaryLogRecord {
+
+enum class ArgType : uint8_t
+{
+  String = 0,
+  Int = 1, //!< int64
+  UInt = 2, //!< uint64
+  Double = 3,
+};
+
+constexpr size_t objectIdLengthMax = std::numeric_limits<uint16_t>::max();
+constexpr size_t argCountMax = std::numeric_limits<uint8_t>::max();
+
+template<class T>
+inline void append(std::string& record, T value)
+{
+  if constexpr(std::is_floating_point_v<T>)
+  {
+    static_assert(sizeof(T) == sizeof(uint64_t));
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    append(record, bits);
+  }
+  else
+  {
+    if constexpr(sizeof(T) > 1)
+      value = host_to_le(value);
+    record.append(reinterpret_cast<const char*>(&value), sizeof(value));
+  }
+}
+
+inline void appendString(std::string& record, std::string_view value)
+{
+  append(record, static_cast<uint32_t>(value.size()));
+  record.append(value);
+}
+
+template<class T>
+inline void appendArgument(std::string& record, const T& value)
+{
+  if constexpr(std::is_convertible_v<const T&, std::string_view>)
+  {
+    append(record, ArgType::String);
+    appendString(record, std::string_view{value});
+  }
+  else if constexpr(std::is_integral_v<T> && std::is_signed_v<T>)
+  {
+    append(record, ArgType::Int);
+    append(record, static_cast<int64_t>(value));
+  }
+  else if constexpr(std::is_integral_v<T>)
+  {
+    append(record, ArgType::UInt);
+    append(record, static_cast<uint64_t>(value));
+  }
+  else if constexpr(std::is_floating_point_v<T>)
+  {
+    append(record, ArgType::Double);
+    append(record, static_cast<double>(value));
+  }
+  else // no binary representation, store the text:
+  {
+    std::vector<std::string> list;
+    appendArguments(list, value);
+    append(record, ArgType::String);
+    appendString(record, list.front());
+  }
+}
+
+//! \brief Record header, size is filled in by \ref finish
+inline std::string begin(const std::chrono::system_clock::time_point& time, std::string_view objectId, LogMessage message, size_t argCount)
+{
+  if(objectId.size() > objectIdLengthMax)
+    objectId = objectId.substr(0, objectIdLengthMax);
+
+  std::string record;
+  record.reserve(64 + objectId.size());
+  append(record, static_cast<uint32_t>(0));
+  append(record, static_cast<int64_t>(std::chrono::duration_cast<std::chrono::microseconds>(time.time_since_epoch()).count()));
+  append(record, static_cast<uint32_t>(message));
+  append(record, static_cast<uint16_t>(objectId.size()));
+  record.append(objectId);
+  append(record, static_cast<uint8_t>(std::min(argCount, argCountMax)));
+  return record;
+}
+
+inline void finish(std::string& record)
+{
+  const uint32_t size = host_to_le(static_cast<uint32_t>(record.size() - sizeof(uint32_t)));
+  std::memcpy(record.data(), &size, sizeof(size));
+}
+
+template<class... Args>
+inline std::string encode(const std::chrono::system_clock::time_point& time, std::string_view objectId, LogMessage message, const Args&... args)
+{
+  static_assert(sizeof...(Args) <= argCountMax);
+  std::string record = begin(time, objectId, message, sizeof...(Args));
+  (appendArgument(record, args), ...);
+  finish(record);
+  return record;
+}
+
+inline std::string encode(const std::chrono::system_clock::time_point& time, std::string_view objectId, LogMessage message, const std::vector<std::string>& args)
+{
+  std::string record = begin(time, objectId, message, args.size());
+  for(size_t i = 0; i < args.size() && i < argCountMax; i++)
+    appendArgument(record, args[i]);
+  finish(record);
+  return record;
+}
+
+}
+
+#endif
@@ -3,7 +3,7 @@
  *
  * This file is part of the traintastic source code.
  *
- * Copyright (C) 2021-2023 Reinder Feenstra
+ * Copyright (C) 2021-2024 Reinder Feenstra
  *
  * This program is free software; you can redistribute it and/or
  * modify it under the terms of the GNU General Public License
@@ -21,46 +21,140 @@
  */
 
 #include "filelogger.hpp"
-#include <iomanip>
 #include <version.hpp>
 #include "../os/localtime.hpp"
+#include "../utils/datetimestr.hpp"
+#include "../utils/setthreadname.hpp"
+
+static int toDate(const tm& tm)
+{
+  return (1900 + tm.tm_year) * 10000 + (1 + tm.tm_mon) * 100 + tm.tm_mday;
+}
+
+static int today()
+{
+  const auto now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+  tm tm;
+  return toDate(*localTime(&now, &tm));
+}
 
 FileLogger::FileLogger(const std::filesystem::path& filename)
+  : m_filename{filename}
+  , m_fileDate{0}
+  , m_stop{false}
+  , m_flushRequested{false}
 {
   // try create directory if it doesn't exist
-  const auto path = filename.parent_path();
+  const auto path = m_filename.parent_path();
   if(!std::filesystem::is_directory(path))
     std::filesystem::create_directories(path);
 
-  // open logfile and write marker
-  m_file.open(filename, std::ios::app);
-  m_file << "=== Traintastic v" TRAINTASTIC_VERSION_FULL << std::endl;
+  open(today());
+
+  m_thread = std::thread(
+    [this]()
+    {
+      setThreadName("filelogger");
+      run();
+    });
+}
+
+FileLogger::~FileLogger()
+{
+  m_stop = true;
+  m_wake.notify_one();
+  m_thread.join();
 }
 
 void FileLogger::log(const std::chrono::system_clock::time_point& time, std::string_view objectId, LogMessage message)
 {
-  write(time, objectId, message, toString(message));
+  enqueue(Record{time, std::string{objectId}, message, {}});
 }
 
 void FileLogger::log(const std::chrono::system_clock::time_point& time, std::string_view objectId, LogMessage message, const std::vector<std::string>& args)
 {
-  write(time, objectId, message, toString(message, args));
+  enqueue(Record{time, std::string{objectId}, message, args});
 }
 
-void FileLogger::write(const std::chrono::system_clock::time_point& time, std::string_view objectId, LogMessage code, std::string_view message)
+void FileLogger::enqueue(Record record)
 {
-  const auto systemTime = std::chrono::system_clock::to_time_t(time);
-  const auto us = std::chrono::duration_cast<std::chrono::microseconds>(time.time_since_epoch()) % 1000000;
-  tm tm;
+  const bool flush = record.message >= static_cast<LogMessage>(LogMessageOffset::error);
+  m_queue.push(std::move(record));
+  if(flush)
+  {
+    m_flushRequested = true;
+    m_wake.notify_one();
+  }
+}
+
+void FileLogger::run()
+{
+  std::string buffer;
+
+  while(true)
+  {
+    {
+      std::unique_lock<std::mutex> lock(m_wakeMutex);
+      m_wake.wait_for(lock, flushInterval, [this]() { return m_stop || m_flushRequested; });
+    }
+    m_flushRequested = false;
 
-  std::lock_guard<std::mutex> lock(m_fileMutex);
+    const bool stop = m_stop;
+
+    buffer.clear();
+    m_queue.consume(
+      [this, &buffer](Record&& record)
+      {
+        write(buffer, record);
+      });
+
+    if(!buffer.empty())
+    {
+      m_file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+      m_file.flush();
+    }
+
+    if(stop)
+      break;
+  }
+}
+
+void FileLogger::open(int date)
+{
+  m_file.open(m_filename, std::ios::app);
+  m_fileDate = date;
+
+  // write marker
+  m_file << "=== Traintastic v" TRAINTASTIC_VERSION_FULL "\n";
+  m_file.flush();
+}
+
+void FileLogger::rotate(int date)
+{
+  m_file.close();
+
+  std::error_code ec;
+  const auto rotated = m_filename.parent_path() / m_filename.stem() += dateTimeStr() += m_filename.extension();
+  std::filesystem::rename(m_filename, rotated, ec); // if it fails, just continue in the same file
+
+  open(date);
+}
+
+void FileLogger::write(std::string& buffer, const Record& record)
+{
+  const auto systemTime = std::chrono::system_clock::to_time_t(record.time);
+  tm tm;
+  const int date = toDate(*localTime(&systemTime, &tm));
 
-  const char time_format[] = TRAINTASTIC_LOG_DATE_FORMAT ";" TRAINTASTIC_LOG_TIME_FORMAT;
+  if(date != m_fileDate || m_file.tellp() + static_cast<std::streamoff>(buffer.size()) >= rotateSize)
+  {
+    if(!buffer.empty())
+    {
+      m_file.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+      buffer.clear();
+    }
+    rotate(date);
+  }
 
-  m_file
-    << std::put_time(localTime(&systemTime, &tm), time_format) << '.' << std::setfill('0') << std::setw(6) << us.count() << ';'
-    << objectId << ';'
-    << logMessageChar(code) << std::setw(4) << logMessageNumber(code) << ';'
-    << message
-    << std::endl;
+  appendText(buffer, record.time, record.objectId, record.message, record.args);
 }
@@ -3,7 +3,7 @@
  *
  * This file is part of the traintastic source code.
  *
- * Copyright (C) 2021-2022 Reinder Feenstra
+ * Copyright (C) 2021-2024 Reinder Feenstra
  *
  * This program is free software; you can redistribute it and/or
  * modify it under the terms of the GNU General Public License
@@ -24,20 +24,56 @@
 #define TRAINTASTIC_SERVER_LOG_FILELOGGER_HPP
 
 #include "logger.hpp"
+#include <atomic>
+#include <condition_variable>
 #include <mutex>
+#include <thread>
 #include <fstream>
 #include <traintastic/utils/stdfilesystem.hpp>
+#include "../utils/mpscqueue.hpp"
 
+/**
+ * \brief Logger writing to a text file
+ *
+ * Log messages are queued (lock-free) and formatted and written by a dedicated writer thread,
+ * so logging doesn't block the calling thread on file I/O.
+ * The file is flushed periodically or immediately for messages of error severity or higher.
+ * The file is rotated when it exceeds \ref rotateSize or when the date changes.
+ */
 class FileLogger : public Logger
 {
+  public:
+    static constexpr auto flushInterval = std::chrono::seconds(1);
+    static constexpr std::streamoff rotateSize = 16 * 1024 * 1024;
+
   private:
+    struct Record
+    {
+      std::chrono::system_clock::time_point time;
+      std::string objectId;
+      LogMessage message;
+      std::vector<std::string> args;
+    };
+
+    const std::filesystem::path m_filename;
     std::ofstream m_file;
-    std::mutex m_fileMutex;
+    int m_fileDate; //!< date the file was opened (yyyymmdd)
+    MPSCQueue<Record> m_queue;
+    std::atomic_bool m_stop;
+    std::atomic_bool m_flushRequested;
+    std::mutex m_wakeMutex;
+    std::condition_variable m_wake;
+    std::thread m_thread;
 
-    void write(const std::chrono::system_clock::time_point& time, std::string_view objectId, LogMessage code, std::string_view message);
+    void enqueue(Record record);
+    void run();
+    void open(int date);
+    void rotate(int date);
+    void write(std::string& buffer, const Record& record);
 
   public:
     FileLogger(const std::filesystem::path& filename);
+    ~FileLogger() final;
 
     void log(const std::chrono::system_clock::time_point& time, std::string_view objectId, LogMessage message) final;
     void log(const std::chrono::system_clock::time_point& time, std::string_view objectId, LogMessage message, const std::vector<std::string>& args) final;
@@ -3,7 +3,7 @@
  *
  * This file is part of the traintastic source code.
  *
- * Copyright (C) 2021 Reinder Feenstra
+ * Copyright (C) 2021,2024 Reinder Feenstra
  *
  * This program is free software; you can redistribute it and/or
  * modify it under the terms of the GNU General Public License
@@ -23,9 +23,18 @@
 #include "log.hpp"
 #include "consolelogger.hpp"
 #include "filelogger.hpp"
+#include "binarylogger.hpp"
 #include "memorylogger.hpp"
 
 std::list<std::unique_ptr<Logger>> Log::s_loggers;
+BinaryLogger* Log::s_binaryLogger = nullptr;
+bool Log::s_textLoggers = false;
+
+void Log::loggersChanged()
+{
+  s_binaryLogger = get<BinaryLogger>();
+  s_textLoggers = s_loggers.size() > (s_binaryLogger ? 1 : 0);
+}
 
 void Log::enableConsoleLogger()
 {
@@ -42,6 +51,16 @@ void Log::disableFileLogger()
   disable<FileLogger>();
 }
 
+void Log::enableBinaryLogger(const std::filesystem::path& filename)
+{
+  enable<BinaryLogger>(filename);
+}
+
+void Log::disableBinaryLogger()
+{
+  disable<BinaryLogger>();
+}
+
 void Log::enableMemoryLogger(uint32_t size)
 {
   enable<MemoryLogger>(size);
@@ -70,3 +89,15 @@ void Log::logFormatted(std::string objectId, LogMessage message, std::vector<std
   for(const auto& logger : s_loggers)
     logger->log(time, objectId, message, args);
 }
+
+void Log::logBinary(std::string record, LogMessage message)
+{
+  s_binaryLogger->log(std::move(record), message);
+}
+
+void Log::logText(const std::chrono::system_clock::time_point& time, std::string_view objectId, LogMessage message, const std::vector<std::string>& args)
+{
+  for(const auto& logger : s_loggers)
+    if(logger.get() != static_cast<Logger*>(s_binaryLogger))
+      logger->log(time, objectId, message, args);
+}
@@ -3,7 +3,7 @@
  *
  * This file is part of the traintastic source code.
  *
- * Copyright (C) 2021,2023 Reinder Feenstra
+ * Copyright (C) 2021,2023-2024 Reinder Feenstra
  *
  * This program is free software; you can redistribute it and/or
  * modify it under the terms of the GNU General Public License
@@ -27,17 +27,21 @@
 #include <vector>
 #include <traintastic/enum/logmessage.hpp>
 #include "appendarguments.hpp"
+#include "binarylogrecord.hpp"
 #ifdef ENABLE_LOG_DEBUG
   #include "joinarguments.hpp"
 #endif
 
 class Logger;
+class BinaryLogger;
 class MemoryLogger;
 
 class Log
 {
   private:
     static std::list<std::unique_ptr<Logger>> s_loggers;
+    static BinaryLogger* s_binaryLogger; //!< also in s_loggers, gets encoded records directly
+    static bool s_textLoggers; //!< \c true if there are loggers besides the binary logger
 
     Log() = default;
 
@@ -55,6 +59,7 @@ class Log
     {
       disable<T>();
       s_loggers.emplace_back(new T(std::forward<Args>(args)...));
+      loggersChanged();
     }
 
     template<class T>
@@ -63,9 +68,13 @@ class Log
       auto it = std::find_if(s_loggers.begin(), s_loggers.end(), [](const auto& logger){ return dynamic_cast<T*>(logger.get()); });
       if(it != s_loggers.end())
         s_loggers.erase(it);
+      loggersChanged();
     }
 
+    static void loggersChanged();
     static void logFormatted(std::string objectId, LogMessage message, std::vector<std::string> args);
+    static void logBinary(std::string record, LogMessage message);
+    static void logText(const std::chrono::system_clock::time_point& time, std::string_view objectId, LogMessage message, const std::vector<std::string>& args);
 
   public:
     static void enableConsoleLogger();
@@ -73,6 +82,9 @@ class Log
     static void enableFileLogger(const std::filesystem::path& filename);
     static void disableFileLogger();
 
+    static void enableBinaryLogger(const std::filesystem::path& filename);
+    static void disableBinaryLogger();
+
     static void enableMemoryLogger(uint32_t size);
     static void disableMemoryLogger();
     static MemoryLogger* getMemoryLogger();
@@ -105,21 +117,27 @@ class Log
     }
 
     template<class... Args>
-    static void log(std::string objectId, LogMessage message, const Args&... args)
+    inline static void log(const std::string& objectId, LogMessage message, const Args&... args)
     {
-      std::vector<std::string> list;
-      list.reserve(sizeof...(Args));
-      appendArguments(list, std::forward<const Args&>(args)...);
-      logFormatted(std::move(objectId), message, std::move(list));
+      log(std::string_view{objectId}, message, std::forward<const Args&>(args)...);
     }
 
     template<class... Args>
-    inline static void log(std::string_view objectId, LogMessage message, const Args&... args)
+    static void log(std::string_view objectId, LogMessage message, const Args&... args)
     {
-      std::vector<std::string> list;
-      list.reserve(sizeof...(Args));
-      appendArguments(list, std::forward<const Args&>(args)...);
-      logFormatted(std::string{objectId}, message, std::move(list));
+      const auto time = std::chrono::system_clock::now();
+
+      // arguments are only converted to text if a logger needs it:
+      if(s_binaryLogger)
+        logBinary(BinaryLogRecord::encode(time, objectId, message, std::forward<const Args&>(args)...), message);
+
+      if(s_textLoggers)
+      {
+        std::vector<std::string> list;
+        list.reserve(sizeof...(Args));
+        appendArguments(list, std::forward<const Args&>(args)...);
+        logText(time, objectId, message, list);
+      }
     }
 
     template<class... Args>
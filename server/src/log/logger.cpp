@@ -3,7 +3,7 @@
  *
  * This file is part of the traintastic source code.
  *
- * Copyright (C) 2021 Reinder Feenstra
+ * Copyright (C) 2021,2024 Reinder Feenstra
  *
  * This program is free software; you can redistribute it and/or
  * modify it under the terms of the GNU General Public License
@@ -22,7 +22,9 @@
 
 #include "logger.hpp"
 #include <cassert>
+#include <cstdio>
 #include <traintastic/locale/locale.hpp>
+#include "../os/localtime.hpp"
 
 std::string_view Logger::toString(LogMessage message)
 {
@@ -62,3 +64,25 @@ std::string Logger::toString(LogMessage message, const std::vector<std::string>&
 
   return s;
 }
+
+void Logger::appendText(std::string& text, const std::chrono::system_clock::time_point& time, std::string_view objectId, LogMessage message, const std::vector<std::string>& args)
+{
+  const auto systemTime = std::chrono::system_clock::to_time_t(time);
+  const auto us = std::chrono::duration_cast<std::chrono::microseconds>(time.time_since_epoch()) % 1000000;
+  tm tm;
+
+  const char timeFormat[] = TRAINTASTIC_LOG_DATE_FORMAT ";" TRAINTASTIC_LOG_TIME_FORMAT;
+  char buffer[64];
+  size_t n = strftime(buffer, sizeof(buffer), timeFormat, localTime(&systemTime, &tm));
+  n += static_cast<size_t>(snprintf(buffer + n, sizeof(buffer) - n, ".%06d;", static_cast<int>(us.count())));
+
+  text.append(buffer, n);
+  text.append(objectId);
+  n = static_cast<size_t>(snprintf(buffer, sizeof(buffer), ";%c%04u;", logMessageChar(message), static_cast<unsigned int>(logMessageNumber(message))));
+  text.append(buffer, n);
+  if(args.empty())
+    text.append(toString(message));
+  else
+    text.append(toString(message, args));
+  text.push_back('\n');
+}
@@ -3,7 +3,7 @@
  *
  * This file is part of the traintastic source code.
  *
- * Copyright (C) 2021 Reinder Feenstra
+ * Copyright (C) 2021,2024 Reinder Feenstra
  *
  * This program is free software; you can redistribute it and/or
  * modify it under the terms of the GNU General Public License
@@ -44,6 +44,7 @@ class Logger
   protected:
     static std::string_view toString(LogMessage message);
     static std::string toString(LogMessage message, const std::vector<std::string>& args);
+    static void appendText(std::string& text, const std::chrono::system_clock::time_point& time, std::string_view objectId, LogMessage message, const std::vector<std::string>& args);
 
     Logger() = default;
 
@@ -3,7 +3,7 @@
  *
  * This file is part of the traintastic source code.
  *
- * Copyright (C) 2021-2022 Reinder Feenstra
+ * Copyright (C) 2021-2024 Reinder Feenstra
  *
  * This program is free software; you can redistribute it and/or
  * modify it under the terms of the GNU General Public License
@@ -21,43 +21,178 @@
  */
 
 #include "memorylogger.hpp"
+#include <cassert>
+#include <limits>
 #include "../core/eventloop.hpp"
 
+static constexpr size_t argLengthMax = std::numeric_limits<uint16_t>::max();
+
 MemoryLogger::MemoryLogger(uint32_t sizeMax)
-  : m_sizeMax{sizeMax}
+  : m_records(std::max<uint32_t>(sizeMax, 1))
+  , m_arena(m_records.size() * arenaBytesPerLog)
+{
+}
+
+MemoryLogger::Log MemoryLogger::get(uint64_t sequence) const
 {
+  assert(sequence >= m_first && sequence < m_next);
+  const auto& r = record(sequence);
+  return {r.time, m_objectIds[r.objectId].id, r.message, r.argc, m_arena.data() + r.argsOffset};
 }
 
 void MemoryLogger::log(const std::chrono::system_clock::time_point& time, std::string_view objectId, LogMessage message)
 {
-  add(time, std::string{objectId}, message, nullptr);
+  if(isEventLoopThread())
+    add(time, objectId, message, nullptr);
+  else
+    enqueue(Pending{time, std::string{objectId}, message, {}});
 }
 
 void MemoryLogger::log(const std::chrono::system_clock::time_point& time, std::string_view objectId, LogMessage message, const std::vector<std::string>& args)
 {
-  add(time, std::string{objectId}, message, new std::vector<std::string>(args));
+  if(isEventLoopThread())
+    add(time, objectId, message, &args);
+  else
+    enqueue(Pending{time, std::string{objectId}, message, args});
 }
 
-void MemoryLogger::add(std::chrono::system_clock::time_point time, std::string objectId, LogMessage message, std::vector<std::string>* args)
+uint32_t MemoryLogger::internObjectId(std::string_view objectId)
 {
-  if(isEventLoopThread())
+  if(auto it = m_objectIdIndex.find(objectId); it != m_objectIdIndex.end())
+  {
+    m_objectIds[it->second].refs++;
+    return it->second;
+  }
+
+  uint32_t index;
+  if(!m_objectIdsFree.empty())
   {
-    m_logs.emplace_back(std::move(time), std::move(objectId), message, std::unique_ptr<std::vector<std::string>>{args});
-    changed(*this, 1, cleanUp());
+    index = m_objectIdsFree.back();
+    m_objectIdsFree.pop_back();
+    m_objectIds[index] = ObjectId{std::string{objectId}, 1};
   }
   else
   {
-    EventLoop::call(
-      [this, time=std::move(time), objectId=std::move(objectId), message, args]()
-      {
-        add(std::move(time), std::move(objectId), message, args);
-      });
+    index = static_cast<uint32_t>(m_objectIds.size());
+    m_objectIds.emplace_back(ObjectId{std::string{objectId}, 1});
+  }
+  m_objectIdIndex.emplace(m_objectIds[index].id, index);
+  return index;
+}
+
+void MemoryLogger::releaseObjectId(uint32_t index)
+{
+  auto& objectId = m_objectIds[index];
+  assert(objectId.refs != 0);
+  if(--objectId.refs != 0)
+    return;
+
+  m_objectIdIndex.erase(objectId.id);
+  objectId.id = std::string{};
+  m_objectIdsFree.emplace_back(index);
+}
+
+void MemoryLogger::removeUntil(uint64_t sequence)
+{
+  for(; m_first < sequence; m_first++)
+    releaseObjectId(record(m_first).objectId);
+}
+
+void MemoryLogger::add(const std::chrono::system_clock::time_point& time, std::string_view objectId, LogMessage message, const std::vector<std::string>* args)
+{
+  assert(isEventLoopThread());
+
+  if(m_next - m_first == m_records.size()) // full, drop oldest
+    removeUntil(m_first + 1);
+
+  uint8_t argc = 0;
+  size_t argsSize = 0;
+  if(args)
+  {
+    argc = static_cast<uint8_t>(std::min<size_t>(args->size(), std::numeric_limits<uint8_t>::max()));
+    for(uint8_t i = 0; i < argc; i++)
+      argsSize += sizeof(uint16_t) + std::min((*args)[i].size(), argLengthMax);
+    if(argsSize > m_arena.size()) // doesn't fit at all, drop arguments
+    {
+      argc = 0;
+      argsSize = 0;
+    }
+  }
+
+  const size_t argsOffset = argsSize != 0 ? allocateArgs(argsSize) : 0;
+
+  char* p = m_arena.data() + argsOffset;
+  for(uint8_t i = 0; i < argc; i++)
+  {
+    const auto& arg = (*args)[i];
+    const uint16_t length = static_cast<uint16_t>(std::min(arg.size(), argLengthMax));
+    memcpy(p, &length, sizeof(length));
+    p += sizeof(length);
+    memcpy(p, arg.data(), length);
+    p += length;
   }
+
+  record(m_next) = Record{time, internObjectId(objectId), message, argc, static_cast<uint32_t>(argsOffset), static_cast<uint32_t>(argsSize)};
+  m_next++;
+
+  notify();
 }
 
-uint32_t MemoryLogger::cleanUp()
+size_t MemoryLogger::allocateArgs(size_t size)
 {
-  const uint32_t remove = (size() > m_sizeMax) ? (size() - m_sizeMax) : 0;
-  m_logs.erase(m_logs.begin(), m_logs.begin() + remove);
-  return remove;
+  size_t offset = m_arenaHead;
+  const bool wrap = offset + size > m_arena.size(); // doesn't fit at the end, wrap around
+  if(wrap)
+    offset = 0;
+
+  // arguments are allocated in log order: first the logs behind the head (if the arena wrapped before),
+  // followed by the logs from the start of the arena up to the head.
+  uint64_t removeSequence = m_first;
+  for(uint64_t sequence = m_first; sequence < m_next; sequence++)
+  {
+    const auto& r = record(sequence);
+    if(r.argsSize == 0)
+      continue;
+    if(wrap && r.argsOffset >= m_arenaHead) // behind the head, older than the logs at the start of the arena
+      removeSequence = sequence + 1;
+    else if(r.argsOffset < offset + size && offset < r.argsOffset + r.argsSize)
+      removeSequence = sequence + 1;
+    else
+      break;
+  }
+  removeUntil(removeSequence);
+
+  m_arenaHead = offset + size;
+  return offset;
+}
+
+void MemoryLogger::enqueue(Pending pending)
+{
+  m_pending.push(std::move(pending));
+  if(!m_drainPosted.exchange(true))
+    EventLoop::call(&MemoryLogger::drain, this);
+}
+
+void MemoryLogger::drain()
+{
+  m_drainPosted = false;
+  m_pending.consume(
+    [this](Pending&& pending)
+    {
+      add(pending.time, pending.objectId, pending.message, pending.args.empty() ? nullptr : &pending.args);
+    });
+}
+
+void MemoryLogger::notify()
+{
+  if(m_notifyPosted)
+    return;
+
+  m_notifyPosted = true;
+  EventLoop::call(
+    [this]()
+    {
+      m_notifyPosted = false;
+      changed(*this);
+    });
 }
@@ -3,7 +3,7 @@
  *
  * This file is part of the traintastic source code.
  *
- * Copyright (C) 2021-2022 Reinder Feenstra
+ * Copyright (C) 2021-2024 Reinder Feenstra
  *
  * This program is free software; you can redistribute it and/or
  * modify it under the terms of the GNU General Public License
@@ -24,43 +24,114 @@
 #define TRAINTASTIC_SERVER_LOG_MEMORYLOGGER_HPP
 
 #include "logger.hpp"
-#include <list>
-#include <functional>
+#include <atomic>
+#include <cstring>
+#include <deque>
+#include <unordered_map>
 #include <boost/signals2/signal.hpp>
+#include "../utils/mpscqueue.hpp"
 
+/**
+ * \brief Logger keeping the last logs in memory
+ *
+ * Logs are stored in a fixed capacity ring buffer, every log gets a sequence number.
+ * Object ids are interned (and released when the last log using them is removed)
+ * and arguments are stored in a (ring) arena, if the arena is full the oldest logs are removed.
+ *
+ * Logs from other threads are queued and added by the event loop in batches,
+ * \ref changed is emitted at most once per event loop iteration.
+ */
 class MemoryLogger : public Logger
 {
   public:
+    static constexpr size_t arenaBytesPerLog = 32; //!< average argument space per log
+
     struct Log
     {
       std::chrono::system_clock::time_point time;
-      std::string objectId;
+      std::string_view objectId;
       LogMessage message;
-      std::unique_ptr<std::vector<std::string>> args;
-
-      Log(std::chrono::system_clock::time_point _time, std::string _objectId, LogMessage _message, std::unique_ptr<std::vector<std::string>> _args = {})
-        : time{std::move(_time)}
-        , objectId{std::move(_objectId)}
-        , message{_message}
-        , args{std::move(_args)}
-      {
-      }
+      uint8_t argc;
+      const char* args; //!< argument data: uint16 length + data, for each argument
     };
 
   private:
-    std::vector<Log> m_logs;
-    size_t m_sizeMax;
+    struct Record
+    {
+      std::chrono::system_clock::time_point time;
+      uint32_t objectId;
+      LogMessage message;
+      uint8_t argc;
+      uint32_t argsOffset;
+      uint32_t argsSize;
+    };
 
-    void add(std::chrono::system_clock::time_point time, std::string objectId, LogMessage message, std::vector<std::string>* args);
-    uint32_t cleanUp();
+    struct ObjectId
+    {
+      std::string id;
+      uint32_t refs; //!< number of records using the object id
+    };
+
+    struct Pending
+    {
+      std::chrono::system_clock::time_point time;
+      std::string objectId;
+      LogMessage message;
+      std::vector<std::string> args;
+    };
+
+    std::vector<Record> m_records;
+    uint64_t m_first = 0; //!< sequence number of the oldest log
+    uint64_t m_next = 0; //!< sequence number of the next log
+    std::deque<ObjectId> m_objectIds; //!< deque: elements don't move, index can use views
+    std::unordered_map<std::string_view, uint32_t> m_objectIdIndex;
+    std::vector<uint32_t> m_objectIdsFree; //!< unused m_objectIds slots
+    std::vector<char> m_arena;
+    size_t m_arenaHead = 0;
+    MPSCQueue<Pending> m_pending;
+    std::atomic_bool m_drainPosted = false;
+    bool m_notifyPosted = false;
+
+    inline Record& record(uint64_t sequence) { return m_records[sequence % m_records.size()]; }
+    inline const Record& record(uint64_t sequence) const { return m_records[sequence % m_records.size()]; }
+
+    uint32_t internObjectId(std::string_view objectId);
+    void releaseObjectId(uint32_t index);
+    void removeUntil(uint64_t sequence);
+    void add(const std::chrono::system_clock::time_point& time, std::string_view objectId, LogMessage message, const std::vector<std::string>* args);
+    size_t allocateArgs(size_t size);
+    void enqueue(Pending pending);
+    void drain();
+    void notify();
 
   public:
-    boost::signals2::signal<void(const MemoryLogger&, uint32_t added, uint32_t removed)> changed;
+    boost::signals2::signal<void(const MemoryLogger&)> changed;
 
     MemoryLogger(uint32_t sizeMax);
 
-    inline const Log& operator[](uint32_t index) const { return m_logs[index]; }
-    inline uint32_t size() const { return static_cast<uint32_t>(m_logs.size()); }
+    //! \brief Sequence number of the oldest log
+    inline uint64_t first() const { return m_first; }
+    //! \brief Sequence number of the next log, i.e. newest log + 1
+    inline uint64_t next() const { return m_next; }
+    inline uint32_t size() const { return static_cast<uint32_t>(m_next - m_first); }
+
+    //! \param[in] sequence Sequence number, must be in range [first(), next())
+    Log get(uint64_t sequence) const;
+
+    //! \brief Call \a f for each argument of a log
+    template<class F>
+    static void forEachArg(const Log& log, F&& f)
+    {
+      const char* p = log.args;
+      for(uint8_t i = 0; i < log.argc; i++)
+      {
+        uint16_t length;
+        memcpy(&length, p, sizeof(length));
+        p += sizeof(length);
+        f(std::string_view{p, length});
+        p += length;
+      }
+    }
 
     void log(const std::chrono::system_clock::time_point& time, std::string_view objectId, LogMessage message) final;
     void log(const std::chrono::system_clock::time_point& time, std::string_view objectId, LogMessage message, const std::vector<std::string>& args) final;
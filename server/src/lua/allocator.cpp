@@ -0,0 +1,200 @@
+/**
+ * server/src/lua/allocator.cpp
+ *
+ * This file is part of the traintastic source code.
+ *
+ * Copyright (C) 2024 Reinder Feenstra
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "allocator.hpp"
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <new>
+
+namespace Lua {
+
+Allocator::Allocator(size_t limit)
+  : m_limit{limit}
+{
+}
+
+Allocator::~Allocator()
+{
+  for(void* chunk : m_chunks)
+    free(chunk);
+}
+
+void* Allocator::poolAllocate(size_t size)
+{
+  const size_t index = poolIndex(size);
+
+  if(FreeBlock* block = m_freeLists[index])
+  {
+    m_freeLists[index] = block->next;
+    return block;
+  }
+
+  const size_t blockSize = (index + 1) * poolBlockSizeGranularity;
+  if(static_cast<size_t>(m_chunkEnd - m_chunkPosition) < blockSize)
+  {
+    // put the remainder of the current chunk in the free list of the largest fitting size class:
+    if(const size_t remaining = static_cast<size_t>(m_chunkEnd - m_chunkPosition); remaining >= poolBlockSizeGranularity)
+    {
+      const size_t remainingIndex = remaining / poolBlockSizeGranularity - 1;
+      auto* remainder = reinterpret_cast<FreeBlock*>(m_chunkPosition);
+      remainder->next = m_freeLists[remainingIndex];
+      m_freeLists[remainingIndex] = remainder;
+    }
+
+    void* chunk = malloc(poolChunkSize);
+    if(!chunk)
+    {
+      m_chunkPosition = m_chunkEnd = nullptr;
+      return nullptr;
+    }
+    m_chunks.push_back(chunk);
+    m_chunkPosition = static_cast<std::byte*>(chunk);
+    m_chunkEnd = m_chunkPosition + poolChunkSize;
+  }
+
+  void* block = m_chunkPosition;
+  m_chunkPosition += blockSize;
+  return block;
+}
+
+void Allocator::poolFree(void* ptr, size_t size)
+{
+  const size_t index = poolIndex(size);
+  auto* block = static_cast<FreeBlock*>(ptr);
+  block->next = m_freeLists[index];
+  m_freeLists[index] = block;
+}
+
+void* Allocator::allocate(size_t size)
+{
+  return isPoolSize(size) ? poolAllocate(size) : malloc(size);
+}
+
+void Allocator::deallocate(void* ptr, size_t size)
+{
+  if(isPoolSize(size))
+    poolFree(ptr, size);
+  else
+    free(ptr);
+}
+
+size_t Allocator::blockSize(void* ptr, size_t size) const
+{
+  if(!m_keptBlocks.empty())
+  {
+    if(auto it = m_keptBlocks.find(ptr); it != m_keptBlocks.end())
+      return it->second;
+  }
+  return size;
+}
+
+void Allocator::keep(void* ptr, size_t size)
+{
+  try
+  {
+    m_keptBlocks.insert_or_assign(ptr, size);
+  }
+  catch(const std::bad_alloc&)
+  {
+    // without the real size the block is released to the size class of its new size,
+    // a pool block only wastes its tail, a malloc block is never freed, both are safe.
+  }
+}
+
+void* Allocator::alloc(void* ud, void* ptr, size_t osize, size_t nsize)
+{
+  auto& allocator = *static_cast<Allocator*>(ud);
+
+  // if ptr is NULL, osize is the type of object being allocated, not its size:
+  const size_t oldSize = ptr ? osize : 0;
+
+  // the real size differs from oldSize if the block was kept in place on shrink:
+  const size_t oldBlockSize = ptr ? allocator.blockSize(ptr, oldSize) : 0;
+
+  if(nsize == 0)
+  {
+    if(oldBlockSize != oldSize)
+      allocator.m_keptBlocks.erase(ptr);
+    if(ptr)
+      allocator.deallocate(ptr, oldBlockSize);
+    allocator.m_usage -= oldSize;
+    return nullptr;
+  }
+
+  // only growing allocations are limited, Lua assumes shrinking never fails:
+  if(nsize > oldSize && allocator.m_limitEnabled && allocator.m_limit != 0 && allocator.m_usage - oldSize + nsize > allocator.m_limit)
+  {
+    allocator.m_limitExceeded = true;
+    return nullptr; // Lua does an emergency garbage collection and retries once
+  }
+
+  void* p;
+  bool kept = false;
+  if(!ptr)
+  {
+    p = allocator.allocate(nsize);
+  }
+  else if(isPoolSize(oldBlockSize) && isPoolSize(nsize) && poolIndex(oldBlockSize) == poolIndex(nsize))
+  {
+    p = ptr; // same size class, block can be reused
+  }
+  else if(!isPoolSize(oldBlockSize) && !isPoolSize(nsize))
+  {
+    p = realloc(ptr, nsize);
+    if(!p && nsize <= oldSize)
+      p = ptr; // large enough, free() doesn't need the size
+  }
+  else
+  {
+    p = allocator.allocate(nsize);
+    if(p)
+    {
+      memcpy(p, ptr, std::min(oldSize, nsize));
+      allocator.deallocate(ptr, oldBlockSize);
+    }
+    else if(nsize <= oldSize)
+    {
+      p = ptr; // moving to a smaller size class failed, keep it in place, Lua assumes shrinking never fails
+      kept = true;
+    }
+  }
+
+  if(!p)
+    return nullptr; // Lua handles the out of memory error, old block is still valid
+
+  if(kept)
+    allocator.keep(ptr, oldBlockSize);
+  else if(oldBlockSize != oldSize)
+    allocator.m_keptBlocks.erase(ptr); // moved, reallocated or its size class matches again
+
+  allocator.m_usage = allocator.m_usage - oldSize + nsize;
+  allocator.m_peak = std::max(allocator.m_peak, allocator.m_usage);
+  if(nsize > oldSize)
+    allocator.m_limitExceeded = false;
+  if(!ptr)
+    allocator.m_allocations++;
+
+  return p;
+}
+
+}
@@ -0,0 +1,119 @@
+/**
+ * server/src/lua/allocator.hpp
+ *
+ * This file is part of the traintastic source code.
+ *
+ * Copyright (C) 2024 Reinder Feenstra
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef TRAINTASTIC_SERVER_LUA_ALLOCATOR_HPP
+#define TRAINTASTIC_SERVER_LUA_ALLOCATOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <array>
+#include <vector>
+#include <unordered_map>
+
+namespace Lua {
+
+/**
+ * \brief Lua memory allocator with accounting and memory limit
+ *
+ * Keeps track of the number of bytes in use, the peak usage and number of allocations of a Lua state.
+ *
+ * Lua allocates mostly small objects (strings, tables, closures), blocks up to \ref poolBlockSizeMax bytes
+ * are taken from per size class free lists which are carved from larger chunks. Chunks are only released
+ * when the allocator is destroyed (after lua_close), larger blocks are passed on to realloc/free.
+ *
+ * When a limit is set, growing allocations that would exceed it fail, Lua then runs an emergency
+ * garbage collection and if that doesn't free enough memory it raises a memory error (LUA_ERRMEM).
+ * The limit is only enforced while enabled, the sandbox enables it during a pcall only. A memory error
+ * outside a protected call would make Lua panic, e.g. while pushing event handler arguments.
+ *
+ * Shrinking never fails, if a block can't be moved to a smaller size class it is kept in place and
+ * its real size is remembered so it is released to the right size class.
+ */
+class Allocator
+{
+  public:
+    static constexpr size_t poolBlockSizeGranularity = 16;
+    static constexpr size_t poolBlockSizeMax = 256;
+    static constexpr size_t poolChunkSize = 64 * 1024;
+
+  private:
+    static constexpr size_t poolCount = poolBlockSizeMax / poolBlockSizeGranularity;
+
+    struct FreeBlock
+    {
+      FreeBlock* next;
+    };
+
+    std::array<FreeBlock*, poolCount> m_freeLists = {};
+    std::vector<void*> m_chunks;
+    std::byte* m_chunkPosition = nullptr;
+    std::byte* m_chunkEnd = nullptr;
+    std::unordered_map<void*, size_t> m_keptBlocks; //!< blocks kept in place on shrink, to their real size
+    size_t m_limit;
+    bool m_limitEnabled = false;
+    bool m_limitExceeded = false;
+    size_t m_usage = 0;
+    size_t m_peak = 0;
+    uint64_t m_allocations = 0;
+
+    static constexpr bool isPoolSize(size_t size)
+    {
+      return size <= poolBlockSizeMax;
+    }
+
+    static constexpr size_t poolIndex(size_t size)
+    {
+      return (size - 1) / poolBlockSizeGranularity;
+    }
+
+    void* poolAllocate(size_t size);
+    void poolFree(void* ptr, size_t size);
+    void* allocate(size_t size);
+    void deallocate(void* ptr, size_t size);
+    size_t blockSize(void* ptr, size_t size) const;
+    void keep(void* ptr, size_t size);
+
+  public:
+    //! \param[in] limit Maximum number of bytes in use, zero for no limit
+    Allocator(size_t limit = 0);
+    Allocator(const Allocator&) = delete;
+    Allocator& operator =(const Allocator&) = delete;
+    ~Allocator();
+
+    //! \brief lua_Alloc compatible function, \a ud must point to an Allocator
+    static void* alloc(void* ud, void* ptr, size_t osize, size_t nsize);
+
+    inline size_t limit() const { return m_limit; }
+    inline void setLimit(size_t value) { m_limit = value; }
+    inline void setLimitEnabled(bool value) { m_limitEnabled = value; }
+
+    //! \brief \c true if the last failed allocation was refused because of the memory limit
+    inline bool limitExceeded() const { return m_limitExceeded; }
+
+    inline size_t usage() const { return m_usage; }
+    inline size_t peak() const { return m_peak; }
+    inline uint64_t allocations() const { return m_allocations; }
+};
+
+}
+
+#endif
@@ -0,0 +1,111 @@
+/**
+ * server/src/lua/bytecodecache.cpp
+ *
+ * This file is part of the traintastic source code.
+ *
+ * Copyright (C) 2024 Reinder Feenstra
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "bytecodecache.hpp"
+#include <fstream>
+#include <version.hpp>
+#include "../utils/sha1.hpp"
+
+namespace Lua {
+
+static int writer(lua_State* /*L*/, const void* p, size_t size, void* ud)
+{
+  static_cast<std::string*>(ud)->append(static_cast<const char*>(p), size);
+  return 0;
+}
+
+void BytecodeCache::setDirectory(const std::filesystem::path& directory)
+{
+  s_directory = directory;
+
+  if(s_directory.empty())
+    return;
+
+  std::error_code ec;
+  std::filesystem::create_directories(s_directory, ec);
+
+  // remove expired cache files:
+  const auto expired = std::filesystem::file_time_type::clock::now() - expireAfter;
+  for(const auto& entry : std::filesystem::directory_iterator(s_directory, ec))
+    if(entry.path().extension() == dotLuac && entry.last_write_time(ec) < expired && !ec)
+      std::filesystem::remove(entry.path(), ec);
+}
+
+std::filesystem::path BytecodeCache::filename(std::string_view code)
+{
+  // bytecode is Lua version and build specific:
+  std::string key{LUA_RELEASE " " TRAINTASTIC_VERSION_FULL};
+  key += '\0';
+  key.append(code);
+
+  return s_directory / Sha1::of(key).toString() += dotLuac;
+}
+
+int BytecodeCache::load(lua_State* L, std::string_view code, const char* chunkname)
+{
+  if(s_directory.empty())
+    return luaL_loadbufferx(L, code.data(), code.size(), chunkname, "t");
+
+  const auto cacheFile = filename(code);
+  std::error_code ec;
+
+  // try cached bytecode:
+  if(std::ifstream file(cacheFile, std::ios::binary | std::ios::ate); file.is_open())
+  {
+    std::string bytecode(static_cast<size_t>(file.tellg()), '\0');
+    file.seekg(0);
+    if(file.read(bytecode.data(), bytecode.size()))
+    {
+      if(luaL_loadbufferx(L, bytecode.data(), bytecode.size(), chunkname, "b") == LUA_OK)
+      {
+        std::filesystem::last_write_time(cacheFile, std::filesystem::file_time_type::clock::now(), ec); // mark as used
+        return LUA_OK;
+      }
+      lua_pop(L, 1); // pop error message, invalid cache file is replaced below
+    }
+  }
+
+  const int r = luaL_loadbufferx(L, code.data(), code.size(), chunkname, "t");
+  if(r != LUA_OK)
+    return r;
+
+  std::string bytecode;
+  if(lua_dump(L, writer, &bytecode, 0) == 0)
+  {
+    // write to a temporary file first, so a cache file is always complete:
+    auto tmpFile = cacheFile;
+    tmpFile += ".tmp";
+    if(std::ofstream file(tmpFile, std::ios::binary | std::ios::trunc); file.is_open())
+    {
+      file.write(bytecode.data(), bytecode.size());
+      file.close();
+      if(file)
+        std::filesystem::rename(tmpFile, cacheFile, ec);
+      else
+        std::filesystem::remove(tmpFile, ec);
+    }
+  }
+
+  return LUA_OK;
+}
+
+}
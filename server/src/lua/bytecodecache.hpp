@@ -0,0 +1,68 @@
+/**
+ * server/src/lua/bytecodecache.hpp
+ *
+ * This file is part of the traintastic source code.
+ *
+ * Copyright (C) 2024 Reinder Feenstra
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef TRAINTASTIC_SERVER_LUA_BYTECODECACHE_HPP
+#define TRAINTASTIC_SERVER_LUA_BYTECODECACHE_HPP
+
+#include <string_view>
+#include <chrono>
+#include <lua.hpp>
+#include <traintastic/utils/stdfilesystem.hpp>
+
+namespace Lua {
+
+/**
+ * \brief Cache of precompiled script chunks
+ *
+ * Compiled chunks (lua_dump) are stored as files in the cache directory, the filename is the SHA-1 of
+ * the source code, the Lua version and the Traintastic version. Binary chunks are only ever read from
+ * the cache directory, source code is always loaded in text mode.
+ */
+class BytecodeCache
+{
+  private:
+    inline static std::filesystem::path s_directory;
+
+    static std::filesystem::path filename(std::string_view code);
+
+  public:
+    static constexpr std::string_view directoryName = ".luacache";
+    static constexpr std::string_view dotLuac = ".luac";
+    static constexpr auto expireAfter = std::chrono::hours(24 * 30); //!< Remove cache files not used for this period
+
+    //! \brief Set cache directory, an empty path disables the cache
+    //! Cache files which are not used for \ref expireAfter are removed.
+    static void setDirectory(const std::filesystem::path& directory);
+
+    static const std::filesystem::path& directory()
+    {
+      return s_directory;
+    }
+
+    //! \brief Load the chunk for \a code, like luaL_loadbufferx
+    //! Uses the cached bytecode if available, else compiles \a code and adds it to the cache.
+    static int load(lua_State* L, std::string_view code, const char* chunkname);
+};
+
+}
+
+#endif
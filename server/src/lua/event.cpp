@@ -92,6 +92,11 @@ int Event::__index(lua_State* L)
     push(L, event);
     lua_pushcclosure(L, connect, 1);
   }
+  else if(name == "connect_batched")
+  {
+    push(L, event);
+    lua_pushcclosure(L, connectBatched, 1);
+  }
   else if(name == "disconnect")
   {
     push(L, event);
@@ -106,11 +111,7 @@ int Event::__index(lua_State* L)
 int Event::__call(lua_State* L)
 {
   checkArguments(L, 2, 3);
-  auto& event = check(L, 1);
-  auto handler = std::make_shared<EventHandler>(event, L, 2);
-  event.connect(handler);
-  lua_pushinteger(L, Sandbox::getStateData(L).registerEventHandler(handler));
-  return 1;
+  return connectHandler(L, check(L, 1), 2, false);
 }
 
 int Event::__gc(lua_State* L)
@@ -122,12 +123,35 @@ int Event::__gc(lua_State* L)
 int Event::connect(lua_State* L)
 {
   checkArguments(L, 1, 2);
+  return connectHandler(L, check(L, lua_upvalueindex(1)), 1, false);
+}
 
-  auto& event = check(L, lua_upvalueindex(1));
-  auto handler = std::make_shared<EventHandler>(event, L);
-  event.connect(handler);
-  lua_pushinteger(L, Sandbox::getStateData(L).registerEventHandler(handler));
+int Event::connectBatched(lua_State* L)
+{
+  checkArguments(L, 1, 2);
+  return connectHandler(L, check(L, lua_upvalueindex(1)), 1, true);
+}
+
+int Event::connectHandler(lua_State* L, AbstractEvent& event, int functionIndex, bool batched)
+{
+  auto& stateData = Sandbox::getStateData(L);
+  const auto key = stateData.nextEventHandlerKey(event);
 
+  // hot-reload: keep the handler connected, only swap the function:
+  lua_Integer id = 0;
+  if(key)
+  {
+    if(auto handler = stateData.reuseEventHandler(*key, batched, id))
+    {
+      handler->setFunction(functionIndex);
+      lua_pushinteger(L, id);
+      return 1;
+    }
+  }
+
+  auto handler = std::make_shared<EventHandler>(event, L, functionIndex, batched);
+  event.connect(handler);
+  lua_pushinteger(L, stateData.registerEventHandler(handler, key));
   return 1;
 }
 
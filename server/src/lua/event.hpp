@@ -36,7 +36,9 @@ class Event
     static int __call(lua_State* L);
     static int __gc(lua_State* L);
     static int connect(lua_State* L);
+    static int connectBatched(lua_State* L);
     static int disconnect(lua_State* L);
+    static int connectHandler(lua_State* L, AbstractEvent& event, int functionIndex, bool batched);
 
   public:
     static constexpr char const* metaTableName = "event";
@@ -26,29 +26,20 @@
 #include "to.hpp"
 #include "script.hpp"
 #include "../core/abstractevent.hpp"
+#include "../core/eventloop.hpp"
 #include "../core/object.hpp"
 #include "../log/log.hpp"
 
 namespace Lua {
 
-EventHandler::EventHandler(AbstractEvent& evt, lua_State* L, int functionIndex)
+EventHandler::EventHandler(AbstractEvent& evt, lua_State* L, int functionIndex, bool batched)
   : AbstractEventHandler(evt)
   , m_L{L}
   , m_function{LUA_NOREF}
   , m_userData{LUA_NOREF}
+  , m_batched{batched}
 {
-  luaL_checktype(L, functionIndex, LUA_TFUNCTION);
-
-  // add function to registry:
-  lua_pushvalue(L, functionIndex);
-  m_function = luaL_ref(m_L, LUA_REGISTRYINDEX);
-
-  // add userdata to registry (if available):
-  if(!lua_isnoneornil(L, functionIndex + 1))
-  {
-    lua_pushvalue(L, functionIndex + 1);
-    m_userData = luaL_ref(m_L, LUA_REGISTRYINDEX);;
-  }
+  addToRegistry(functionIndex);
 }
 
 EventHandler::~EventHandler()
@@ -56,16 +47,35 @@ EventHandler::~EventHandler()
   release();
 }
 
-void EventHandler::execute(const Arguments& args)
+void EventHandler::setFunction(int functionIndex)
 {
-  const auto argumentTypeInfo = m_event.argumentTypeInfo();
-  assert(args.size() == argumentTypeInfo.size());
+  assert(m_L);
+  luaL_checktype(m_L, functionIndex, LUA_TFUNCTION);
+  luaL_unref(m_L, LUA_REGISTRYINDEX, m_function);
+  luaL_unref(m_L, LUA_REGISTRYINDEX, m_userData);
+  m_userData = LUA_NOREF;
+  addToRegistry(functionIndex);
+}
 
-  if(args.size() != argumentTypeInfo.size())
-    return;
+void EventHandler::addToRegistry(int functionIndex)
+{
+  luaL_checktype(m_L, functionIndex, LUA_TFUNCTION);
 
-  lua_rawgeti(m_L, LUA_REGISTRYINDEX, m_function);
+  // add function to registry:
+  lua_pushvalue(m_L, functionIndex);
+  m_function = luaL_ref(m_L, LUA_REGISTRYINDEX);
+
+  // add userdata to registry (if available):
+  if(!lua_isnoneornil(m_L, functionIndex + 1))
+  {
+    lua_pushvalue(m_L, functionIndex + 1);
+    m_userData = luaL_ref(m_L, LUA_REGISTRYINDEX);
+  }
+}
 
+void EventHandler::pushArguments(const Arguments& args)
+{
+  const auto argumentTypeInfo = m_event.argumentTypeInfo();
   const size_t nargs = args.size();
   for(size_t i = 0; i < nargs; i++)
   {
@@ -108,10 +118,74 @@ void EventHandler::execute(const Arguments& args)
         break;
     }
   }
+}
+
+void EventHandler::execute(const Arguments& args)
+{
+  assert(args.size() == m_event.argumentTypeInfo().size());
+
+  if(args.size() != m_event.argumentTypeInfo().size())
+    return;
+
+  if(m_batched)
+  {
+    m_queue.emplace_back(args);
+    if(m_queue.size() == 1) // first queued event, schedule delivery
+    {
+      EventLoop::call(
+        [weak = std::weak_ptr<AbstractEventHandler>(shared_from_this())]()
+        {
+          if(auto handler = std::static_pointer_cast<EventHandler>(weak.lock()))
+            handler->executeBatch();
+        });
+    }
+    return;
+  }
+
+  lua_rawgeti(m_L, LUA_REGISTRYINDEX, m_function);
+  pushArguments(args);
+  lua_rawgeti(m_L, LUA_REGISTRYINDEX, m_userData);
+  call(static_cast<int>(args.size()) + 1);
+}
+
+void EventHandler::executeBatch()
+{
+  std::vector<Arguments> queue;
+  std::swap(queue, m_queue);
+
+  if(!m_L || queue.empty()) // disconnected
+    return;
+
+  lua_rawgeti(m_L, LUA_REGISTRYINDEX, m_function);
+
+  // array of events, each event is an array of its arguments:
+  lua_createtable(m_L, static_cast<int>(queue.size()), 0);
+  lua_Integer n = 1;
+  for(const auto& args : queue)
+  {
+    lua_createtable(m_L, static_cast<int>(args.size()), 0);
+    const int top = lua_gettop(m_L);
+    pushArguments(args);
+    for(int i = lua_gettop(m_L) - top; i > 0; i--)
+      lua_rawseti(m_L, top, i); // pops value
+    lua_rawseti(m_L, -2, n++);
+  }
 
   lua_rawgeti(m_L, LUA_REGISTRYINDEX, m_userData);
+  call(2);
+}
+
+void EventHandler::call(int nargs)
+{
+  Profiler* profiler = Sandbox::getStateData(m_L).profiler.get();
+  const auto start = profiler ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point{};
+
+  const int r = Sandbox::pcall(m_L, nargs, 0, 0);
+
+  if(profiler)
+    profiler->handlerExecuted(m_event.object().getObjectId().append(".").append(m_event.name()), std::chrono::steady_clock::now() - start);
 
-  if(Sandbox::pcall(m_L, args.size() + 1, 0, 0) != LUA_OK)
+  if(r != LUA_OK)
   {
     Log::log(
       Sandbox::getStateData(m_L).script().id,
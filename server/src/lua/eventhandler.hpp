@@ -23,6 +23,7 @@
 #ifndef TRAINTASTIC_SERVER_LUA_EVENTHANDLER_HPP
 #define TRAINTASTIC_SERVER_LUA_EVENTHANDLER_HPP
 
+#include <vector>
 #include <lua.hpp>
 #include "../core/abstracteventhandler.hpp"
 
@@ -34,13 +35,28 @@ class EventHandler final : public AbstractEventHandler
     lua_State* m_L;
     int m_function;
     int m_userData;
+    const bool m_batched;
+    std::vector<Arguments> m_queue; //!< events queued for batched delivery
 
     void release();
+    void addToRegistry(int functionIndex);
+    void pushArguments(const Arguments& args);
+    void executeBatch();
+    void call(int nargs);
 
   public:
-    EventHandler(AbstractEvent& evt, lua_State* L, int functionIndex = 1);
+    /**
+     * \param[in] batched If \c true events are queued and delivered in the next event loop iteration,
+     *                    the function is called once with an array of events, each event is an array of its arguments.
+     */
+    EventHandler(AbstractEvent& evt, lua_State* L, int functionIndex = 1, bool batched = false);
     ~EventHandler() final;
 
+    inline bool batched() const { return m_batched; }
+
+    //! \brief Replace handler function and userdata, used by hot-reload so the handler stays connected
+    void setFunction(int functionIndex);
+
     void execute(const Arguments& args) final;
 
     bool disconnect() final;
@@ -24,6 +24,7 @@
 #include "readonlytable.hpp"
 #include "sandbox.hpp"
 #include "script.hpp"
+#include "worker.hpp"
 #include "test.hpp"
 #include "method.hpp"
 #include "event.hpp"
@@ -104,7 +105,10 @@ int Log::log(lua_State* L, LogMessage code)
       message += luaL_checkstring(L, i);
   }
 
-  ::Log::log(Sandbox::getStateData(L).script(), code, message);
+  if(auto* worker = Sandbox::getStateData(L).worker) // called by the worker thread
+    worker->log(code, std::move(message));
+  else
+    ::Log::log(Sandbox::getStateData(L).script(), code, message);
 
   return 0;
 }
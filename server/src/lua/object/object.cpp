@@ -35,6 +35,36 @@
 
 namespace Lua::Object {
 
+static void getCache(lua_State* L)
+{
+  if(lua_getuservalue(L, 1) != LUA_TTABLE)
+  {
+    lua_pop(L, 1); // remove nil
+    lua_newtable(L);
+    lua_pushvalue(L, -1);
+    lua_setuservalue(L, 1);
+  }
+}
+
+//! \brief Cache the value on top of the stack for key at index 2, value is left on the stack
+static void addToCache(lua_State* L)
+{
+  getCache(L);
+  lua_pushvalue(L, 2); // key
+  lua_pushvalue(L, -3); // value
+  lua_rawset(L, -3);
+  lua_pop(L, 1); // remove cache table
+}
+
+static void addToCache(lua_State* L, AbstractProperty* property)
+{
+  getCache(L);
+  lua_pushvalue(L, 2); // key
+  lua_pushlightuserdata(L, property);
+  lua_rawset(L, -3);
+  lua_pop(L, 1); // remove cache table
+}
+
 void Object::registerType(lua_State* L)
 {
   luaL_newmetatable(L, metaTableName);
@@ -47,8 +77,80 @@ void Object::registerType(lua_State* L)
   lua_pop(L, 1);
 }
 
+static void pushProperty(lua_State* L, AbstractProperty& property)
+{
+  switch(property.type())
+  {
+    case ValueType::Boolean:
+      Lua::push(L, property.toBool());
+      break;
+
+    case ValueType::Enum:
+      // EnumName<T>::value assigned to the std::string_view is NUL terminated,
+      // so it can be used as const char* however it is a bit tricky :)
+      assert(*(property.enumName().data() + property.enumName().size()) == '\0');
+      pushEnum(L, property.enumName().data(), static_cast<lua_Integer>(property.toInt64()));
+      break;
+
+    case ValueType::Integer:
+      Lua::push(L, property.toInt64());
+      break;
+
+    case ValueType::Float:
+      Lua::push(L, property.toDouble());
+      break;
+
+    case ValueType::String:
+      Lua::push(L, property.toString());
+      break;
+
+    case ValueType::Object:
+      push(L, property.toObject());
+      break;
+
+    case ValueType::Set:
+      // set_name<T>::value assigned to the std::string_view is NUL terminated,
+      // so it can be used as const char* however it is a bit tricky :)
+      assert(*(property.setName().data() + property.setName().size()) == '\0');
+      pushSet(L, property.setName().data(), static_cast<lua_Integer>(property.toInt64()));
+      break;
+
+    default:
+      assert(false);
+      lua_pushnil(L);
+      break;
+  }
+}
+
 int Object::index(lua_State* L, ::Object& object)
 {
+  // Resolved interface items are cached in a table stored as user value of the object userdata,
+  // Lua strings are interned so a lookup is just a pointer hash instead of converting the key,
+  // a getItem() lookup and several dynamic_casts. Interface items are never removed from an
+  // object, so cache entries stay valid as long as the object lives.
+  //   property -> light userdata pointing to the AbstractProperty, value is read on each access
+  //   vector property, method, event -> the Lua value itself, they are stateless wrappers
+  const bool cacheable = lua_type(L, 2) == LUA_TSTRING;
+  if(cacheable && lua_getuservalue(L, 1) == LUA_TTABLE)
+  {
+    lua_pushvalue(L, 2);
+    switch(lua_rawget(L, -2))
+    {
+      case LUA_TNIL:
+        lua_pop(L, 2); // remove nil and cache table
+        break;
+
+      case LUA_TLIGHTUSERDATA:
+        pushProperty(L, *static_cast<AbstractProperty*>(lua_touserdata(L, -1)));
+        return 1;
+
+      default:
+        return 1;
+    }
+  }
+  else if(cacheable)
+    lua_pop(L, 1); // remove uservalue
+
   const auto key = to<std::string_view>(L, 2);
 
   if(InterfaceItem* item = object.getItem(key))
@@ -57,47 +159,9 @@ int Object::index(lua_State* L, ::Object& object)
     {
       if(property->isScriptReadable())
       {
-        switch(property->type())
-        {
-          case ValueType::Boolean:
-            Lua::push(L, property->toBool());
-            break;
-
-          case ValueType::Enum:
-            // EnumName<T>::value assigned to the std::string_view is NUL terminated,
-            // so it can be used as const char* however it is a bit tricky :)
-            assert(*(property->enumName().data() + property->enumName().size()) == '\0');
-            pushEnum(L, property->enumName().data(), static_cast<lua_Integer>(property->toInt64()));
-            break;
-
-          case ValueType::Integer:
-            Lua::push(L, property->toInt64());
-            break;
-
-          case ValueType::Float:
-            Lua::push(L, property->toDouble());
-            break;
-
-          case ValueType::String:
-            Lua::push(L, property->toString());
-            break;
-
-          case ValueType::Object:
-            push(L, property->toObject());
-            break;
-
-          case ValueType::Set:
-            // set_name<T>::value assigned to the std::string_view is NUL terminated,
-            // so it can be used as const char* however it is a bit tricky :)
-            assert(*(property->setName().data() + property->setName().size()) == '\0');
-            pushSet(L, property->setName().data(), static_cast<lua_Integer>(property->toInt64()));
-            break;
-
-          default:
-            assert(false);
-            lua_pushnil(L);
-            break;
-        }
+        if(cacheable)
+          addToCache(L, property);
+        pushProperty(L, *property);
       }
       else
         lua_pushnil(L);
@@ -105,21 +169,33 @@ int Object::index(lua_State* L, ::Object& object)
     else if(auto* vectorProperty = dynamic_cast<AbstractVectorProperty*>(item))
     {
       if(vectorProperty->isScriptReadable())
+      {
         VectorProperty::push(L, *vectorProperty);
+        if(cacheable)
+          addToCache(L);
+      }
       else
         lua_pushnil(L);
     }
     else if(AbstractMethod* method = dynamic_cast<AbstractMethod*>(item))
     {
       if(method->isScriptCallable())
+      {
         Method::push(L, *method);
+        if(cacheable)
+          addToCache(L);
+      }
       else
         lua_pushnil(L);
     }
     else if(auto* event = dynamic_cast<AbstractEvent*>(item))
     {
       if(event->isScriptable())
+      {
         Event::push(L, *event);
+        if(cacheable)
+          addToCache(L);
+      }
       else
         lua_pushnil(L);
     }
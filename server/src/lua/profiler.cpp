@@ -0,0 +1,85 @@
+/**
+ * server/src/lua/profiler.cpp
+ *
+ * This file is part of the traintastic source code.
+ *
+ * Copyright (C) 2024 Reinder Feenstra
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "profiler.hpp"
+#include <algorithm>
+#include <vector>
+#include <cstdio>
+
+namespace Lua {
+
+static long long toMicroseconds(std::chrono::steady_clock::duration duration)
+{
+  return static_cast<long long>(std::chrono::duration_cast<std::chrono::microseconds>(duration).count());
+}
+
+void Profiler::sample(lua_State* L, lua_Debug* ar, std::chrono::steady_clock::time_point now)
+{
+  if(lua_getinfo(L, "l", ar) && ar->currentline > 0)
+  {
+    auto& line = m_lines[ar->currentline];
+    line.samples++;
+    line.total += now - m_lastSample;
+  }
+  m_lastSample = now;
+}
+
+void Profiler::handlerExecuted(const std::string& name, std::chrono::steady_clock::duration duration)
+{
+  auto& handler = m_handlers[name];
+  handler.calls++;
+  handler.total += duration;
+  handler.max = std::max(handler.max, duration);
+}
+
+std::string Profiler::report(size_t maxLines) const
+{
+  std::string s;
+  char buffer[256];
+
+  s.append("event handler: calls, total (us), max (us)\n");
+  for(const auto& [name, handler] : m_handlers)
+  {
+    snprintf(buffer, sizeof(buffer), ": %llu, %lld, %lld\n", static_cast<unsigned long long>(handler.calls), toMicroseconds(handler.total), toMicroseconds(handler.max));
+    s.append(name).append(buffer);
+  }
+
+  std::vector<std::pair<int, LineStats>> lines{m_lines.begin(), m_lines.end()};
+  std::sort(lines.begin(), lines.end(),
+    [](const auto& a, const auto& b)
+    {
+      return a.second.total > b.second.total;
+    });
+  if(lines.size() > maxLines)
+    lines.resize(maxLines);
+
+  s.append("\nline: samples, time (us)\n");
+  for(const auto& [line, stats] : lines)
+  {
+    snprintf(buffer, sizeof(buffer), "%d: %llu, %lld\n", line, static_cast<unsigned long long>(stats.samples), toMicroseconds(stats.total));
+    s.append(buffer);
+  }
+
+  return s;
+}
+
+}
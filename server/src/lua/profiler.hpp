@@ -0,0 +1,81 @@
+/**
+ * server/src/lua/profiler.hpp
+ *
+ * This file is part of the traintastic source code.
+ *
+ * Copyright (C) 2024 Reinder Feenstra
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef TRAINTASTIC_SERVER_LUA_PROFILER_HPP
+#define TRAINTASTIC_SERVER_LUA_PROFILER_HPP
+
+#include <chrono>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <lua.hpp>
+
+namespace Lua {
+
+/**
+ * \brief Script profiler
+ *
+ * Collects per event handler statistics and attributes execution time to source lines using a sampling hook.
+ */
+class Profiler
+{
+  public:
+    static constexpr int sampleInstructionCount = 100; //!< Hook interval when profiling
+
+    struct HandlerStats
+    {
+      uint64_t calls = 0;
+      std::chrono::steady_clock::duration total{0};
+      std::chrono::steady_clock::duration max{0};
+    };
+
+    struct LineStats
+    {
+      uint64_t samples = 0;
+      std::chrono::steady_clock::duration total{0};
+    };
+
+  private:
+    std::map<std::string, HandlerStats> m_handlers;
+    std::unordered_map<int, LineStats> m_lines;
+    std::chrono::steady_clock::time_point m_lastSample;
+
+  public:
+    //! \brief Must be called when execution starts, to start sample timing
+    inline void start(std::chrono::steady_clock::time_point now)
+    {
+      m_lastSample = now;
+    }
+
+    void sample(lua_State* L, lua_Debug* ar, std::chrono::steady_clock::time_point now);
+    void handlerExecuted(const std::string& name, std::chrono::steady_clock::duration duration);
+
+    const std::map<std::string, HandlerStats>& handlers() const { return m_handlers; }
+    const std::unordered_map<int, LineStats>& lines() const { return m_lines; }
+
+    //! \brief Human readable profile report
+    std::string report(size_t maxLines = 20) const;
+};
+
+}
+
+#endif
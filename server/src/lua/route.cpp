@@ -0,0 +1,112 @@
+/**
+ * server/src/lua/route.cpp
+ *
+ * This file is part of the traintastic source code.
+ *
+ * Copyright (C) 2024 Reinder Feenstra
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+#include "route.hpp"
+#include "check.hpp"
+#include "push.hpp"
+#include "readonlytable.hpp"
+#include "sandbox.hpp"
+#include "script.hpp"
+#include "../board/boardlist.hpp"
+#include "../board/map/blockpath.hpp"
+#include "../board/map/routegraph.hpp"
+#include "../board/tile/rail/blockrailtile.hpp"
+#include "../world/world.hpp"
+
+namespace Lua {
+
+static void pushRoute(lua_State* L, const std::shared_ptr<BlockRailTile>& from, const RouteGraph::Route& route)
+{
+  lua_createtable(L, 0, 4);
+
+  lua_createtable(L, static_cast<int>(route.paths.size() + 1), 0);
+  push(L, from);
+  lua_rawseti(L, -2, 1);
+  lua_Integer n = 2;
+  for(const auto& path : route.paths)
+  {
+    push(L, path->toBlock());
+    lua_rawseti(L, -2, n++);
+  }
+  lua_setfield(L, -2, "blocks");
+
+  push(L, route.length);
+  lua_setfield(L, -2, "length");
+  push(L, route.turnouts);
+  lua_setfield(L, -2, "turnouts");
+  push(L, route.cost);
+  lua_setfield(L, -2, "cost");
+}
+
+void Route::push(lua_State* L)
+{
+  lua_createtable(L, 0, 2);
+
+  lua_pushcfunction(L, shortest);
+  lua_setfield(L, -2, "shortest");
+  lua_pushcfunction(L, kShortest);
+  lua_setfield(L, -2, "k_shortest");
+
+  ReadOnlyTable::wrap(L, -1);
+}
+
+int Route::shortest(lua_State* L)
+{
+  const auto from = check<BlockRailTile>(L, 1);
+  const auto to = check<BlockRailTile>(L, 2);
+
+  const auto& routeGraph = Sandbox::getStateData(L).script().world().boards->routeGraph();
+  if(const auto route = routeGraph.shortest(*from, *to))
+  {
+    pushRoute(L, from, *route);
+  }
+  else
+  {
+    lua_pushnil(L);
+  }
+  return 1;
+}
+
+int Route::kShortest(lua_State* L)
+{
+  const auto from = check<BlockRailTile>(L, 1);
+  const auto to = check<BlockRailTile>(L, 2);
+  const lua_Integer k = luaL_checkinteger(L, 3);
+  if(k < 1 || k > kMax)
+  {
+    errorArgumentOutOfRange(L, 3);
+  }
+
+  const auto& routeGraph = Sandbox::getStateData(L).script().world().boards->routeGraph();
+  const auto routes = routeGraph.kShortest(*from, *to, static_cast<size_t>(k));
+  lua_createtable(L, static_cast<int>(routes.size()), 0);
+  lua_Integer n = 1;
+  for(const auto& route : routes)
+  {
+    pushRoute(L, from, route);
+    lua_rawseti(L, -2, n++);
+  }
+  return 1;
+}
+
+}
@@ -0,0 +1,51 @@
+/**
+ * server/src/lua/route.hpp
+ *
+ * This file is part of the traintastic source code.
+ *
+ * Copyright (C) 2024 Reinder Feenstra
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+#ifndef TRAINTASTIC_SERVER_LUA_ROUTE_HPP
+#define TRAINTASTIC_SERVER_LUA_ROUTE_HPP
+
+#include <lua.hpp>
+
+namespace Lua {
+
+/**
+ * \brief Lua route library, queries the world route graph
+ *
+ * A route is returned as table with the passed blocks (including from and to block),
+ * the length in tiles, the number of turnouts and the cost used for ordering.
+ */
+class Route
+{
+  private:
+    static constexpr lua_Integer kMax = 16; //!< limits execution time of k_shortest
+
+    static int shortest(lua_State* L);
+    static int kShortest(lua_State* L);
+
+  public:
+    static void push(lua_State* L);
+};
+
+}
+
+#endif
@@ -26,6 +26,7 @@
 #include "event.hpp"
 #include "eventhandler.hpp"
 #include "log.hpp"
+#include "route.hpp"
 #include "class.hpp"
 #include "to.hpp"
 #include "type.hpp"
@@ -35,6 +36,8 @@
 #include "getversion.hpp"
 #include "script.hpp"
 #include "vectorproperty.hpp"
+#include "allocator.hpp"
+#include "worker.hpp"
 #include <version.hpp>
 #include <traintastic/utils/str.hpp>
 #include "../world/world.hpp"
@@ -43,7 +46,7 @@
 #define LUA_SANDBOX "_sandbox"
 #define LUA_SANDBOX_GLOBALS "_sandbox_globals"
 
-constexpr std::array<std::string_view, 23> readOnlyGlobals = {{
+constexpr std::array<std::string_view, 25> readOnlyGlobals = {{
   // Lua baselib:
   "assert",
   "type",
@@ -67,6 +70,8 @@ constexpr std::array<std::string_view, 23> readOnlyGlobals = {{
   // Objects:
   "world",
   "log",
+  "timer",
+  "route",
   // Functions:
   "is_instance",
   // Type info:
@@ -127,8 +132,17 @@ namespace Lua {
 
 void Sandbox::close(lua_State* L)
 {
+  void* allocator = nullptr;
+  lua_getallocf(L, &allocator);
   delete *static_cast<StateData**>(lua_getextraspace(L)); // free state data
   lua_close(L);
+  delete static_cast<Allocator*>(allocator);
+}
+
+int Sandbox::panic(lua_State* L)
+{
+  lua_writestringerror("PANIC: unprotected error in call to Lua API (%s)\n", lua_tostring(L, -1));
+  return 0; // return to Lua to abort
 }
 
 int Sandbox::__index(lua_State* L)
@@ -154,12 +168,19 @@ int Sandbox::__newindex(lua_State* L)
   return 0;
 }
 
-SandboxPtr Sandbox::create(Script& script)
+SandboxPtr Sandbox::create(Script& script, Worker* worker)
 {
-  lua_State* L = luaL_newstate();
+  auto* allocator = new Allocator(script.memoryLimit);
+  lua_State* L = lua_newstate(Allocator::alloc, allocator);
+  if(!L)
+  {
+    delete allocator;
+    return SandboxPtr(nullptr, close);
+  }
+  lua_atpanic(L, panic);
 
   // create state data:
-  *static_cast<StateData**>(lua_getextraspace(L)) = new StateData(script);
+  *static_cast<StateData**>(lua_getextraspace(L)) = new StateData(script, worker);
 
   // register types:
   Enums::registerTypes<LUA_ENUMS>(L);
@@ -218,14 +239,37 @@ SandboxPtr Sandbox::create(Script& script)
   push(L, getVersion());
   lua_setfield(L, -2, "LUA_VERSION");
 
-  // add world:
-  push(L, script.world().shared_from_this());
-  lua_setfield(L, -2, "world");
+  if(worker)
+  {
+    // add command, worker scripts can only modify the world using commands:
+    Worker::pushCommand(L);
+    lua_setfield(L, -2, "command");
+  }
+  else
+  {
+    // add world:
+    push(L, script.world().shared_from_this());
+    lua_setfield(L, -2, "world");
+  }
 
   // add logger:
   Log::push(L);
   lua_setfield(L, -2, "log");
 
+  // add timer:
+  if(!worker) // timers are executed by the event loop
+  {
+    Timers::push(L);
+    lua_setfield(L, -2, "timer");
+  }
+
+  // add route:
+  if(!worker) // worker scripts can't access the world
+  {
+    Route::push(L);
+    lua_setfield(L, -2, "route");
+  }
+
   // add class types:
   lua_newtable(L);
   Class::registerValues(L);
@@ -258,6 +302,13 @@ Sandbox::StateData& Sandbox::getStateData(lua_State* L)
   return **static_cast<StateData**>(lua_getextraspace(L));
 }
 
+Allocator& Sandbox::getAllocator(lua_State* L)
+{
+  void* allocator = nullptr;
+  lua_getallocf(L, &allocator);
+  return *static_cast<Allocator*>(allocator);
+}
+
 int Sandbox::getGlobal(lua_State* L, const char* name)
 {
   lua_getglobal(L, LUA_SANDBOX_GLOBALS); // get the sandbox
@@ -298,14 +349,17 @@ int Sandbox::pcall(lua_State* L, int nargs, int nresults, int errfunc)
     auto& stateData = getStateData(L);
     stateData.pcallStart = std::chrono::steady_clock::now();
     stateData.pcallExecutionTimeViolation = false;
-    lua_sethook(L, hook, LUA_MASKCOUNT, 1000);
+    if(stateData.profiler)
+      stateData.profiler->start(stateData.pcallStart);
+    lua_sethook(L, hook, LUA_MASKCOUNT, stateData.profiler ? Profiler::sampleInstructionCount : hookInstructionCount);
+    getAllocator(L).setLimitEnabled(true);
   }
 
   const int r = lua_pcall(L, nargs, nresults, errfunc);
 
   if(firstCall)
   {
-    if(!getStateData(L).pcallExecutionTimeViolation)
+    if(!getStateData(L).pcallExecutionTimeViolation && !getStateData(L).worker)
     {
       const auto duration = (std::chrono::steady_clock::now() - getStateData(L).pcallStart);
       if(duration >= pcallDurationWarning)
@@ -314,20 +368,121 @@ int Sandbox::pcall(lua_State* L, int nargs, int nresults, int errfunc)
       }
     }
     lua_sethook(L, nullptr, 0, 0);
+    getAllocator(L).setLimitEnabled(false);
   }
 
+  if(r == LUA_ERRMEM && getAllocator(L).limitExceeded() && !getStateData(L).worker) // worker handles it itself
+    getStateData(L).script().memoryLimitExceeded();
+
   return r;
 }
 
-void Sandbox::hook(lua_State* L, lua_Debug* /*ar*/)
+void Sandbox::hook(lua_State* L, lua_Debug* ar)
 {
-  if((std::chrono::steady_clock::now() - getStateData(L).pcallStart) > pcallDurationMax)
+  auto& stateData = getStateData(L);
+  const auto now = std::chrono::steady_clock::now();
+
+  if(stateData.profiler)
+    stateData.profiler->sample(L, ar, now);
+
+  if(stateData.abort)
+    luaL_error(L, "Script stopped.");
+
+  if((now - stateData.pcallStart) > (stateData.worker ? workerPcallDurationMax : pcallDurationMax))
   {
-    getStateData(L).pcallExecutionTimeViolation = true;
+    stateData.pcallExecutionTimeViolation = true;
     luaL_error(L, "Exceeded maximum execution time.");
   }
 }
 
+void Sandbox::StateData::beginChunk(bool reload)
+{
+  assert(!m_executingChunk);
+  m_executingChunk = true;
+  m_chunkConnectCount.clear();
+  m_chunkTimerCount = {};
+  if(reload)
+  {
+    m_reloadEventHandlers = std::move(m_chunkEventHandlers);
+    m_reloadTimers = std::move(m_chunkTimers);
+  }
+  m_chunkEventHandlers.clear();
+  m_chunkTimers.clear();
+}
+
+void Sandbox::StateData::endChunk(bool success)
+{
+  assert(m_executingChunk);
+  m_executingChunk = false;
+  m_chunkConnectCount.clear();
+
+  if(success)
+  {
+    // handlers not reused are removed from the script:
+    for(const auto& it : m_reloadEventHandlers)
+      if(auto handler = getEventHandler(it.second))
+        handler->disconnect();
+
+    // timers not reused are cancelled:
+    if(timers)
+      for(const auto& it : m_reloadTimers)
+        timers->remove(it.second);
+  }
+  else
+  {
+    // keep previous handlers and timers, so they can be reused by the next reload:
+    m_chunkEventHandlers.merge(m_reloadEventHandlers);
+    m_chunkTimers.merge(m_reloadTimers);
+  }
+  m_reloadEventHandlers.clear();
+  m_reloadTimers.clear();
+}
+
+std::optional<Sandbox::StateData::EventHandlerKey> Sandbox::StateData::nextEventHandlerKey(const AbstractEvent& event)
+{
+  if(!m_executingChunk)
+    return std::nullopt;
+  return EventHandlerKey{&event, m_chunkConnectCount[&event]++};
+}
+
+std::shared_ptr<EventHandler> Sandbox::StateData::reuseEventHandler(const EventHandlerKey& key, bool batched, lua_Integer& id)
+{
+  auto it = m_reloadEventHandlers.find(key);
+  if(it == m_reloadEventHandlers.end())
+    return {};
+
+  auto handler = getEventHandler(it->second);
+  if(!handler || &handler->event() != key.first || handler->batched() != batched)
+    return {}; // not connected anymore or changed to/from batched, it will be disconnected by endChunk
+
+  id = it->second;
+  m_reloadEventHandlers.erase(it);
+  m_chunkEventHandlers.emplace(key, id);
+  return handler;
+}
+
+std::optional<Sandbox::StateData::TimerKey> Sandbox::StateData::nextTimerKey(bool periodic)
+{
+  if(!m_executingChunk)
+    return std::nullopt;
+  return TimerKey{periodic, m_chunkTimerCount[periodic ? 1 : 0]++};
+}
+
+std::optional<lua_Integer> Sandbox::StateData::reuseTimer(const TimerKey& key)
+{
+  auto it = m_reloadTimers.find(key);
+  if(it == m_reloadTimers.end())
+    return std::nullopt;
+
+  const lua_Integer id = it->second;
+  m_reloadTimers.erase(it);
+  if(!timers || !timers->contains(id))
+    return std::nullopt; // cancelled or expired (one-shot)
+
+  m_chunkTimers.emplace(key, id);
+  return id;
+}
+
 Sandbox::StateData::~StateData()
 {
   while(!m_eventHandlers.empty())
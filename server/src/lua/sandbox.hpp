@@ -24,14 +24,20 @@
 #define TRAINTASTIC_SERVER_LUA_SANDBOX_HPP
 
 #include <memory>
+#include <array>
 #include <map>
 #include <set>
+#include <optional>
 #include <algorithm>
 #include <limits>
 #include <chrono>
+#include <atomic>
 #include <cassert>
 #include <lua.hpp>
+#include "profiler.hpp"
+#include "timers.hpp"
 
+class AbstractEvent;
 class OutputController;
 class Output;
 
@@ -39,6 +45,8 @@ namespace Lua {
 
 class Script;
 class EventHandler;
+class Allocator;
+class Worker;
 
 using SandboxPtr = std::unique_ptr<lua_State, void(*)(lua_State*)>;
 
@@ -47,8 +55,11 @@ class Sandbox
   private:
     static constexpr auto pcallDurationMax = std::chrono::milliseconds(10); //!< Execution time limit
     static constexpr auto pcallDurationWarning = pcallDurationMax / 2; //!< Execution time warning level
+    static constexpr auto workerPcallDurationMax = std::chrono::seconds(1); //!< Execution time limit for worker scripts
+    static constexpr int hookInstructionCount = 1000; //!< Execution time check interval
 
     static void close(lua_State* L);
+    static int panic(lua_State* L);
     static int __index(lua_State* L);
     static int __newindex(lua_State* L);
 
@@ -57,10 +68,23 @@ class Sandbox
   public:
     class StateData
     {
+      public:
+        //! \brief Identifies a handler connected by the script chunk: the event and the connect order for that event
+        using EventHandlerKey = std::pair<const AbstractEvent*, uint32_t>;
+        //! \brief Identifies a timer added by the script chunk: periodic or not and the add order for that kind
+        using TimerKey = std::pair<bool, uint32_t>;
+
       private:
         Script& m_script;
         lua_Integer m_eventHandlerId;
         std::map<lua_Integer, std::shared_ptr<EventHandler>> m_eventHandlers;
+        bool m_executingChunk = false;
+        std::map<const AbstractEvent*, uint32_t> m_chunkConnectCount;
+        std::map<EventHandlerKey, lua_Integer> m_chunkEventHandlers; //!< handlers connected by the last chunk execution
+        std::map<EventHandlerKey, lua_Integer> m_reloadEventHandlers; //!< handlers of the previous chunk execution, not (yet) reused
+        std::array<uint32_t, 2> m_chunkTimerCount = {};
+        std::map<TimerKey, lua_Integer> m_chunkTimers; //!< timers added by the last chunk execution
+        std::map<TimerKey, lua_Integer> m_reloadTimers; //!< timers of the previous chunk execution, not (yet) reused
         std::map<
           std::weak_ptr<OutputController>,
           std::set<std::weak_ptr<Output>, std::owner_less<std::weak_ptr<Output>>>,
@@ -70,10 +94,15 @@ class Sandbox
       public:
         std::chrono::time_point<std::chrono::steady_clock> pcallStart;
         bool pcallExecutionTimeViolation;
+        std::unique_ptr<Profiler> profiler; //!< only set when profiling is enabled
+        std::unique_ptr<Timers> timers; //!< created when the first timer is added
+        Worker* const worker; //!< only set for worker scripts, they run on their own thread
+        std::atomic_bool abort = false; //!< abort the running pcall, can be set from any thread
 
-        StateData(Script& script)
+        StateData(Script& script, Worker* worker_)
           : m_script{script}
           , m_eventHandlerId{1}
+          , worker{worker_}
         {
         }
 
@@ -93,7 +122,42 @@ class Sandbox
             return std::shared_ptr<EventHandler>();
         }
 
-        inline lua_Integer registerEventHandler(std::shared_ptr<EventHandler> handler)
+        //! \brief Call before executing the script chunk, if \a reload is \c true handlers and timers of the previous execution can be reused
+        void beginChunk(bool reload);
+        //! \brief Call after executing the script chunk, after a successful reload handlers and timers that weren't reused are removed
+        void endChunk(bool success);
+
+        /**
+         * \brief Get key for the next handler connected to \a event
+         * \return Key if the script chunk is being executed, \c nullopt otherwise
+         */
+        std::optional<EventHandlerKey> nextEventHandlerKey(const AbstractEvent& event);
+
+        /**
+         * \brief Reuse handler connected at the same place by the previous chunk execution, only while reloading
+         * \param[out] id Handler id
+         * \return Handler or \c nullptr if there is no handler to reuse
+         */
+        std::shared_ptr<EventHandler> reuseEventHandler(const EventHandlerKey& key, bool batched, lua_Integer& id);
+
+        /**
+         * \brief Get key for the next timer added
+         * \return Key if the script chunk is being executed, \c nullopt otherwise
+         */
+        std::optional<TimerKey> nextTimerKey(bool periodic);
+
+        /**
+         * \brief Reuse timer added at the same place by the previous chunk execution, only while reloading
+         * \return Timer id or \c nullopt if there is no timer to reuse
+         */
+        std::optional<lua_Integer> reuseTimer(const TimerKey& key);
+
+        inline void registerTimer(const TimerKey& key, lua_Integer id)
+        {
+          m_chunkTimers.emplace(key, id);
+        }
+
+        inline lua_Integer registerEventHandler(std::shared_ptr<EventHandler> handler, const std::optional<EventHandlerKey>& key = std::nullopt)
         {
           while(m_eventHandlers.find(m_eventHandlerId) != m_eventHandlers.end())
           {
@@ -105,6 +169,8 @@ class Sandbox
           const lua_Integer id = m_eventHandlerId;
           m_eventHandlerId++;
           m_eventHandlers.emplace(id, std::move(handler));
+          if(key)
+            m_chunkEventHandlers.emplace(*key, id);
           return id;
         }
 
@@ -126,8 +192,9 @@ class Sandbox
         }
     };
 
-    static SandboxPtr create(Script& script);
+    static SandboxPtr create(Script& script, Worker* worker = nullptr);
     static StateData& getStateData(lua_State* L);
+    static Allocator& getAllocator(lua_State* L);
     static int getGlobal(lua_State* L, const char* name);
     static int pcall(lua_State* L, int nargs = 0, int nresults = 0, int errfunc = 0);
 };
@@ -24,6 +24,10 @@
 #include "scriptlist.hpp"
 #include "scriptlisttablemodel.hpp"
 #include "push.hpp"
+#include "allocator.hpp"
+#include "bytecodecache.hpp"
+#include "worker.hpp"
+#include "../core/eventloop.hpp"
 #include "../world/world.hpp"
 #include "../enum/worldevent.hpp"
 #include "../set/worldstate.hpp"
@@ -43,6 +47,8 @@ constexpr std::string_view dotLua = ".lua";
 Script::Script(World& world, std::string_view _id) :
   IdObject(world, _id),
   m_sandbox{nullptr, nullptr},
+  m_statsTimer{EventLoop::ioContext},
+  m_workerTimer{EventLoop::ioContext},
   name{this, "name", std::string(_id), PropertyFlags::ReadWrite | PropertyFlags::Store},
   disabled{this, "disabled", false, PropertyFlags::ReadWrite | PropertyFlags::NoStore | PropertyFlags::NoScript,
     [this](bool value)
@@ -53,6 +59,31 @@ Script::Script(World& world, std::string_view _id) :
   state{this, "state", LuaScriptState::Stopped, PropertyFlags::ReadOnly | PropertyFlags::Store},
   code{this, "code", "", PropertyFlags::ReadWrite | PropertyFlags::NoStore},
   error{this, "error", "", PropertyFlags::ReadOnly | PropertyFlags::NoStore},
+  worker{this, "worker", false, PropertyFlags::ReadWrite | PropertyFlags::Store | PropertyFlags::NoScript,
+    [this](bool value)
+    {
+      Attributes::setVisible(workerInterval, value);
+    }},
+  workerInterval{this, "worker_interval", workerIntervalDefault, PropertyFlags::ReadWrite | PropertyFlags::Store | PropertyFlags::NoScript},
+  profiling{this, "profiling", false, PropertyFlags::ReadWrite | PropertyFlags::NoStore | PropertyFlags::NoScript,
+    [this](bool value)
+    {
+      if(m_sandbox)
+      {
+        auto& stateData = Sandbox::getStateData(m_sandbox.get());
+        if(value)
+          stateData.profiler = std::make_unique<Profiler>();
+        else
+          stateData.profiler.reset();
+        updateStats();
+      }
+      Attributes::setVisible(profile, value);
+    }},
+  profile{this, "profile", "", PropertyFlags::ReadOnly | PropertyFlags::NoStore | PropertyFlags::NoScript},
+  memoryLimit{this, "memory_limit", memoryLimitDefault, PropertyFlags::ReadWrite | PropertyFlags::Store | PropertyFlags::NoScript},
+  memoryUsage{this, "memory_usage", 0, PropertyFlags::ReadOnly | PropertyFlags::NoStore | PropertyFlags::NoScript},
+  memoryPeak{this, "memory_peak", 0, PropertyFlags::ReadOnly | PropertyFlags::NoStore | PropertyFlags::NoScript},
+  memoryAllocations{this, "memory_allocations", 0, PropertyFlags::ReadOnly | PropertyFlags::NoStore | PropertyFlags::NoScript},
   start{*this, "start",
     [this]()
     {
@@ -64,6 +95,12 @@ Script::Script(World& world, std::string_view _id) :
     {
       if(state == LuaScriptState::Running)
         stopSandbox();
+    }},
+  reload{*this, "reload",
+    [this]()
+    {
+      if(state == LuaScriptState::Running)
+        reloadSandbox();
     }}
 {
   Attributes::addDisplayName(name, DisplayName::Object::name);
@@ -76,10 +113,27 @@ Script::Script(World& world, std::string_view _id) :
   Attributes::addEnabled(code, false);
   m_interfaceItems.add(code);
   m_interfaceItems.add(error);
+  Attributes::addEnabled(worker, false);
+  m_interfaceItems.add(worker);
+  Attributes::addEnabled(workerInterval, false);
+  Attributes::addMinMax(workerInterval, workerIntervalMin, workerIntervalMax);
+  Attributes::addVisible(workerInterval, false);
+  m_interfaceItems.add(workerInterval);
+  m_interfaceItems.add(profiling);
+  Attributes::addVisible(profile, false);
+  m_interfaceItems.add(profile);
+  Attributes::addEnabled(memoryLimit, false);
+  Attributes::addMinMax(memoryLimit, memoryLimitMin, memoryLimitMax);
+  m_interfaceItems.add(memoryLimit);
+  m_interfaceItems.add(memoryUsage);
+  m_interfaceItems.add(memoryPeak);
+  m_interfaceItems.add(memoryAllocations);
   Attributes::addEnabled(start, false);
   m_interfaceItems.add(start);
   Attributes::addEnabled(stop, false);
   m_interfaceItems.add(stop);
+  Attributes::addEnabled(reload, false);
+  m_interfaceItems.add(reload);
 
   updateEnabled();
 }
@@ -113,6 +167,8 @@ void Script::addToWorld()
 
 void Script::destroying()
 {
+  m_workerTimer.cancel();
+  m_worker.reset(); // join worker thread, it uses the script for logging
   m_world.luaScripts->removeObject(shared_ptr<Script>());
   IdObject::destroying();
 }
@@ -121,6 +177,8 @@ void Script::loaded()
 {
   IdObject::loaded();
 
+  Attributes::setVisible(workerInterval, worker);
+
   switch(state)
   {
     case LuaScriptState::Error:
@@ -160,10 +218,14 @@ void Script::updateEnabled()
   Attributes::setEnabled(id, editable);
   Attributes::setEnabled(name, editable);
   Attributes::setEnabled(disabled, editable);
-  Attributes::setEnabled(code, editable);
+  Attributes::setEnabled(code, contains(m_world.state.value(), WorldState::Edit)); // can be changed while running, see reload
+  Attributes::setEnabled(worker, editable);
+  Attributes::setEnabled(workerInterval, editable);
+  Attributes::setEnabled(memoryLimit, editable);
 
   Attributes::setEnabled(start, state == LuaScriptState::Stopped || state == LuaScriptState::Error);
   Attributes::setEnabled(stop, state == LuaScriptState::Running);
+  Attributes::setEnabled(reload, state == LuaScriptState::Running);
 }
 
 void Script::setState(LuaScriptState value)
@@ -203,16 +265,29 @@ void Script::setState(LuaScriptState value)
 
 void Script::startSandbox()
 {
-  assert(!m_sandbox);
+  assert(!m_sandbox && !m_worker);
+  if(worker)
+  {
+    startWorker();
+    return;
+  }
+
   if((m_sandbox = Sandbox::create(*this)))
   {
     Log::log(*this, LogMessage::N9001_STARTING_SCRIPT);
     lua_State* L = m_sandbox.get();
-    const int r = luaL_loadbuffer(L, code.value().c_str(), code.value().size(), "=") || Sandbox::pcall(L, 0, LUA_MULTRET);
+    if(profiling)
+      Sandbox::getStateData(L).profiler = std::make_unique<Profiler>();
+    auto& stateData = Sandbox::getStateData(L);
+    stateData.beginChunk(false);
+    const int r = BytecodeCache::load(L, code.value(), "=") || Sandbox::pcall(L, 0, LUA_MULTRET);
+    stateData.endChunk(r == LUA_OK);
     if(r == LUA_OK)
     {
       setState(LuaScriptState::Running);
       error.setValueInternal("");
+      updateStats();
+      startStatsTimer();
     }
     else
     {
@@ -231,10 +306,72 @@ void Script::startSandbox()
   }
 }
 
+void Script::reloadSandbox()
+{
+  assert(state == LuaScriptState::Running);
+
+  if(m_worker) // a worker has no world access, so there is nothing to keep, just restart it
+  {
+    stopSandbox();
+    startSandbox();
+    return;
+  }
+
+  // The chunk is executed again in the same Lua state, so globals and claimed outputs are kept.
+  // Event handlers connected by the chunk are matched by event and connect order, matching handlers
+  // stay connected and only get the new function, handlers no longer connected by the chunk are removed.
+  // Timers added by the chunk are matched the same way by kind (once/periodic) and add order.
+  Log::log(*this, LogMessage::N9002_RELOADING_SCRIPT);
+  lua_State* L = m_sandbox.get();
+  auto& stateData = Sandbox::getStateData(L);
+  const int top = lua_gettop(L);
+  stateData.beginChunk(true);
+  const int r = BytecodeCache::load(L, code.value(), "=") || Sandbox::pcall(L, 0, 0);
+  stateData.endChunk(r == LUA_OK);
+  if(r == LUA_OK)
+  {
+    error.setValueInternal("");
+  }
+  else
+  {
+    // keep running with the previous handlers:
+    error.setValueInternal(lua_tostring(L, -1));
+    Log::log(*this, LogMessage::E9005_RELOADING_SCRIPT_FAILED_X, error.value());
+  }
+  lua_settop(L, top);
+  updateStats();
+}
+
+void Script::startWorker()
+{
+  auto w = std::make_shared<Worker>(*this);
+  if(w->valid())
+  {
+    Log::log(*this, LogMessage::N9001_STARTING_SCRIPT);
+    m_worker = std::move(w);
+    m_worker->start(code.value()); // first snapshot is requested by the worker after running the code
+    setState(LuaScriptState::Running);
+    error.setValueInternal("");
+    updateStats();
+    startStatsTimer();
+    startWorkerTimer();
+  }
+  else
+  {
+    error.setValueInternal("creating lua state failed");
+    setState(LuaScriptState::Error);
+    Log::log(*this, LogMessage::F9001_CREATING_LUA_STATE_FAILED);
+  }
+}
+
 void Script::stopSandbox()
 {
-  assert(m_sandbox);
+  assert(m_sandbox || m_worker);
+  updateStats();
+  m_statsTimer.cancel();
+  m_workerTimer.cancel();
   m_sandbox.reset();
+  m_worker.reset(); // stops and joins the worker thread
   if(state == LuaScriptState::Running)
   {
     setState(LuaScriptState::Stopped);
@@ -242,6 +379,94 @@ void Script::stopSandbox()
   }
 }
 
+void Script::startStatsTimer()
+{
+  m_statsTimer.expires_after(statsUpdateInterval);
+  m_statsTimer.async_wait(
+    [this](const boost::system::error_code& ec)
+    {
+      if(!ec && (m_sandbox || m_worker))
+      {
+        updateStats();
+        startStatsTimer();
+      }
+    });
+}
+
+void Script::startWorkerTimer()
+{
+  m_workerTimer.expires_after(std::chrono::milliseconds(workerInterval.value()));
+  m_workerTimer.async_wait(
+    [this](const boost::system::error_code& ec)
+    {
+      if(!ec && m_worker)
+      {
+        m_worker->update();
+        startWorkerTimer();
+      }
+    });
+}
+
+void Script::workerFailed(const std::string& message, bool memoryLimitExceeded)
+{
+  assert(m_worker);
+  if(memoryLimitExceeded)
+  {
+    Log::log(*this, LogMessage::E9002_EXCEEDED_MEMORY_LIMIT_OF_X_BYTES, memoryLimit.value());
+    error.setValueInternal("exceeded memory limit");
+  }
+  else
+  {
+    Log::log(*this, LogMessage::F9002_RUNNING_SCRIPT_FAILED_X, message);
+    error.setValueInternal(message);
+  }
+  setState(LuaScriptState::Error);
+  stopSandbox();
+}
+
+void Script::updateStats()
+{
+  constexpr size_t max = std::numeric_limits<uint32_t>::max();
+
+  if(m_worker)
+  {
+    memoryUsage.setValueInternal(static_cast<uint32_t>(std::min(m_worker->memoryUsage(), max)));
+    memoryPeak.setValueInternal(static_cast<uint32_t>(std::min(m_worker->memoryPeak(), max)));
+    memoryAllocations.setValueInternal(static_cast<uint32_t>(std::min<uint64_t>(m_worker->memoryAllocations(), max)));
+    return;
+  }
+
+  if(!m_sandbox)
+    return;
+
+  lua_State* L = m_sandbox.get();
+  const auto& allocator = Sandbox::getAllocator(L);
+  memoryUsage.setValueInternal(static_cast<uint32_t>(std::min(allocator.usage(), max)));
+  memoryPeak.setValueInternal(static_cast<uint32_t>(std::min(allocator.peak(), max)));
+  memoryAllocations.setValueInternal(static_cast<uint32_t>(std::min<uint64_t>(allocator.allocations(), max)));
+
+  if(const auto& profiler = Sandbox::getStateData(L).profiler)
+    profile.setValueInternal(profiler->report());
+}
+
+void Script::memoryLimitExceeded()
+{
+  Log::log(*this, LogMessage::E9002_EXCEEDED_MEMORY_LIMIT_OF_X_BYTES, memoryLimit.value());
+
+  // The Lua state can still be in use by the caller, stop it from the event loop.
+  // Don't re-check the allocator there, a later successful allocation clears its limit exceeded flag:
+  EventLoop::call(
+    [weak = std::weak_ptr<Script>(shared_ptr<Script>()), L = m_sandbox.get()]()
+    {
+      if(auto script = weak.lock(); script && script->m_sandbox && script->m_sandbox.get() == L)
+      {
+        script->error.setValueInternal("exceeded memory limit");
+        script->setState(LuaScriptState::Error);
+        script->stopSandbox();
+      }
+    });
+}
+
 bool Script::pcall(lua_State* L, int nargs, int nresults)
 {
   const bool success = Sandbox::pcall(L, nargs, nresults) == LUA_OK;
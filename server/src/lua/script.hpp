@@ -3,7 +3,7 @@
  *
  * This file is part of the traintastic source code.
  *
- * Copyright (C) 2019-2023 Reinder Feenstra
+ * Copyright (C) 2019-2024 Reinder Feenstra
  *
  * This program is free software; you can redistribute it and/or
  * modify it under the terms of the GNU General Public License
@@ -26,17 +26,33 @@
 #include "../core/idobject.hpp"
 #include "../core/method.hpp"
 #include "../enum/luascriptstate.hpp"
+#include <boost/asio/steady_timer.hpp>
 #include "sandbox.hpp"
 
 namespace Lua {
 
+class Worker;
+
 class Script : public IdObject
 {
+  friend class Worker;
+
   private:
     mutable std::string m_basename; //!< filename on disk for script
 
   protected:
+    static constexpr auto statsUpdateInterval = std::chrono::seconds(1);
+    static constexpr uint32_t memoryLimitDefault = 16 * 1024 * 1024;
+    static constexpr uint32_t memoryLimitMin = 1024 * 1024;
+    static constexpr uint32_t memoryLimitMax = 1024 * 1024 * 1024;
+    static constexpr uint32_t workerIntervalDefault = 1000;
+    static constexpr uint32_t workerIntervalMin = 50;
+    static constexpr uint32_t workerIntervalMax = 60000;
+
     SandboxPtr m_sandbox;
+    std::shared_ptr<Worker> m_worker; //!< only set for running worker scripts
+    boost::asio::steady_timer m_statsTimer;
+    boost::asio::steady_timer m_workerTimer;
 
     void load(WorldLoader& loader, const nlohmann::json& data) final;
     void save(WorldSaver& saver, nlohmann::json& data, nlohmann::json& stateData) const final;
@@ -49,7 +65,13 @@ class Script : public IdObject
     void setState(LuaScriptState value);
 
     void startSandbox();
+    void reloadSandbox();
+    void startWorker();
     void stopSandbox();
+    void startStatsTimer();
+    void startWorkerTimer();
+    void workerFailed(const std::string& message, bool memoryLimitExceeded);
+    void updateStats();
     bool pcall(lua_State* L, int nargs = 0, int nresults = 0);
 
   public:
@@ -63,8 +85,20 @@ class Script : public IdObject
     Property<LuaScriptState> state;
     Property<std::string> code;
     Property<std::string> error;
+    Property<bool> worker;
+    Property<uint32_t> workerInterval; //!< Interval between world snapshots in milliseconds
+    Property<bool> profiling;
+    Property<std::string> profile;
+    Property<uint32_t> memoryLimit;
+    Property<uint32_t> memoryUsage;
+    Property<uint32_t> memoryPeak;
+    Property<uint32_t> memoryAllocations;
     ::Method<void()> start;
     ::Method<void()> stop;
+    ::Method<void()> reload; //!< Apply code changes to a running script without stopping it
+
+    //! \brief Called by the sandbox when a pcall failed due to the memory limit, stops the script
+    void memoryLimitExceeded();
 };
 
 }
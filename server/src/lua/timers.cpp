@@ -0,0 +1,233 @@
+/**
+ * server/src/lua/timers.cpp
+ *
+ * This file is part of the traintastic source code.
+ *
+ * Copyright (C) 2024 Reinder Feenstra
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "timers.hpp"
+#include <algorithm>
+#include <limits>
+#include <vector>
+#include "sandbox.hpp"
+#include "script.hpp"
+#include "readonlytable.hpp"
+#include "checkarguments.hpp"
+#include "error.hpp"
+#include "to.hpp"
+#include "../core/eventloop.hpp"
+#include "../log/log.hpp"
+
+namespace Lua {
+
+void Timers::push(lua_State* L)
+{
+  lua_createtable(L, 0, 3);
+
+  lua_pushcfunction(L, once);
+  lua_setfield(L, -2, "once");
+  lua_pushcfunction(L, periodic);
+  lua_setfield(L, -2, "periodic");
+  lua_pushcfunction(L, cancel);
+  lua_setfield(L, -2, "cancel");
+
+  ReadOnlyTable::wrap(L, -1);
+}
+
+Timers::Timers(lua_State* L)
+  : m_L{L}
+  , m_timer{EventLoop::ioContext}
+{
+}
+
+Timers::~Timers()
+{
+  m_timer.cancel();
+  for(const auto& it : m_timers)
+    release(it.second);
+}
+
+void Timers::schedule()
+{
+  if(m_timers.empty())
+  {
+    if(m_armedExpiry != Clock::time_point::max())
+    {
+      m_timer.cancel();
+      m_armedExpiry = Clock::time_point::max();
+    }
+    return;
+  }
+
+  const auto expires = std::min_element(m_timers.begin(), m_timers.end(),
+    [](const auto& a, const auto& b)
+    {
+      return a.second.expires < b.second.expires;
+    })->second.expires;
+
+  if(expires == m_armedExpiry)
+    return; // already armed for it
+
+  m_armedExpiry = expires;
+  m_timer.expires_at(expires); // cancels pending wait
+  m_timer.async_wait(
+    [this](const boost::system::error_code& ec)
+    {
+      if(!ec)
+        expired();
+    });
+}
+
+void Timers::expired()
+{
+  m_armedExpiry = Clock::time_point::max();
+
+  // collect expired timers, earliest first:
+  const auto now = Clock::now();
+  std::vector<std::pair<Clock::time_point, lua_Integer>> due;
+  for(const auto& it : m_timers)
+    if(it.second.expires <= now)
+      due.emplace_back(it.second.expires, it.first);
+  std::sort(due.begin(), due.end());
+
+  for(const auto& [_, id] : due)
+  {
+    auto it = m_timers.find(id);
+    if(it == m_timers.end())
+      continue; // cancelled by a previous callback
+
+    const Entry entry = it->second;
+    if(entry.interval.count() != 0)
+    {
+      // skip missed periods instead of calling the callback in a burst:
+      it->second.expires += entry.interval;
+      if(it->second.expires <= now)
+        it->second.expires = now + entry.interval;
+    }
+    else
+      m_timers.erase(it);
+
+    lua_rawgeti(m_L, LUA_REGISTRYINDEX, entry.function);
+    lua_rawgeti(m_L, LUA_REGISTRYINDEX, entry.userData);
+    if(Sandbox::pcall(m_L, 1, 0, 0) != LUA_OK)
+    {
+      ::Log::log(Sandbox::getStateData(m_L).script().id, LogMessage::E9003_X_DURING_EXECUTION_OF_TIMER_CALLBACK, to<std::string_view>(m_L, -1));
+      lua_pop(m_L, 1); // pop error message from the stack
+    }
+
+    if(entry.interval.count() == 0)
+      release(entry);
+  }
+
+  schedule();
+}
+
+void Timers::release(const Entry& entry)
+{
+  luaL_unref(m_L, LUA_REGISTRYINDEX, entry.function);
+  luaL_unref(m_L, LUA_REGISTRYINDEX, entry.userData);
+}
+
+int Timers::add(lua_State* L, bool periodic)
+{
+  checkArguments(L, 2, 3);
+
+  const lua_Integer ms = luaL_checkinteger(L, 1);
+  if(ms < 0 || (periodic && ms < periodicIntervalMin.count()))
+    errorArgumentOutOfRange(L, 1);
+  luaL_checktype(L, 2, LUA_TFUNCTION);
+
+  auto& stateData = Sandbox::getStateData(L);
+  if(!stateData.timers)
+    stateData.timers = std::make_unique<Timers>(L);
+  auto& timers = *stateData.timers;
+
+  const auto interval = std::chrono::milliseconds(ms);
+  const auto key = stateData.nextTimerKey(periodic);
+
+  // hot-reload: keep the timer, only swap the function and user data:
+  if(const auto id = key ? stateData.reuseTimer(*key) : std::nullopt)
+  {
+    auto& entry = timers.m_timers.at(*id);
+    timers.release(entry);
+    lua_pushvalue(L, 2);
+    entry.function = luaL_ref(L, LUA_REGISTRYINDEX);
+    lua_settop(L, 3);
+    entry.userData = luaL_ref(L, LUA_REGISTRYINDEX);
+    if(const auto newInterval = periodic ? interval : std::chrono::milliseconds::zero(); entry.interval != newInterval)
+    {
+      entry.interval = newInterval;
+      entry.expires = Clock::now() + interval;
+      timers.schedule();
+    }
+    lua_pushinteger(L, *id);
+    return 1;
+  }
+
+  Entry entry{Clock::now() + interval, periodic ? interval : std::chrono::milliseconds::zero(), LUA_NOREF, LUA_REFNIL};
+  lua_pushvalue(L, 2);
+  entry.function = luaL_ref(L, LUA_REGISTRYINDEX);
+  lua_settop(L, 3); // userdata is optional
+  entry.userData = luaL_ref(L, LUA_REGISTRYINDEX); // returns LUA_REFNIL for nil
+
+  while(timers.m_timers.find(timers.m_nextId) != timers.m_timers.end())
+    timers.m_nextId = (timers.m_nextId == std::numeric_limits<lua_Integer>::max()) ? 1 : timers.m_nextId + 1;
+  const lua_Integer id = timers.m_nextId++;
+  timers.m_timers.emplace(id, entry);
+  timers.schedule();
+  if(key)
+    stateData.registerTimer(*key, id);
+
+  lua_pushinteger(L, id);
+  return 1;
+}
+
+int Timers::once(lua_State* L)
+{
+  return add(L, false);
+}
+
+int Timers::periodic(lua_State* L)
+{
+  return add(L, true);
+}
+
+int Timers::cancel(lua_State* L)
+{
+  checkArguments(L, 1);
+  const lua_Integer id = luaL_checkinteger(L, 1);
+
+  auto& timers = Sandbox::getStateData(L).timers;
+  lua_pushboolean(L, timers && timers->remove(id));
+  return 1;
+}
+
+bool Timers::remove(lua_Integer id)
+{
+  auto it = m_timers.find(id);
+  if(it == m_timers.end())
+    return false;
+
+  const Entry entry = it->second;
+  m_timers.erase(it);
+  release(entry);
+  schedule();
+  return true;
+}
+
+}
@@ -0,0 +1,90 @@
+/**
+ * server/src/lua/timers.hpp
+ *
+ * This file is part of the traintastic source code.
+ *
+ * Copyright (C) 2024 Reinder Feenstra
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef TRAINTASTIC_SERVER_LUA_TIMERS_HPP
+#define TRAINTASTIC_SERVER_LUA_TIMERS_HPP
+
+#include <map>
+#include <chrono>
+#include <lua.hpp>
+#include <boost/asio/steady_timer.hpp>
+
+namespace Lua {
+
+/**
+ * \brief Lua timer library and per sandbox timer queue
+ *
+ * All timers of a sandbox share a single steady_timer which is armed for the earliest expiry,
+ * when it fires all expired timers are handled in one go. Each callback is executed using
+ * Sandbox::pcall, so the execution time limit applies per callback.
+ *
+ * Timers added by the script chunk are matched by add order on hot-reload (see
+ * Sandbox::StateData::reuseTimer), a matching timer keeps its id and only gets the new function.
+ */
+class Timers
+{
+  private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Entry
+    {
+      Clock::time_point expires;
+      std::chrono::milliseconds interval; //!< zero for one-shot timers
+      int function;
+      int userData;
+    };
+
+    lua_State* m_L;
+    boost::asio::steady_timer m_timer;
+    std::map<lua_Integer, Entry> m_timers;
+    lua_Integer m_nextId = 1;
+    Clock::time_point m_armedExpiry = Clock::time_point::max();
+
+    void schedule();
+    void expired();
+    void release(const Entry& entry);
+
+    static int add(lua_State* L, bool periodic);
+    static int once(lua_State* L);
+    static int periodic(lua_State* L);
+    static int cancel(lua_State* L);
+
+  public:
+    static constexpr auto periodicIntervalMin = std::chrono::milliseconds(10);
+
+    static void push(lua_State* L);
+
+    Timers(lua_State* L);
+    Timers(const Timers&) = delete;
+    Timers& operator =(const Timers&) = delete;
+    ~Timers();
+
+    inline size_t size() const { return m_timers.size(); }
+    inline bool contains(lua_Integer id) const { return m_timers.find(id) != m_timers.end(); }
+
+    //! \brief Cancel timer \a id, returns \c false if there is no such timer
+    bool remove(lua_Integer id);
+};
+
+}
+
+#endif
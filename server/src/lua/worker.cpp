@@ -0,0 +1,411 @@
+/**
+ * server/src/lua/worker.cpp
+ *
+ * This file is part of the traintastic source code.
+ *
+ * Copyright (C) 2024 Reinder Feenstra
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "worker.hpp"
+#include "script.hpp"
+#include "allocator.hpp"
+#include "bytecodecache.hpp"
+#include "worldsnapshot.hpp"
+#include "readonlytable.hpp"
+#include "../core/eventloop.hpp"
+#include "../core/abstractproperty.hpp"
+#include "../core/abstractmethod.hpp"
+#include "../world/world.hpp"
+#include "../log/log.hpp"
+
+namespace Lua {
+
+Worker::Worker(Script& script)
+  : m_script{script}
+  , m_sandbox{Sandbox::create(script, this)}
+{
+}
+
+Worker::~Worker()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stop = true;
+  }
+  if(m_sandbox)
+    Sandbox::getStateData(m_sandbox.get()).abort = true; // abort running script
+  m_condition.notify_one();
+
+  if(m_thread.joinable())
+    m_thread.join();
+}
+
+void Worker::start(std::string code)
+{
+  assert(valid());
+  assert(!m_thread.joinable());
+  m_thread = std::thread(&Worker::run, this, std::move(code));
+}
+
+void Worker::update()
+{
+  assert(isEventLoopThread());
+
+  std::shared_ptr<const WorldSnapshot::Subscriptions> subscriptions;
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if(m_snapshot) // worker can't keep up, skip
+      return;
+    subscriptions = m_subscriptions;
+  }
+
+  auto snapshot = subscriptions ? WorldSnapshot::create(m_script.world(), *subscriptions) : std::make_shared<const WorldSnapshot>();
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_snapshot = std::move(snapshot);
+  }
+  m_condition.notify_one();
+}
+
+void Worker::log(LogMessage message, std::string text)
+{
+  // the script is owned by the event loop, log from there:
+  EventLoop::call(
+    [weak = weak_from_this(), message, text = std::move(text)]()
+    {
+      if(auto worker = weak.lock())
+        ::Log::log(worker->m_script, message, text);
+    });
+}
+
+void Worker::run(std::string code)
+{
+  lua_State* L = m_sandbox.get();
+
+  if(BytecodeCache::load(L, code, "=") || Sandbox::pcall(L, 0, 0))
+  {
+    failed(lua_tostring(L, -1));
+    return;
+  }
+  updateStats();
+
+  // first snapshot, now the subscriptions of the script are known:
+  EventLoop::call(
+    [weak = weak_from_this()]()
+    {
+      if(auto worker = weak.lock())
+        worker->update();
+    });
+
+  for(;;)
+  {
+    std::shared_ptr<const WorldSnapshot> snapshot;
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_condition.wait(lock, [this]() { return m_stop || m_snapshot; });
+      if(m_stop)
+        return;
+      snapshot = std::move(m_snapshot);
+    }
+
+    // building the snapshot table can raise a memory error, do it in protected mode:
+    lua_pushcfunction(L, callUpdate);
+    lua_pushlightuserdata(L, &snapshot);
+    if(Sandbox::pcall(L, 1, 0))
+    {
+      failed(lua_tostring(L, -1));
+      return;
+    }
+    updateStats();
+  }
+}
+
+int Worker::callUpdate(lua_State* L)
+{
+  auto& snapshot = *static_cast<std::shared_ptr<const WorldSnapshot>*>(lua_touserdata(L, 1));
+  lua_settop(L, 0);
+
+  if(Sandbox::getGlobal(L, "update") != LUA_TFUNCTION)
+    return 0; // nothing to do
+
+  snapshot->push(L);
+  snapshot.reset(); // the Lua table is a copy, release it as soon as possible
+
+  lua_call(L, 1, 0);
+  return 0;
+}
+
+void Worker::updateStats()
+{
+  const auto& allocator = Sandbox::getAllocator(m_sandbox.get());
+  m_memoryUsage = allocator.usage();
+  m_memoryPeak = allocator.peak();
+  m_memoryAllocations = allocator.allocations();
+}
+
+void Worker::failed(std::string message)
+{
+  updateStats();
+  const bool memoryLimitExceeded = Sandbox::getAllocator(m_sandbox.get()).limitExceeded();
+  EventLoop::call(
+    [weak = weak_from_this(), message = std::move(message), memoryLimitExceeded]()
+    {
+      if(auto worker = weak.lock())
+        worker->m_script.workerFailed(message, memoryLimitExceeded); // destroys worker
+    });
+}
+
+void Worker::post(Command command)
+{
+  m_commands.push(std::move(command));
+  if(!m_commandsPosted.exchange(true))
+  {
+    EventLoop::call(
+      [weak = weak_from_this()]()
+      {
+        if(auto worker = weak.lock())
+          worker->executeCommands();
+      });
+  }
+}
+
+void Worker::subscribe(WorldSnapshot::Subscription subscription)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto subscriptions = m_subscriptions ? std::make_shared<WorldSnapshot::Subscriptions>(*m_subscriptions) : std::make_shared<WorldSnapshot::Subscriptions>();
+  subscriptions->emplace_back(std::move(subscription));
+  m_subscriptions = std::move(subscriptions);
+}
+
+void Worker::executeCommands()
+{
+  m_commandsPosted = false; // clear first, commands posted while executing get a new call
+  m_commands.consume(
+    [this](Command&& command)
+    {
+      execute(command);
+    });
+}
+
+void Worker::execute(const Command& command)
+{
+  auto& world = m_script.world();
+
+  try
+  {
+    auto object = world.getObjectById(command.objectId);
+    if(!object)
+      throw std::runtime_error("unknown object");
+
+    if(!command.call)
+    {
+      auto* property = object->getProperty(command.name);
+      if(!property || !property->isScriptReadable())
+        throw std::runtime_error("unknown property");
+      if(!property->isScriptWriteable() || !property->isWriteable())
+        throw std::runtime_error("property is read only");
+
+      assert(command.args.size() == 1);
+      std::visit(
+        [&world, property](const auto& value)
+        {
+          using T = std::decay_t<decltype(value)>;
+          if constexpr(std::is_same_v<T, std::monostate>)
+            property->fromObject(ObjectPtr());
+          else if constexpr(std::is_same_v<T, bool>)
+            property->fromBool(value);
+          else if constexpr(std::is_same_v<T, int64_t>)
+            property->fromInt64(value);
+          else if constexpr(std::is_same_v<T, double>)
+            property->fromDouble(value);
+          else if constexpr(std::is_same_v<T, std::string>)
+          {
+            if(property->type() == ValueType::Object)
+            {
+              auto target = world.getObjectById(value);
+              if(!target)
+                throw std::runtime_error("unknown object");
+              property->fromObject(target);
+            }
+            else
+              property->fromString(value);
+          }
+        }, command.args.front());
+    }
+    else
+    {
+      auto* method = object->getMethod(command.name);
+      if(!method || !method->isScriptCallable())
+        throw std::runtime_error("unknown method");
+
+      const auto typeInfo = method->argumentTypeInfo();
+      if(typeInfo.size() != command.args.size())
+        throw AbstractMethod::InvalidNumberOfArgumentsError();
+
+      Arguments args;
+      args.reserve(command.args.size());
+      for(size_t i = 0; i < typeInfo.size(); i++)
+      {
+        const auto& value = command.args[i];
+        switch(typeInfo[i].type)
+        {
+          case ValueType::Boolean:
+            if(!std::holds_alternative<bool>(value))
+              throw AbstractMethod::ArgumentError(i, "argument: expected boolean");
+            args.emplace_back(std::get<bool>(value));
+            break;
+
+          case ValueType::Enum:
+          case ValueType::Integer:
+          case ValueType::Set:
+            if(!std::holds_alternative<int64_t>(value))
+              throw AbstractMethod::ArgumentError(i, "argument: expected integer");
+            args.emplace_back(std::get<int64_t>(value));
+            break;
+
+          case ValueType::Float:
+            if(std::holds_alternative<int64_t>(value))
+              args.emplace_back(static_cast<double>(std::get<int64_t>(value)));
+            else if(std::holds_alternative<double>(value))
+              args.emplace_back(std::get<double>(value));
+            else
+              throw AbstractMethod::ArgumentError(i, "argument: expected number");
+            break;
+
+          case ValueType::String:
+            if(!std::holds_alternative<std::string>(value))
+              throw AbstractMethod::ArgumentError(i, "argument: expected string");
+            args.emplace_back(std::get<std::string>(value));
+            break;
+
+          case ValueType::Object:
+            if(std::holds_alternative<std::monostate>(value))
+              args.emplace_back(ObjectPtr());
+            else if(!std::holds_alternative<std::string>(value))
+              throw AbstractMethod::ArgumentError(i, "argument: expected object id");
+            else if(auto argument = world.getObjectById(std::get<std::string>(value)))
+              args.emplace_back(std::move(argument));
+            else
+              throw AbstractMethod::InvalidObjectArgumentError(i);
+            break;
+
+          case ValueType::Invalid:
+            assert(false);
+            throw std::runtime_error("internal error");
+        }
+      }
+
+      method->call(args);
+    }
+  }
+  catch(const std::exception& e)
+  {
+    Log::log(m_script, LogMessage::E9004_X_DURING_EXECUTION_OF_WORKER_COMMAND_X, e.what(), command.objectId + "." + command.name);
+  }
+}
+
+Worker::Value Worker::toValue(lua_State* L, int index)
+{
+  switch(lua_type(L, index))
+  {
+    case LUA_TNIL:
+    case LUA_TNONE:
+      return std::monostate();
+
+    case LUA_TBOOLEAN:
+      return static_cast<bool>(lua_toboolean(L, index));
+
+    case LUA_TNUMBER:
+      if(lua_isinteger(L, index))
+        return static_cast<int64_t>(lua_tointeger(L, index));
+      return static_cast<double>(lua_tonumber(L, index));
+
+    case LUA_TSTRING:
+    {
+      size_t len;
+      const char* s = lua_tolstring(L, index, &len);
+      return std::string(s, len);
+    }
+    case LUA_TUSERDATA:
+      // enum and set values are userdata containing a lua_Integer, a worker has no other userdata types
+      if(lua_getmetatable(L, index))
+      {
+        lua_pop(L, 1);
+        if(lua_rawlen(L, index) == sizeof(lua_Integer))
+          return static_cast<int64_t>(*static_cast<const lua_Integer*>(lua_touserdata(L, index)));
+      }
+      break;
+  }
+  luaL_argerror(L, index, "unsupported type");
+  return {}; // never reached, luaL_argerror doesn't return
+}
+
+int Worker::set(lua_State* L)
+{
+  const char* objectId = luaL_checkstring(L, 1);
+  const char* name = luaL_checkstring(L, 2);
+  Value value = toValue(L, 3);
+  Command command{false, objectId, name, {}};
+  command.args.emplace_back(std::move(value));
+  Sandbox::getStateData(L).worker->post(std::move(command));
+  return 0;
+}
+
+int Worker::call(lua_State* L)
+{
+  const char* objectId = luaL_checkstring(L, 1);
+  const char* name = luaL_checkstring(L, 2);
+  Command command{true, objectId, name, {}};
+  const int top = lua_gettop(L);
+  command.args.reserve(static_cast<size_t>(std::max(top - 2, 0)));
+  for(int i = 3; i <= top; i++)
+    command.args.emplace_back(toValue(L, i));
+  Sandbox::getStateData(L).worker->post(std::move(command));
+  return 0;
+}
+
+int Worker::subscribe(lua_State* L)
+{
+  const int top = lua_gettop(L);
+  luaL_checkstring(L, 1);
+  for(int i = 2; i <= top; i++)
+    luaL_checkstring(L, i);
+
+  WorldSnapshot::Subscription subscription{lua_tostring(L, 1), {}};
+  subscription.properties.reserve(static_cast<size_t>(top - 1));
+  for(int i = 2; i <= top; i++)
+    subscription.properties.emplace_back(lua_tostring(L, i));
+  Sandbox::getStateData(L).worker->subscribe(std::move(subscription));
+  return 0;
+}
+
+void Worker::pushCommand(lua_State* L)
+{
+  lua_createtable(L, 0, 3);
+
+  lua_pushcfunction(L, set);
+  lua_setfield(L, -2, "set");
+  lua_pushcfunction(L, call);
+  lua_setfield(L, -2, "call");
+  lua_pushcfunction(L, subscribe);
+  lua_setfield(L, -2, "subscribe");
+
+  ReadOnlyTable::wrap(L, -1);
+}
+
+}
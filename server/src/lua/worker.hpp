@@ -0,0 +1,128 @@
+/**
+ * server/src/lua/worker.hpp
+ *
+ * This file is part of the traintastic source code.
+ *
+ * Copyright (C) 2024 Reinder Feenstra
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef TRAINTASTIC_SERVER_LUA_WORKER_HPP
+#define TRAINTASTIC_SERVER_LUA_WORKER_HPP
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <variant>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <lua.hpp>
+#include <traintastic/enum/logmessage.hpp>
+#include "sandbox.hpp"
+#include "worldsnapshot.hpp"
+#include "../utils/mpscqueue.hpp"
+
+namespace Lua {
+
+class Script;
+
+/**
+ * \brief Runs a Lua script on its own thread
+ *
+ * A worker script has no access to the live world, it receives an immutable WorldSnapshot
+ * in its global \c update function. The snapshot only contains the objects and properties
+ * the script subscribed to. Changes are posted as commands, which are executed by
+ * the event loop in batches. This keeps heavy computations (e.g. route planning) out of the
+ * event loop, only building the snapshot and executing the commands is done there.
+ *
+ * The Lua state is only used by the worker thread once started.
+ */
+class Worker : public std::enable_shared_from_this<Worker>
+{
+  public:
+    using Value = std::variant<std::monostate, bool, int64_t, double, std::string>;
+
+  private:
+    struct Command
+    {
+      bool call; //!< true: call method, false: set property
+      std::string objectId;
+      std::string name;
+      std::vector<Value> args;
+    };
+
+    Script& m_script;
+    SandboxPtr m_sandbox;
+    std::thread m_thread;
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+    std::shared_ptr<const WorldSnapshot> m_snapshot; //!< next snapshot to process, guarded by m_mutex
+    std::shared_ptr<const WorldSnapshot::Subscriptions> m_subscriptions; //!< guarded by m_mutex, replaced (not modified) when changed
+    bool m_stop = false; //!< guarded by m_mutex
+    MPSCQueue<Command> m_commands;
+    std::atomic_bool m_commandsPosted = false;
+    std::atomic<size_t> m_memoryUsage = 0;
+    std::atomic<size_t> m_memoryPeak = 0;
+    std::atomic<uint64_t> m_memoryAllocations = 0;
+
+    void run(std::string code);
+    void updateStats();
+    void failed(std::string message);
+    void post(Command command);
+    void subscribe(WorldSnapshot::Subscription subscription);
+    void executeCommands();
+    void execute(const Command& command);
+
+    static int callUpdate(lua_State* L); //!< protected part of an update: push the snapshot and call the script's update function
+    static Value toValue(lua_State* L, int index);
+    static int set(lua_State* L);
+    static int call(lua_State* L);
+    static int subscribe(lua_State* L);
+
+  public:
+    static void pushCommand(lua_State* L);
+
+    Worker(Script& script);
+    Worker(const Worker&) = delete;
+    Worker& operator =(const Worker&) = delete;
+    ~Worker();
+
+    //! \brief Check if the Lua state is created
+    inline bool valid() const { return static_cast<bool>(m_sandbox); }
+
+    //! \brief Start worker thread, must be owned by a shared_ptr
+    void start(std::string code);
+
+    /**
+     * \brief Hand a new snapshot of the subscribed objects to the worker
+     *
+     * Skipped if the previous snapshot isn't taken by the worker yet, must be called by the event loop.
+     */
+    void update();
+
+    //! \brief Log a message of the script, can be called by the worker thread
+    void log(LogMessage message, std::string text);
+
+    inline size_t memoryUsage() const { return m_memoryUsage; }
+    inline size_t memoryPeak() const { return m_memoryPeak; }
+    inline uint64_t memoryAllocations() const { return m_memoryAllocations; }
+};
+
+}
+
+#endif
@@ -0,0 +1,188 @@
+/**
+ * server/src/lua/worldsnapshot.cpp
+ *
+ * This file is part of the traintastic source code.
+ *
+ * Copyright (C) 2024 Reinder Feenstra
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "worldsnapshot.hpp"
+#include <algorithm>
+#include <unordered_map>
+#include "enum.hpp"
+#include "set.hpp"
+#include "../core/abstractproperty.hpp"
+#include "../world/world.hpp"
+
+namespace Lua {
+
+static WorldSnapshot::Value getValue(const AbstractProperty& property)
+{
+  switch(property.type())
+  {
+    case ValueType::Boolean:
+      return property.toBool();
+
+    case ValueType::Enum:
+      // EnumName<T>::value is NUL terminated, see Lua::Object::index
+      return WorldSnapshot::EnumValue{property.enumName().data(), property.toInt64()};
+
+    case ValueType::Integer:
+      return property.toInt64();
+
+    case ValueType::Float:
+      return property.toDouble();
+
+    case ValueType::String:
+      return property.toString();
+
+    case ValueType::Object:
+      if(auto object = property.toObject())
+        return object->getObjectId();
+      break;
+
+    case ValueType::Set:
+      // set_name<T>::value is NUL terminated, see Lua::Object::index
+      return WorldSnapshot::SetValue{property.setName().data(), property.toInt64()};
+
+    case ValueType::Invalid:
+      assert(false);
+      break;
+  }
+  return {};
+}
+
+std::shared_ptr<const WorldSnapshot> WorldSnapshot::create(const World& world, const Subscriptions& subscriptions)
+{
+  auto snapshot = std::make_shared<WorldSnapshot>();
+
+  if(subscriptions.empty())
+    return snapshot;
+
+  // subscriptions by object or class id:
+  std::unordered_multimap<std::string_view, const Subscription*> index;
+  bool classIds = false;
+  for(const auto& subscription : subscriptions)
+  {
+    index.emplace(subscription.id, &subscription);
+    if(!classIds && world.m_objects.find(subscription.id) == world.m_objects.end())
+      classIds = true;
+  }
+
+  std::vector<const Subscription*> matches;
+  auto add =
+    [&snapshot, &index, &matches](const std::string& id, const ::Object& object)
+    {
+      matches.clear();
+      for(auto key : {std::string_view{id}, object.getClassId()})
+      {
+        auto [first, last] = index.equal_range(key);
+        for(auto it = first; it != last; ++it)
+          matches.emplace_back(it->second);
+      }
+      if(matches.empty())
+        return;
+
+      auto& entry = snapshot->m_objects.emplace_back();
+      entry.id = id;
+      entry.classId = object.getClassId();
+
+      const bool all = std::any_of(matches.begin(), matches.end(), [](const Subscription* s) { return s->properties.empty(); });
+      if(all)
+      {
+        for(const auto& item : object.interfaceItems())
+        {
+          if(const auto* property = dynamic_cast<const AbstractProperty*>(&item.second); property && property->isScriptReadable())
+            entry.properties.emplace_back(property->name(), getValue(*property));
+        }
+        return;
+      }
+
+      for(const auto* subscription : matches)
+      {
+        for(const auto& name : subscription->properties)
+        {
+          const auto* property = object.getProperty(name);
+          if(!property || !property->isScriptReadable())
+            continue;
+          if(std::find_if(entry.properties.begin(), entry.properties.end(), [&name](const auto& p) { return p.first == name; }) != entry.properties.end())
+            continue; // already added by another subscription
+          entry.properties.emplace_back(name, getValue(*property));
+        }
+      }
+    };
+
+  if(classIds) // need to check the class of every object
+  {
+    for(const auto& it : world.m_objects)
+      if(auto object = it.second.lock())
+        add(it.first, *object);
+  }
+  else // object ids only, no need to visit all objects
+  {
+    for(const auto& subscription : subscriptions)
+      if(auto it = world.m_objects.find(subscription.id); it != world.m_objects.end())
+        if(auto object = it->second.lock(); object && std::none_of(snapshot->m_objects.begin(), snapshot->m_objects.end(), [&it](const Object& o) { return o.id == it->first; }))
+          add(it->first, *object);
+  }
+
+  return snapshot;
+}
+
+void WorldSnapshot::push(lua_State* L) const
+{
+  lua_createtable(L, 0, static_cast<int>(m_objects.size()));
+
+  for(const auto& object : m_objects)
+  {
+    lua_createtable(L, 0, static_cast<int>(object.properties.size()) + 1);
+
+    lua_pushlstring(L, object.classId.data(), object.classId.size());
+    lua_setfield(L, -2, "class_id");
+
+    for(const auto& [name, value] : object.properties)
+    {
+      lua_pushlstring(L, name.data(), name.size());
+
+      std::visit(
+        [L](const auto& v)
+        {
+          using T = std::decay_t<decltype(v)>;
+          if constexpr(std::is_same_v<T, std::monostate>)
+            lua_pushnil(L);
+          else if constexpr(std::is_same_v<T, bool>)
+            lua_pushboolean(L, v);
+          else if constexpr(std::is_same_v<T, int64_t>)
+            lua_pushinteger(L, static_cast<lua_Integer>(v));
+          else if constexpr(std::is_same_v<T, double>)
+            lua_pushnumber(L, v);
+          else if constexpr(std::is_same_v<T, std::string>)
+            lua_pushlstring(L, v.data(), v.size());
+          else if constexpr(std::is_same_v<T, EnumValue>)
+            pushEnum(L, v.name, static_cast<lua_Integer>(v.value));
+          else if constexpr(std::is_same_v<T, SetValue>)
+            pushSet(L, v.name, static_cast<lua_Integer>(v.value));
+        }, value);
+
+      lua_rawset(L, -3);
+    }
+
+    lua_setfield(L, -2, object.id.c_str());
+  }
+}
+
+}
@@ -0,0 +1,92 @@
+/**
+ * server/src/lua/worldsnapshot.hpp
+ *
+ * This file is part of the traintastic source code.
+ *
+ * Copyright (C) 2024 Reinder Feenstra
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef TRAINTASTIC_SERVER_LUA_WORLDSNAPSHOT_HPP
+#define TRAINTASTIC_SERVER_LUA_WORLDSNAPSHOT_HPP
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <variant>
+#include <cstdint>
+#include <lua.hpp>
+
+class World;
+
+namespace Lua {
+
+/**
+ * \brief Immutable copy of the script readable world state
+ *
+ * Created by the event loop and shared with worker scripts, it contains the script readable
+ * properties of the objects a worker has subscribed to. Once created it is never modified,
+ * so it can be read from any thread without locking.
+ */
+class WorldSnapshot
+{
+  public:
+    struct EnumValue
+    {
+      const char* name; //!< NUL terminated enum name, has static storage
+      int64_t value;
+    };
+
+    struct SetValue
+    {
+      const char* name; //!< NUL terminated set name, has static storage
+      int64_t value;
+    };
+
+    //! \note Object properties are stored as the id of the object they refer to
+    using Value = std::variant<std::monostate, bool, int64_t, double, std::string, EnumValue, SetValue>;
+
+    //! \brief Objects with object id or class id \a id, only the listed properties or all if empty
+    struct Subscription
+    {
+      std::string id;
+      std::vector<std::string> properties;
+    };
+
+    using Subscriptions = std::vector<Subscription>;
+
+    struct Object
+    {
+      std::string id;
+      std::string_view classId; //!< has static storage
+      std::vector<std::pair<std::string, Value>> properties;
+    };
+
+  private:
+    std::vector<Object> m_objects;
+
+  public:
+    static std::shared_ptr<const WorldSnapshot> create(const World& world, const Subscriptions& subscriptions);
+
+    inline const std::vector<Object>& objects() const { return m_objects; }
+
+    //! \brief Push snapshot as table indexed by object id
+    void push(lua_State* L) const;
+};
+
+}
+
+#endif
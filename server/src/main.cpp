@@ -21,10 +21,12 @@
  */
 
 #include <iostream>
+#include <fstream>
 #include <functional>
 #include "options.hpp"
 #include "traintastic/traintastic.hpp"
 #include "log/log.hpp"
+#include "log/binarylogger.hpp"
 #include <traintastic/locale/locale.hpp>
 #include <traintastic/utils/standardpaths.hpp>
 #ifdef __unix__
@@ -98,6 +100,17 @@ int main(int argc, char* argv[])
     exit(EXIT_FAILURE);
   }
 
+  if(!options.formatLog.empty())
+  {
+    std::ifstream file(options.formatLog, std::ios::binary);
+    if(!file.is_open())
+    {
+      std::cerr << "Error: can't open " << options.formatLog << std::endl;
+      exit(EXIT_FAILURE);
+    }
+    exit(BinaryLogger::format(file, std::cout) ? EXIT_SUCCESS : EXIT_FAILURE);
+  }
+
   if(enableConsoleLogger)
     Log::enableConsoleLogger();
 
@@ -118,6 +131,11 @@ int main(int argc, char* argv[])
         Log::enableFileLogger(dataDir / "log" / "traintastic.txt");
       else
         Log::disableFileLogger();
+
+      if(settings.enableBinaryLogger)
+        Log::enableBinaryLogger(dataDir / "log" / "traintastic.tlog");
+      else
+        Log::disableBinaryLogger();
     }
 
 #ifdef WIN32
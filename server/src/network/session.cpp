@@ -60,6 +60,11 @@ Session::~Session()
     it.second.disconnect();
 }
 
+void Session::sendMessage(std::unique_ptr<Message> message)
+{
+  m_connection->sendMessage(std::move(message));
+}
+
 bool Session::processMessage(const Message& message)
 {
   switch(message.command())
@@ -106,11 +111,11 @@ bool Session::processMessage(const Message& message)
       {
         auto response = Message::newResponse(message.command(), message.requestId());
         writeObject(*response, obj);
-        m_connection->sendMessage(std::move(response));
+        sendMessage(std::move(response));
       }
       else
       {
-        m_connection->sendMessage(Message::newErrorResponse(message.command(), message.requestId(), LogMessage::C1015_UNKNOWN_OBJECT));
+        sendMessage(Message::newErrorResponse(message.command(), message.requestId(), LogMessage::C1015_UNKNOWN_OBJECT));
       }
       return true;
     }
@@ -124,6 +129,7 @@ bool Session::processMessage(const Message& message)
       if(counter == m_handles.getCounter(handle))
       {
         m_handles.removeHandle(handle);
+        m_boardViewports.erase(handle);
 
         auto it = m_objectSignals.find(handle);
         while(it != m_objectSignals.end())
@@ -135,7 +141,7 @@ bool Session::processMessage(const Message& message)
 
         auto event = Message::newEvent(message.command(), sizeof(Handle));
         event->write(handle);
-        m_connection->sendMessage(std::move(event));
+        sendMessage(std::move(event));
       }
       break;
     }
@@ -175,23 +181,23 @@ bool Session::processMessage(const Message& message)
             {
               if(message.isRequest()) // send error response
               {
-                m_connection->sendMessage(Message::newErrorResponse(message.command(), message.requestId(), LogMessage::C1018_EXCEPTION_X, e.what()));
+                sendMessage(Message::newErrorResponse(message.command(), message.requestId(), LogMessage::C1018_EXCEPTION_X, e.what()));
               }
               else // send changed event with current value:
                 objectPropertyChanged(*property);
             }
 
             if(message.isRequest()) // send success response
-              m_connection->sendMessage(Message::newResponse(message.command(), message.requestId()));
+              sendMessage(Message::newResponse(message.command(), message.requestId()));
           }
           else if(message.isRequest()) // send error response
           {
-            m_connection->sendMessage(Message::newErrorResponse(message.command(), message.requestId(), LogMessage::C1016_UNKNOWN_PROPERTY));
+            sendMessage(Message::newErrorResponse(message.command(), message.requestId(), LogMessage::C1016_UNKNOWN_PROPERTY));
           }
         }
         else if(message.isRequest()) // send error response
         {
-          m_connection->sendMessage(Message::newErrorResponse(message.command(), message.requestId(), LogMessage::C1015_UNKNOWN_OBJECT));
+          sendMessage(Message::newErrorResponse(message.command(), message.requestId(), LogMessage::C1015_UNKNOWN_OBJECT));
         }
       }
       return true;
@@ -234,23 +240,23 @@ bool Session::processMessage(const Message& message)
             {
               if(message.isRequest()) // send error response
               {
-                m_connection->sendMessage(Message::newErrorResponse(message.command(), message.requestId(), LogMessage::C1018_EXCEPTION_X, e.what()));
+                sendMessage(Message::newErrorResponse(message.command(), message.requestId(), LogMessage::C1018_EXCEPTION_X, e.what()));
               }
               else // send changed event with current value:
                 objectPropertyChanged(*property);
             }
 
             if(message.isRequest()) // send success response
-              m_connection->sendMessage(Message::newResponse(message.command(), message.requestId()));
+              sendMessage(Message::newResponse(message.command(), message.requestId()));
           }
           else if(message.isRequest()) // send error response
           {
-            m_connection->sendMessage(Message::newErrorResponse(message.command(), message.requestId(), LogMessage::C1016_UNKNOWN_PROPERTY));
+            sendMessage(Message::newErrorResponse(message.command(), message.requestId(), LogMessage::C1016_UNKNOWN_PROPERTY));
           }
         }
         else if(message.isRequest()) // send error response
         {
-          m_connection->sendMessage(Message::newErrorResponse(message.command(), message.requestId(), LogMessage::C1015_UNKNOWN_OBJECT));
+          sendMessage(Message::newErrorResponse(message.command(), message.requestId(), LogMessage::C1015_UNKNOWN_OBJECT));
         }
       }
       return true;
@@ -285,16 +291,16 @@ bool Session::processMessage(const Message& message)
             {
               auto response = Message::newResponse(message.command(), message.requestId());
               writeObject(*response, obj);
-              m_connection->sendMessage(std::move(response));
+              sendMessage(std::move(response));
             }
             else
-              m_connection->sendMessage(Message::newErrorResponse(message.command(), message.requestId(), LogMessage::C1015_UNKNOWN_OBJECT));
+              sendMessage(Message::newErrorResponse(message.command(), message.requestId(), LogMessage::C1015_UNKNOWN_OBJECT));
           }
           else // send error response
-            m_connection->sendMessage(Message::newErrorResponse(message.command(), message.requestId(), LogMessage::C1016_UNKNOWN_PROPERTY));
+            sendMessage(Message::newErrorResponse(message.command(), message.requestId(), LogMessage::C1016_UNKNOWN_PROPERTY));
         }
         else // send error response
-          m_connection->sendMessage(Message::newErrorResponse(message.command(), message.requestId(), LogMessage::C1015_UNKNOWN_OBJECT));
+          sendMessage(Message::newErrorResponse(message.command(), message.requestId(), LogMessage::C1015_UNKNOWN_OBJECT));
 
         return true;
       }
@@ -315,16 +321,16 @@ bool Session::processMessage(const Message& message)
               auto response = Message::newResponse(message.command(), message.requestId());
               for(size_t i = startIndex; i <= endIndex; i++)
                 writeObject(*response, property->getObject(i));
-              m_connection->sendMessage(std::move(response));
+              sendMessage(std::move(response));
             }
             else // send error response
-              m_connection->sendMessage(Message::newErrorResponse(message.command(), message.requestId(), LogMessage::C1017_INVALID_INDICES));
+              sendMessage(Message::newErrorResponse(message.command(), message.requestId(), LogMessage::C1017_INVALID_INDICES));
           }
           else // send error response
-            m_connection->sendMessage(Message::newErrorResponse(message.command(), message.requestId(), LogMessage::C1016_UNKNOWN_PROPERTY));
+            sendMessage(Message::newErrorResponse(message.command(), message.requestId(), LogMessage::C1016_UNKNOWN_PROPERTY));
         }
         else // send error response
-          m_connection->sendMessage(Message::newErrorResponse(message.command(), message.requestId(), LogMessage::C1015_UNKNOWN_OBJECT));
+          sendMessage(Message::newErrorResponse(message.command(), message.requestId(), LogMessage::C1015_UNKNOWN_OBJECT));
 
         return true;
       }
@@ -448,7 +454,7 @@ bool Session::processMessage(const Message& message)
                   break;
               }
 
-              m_connection->sendMessage(std::move(response));
+              sendMessage(std::move(response));
               return true;
             }
           }
@@ -456,7 +462,7 @@ bool Session::processMessage(const Message& message)
           {
             if(message.isRequest())
             {
-              m_connection->sendMessage(Message::newErrorResponse(message.command(), message.requestId(), e.message(), e.args()));
+              sendMessage(Message::newErrorResponse(message.command(), message.requestId(), e.message(), e.args()));
               return true;
             }
             else
@@ -469,7 +475,7 @@ bool Session::processMessage(const Message& message)
           {
             if(message.isRequest())
             {
-              m_connection->sendMessage(Message::newErrorResponse(message.command(), message.requestId(), LogMessage::C1018_EXCEPTION_X, e.what()));
+              sendMessage(Message::newErrorResponse(message.command(), message.requestId(), LogMessage::C1018_EXCEPTION_X, e.what()));
               return true;
             }
           }
@@ -487,7 +493,7 @@ bool Session::processMessage(const Message& message)
           assert(model);
           auto response = Message::newResponse(message.command(), message.requestId());
           writeTableModel(*response, model);
-          m_connection->sendMessage(std::move(response));
+          sendMessage(std::move(response));
 
           model->columnHeadersChanged = [this](const TableModelPtr& tableModel)
             {
@@ -496,7 +502,7 @@ bool Session::processMessage(const Message& message)
               event->write(tableModel->columnCount());
               for(const auto& text : tableModel->columnHeaders())
                 event->write(text);
-              m_connection->sendMessage(std::move(event));
+              sendMessage(std::move(event));
             };
 
           model->rowCountChanged = [this](const TableModelPtr& tableModel)
@@ -504,7 +510,7 @@ bool Session::processMessage(const Message& message)
               auto event = Message::newEvent(Message::Command::TableModelRowCountChanged);
               event->write(m_handles.getHandle(std::dynamic_pointer_cast<Object>(tableModel)));
               event->write(tableModel->rowCount());
-              m_connection->sendMessage(std::move(event));
+              sendMessage(std::move(event));
             };
 
           model->updateRegion = [this](const TableModelPtr& tableModel, const TableModel::Region& region)
@@ -520,13 +526,13 @@ bool Session::processMessage(const Message& message)
                 for(uint32_t column = region.columnMin; column <= region.columnMax; column++)
                   event->write(tableModel->getText(column, row));
 
-              m_connection->sendMessage(std::move(event));
+              sendMessage(std::move(event));
             };
 
           return true;
         }
       }
-      m_connection->sendMessage(Message::newErrorResponse(message.command(), message.requestId(), LogMessage::C1019_OBJECT_NOT_A_TABLE));
+      sendMessage(Message::newErrorResponse(message.command(), message.requestId(), LogMessage::C1019_OBJECT_NOT_A_TABLE));
       return true;
     }
     case Message::Command::ReleaseTableModel:
@@ -561,7 +567,7 @@ bool Session::processMessage(const Message& message)
           response->write(info.id);
           response->write(info.value);
         }
-        m_connection->sendMessage(std::move(response));
+        sendMessage(std::move(response));
         return true;
       }
       break;
@@ -595,7 +601,7 @@ bool Session::processMessage(const Message& message)
               break;
           }
         }
-        m_connection->sendMessage(std::move(response));
+        sendMessage(std::move(response));
         return true;
       }
       break;
@@ -606,22 +612,31 @@ bool Session::processMessage(const Message& message)
       if(board)
       {
         auto response = Message::newResponse(message.command(), message.requestId());
-        for(const auto& it : board->tileMap())
+        for(const auto& tilePtr : board->tileGrid().tiles())
         {
-          const Tile& tile = *(it.second);
-          if(it.first != tile.location()) // only tiles at origin
-            continue;
+          const Tile& tile = *tilePtr;
           response->write(tile.location());
           response->write(tile.data());
           assert(tile.data().isActive() == isActive(tile.data().id()));
           if(tile.data().isActive())
-            writeObject(*response, it.second);
+            writeObject(*response, tilePtr);
         }
-        m_connection->sendMessage(std::move(response));
+        sendMessage(std::move(response));
         return true;
       }
       break;
     }
+    case Message::Command::BoardSetViewport:
+    {
+      const Handle handle = message.read<Handle>();
+      if(auto board = std::dynamic_pointer_cast<Board>(m_handles.getItem(handle)))
+      {
+        const auto topLeft = message.read<TileLocation>();
+        const auto bottomRight = message.read<TileLocation>();
+        boardSetViewport(handle, *board, topLeft, bottomRight);
+      }
+      break;
+    }
     case Message::Command::BoardGetTileInfo:
     {
       auto response = Message::newResponse(message.command(), message.requestId());
@@ -636,7 +651,7 @@ bool Session::processMessage(const Message& message)
         response->write(item.menu);
         response->writeBlockEnd();
       }
-      m_connection->sendMessage(std::move(response));
+      sendMessage(std::move(response));
       return true;
     }
     case Message::Command::ServerLog:
@@ -644,8 +659,10 @@ bool Session::processMessage(const Message& message)
       {
         if(auto* logger = Log::getMemoryLogger())
         {
-          m_memoryLoggerChanged = logger->changed.connect(std::bind(&Session::memoryLoggerChanged, this, std::placeholders::_1, std::placeholders::_2, std::placeholders::_3));
-          memoryLoggerChanged(*logger, logger->size(), 0);
+          m_memoryLoggerChanged = logger->changed.connect(std::bind(&Session::memoryLoggerChanged, this, std::placeholders::_1));
+          m_memoryLoggerFirst = logger->first();
+          m_memoryLoggerNext = logger->first();
+          memoryLoggerChanged(*logger);
         }
       }
       else // disable
@@ -660,11 +677,11 @@ bool Session::processMessage(const Message& message)
           std::vector<std::byte> worldData;
           message.read(worldData);
           Traintastic::instance->importWorld(worldData);
-          m_connection->sendMessage(Message::newResponse(message.command(), message.requestId()));
+          sendMessage(Message::newResponse(message.command(), message.requestId()));
         }
         catch(const LogMessageException& e)
         {
-          m_connection->sendMessage(Message::newErrorResponse(message.command(), message.requestId(), e.message(), e.args()));
+          sendMessage(Message::newErrorResponse(message.command(), message.requestId(), e.message(), e.args()));
         }
       }
       break;
@@ -680,16 +697,16 @@ bool Session::processMessage(const Message& message)
             Traintastic::instance->world->export_(worldData);
             auto response = Message::newResponse(message.command(), message.requestId());
             response->write(worldData);
-            m_connection->sendMessage(std::move(response));
+            sendMessage(std::move(response));
           }
           catch(const LogMessageException& e)
           {
-            m_connection->sendMessage(Message::newErrorResponse(message.command(), message.requestId(), e.message(), e.args()));
+            sendMessage(Message::newErrorResponse(message.command(), message.requestId(), e.message(), e.args()));
           }
         }
         else
         {
-          m_connection->sendMessage(Message::newErrorResponse(message.command(), message.requestId(), LogMessage::C1010_EXPORTING_WORLD_FAILED_X, "nullptr"));
+          sendMessage(Message::newErrorResponse(message.command(), message.requestId(), LogMessage::C1010_EXPORTING_WORLD_FAILED_X, "nullptr"));
         }
         return true;
       }
@@ -845,26 +862,38 @@ void Session::writeTableModel(Message& message, const TableModelPtr& model)
   message.writeBlockEnd(); // end model
 }
 
-void Session::memoryLoggerChanged(const MemoryLogger& logger, const uint32_t added, const uint32_t removed)
+void Session::memoryLoggerChanged(const MemoryLogger& logger)
 {
+  // logs removed from the logger that the client still has:
+  const uint64_t removed = std::min(logger.first(), m_memoryLoggerNext) - std::min(logger.first(), m_memoryLoggerFirst);
+  const uint64_t first = std::max(logger.first(), m_memoryLoggerNext);
+  const uint64_t added = logger.next() - first;
+
+  m_memoryLoggerFirst = logger.first();
+  m_memoryLoggerNext = logger.next();
+
+  if(removed == 0 && added == 0)
+    return;
+
   auto event = Message::newEvent(Message::Command::ServerLog);
-  event->write(removed);
-  event->write(added);
+  event->write(static_cast<uint32_t>(removed));
+  event->write(static_cast<uint32_t>(added));
 
-  const uint32_t size = logger.size();
-  for(uint32_t i = size - added; i < size; i++)
+  for(uint64_t sequence = first; sequence < logger.next(); sequence++)
   {
-    const auto& log = logger[i];
+    const auto log = logger.get(sequence);
     event->write((std::chrono::duration_cast<std::chrono::microseconds>(log.time.time_since_epoch())).count());
     event->write(log.objectId);
     event->write(log.message);
-    const size_t argc = log.args ? std::min<size_t>(log.args->size(), std::numeric_limits<uint8_t>::max()) : 0;
-    event->write(static_cast<uint8_t>(argc));
-    for(size_t j = 0; j < argc; j++)
-      event->write(log.args->at(j));
+    event->write(log.argc);
+    MemoryLogger::forEachArg(log,
+      [&event](std::string_view arg)
+      {
+        event->write(arg);
+      });
   }
 
-  m_connection->sendMessage(std::move(event));
+  sendMessage(std::move(event));
 }
 
 void Session::objectDestroying(Object& object)
@@ -872,10 +901,11 @@ void Session::objectDestroying(Object& object)
   const auto handle = m_handles.getHandle(object.shared_from_this());
   m_handles.removeHandle(handle);
   m_objectSignals.erase(handle);
+  m_boardViewports.erase(handle);
 
   auto event = Message::newEvent(Message::Command::ObjectDestroyed, sizeof(Handle));
   event->write(handle);
-  m_connection->sendMessage(std::move(event));
+  sendMessage(std::move(event));
 }
 
 void Session::objectPropertyChanged(BaseProperty& baseProperty)
@@ -899,7 +929,7 @@ void Session::objectPropertyChanged(BaseProperty& baseProperty)
   else
     assert(false);
 
-  m_connection->sendMessage(std::move(event));
+  sendMessage(std::move(event));
 }
 
 void Session::writePropertyValue(Message& message , const AbstractProperty& property)
@@ -986,7 +1016,7 @@ void Session::objectAttributeChanged(AbstractAttribute& attribute)
   event->write(m_handles.getHandle(attribute.item().object().shared_from_this()));
   event->write(attribute.item().name());
   writeAttribute(*event, attribute);
-  m_connection->sendMessage(std::move(event));
+  sendMessage(std::move(event));
 }
 
 void Session::objectEventFired(const AbstractEvent& event, const Arguments& arguments)
@@ -1031,7 +1061,7 @@ void Session::objectEventFired(const AbstractEvent& event, const Arguments& argu
     }
     i++;
   }
-  m_connection->sendMessage(std::move(message));
+  sendMessage(std::move(message));
 }
 
 void Session::writeAttribute(Message& message , const AbstractAttribute& attribute)
@@ -1120,7 +1150,7 @@ void Session::inputMonitorInputIdChanged(InputMonitor& inputMonitor, const uint3
   event->write(m_handles.getHandle(inputMonitor.shared_from_this()));
   event->write(address);
   event->write(id);
-  m_connection->sendMessage(std::move(event));
+  sendMessage(std::move(event));
 }
 
 void Session::inputMonitorInputValueChanged(InputMonitor& inputMonitor, const uint32_t address, const TriState value)
@@ -1129,13 +1159,58 @@ void Session::inputMonitorInputValueChanged(InputMonitor& inputMonitor, const ui
   event->write(m_handles.getHandle(inputMonitor.shared_from_this()));
   event->write(address);
   event->write(value);
-  m_connection->sendMessage(std::move(event));
+  sendMessage(std::move(event));
+}
+
+void Session::boardSetViewport(Handle handle, const Board& board, TileLocation topLeft, TileLocation bottomRight)
+{
+  auto it = m_boardViewports.find(handle);
+  if(it != m_boardViewports.end() && it->second.contains(topLeft, bottomRight))
+    return; // still within the subscribed area
+
+  auto clamp =
+    [](int value)
+    {
+      return static_cast<int16_t>(std::clamp<int>(value, Board::sizeMin, Board::sizeMax));
+    };
+
+  const BoardViewport viewport{
+    {clamp(topLeft.x - BoardViewport::margin), clamp(topLeft.y - BoardViewport::margin)},
+    {clamp(bottomRight.x + BoardViewport::margin), clamp(bottomRight.y + BoardViewport::margin)}};
+
+  TileGrid::Tiles tiles;
+  board.tileGrid().getTiles(viewport.topLeft, viewport.bottomRight, tiles);
+
+  // the client drops all tiles outside the new area, tiles within the previous area are already known by the client:
+  auto event = Message::newEvent(Message::Command::BoardTileDataRegion);
+  event->write(handle);
+  event->write(viewport.topLeft);
+  event->write(viewport.bottomRight);
+  for(const auto& tile : tiles)
+  {
+    if(it != m_boardViewports.end() && it->second.intersects(tile->location(), tile->width, tile->height))
+      continue;
+
+    event->write(tile->location());
+    event->write(tile->data());
+    if(tile->data().isActive())
+      writeObject(*event, tile);
+  }
+  sendMessage(std::move(event));
+
+  m_boardViewports[handle] = viewport;
 }
 
 void Session::boardTileDataChanged(Board& board, const TileLocation& location, const TileData& data)
 {
+  const Handle handle = m_handles.getHandle(board.shared_from_this());
+
+  // removals are always sent, a tile partly within the area can have its origin outside it:
+  if(auto it = m_boardViewports.find(handle); data && it != m_boardViewports.end() && !it->second.intersects(location, data.width(), data.height()))
+    return;
+
   auto event = Message::newEvent(Message::Command::BoardTileDataChanged);
-  event->write(m_handles.getHandle(board.shared_from_this()));
+  event->write(handle);
   event->write(location);
   event->write(data);
   assert(data.isActive() == isActive(data.id()));
@@ -1145,5 +1220,5 @@ void Session::boardTileDataChanged(Board& board, const TileLocation& location, c
     assert(tile);
     writeObject(*event, tile);
   }
-  m_connection->sendMessage(std::move(event));
+  sendMessage(std::move(event));
 }
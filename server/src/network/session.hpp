@@ -24,10 +24,12 @@
 #define TRAINTASTIC_SERVER_NETWORK_SESSION_HPP
 
 #include <memory>
+#include <unordered_map>
 #include <boost/uuid/uuid.hpp>
 #include <boost/signals2/connection.hpp>
 #include <traintastic/network/message.hpp>
 #include <traintastic/enum/tristate.hpp>
+#include <traintastic/board/tilelocation.hpp>
 #include "handlelist.hpp"
 #include "../core/objectptr.hpp"
 #include "../core/tablemodelptr.hpp"
@@ -45,7 +47,6 @@ class OutputKeyboard;
 class Board;
 class OutputMap;
 struct TypeInfo;
-struct TileLocation;
 struct TileData;
 
 class Session : public std::enable_shared_from_this<Session>
@@ -59,6 +60,8 @@ class Session : public std::enable_shared_from_this<Session>
     static void writeTypeInfo(Message& message, const TypeInfo& typeInfo);
 
     boost::signals2::connection m_memoryLoggerChanged;
+    uint64_t m_memoryLoggerFirst = 0; //!< sequence number of the oldest log the client has
+    uint64_t m_memoryLoggerNext = 0; //!< sequence number of the next log the client needs
 
   protected:
     using Handle = uint32_t;
@@ -69,12 +72,36 @@ class Session : public std::enable_shared_from_this<Session>
     Handles m_handles;
     std::unordered_multimap<Handle, boost::signals2::connection> m_objectSignals;
 
+    //! \brief Board area the client is subscribed to, tiles outside it aren't sent
+    struct BoardViewport
+    {
+      static constexpr int16_t margin = 8; //!< tiles around the visible area
+
+      TileLocation topLeft;
+      TileLocation bottomRight;
+
+      bool contains(TileLocation tl, TileLocation br) const
+      {
+        return tl.x >= topLeft.x && tl.y >= topLeft.y && br.x <= bottomRight.x && br.y <= bottomRight.y;
+      }
+
+      bool intersects(TileLocation origin, int width, int height) const
+      {
+        return origin.x + width - 1 >= topLeft.x && origin.x <= bottomRight.x &&
+          origin.y + height - 1 >= topLeft.y && origin.y <= bottomRight.y;
+      }
+    };
+    std::unordered_map<Handle, BoardViewport> m_boardViewports;
+
     bool processMessage(const Message& message);
 
+    //! \brief Send a message to the client
+    virtual void sendMessage(std::unique_ptr<Message> message);
+
     void writeObject(Message& message, const ObjectPtr& object);
     void writeTableModel(Message& message, const TableModelPtr& model);
 
-    void memoryLoggerChanged(const MemoryLogger& logger, uint32_t added, uint32_t removed);
+    void memoryLoggerChanged(const MemoryLogger& logger);
 
     void objectDestroying(Object& object);
     void objectPropertyChanged(BaseProperty& property);
@@ -84,11 +111,12 @@ class Session : public std::enable_shared_from_this<Session>
     void inputMonitorInputIdChanged(InputMonitor& inputMonitor, uint32_t address, std::string_view id);
     void inputMonitorInputValueChanged(InputMonitor& inputMonitor, uint32_t address, TriState value);
 
+    void boardSetViewport(Handle handle, const Board& board, TileLocation topLeft, TileLocation bottomRight);
     void boardTileDataChanged(Board& board, const TileLocation& location, const TileData& data);
 
   public:
     Session(const std::shared_ptr<Connection>& connection);
-    ~Session();
+    virtual ~Session();
 
     const boost::uuids::uuid& uuid() const { return m_uuid; }
 };
@@ -3,7 +3,7 @@
  *
  * This file is part of the traintastic source code.
  *
- * Copyright (C) 2019-2020 Reinder Feenstra
+ * Copyright (C) 2019-2020,2024 Reinder Feenstra
  *
  * This program is free software; you can redistribute it and/or
  * modify it under the terms of the GNU General Public License
@@ -43,6 +43,7 @@ struct Options
   bool online;
   bool power;
   bool run;
+  std::string formatLog;
 
   Options(int argc , char* argv[])
   {
@@ -65,6 +66,7 @@ struct Options
       ("online", "enable communication after loading world")
       ("power", "enable power after loading world")
       ("run", "start after loading world")
+      ("format-log", boost::program_options::value<std::string>(&formatLog)->value_name("FILENAME"), "convert binary log file to text, write it to stdout and exit")
       ;
 
     boost::program_options::variables_map vm;
@@ -0,0 +1,282 @@
+/**
+ * server/src/train/motionscheduler.cpp
+ *
+ * This file is part of the traintastic source code.
+ *
+ * Copyright (C) 2024 Reinder Feenstra
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "motionscheduler.hpp"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include "train.hpp"
+#include "../world/world.hpp"
+#include "../core/eventloop.hpp"
+#include "../utils/almostzero.hpp"
+
+static constexpr size_t npos = std::numeric_limits<size_t>::max();
+
+MotionScheduler::MotionScheduler(World& world)
+  : m_world{world}
+  , m_timer{EventLoop::ioContext}
+{
+}
+
+MotionScheduler::~MotionScheduler() = default;
+
+std::chrono::milliseconds MotionScheduler::tickInterval() const
+{
+  return std::chrono::milliseconds(std::clamp(m_world.motionTickInterval.value(), tickIntervalMin, tickIntervalMax));
+}
+
+double MotionScheduler::brakingDeceleration(const Train& train)
+{
+  if(train.m_brakingPercentage > 0)
+  {
+    return train.m_brakingPercentage / 100 * brakingDecelerationFull + rollingResistance * gravity;
+  }
+  return deceleration;
+}
+
+double MotionScheduler::brakingDistance(const Train& train)
+{
+  const double speed = train.speed.getValue(SpeedUnit::MeterPerSecond);
+  return speed * speed / (2 * brakingDeceleration(train));
+}
+
+void MotionScheduler::add(Train& train)
+{
+  if(contains(train))
+  {
+    return;
+  }
+
+  m_trains.emplace_back(&train);
+  m_mode.emplace_back(Mode::Accelerate);
+  m_speed.emplace_back(0);
+  m_target.emplace_back(0);
+  m_mass.emplace_back(0);
+  m_power.emplace_back(0);
+  m_tractiveEffort.emplace_back(0);
+  m_deceleration.emplace_back(0);
+  m_stopDistance.emplace_back(0);
+  m_stopDeceleration.emplace_back(0);
+  m_done.emplace_back(0);
+
+  if(!m_running)
+  {
+    m_running = true;
+    startTimer();
+  }
+}
+
+void MotionScheduler::remove(const Train& train)
+{
+  if(const size_t index = indexOf(train); index != npos)
+  {
+    erase(index);
+  }
+}
+
+bool MotionScheduler::contains(const Train& train) const
+{
+  return indexOf(train) != npos;
+}
+
+bool MotionScheduler::stopAt(Train& train, double distance)
+{
+  const double speed = train.speed.getValue(SpeedUnit::MeterPerSecond);
+  if(distance <= 0 || almostZero(speed))
+  {
+    return false;
+  }
+
+  train.m_speedState = Train::SpeedState::Stopping;
+  train.throttleSpeed.setValueInternal(0);
+  add(train);
+
+  // braking curve v = sqrt(2 * a * s), brake harder if the own deceleration isn't enough:
+  const size_t index = indexOf(train);
+  m_stopDistance[index] = distance;
+  m_stopDeceleration[index] = std::max(brakingDeceleration(train), speed * speed / (2 * distance));
+  return true;
+}
+
+void MotionScheduler::update(std::chrono::milliseconds elapsed)
+{
+  m_tickCount++;
+
+  // gather, trains that stopped changing speed (emergency stop, deactivated) are dropped:
+  for(size_t i = m_trains.size(); i > 0; i--)
+  {
+    const size_t index = i - 1;
+    const Train& train = *m_trains[index];
+    if(train.m_speedState == Train::SpeedState::Idle || (train.m_speedState == Train::SpeedState::Accelerate && !train.active))
+    {
+      erase(index);
+      continue;
+    }
+
+    switch(train.m_speedState)
+    {
+      case Train::SpeedState::Accelerate:
+        m_mode[index] = Mode::Accelerate;
+        break;
+
+      case Train::SpeedState::Braking:
+        m_mode[index] = Mode::Brake;
+        break;
+
+      case Train::SpeedState::Stopping:
+        m_mode[index] = Mode::Stop;
+        break;
+
+      case Train::SpeedState::Idle:
+        assert(false);
+        break;
+    }
+    m_speed[index] = train.speed.getValue(SpeedUnit::MeterPerSecond);
+    m_target[index] = train.throttleSpeed.getValue(SpeedUnit::MeterPerSecond);
+    m_mass[index] = train.weight.getValue(WeightUnit::Ton) * 1000;
+    m_power[index] = train.m_power;
+    m_tractiveEffort[index] = train.m_tractiveEffort;
+    m_deceleration[index] = brakingDeceleration(train);
+  }
+
+  // compute:
+  const double dt = std::chrono::duration<double>(elapsed).count();
+  const size_t count = m_trains.size();
+  for(size_t i = 0; i < count; i++)
+  {
+    const double speed = m_speed[i];
+    double next;
+    bool done;
+
+    switch(m_mode[i])
+    {
+      case Mode::Accelerate:
+      {
+        double a = acceleration;
+        if(m_mass[i] > 0 && (m_power[i] > 0 || m_tractiveEffort[i] > 0))
+        {
+          double force = (m_tractiveEffort[i] > 0) ? m_tractiveEffort[i] : std::numeric_limits<double>::infinity();
+          if(m_power[i] > 0)
+          {
+            force = std::min(force, m_power[i] / std::max(speed, powerSpeedMin));
+          }
+          a = force / m_mass[i] - rollingResistance * gravity;
+        }
+        next = speed + a * dt;
+        done = (next >= m_target[i]) || (a <= 0); // a <= 0: train can't go any faster
+        if(next >= m_target[i])
+        {
+          next = m_target[i];
+        }
+        else if(a <= 0)
+        {
+          next = speed;
+        }
+        break;
+      }
+      case Mode::Brake:
+        next = speed - m_deceleration[i] * dt;
+        done = (next <= m_target[i]);
+        if(done)
+        {
+          next = m_target[i];
+        }
+        break;
+
+      case Mode::Stop:
+        m_stopDistance[i] -= speed * dt;
+        next = (m_stopDistance[i] > 0) ? std::min(speed, std::sqrt(2 * m_stopDeceleration[i] * m_stopDistance[i])) : 0;
+        done = (next <= 0);
+        break;
+    }
+
+    m_speed[i] = next;
+    m_done[i] = done ? 1 : 0;
+  }
+
+  // apply, in reverse so finished trains can be erased:
+  for(size_t i = count; i > 0; i--)
+  {
+    const size_t index = i - 1;
+    const bool done = m_done[index] != 0;
+    m_trains[index]->speedUpdated(m_speed[index], done);
+    if(done)
+    {
+      erase(index);
+    }
+  }
+}
+
+void MotionScheduler::tick(const boost::system::error_code& ec)
+{
+  if(ec)
+  {
+    return;
+  }
+
+  update(m_tickInterval);
+
+  if(m_trains.empty())
+  {
+    m_running = false;
+    return;
+  }
+
+  startTimer();
+}
+
+void MotionScheduler::startTimer()
+{
+  m_tickInterval = tickInterval(); // changes to World::motionTickInterval apply from the next tick
+  m_timer.expires_after(m_tickInterval);
+  m_timer.async_wait(std::bind(&MotionScheduler::tick, this, std::placeholders::_1));
+}
+
+size_t MotionScheduler::indexOf(const Train& train) const
+{
+  auto it = std::find(m_trains.begin(), m_trains.end(), &train);
+  return (it != m_trains.end()) ? static_cast<size_t>(it - m_trains.begin()) : npos;
+}
+
+void MotionScheduler::erase(size_t index)
+{
+  // order doesn't matter, move the last element in place:
+  const auto eraseAt =
+    [index](auto& values)
+    {
+      values[index] = values.back();
+      values.pop_back();
+    };
+
+  eraseAt(m_trains);
+  eraseAt(m_mode);
+  eraseAt(m_speed);
+  eraseAt(m_target);
+  eraseAt(m_mass);
+  eraseAt(m_power);
+  eraseAt(m_tractiveEffort);
+  eraseAt(m_deceleration);
+  eraseAt(m_stopDistance);
+  eraseAt(m_stopDeceleration);
+  eraseAt(m_done);
+}
@@ -0,0 +1,154 @@
+/**
+ * server/src/train/motionscheduler.hpp
+ *
+ * This file is part of the traintastic source code.
+ *
+ * Copyright (C) 2024 Reinder Feenstra
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef TRAINTASTIC_SERVER_TRAIN_MOTIONSCHEDULER_HPP
+#define TRAINTASTIC_SERVER_TRAIN_MOTIONSCHEDULER_HPP
+
+#include <vector>
+#include <chrono>
+#include <cstdint>
+#include <boost/asio/steady_timer.hpp>
+
+class Train;
+class World;
+
+/**
+ * \brief Accelerates and brakes all trains using a single timer
+ *
+ * Trains that have to change speed are added to the scheduler, every tick all of them are updated
+ * in one pass: first their target speed and dynamics are gathered, then the new speeds are computed
+ * in a single loop over plain arrays and finally the speeds are applied to the trains. A train is
+ * removed once it reached its target speed, the timer only runs while there are trains to update.
+ *
+ * Acceleration follows from the tractive effort of the powered vehicles, limited by their power at
+ * higher speed, minus rolling resistance, divided by the train weight. Braking deceleration follows
+ * from the braking percentage of the vehicles. If the data is missing \ref acceleration and
+ * \ref deceleration are used.
+ *
+ * A moving train can be stopped at a given distance, see \ref stopAt, it keeps its speed until it
+ * meets the braking curve to that point and follows the curve down to standstill.
+ *
+ * The time between ticks is set by World::motionTickInterval.
+ *
+ * Decoder commands are only sent if the speed step changes, see PoweredRailVehicle::setSpeed.
+ */
+class MotionScheduler
+{
+  public:
+    static constexpr uint16_t tickIntervalMin = 20; //!< ms
+    static constexpr uint16_t tickIntervalMax = 1000; //!< ms
+    static constexpr uint16_t tickIntervalDefault = 100; //!< ms
+    static constexpr double acceleration = 1; //!< m/s^2, if tractive effort, power or weight is unknown
+    static constexpr double deceleration = 0.5; //!< m/s^2, if braking percentage is unknown
+    static constexpr double gravity = 9.81; //!< m/s^2
+    static constexpr double rollingResistance = 0.002; //!< resistance per weight, curve and air resistance are ignored
+    static constexpr double brakingDecelerationFull = 0.9; //!< m/s^2 at 100% braking percentage, approximation
+    static constexpr double powerSpeedMin = 1; //!< m/s, tractive effort from power is limited below this speed
+
+  private:
+    enum class Mode : uint8_t
+    {
+      Accelerate,
+      Brake,
+      Stop,
+    };
+
+    World& m_world;
+    boost::asio::steady_timer m_timer;
+    std::chrono::milliseconds m_tickInterval{tickIntervalDefault}; //!< interval the timer is started with
+    bool m_running = false;
+    uint64_t m_tickCount = 0;
+
+    // one element per train, index based so the speed computation is a plain loop:
+    std::vector<Train*> m_trains;
+    std::vector<Mode> m_mode;
+    std::vector<double> m_speed; //!< m/s
+    std::vector<double> m_target; //!< m/s
+    std::vector<double> m_mass; //!< kg
+    std::vector<double> m_power; //!< W
+    std::vector<double> m_tractiveEffort; //!< N
+    std::vector<double> m_deceleration; //!< m/s^2
+    std::vector<double> m_stopDistance; //!< m, remaining distance to the stopping point
+    std::vector<double> m_stopDeceleration; //!< m/s^2, of the braking curve to the stopping point
+    std::vector<uint8_t> m_done;
+
+    void startTimer();
+    void tick(const boost::system::error_code& ec);
+    size_t indexOf(const Train& train) const;
+    void erase(size_t index);
+
+  public:
+    MotionScheduler(World& world);
+    MotionScheduler(const MotionScheduler&) = delete;
+    MotionScheduler& operator =(const MotionScheduler&) = delete;
+    ~MotionScheduler();
+
+    //! \brief Number of trains changing speed
+    size_t size() const
+    {
+      return m_trains.size();
+    }
+
+    bool isRunning() const
+    {
+      return m_running;
+    }
+
+    //! \brief Number of ticks processed since the scheduler was created
+    uint64_t tickCount() const
+    {
+      return m_tickCount;
+    }
+
+    //! \brief Time between updates, World::motionTickInterval clamped to \ref tickIntervalMin .. \ref tickIntervalMax
+    std::chrono::milliseconds tickInterval() const;
+
+    //! \brief Braking deceleration of \a train in m/s^2
+    static double brakingDeceleration(const Train& train);
+
+    //! \brief Distance in meter \a train needs to stop from its current speed
+    static double brakingDistance(const Train& train);
+
+    //! \brief Update speed of \a train every tick until it reaches its throttle speed
+    void add(Train& train);
+
+    //! \brief Stop updating \a train
+    void remove(const Train& train);
+
+    bool contains(const Train& train) const;
+
+    /**
+     * \brief Stop \a train after \a distance meter
+     *
+     * If the train can't stop within \a distance using its own braking deceleration, it brakes harder
+     * so it still stops at the stopping point. The throttle speed is set to zero, changing the throttle
+     * cancels the stop.
+     *
+     * \return \c false if the train isn't moving or \a distance isn't positive
+     */
+    bool stopAt(Train& train, double distance);
+
+    //! \brief Update all trains for \a elapsed time, without waiting
+    void update(std::chrono::milliseconds elapsed);
+};
+
+#endif
@@ -30,7 +30,6 @@
 #include "../core/method.tpp"
 #include "../core/objectproperty.tpp"
 #include "../core/objectvectorproperty.tpp"
-#include "../core/eventloop.hpp"
 #include "../board/tile/rail/blockrailtile.hpp"
 #include "../vehicle/rail/poweredrailvehicle.hpp"
 #include "../hardware/decoder/decoder.hpp"
@@ -46,7 +45,6 @@ static inline bool isPowered(const RailVehicle& vehicle)
 
 Train::Train(World& world, std::string_view _id) :
   IdObject(world, _id),
-  m_speedTimer{EventLoop::ioContext},
   name{this, "name", "", PropertyFlags::ReadWrite | PropertyFlags::Store | PropertyFlags::ScriptReadOnly},
   lob{*this, "lob", 0, LengthUnit::MilliMeter, PropertyFlags::ReadWrite | PropertyFlags::Store},
   overrideLength{this, "override_length", false, PropertyFlags::ReadWrite | PropertyFlags::Store,
@@ -88,7 +86,6 @@ Train::Train(World& world, std::string_view _id) :
         if(m_speedState == SpeedState::Accelerate)
           return;
 
-        m_speedTimer.cancel();
         m_speedState = SpeedState::Accelerate;
         updateSpeed();
       }
@@ -97,7 +94,6 @@ Train::Train(World& world, std::string_view _id) :
         if(m_speedState == SpeedState::Braking)
           return;
 
-        m_speedTimer.cancel();
         m_speedState = SpeedState::Braking;
         updateSpeed();
       }
@@ -113,7 +109,7 @@ Train::Train(World& world, std::string_view _id) :
       if(value)
       {
         m_speedState = SpeedState::Idle;
-        m_speedTimer.cancel();
+        m_world.trains->motionScheduler().remove(*this);
         throttleSpeed.setValueInternal(0);
         speed.setValueInternal(0);
         isStopped.setValueInternal(true);
@@ -226,6 +222,8 @@ void Train::destroying()
   {
     vehicle->trains.removeInternal(self);
   }
+  m_world.trains->dispatcher().remove(*this);
+  m_world.trains->motionScheduler().remove(*this);
   m_world.trains->removeObject(self);
   IdObject::destroying();
 }
@@ -263,47 +261,18 @@ void Train::updateSpeed()
   if(m_speedState == SpeedState::Accelerate && !active)
     return;
 
-  const double targetSpeed = throttleSpeed.getValue(SpeedUnit::MeterPerSecond);
-  double currentSpeed = speed.getValue(SpeedUnit::MeterPerSecond);
-
-  double acceleration = 0;
-  if(m_speedState == SpeedState::Accelerate)
-  {
-    //! \todo add realistic acceleration
-    acceleration = 1; // m/s^2
-  }
-  else if(m_speedState == SpeedState::Braking)
-  {
-    //! \todo add realistic braking
-    acceleration = -0.5; // m/s^2
-  }
-  else
-    assert(false);
-
-  currentSpeed += acceleration * 0.1; // x 100ms
+  m_world.trains->motionScheduler().add(*this);
+}
 
-  if((m_speedState == SpeedState::Accelerate && currentSpeed >= targetSpeed) ||
-      (m_speedState == SpeedState::Braking && currentSpeed <= targetSpeed))
-  {
+void Train::speedUpdated(double currentSpeed, bool done)
+{
+  if(done)
     m_speedState = SpeedState::Idle;
-    setSpeed(convertUnit(targetSpeed, SpeedUnit::MeterPerSecond, SpeedUnit::KiloMeterPerHour));
-    currentSpeed = targetSpeed;
-  }
-  else
-  {
-    using namespace std::literals;
-    setSpeed(convertUnit(currentSpeed, SpeedUnit::MeterPerSecond, SpeedUnit::KiloMeterPerHour));
-    m_speedTimer.expires_after(100ms);
-    m_speedTimer.async_wait(
-      [this](const boost::system::error_code& ec)
-      {
-        if(!ec)
-          updateSpeed();
-      });
-  }
+
+  setSpeed(convertUnit(currentSpeed, SpeedUnit::MeterPerSecond, SpeedUnit::KiloMeterPerHour));
 
   const bool currentValue = isStopped;
-  isStopped.setValueInternal(m_speedState == SpeedState::Idle && almostZero(currentSpeed) && almostZero(targetSpeed));
+  isStopped.setValueInternal(m_speedState == SpeedState::Idle && almostZero(currentSpeed) && almostZero(throttleSpeed.value()));
   if(currentValue != isStopped)
     updateEnabled();
 }
@@ -314,6 +283,7 @@ void Train::vehiclesChanged()
   updateWeight();
   updatePowered();
   updateSpeedMax();
+  updateDynamics();
   updateEnabled();
 }
 
@@ -372,6 +342,31 @@ void Train::updateSpeedMax()
   Attributes::setMax(throttleSpeed, speedMax.value(), speedMax.unit());
 }
 
+void Train::updateDynamics()
+{
+  m_power = 0;
+  m_tractiveEffort = 0;
+  for(const auto& vehicle : m_poweredVehicles)
+  {
+    m_power += vehicle->power.getValue(PowerUnit::Watt);
+    m_tractiveEffort += vehicle->tractiveEffort.value() * 1000; // kN -> N
+  }
+
+  // vehicles without a known braking percentage don't count:
+  double weighted = 0;
+  double total = 0;
+  for(const auto& vehicle : *vehicles)
+  {
+    if(const double percentage = vehicle->brakingPercentage.getValue(RatioUnit::Percent); percentage > 0)
+    {
+      const double ton = vehicle->totalWeight.getValue(WeightUnit::Ton);
+      weighted += percentage * ton;
+      total += ton;
+    }
+  }
+  m_brakingPercentage = total > 0 ? weighted / total : 0;
+}
+
 void Train::updateEnabled()
 {
   const bool stopped = isStopped;
@@ -462,6 +457,8 @@ void Train::fireBlockReserved(const std::shared_ptr<BlockRailTile>& block, Block
 
 void Train::fireBlockEntered(const std::shared_ptr<BlockRailTile>& block, BlockTrainDirection trainDirection)
 {
+  m_world.trains->dispatcher().blockEntered(*this, *block);
+
   fireEvent(
     onBlockEntered,
     shared_ptr<Train>(),
@@ -471,6 +468,8 @@ void Train::fireBlockEntered(const std::shared_ptr<BlockRailTile>& block, BlockT
 
 void Train::fireBlockLeft(const std::shared_ptr<BlockRailTile>& block, BlockTrainDirection trainDirection)
 {
+  m_world.trains->dispatcher().blockLeft(*this, *block);
+
   fireEvent(
     onBlockLeft,
     shared_ptr<Train>(),
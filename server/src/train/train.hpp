@@ -24,7 +24,6 @@
 #define TRAINTASTIC_SERVER_TRAIN_TRAIN_HPP
 
 #include "../core/idobject.hpp"
-#include <boost/asio/steady_timer.hpp>
 #include <traintastic/enum/blocktraindirection.hpp>
 #include <traintastic/enum/trainmode.hpp>
 #include "../core/event.hpp"
@@ -45,6 +44,7 @@ class Train : public IdObject
 {
   friend class TrainVehicleList;
   friend class TrainTracking;
+  friend class MotionScheduler;
 
   private:
     enum class SpeedState
@@ -52,21 +52,28 @@ class Train : public IdObject
       Idle,
       Accelerate,
       Braking,
+      Stopping, //!< following a braking curve to a stopping point, see MotionScheduler::stopAt
     };
 
     std::vector<std::shared_ptr<PoweredRailVehicle>> m_poweredVehicles;
 
-    boost::asio::steady_timer m_speedTimer;
     SpeedState m_speedState = SpeedState::Idle;
 
+    // aggregated over all vehicles, see updateDynamics():
+    double m_power = 0; //!< W
+    double m_tractiveEffort = 0; //!< N
+    double m_brakingPercentage = 0; //!< weighted by vehicle weight, 0 if unknown
+
     void setSpeed(double kmph);
     void updateSpeed();
+    void speedUpdated(double currentSpeed, bool done);
 
     void vehiclesChanged();
     void updateLength();
     void updateWeight();
     void updatePowered();
     void updateSpeedMax();
+    void updateDynamics();
     void updateEnabled();
     bool setTrainActive(bool val);
 
@@ -0,0 +1,474 @@
+/**
+ * server/src/train/traindispatcher.cpp
+ *
+ * This file is part of the traintastic source code.
+ *
+ * Copyright (C) 2024 Reinder Feenstra
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "traindispatcher.hpp"
+#include <algorithm>
+#include <cassert>
+#include "train.hpp"
+#include "trainblockstatus.hpp"
+#include "trainlist.hpp"
+#include "trainsimulator.hpp"
+#include "../board/boardlist.hpp"
+#include "../board/map/blockpath.hpp"
+#include "../board/map/routegraph.hpp"
+#include "../board/tile/rail/blockrailtile.hpp"
+#include "../core/eventloop.hpp"
+#include "../core/objectproperty.tpp"
+#include "../world/world.hpp"
+
+TrainDispatcher::Entry::Entry()
+  : dwellTimer{EventLoop::ioContext}
+{
+}
+
+TrainDispatcher::TrainDispatcher(TrainList& trainList, World& world)
+  : m_trainList{trainList}
+  , m_world{world}
+{
+}
+
+TrainDispatcher::~TrainDispatcher()
+{
+  m_routeSet.disconnect();
+  m_routeFailed.disconnect();
+}
+
+bool TrainDispatcher::setTimetable(Train& train, std::vector<Stop> stops, bool repeat)
+{
+  if(train.mode != TrainMode::Automatic || train.blocks.empty())
+  {
+    return false;
+  }
+
+  connectRouteSetter();
+
+  auto it = m_entries.find(&train);
+  if(it == m_entries.end())
+  {
+    it = m_entries.emplace(&train, std::make_unique<Entry>()).first;
+  }
+
+  auto& entry = *it->second;
+  entry.dwellTimer.cancel();
+  entry.dwelling = false;
+  entry.stops = std::move(stops);
+  entry.stopIndex = 0;
+  entry.repeat = repeat;
+  entry.route.clear(); // reserved paths are kept, the new route continues after them
+
+  dispatch(entry, train);
+  return true;
+}
+
+void TrainDispatcher::clear(Train& train)
+{
+  auto it = m_entries.find(&train);
+  if(it == m_entries.end())
+  {
+    return;
+  }
+
+  releasePaths(*it->second);
+  m_entries.erase(it);
+
+  setSpeed(train, 0);
+}
+
+void TrainDispatcher::remove(const Train& train)
+{
+  if(auto it = m_entries.find(&train); it != m_entries.end())
+  {
+    forgetReserved(*it->second);
+    m_entries.erase(it);
+  }
+}
+
+size_t TrainDispatcher::reservedCount(const Train& train) const
+{
+  if(const auto* entry = find(train))
+  {
+    return entry->reserved.size();
+  }
+  return 0;
+}
+
+size_t TrainDispatcher::stopIndex(const Train& train) const
+{
+  if(const auto* entry = find(train))
+  {
+    return entry->stopIndex;
+  }
+  return 0;
+}
+
+void TrainDispatcher::blockEntered(Train& train, const BlockRailTile& block)
+{
+  auto* entry = find(train);
+  if(!entry)
+  {
+    return;
+  }
+
+  if(!entry->reserved.empty() && entry->reserved.front()->toBlock().get() == &block)
+  {
+    entry->set.erase(entry->reserved.front().get());
+    m_reservedBy.erase(entry->reserved.front().get());
+    entry->passed.emplace_back(std::move(entry->reserved.front()));
+    entry->reserved.pop_front();
+  }
+
+  if(entry->stopIndex < entry->stops.size() && entry->stops[entry->stopIndex].block.lock().get() == &block)
+  {
+    arrived(*entry, train, block);
+  }
+  else
+  {
+    dispatch(*entry, train);
+  }
+}
+
+void TrainDispatcher::blockLeft(Train& train, const BlockRailTile& block)
+{
+  if(auto* entry = find(train))
+  {
+    auto& passed = entry->passed;
+    auto it = std::partition(passed.begin(), passed.end(),
+      [&block](const auto& path)
+      {
+        return &path->fromBlock() != &block;
+      });
+
+    for(auto item = it; item != passed.end(); ++item)
+    {
+      (*item)->release();
+    }
+    passed.erase(it, passed.end());
+  }
+
+  // a block is freed, trains waiting for it get a chance:
+  retryWaiting();
+}
+
+void TrainDispatcher::blockFreed()
+{
+  if(m_waiting.empty() || m_retryScheduled)
+  {
+    return;
+  }
+
+  m_retryScheduled = true;
+  EventLoop::call(
+    [weak = m_trainList.weak_from_this()]()
+    {
+      if(auto trainList = std::static_pointer_cast<TrainList>(weak.lock()))
+        trainList->dispatcher().retryWaiting();
+    });
+}
+
+TrainDispatcher::Entry* TrainDispatcher::find(const Train& train) const
+{
+  auto it = m_entries.find(&train);
+  return it != m_entries.end() ? it->second.get() : nullptr;
+}
+
+std::shared_ptr<BlockRailTile> TrainDispatcher::frontier(const Entry& entry, const Train& train) const
+{
+  if(!entry.reserved.empty())
+  {
+    return entry.reserved.back()->toBlock();
+  }
+  if(!train.blocks.empty())
+  {
+    return train.blocks[0]->block.value(); // head of train
+  }
+  return {};
+}
+
+bool TrainDispatcher::plan(Entry& entry, const Train& train)
+{
+  if(entry.stopIndex >= entry.stops.size() || !m_world.boards)
+  {
+    return false;
+  }
+
+  auto stop = entry.stops[entry.stopIndex].block.lock();
+  auto from = frontier(entry, train);
+  if(!stop || !from || from == stop)
+  {
+    return false;
+  }
+
+  // train leaves the frontier block at the side opposite to where it entered:
+  BlockSide fromSide;
+  if(!entry.reserved.empty())
+  {
+    fromSide = ~entry.reserved.back()->toSide();
+  }
+  else
+  {
+    fromSide = (train.blocks[0]->direction.value() == BlockTrainDirection::TowardsA) ? BlockSide::A : BlockSide::B;
+  }
+
+  auto route = m_world.boards->routeGraph().shortest(*from, *stop, fromSide);
+  if(!route || route->paths.empty())
+  {
+    return false;
+  }
+
+  entry.route.assign(route->paths.begin(), route->paths.end());
+  return true;
+}
+
+void TrainDispatcher::dispatch(Entry& entry, Train& train)
+{
+  if(entry.dwelling || train.mode != TrainMode::Automatic)
+  {
+    return;
+  }
+
+  const auto self = train.shared_ptr<Train>();
+
+  while(entry.reserved.size() < lookAhead)
+  {
+    if(entry.route.empty() && !plan(entry, train))
+    {
+      break;
+    }
+
+    const auto& path = entry.route.front();
+    if(!path->reserve(self))
+    {
+      if(!entry.waiting)
+      {
+        entry.waiting = true;
+        m_waiting.emplace_back(self);
+      }
+      break;
+    }
+
+    entry.reserved.emplace_back(path);
+    m_reservedBy[path.get()] = &train;
+    entry.route.pop_front();
+  }
+
+  setSpeed(train, setCount(entry)); // paths count once their turnouts are set, see routeSet()
+}
+
+void TrainDispatcher::arrived(Entry& entry, Train& train, const BlockRailTile& block)
+{
+  const auto dwell = entry.stops[entry.stopIndex].dwell;
+
+  entry.route.clear();
+  entry.stopIndex++;
+  if(entry.stopIndex >= entry.stops.size() && entry.repeat)
+  {
+    entry.stopIndex = 0;
+  }
+
+  if(entry.stopIndex >= entry.stops.size()) // last stop, nothing left to reserve
+  {
+    stopInBlock(train, block);
+  }
+  else if(dwell.count() > 0)
+  {
+    entry.dwelling = true;
+    stopInBlock(train, block);
+
+    entry.dwellTimer.expires_after(dwell);
+    entry.dwellTimer.async_wait(
+      [this, weak=std::weak_ptr<Train>(train.shared_ptr<Train>())](const boost::system::error_code& ec)
+      {
+        if(ec)
+        {
+          return;
+        }
+        if(auto t = weak.lock())
+        {
+          if(auto* e = find(*t))
+          {
+            e->dwelling = false;
+            dispatch(*e, *t);
+          }
+        }
+      });
+  }
+  else
+  {
+    dispatch(entry, train);
+  }
+}
+
+void TrainDispatcher::stopInBlock(Train& train, const BlockRailTile& block)
+{
+  // the head of the train just entered the block, stop at its end. The motion scheduler works with
+  // the real train speed, so the block length at layout scale is scaled up:
+  const double distance = TrainSimulator::blockLength(block) * std::max(m_world.scaleRatio.value(), 1.);
+  if(!m_trainList.motionScheduler().stopAt(train, distance))
+  {
+    setSpeed(train, 0); // not moving
+  }
+}
+
+void TrainDispatcher::releasePaths(Entry& entry)
+{
+  entry.dwellTimer.cancel();
+  entry.route.clear();
+  for(const auto& path : entry.passed)
+  {
+    path->release();
+  }
+  entry.passed.clear();
+  forgetReserved(entry);
+  entry.reserved.clear(); // train hasn't passed them yet, they stay reserved (like a manually set route)
+  entry.set.clear();
+}
+
+void TrainDispatcher::forgetReserved(const Entry& entry)
+{
+  for(const auto& path : entry.reserved)
+  {
+    m_reservedBy.erase(path.get());
+  }
+}
+
+void TrainDispatcher::connectRouteSetter()
+{
+  if(m_routeSet.connected() || !m_world.boards)
+  {
+    return;
+  }
+
+  auto& routeSetter = m_world.boards->routeSetter();
+  m_routeSet = routeSetter.routeSet.connect(std::bind(&TrainDispatcher::routeSet, this, std::placeholders::_1));
+  m_routeFailed = routeSetter.routeFailed.connect(std::bind(&TrainDispatcher::routeFailed, this, std::placeholders::_1));
+}
+
+void TrainDispatcher::routeSet(const std::shared_ptr<BlockPath>& path)
+{
+  auto it = m_reservedBy.find(path.get());
+  if(it == m_reservedBy.end())
+  {
+    return; // not reserved by a dispatched train
+  }
+
+  Train& train = *it->second;
+  auto* entry = find(train);
+  assert(entry);
+
+  entry->set.emplace(path.get());
+  if(!entry->dwelling && train.mode == TrainMode::Automatic)
+  {
+    setSpeed(train, setCount(*entry));
+  }
+}
+
+void TrainDispatcher::routeFailed(const std::shared_ptr<BlockPath>& path)
+{
+  auto it = m_reservedBy.find(path.get());
+  if(it == m_reservedBy.end())
+  {
+    return; // not reserved by a dispatched train
+  }
+
+  Train& train = *it->second;
+  auto* entry = find(train);
+  assert(entry);
+
+  // at most lookAhead paths:
+  auto& reserved = entry->reserved;
+  const auto first = std::find(reserved.begin(), reserved.end(), path);
+  assert(first != reserved.end());
+
+  // the train can't get past the failed path, release it and the paths after it, last one first:
+  for(auto item = reserved.end(); item != first;)
+  {
+    --item;
+    (*item)->release();
+    entry->set.erase(item->get());
+    m_reservedBy.erase(item->get());
+  }
+  reserved.erase(first, reserved.end());
+  entry->route.clear(); // planned again when retried
+
+  if(!entry->dwelling && train.mode == TrainMode::Automatic)
+  {
+    setSpeed(train, setCount(*entry));
+  }
+  if(!entry->waiting)
+  {
+    entry->waiting = true;
+    m_waiting.emplace_back(train.shared_ptr<Train>());
+  }
+}
+
+size_t TrainDispatcher::setCount(const Entry& entry)
+{
+  size_t n = 0;
+  while(n < entry.reserved.size() && entry.set.find(entry.reserved[n].get()) != entry.set.end())
+  {
+    n++;
+  }
+  return n;
+}
+
+void TrainDispatcher::retryWaiting()
+{
+  m_retryScheduled = false;
+
+  for(size_t n = std::min(retryMax, m_waiting.size()); n > 0 && !m_waiting.empty(); n--)
+  {
+    auto train = m_waiting.front().lock();
+    m_waiting.pop_front();
+
+    if(!train)
+    {
+      continue;
+    }
+
+    if(auto* entry = find(*train))
+    {
+      entry->waiting = false;
+      dispatch(*entry, *train); // re-queued at the back if still blocked
+    }
+  }
+}
+
+void TrainDispatcher::setSpeed(Train& train, size_t reservedAhead)
+{
+  // speed max and throttle speed can have different units:
+  const double speedMax = train.speedMax.getValue(train.throttleSpeed.unit());
+
+  double value = 0;
+  if(reservedAhead == 1)
+  {
+    value = speedMax * approachSpeedFactor;
+  }
+  else if(reservedAhead > 1)
+  {
+    value = speedMax;
+  }
+
+  if(train.throttleSpeed.value() != value)
+  {
+    train.throttleSpeed.setValue(value);
+  }
+}
@@ -0,0 +1,160 @@
+/**
+ * server/src/train/traindispatcher.hpp
+ *
+ * This file is part of the traintastic source code.
+ *
+ * Copyright (C) 2024 Reinder Feenstra
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef TRAINTASTIC_SERVER_TRAIN_TRAINDISPATCHER_HPP
+#define TRAINTASTIC_SERVER_TRAIN_TRAINDISPATCHER_HPP
+
+#include <memory>
+#include <vector>
+#include <deque>
+#include <chrono>
+#include <unordered_map>
+#include <unordered_set>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/signals2/connection.hpp>
+
+class World;
+class Train;
+class TrainList;
+class BlockRailTile;
+class BlockPath;
+
+/**
+ * \brief Drives trains in automatic mode along a list of stops
+ *
+ * For each train the route to the next stop is searched in the route graph, block paths are reserved
+ * up to \ref lookAhead blocks ahead of the train and released after the train has left the block
+ * the path starts in. The train throttle follows the number of reserved paths ahead whose turnouts
+ * are set by the \ref RouteSetter: stop if none, approach speed if one and maximum speed otherwise.
+ * If the turnouts of a path can't be set, it is released together with the paths after it and the
+ * train waits to try again. A train that has to stop at a stop brakes to the end of the stop block,
+ * see MotionScheduler::stopAt.
+ *
+ * All work is done in response to block events of a single train, trains that couldn't reserve
+ * their next path are queued and at most \ref retryMax of them are retried when a block is left
+ * or freed. Route setter events find their train by path. So the work per event is bounded no
+ * matter how many trains are dispatched.
+ */
+class TrainDispatcher
+{
+  public:
+    struct Stop
+    {
+      std::weak_ptr<BlockRailTile> block;
+      std::chrono::seconds dwell{0}; //!< time to wait after arriving
+    };
+
+    static constexpr size_t lookAhead = 2; //!< number of block paths to reserve ahead of the train
+    static constexpr size_t retryMax = 8; //!< maximum number of waiting trains retried per block event
+    static constexpr double approachSpeedFactor = 0.5; //!< approach speed relative to train maximum speed
+
+  private:
+    struct Entry
+    {
+      std::vector<Stop> stops;
+      size_t stopIndex = 0;
+      bool repeat = false;
+      std::deque<std::shared_ptr<BlockPath>> route; //!< paths to the next stop, not reserved yet
+      std::deque<std::shared_ptr<BlockPath>> reserved; //!< reserved paths, train hasn't entered the destination block yet
+      std::unordered_set<const BlockPath*> set; //!< reserved paths with all turnouts in position
+      std::vector<std::shared_ptr<BlockPath>> passed; //!< reserved paths, train entered the destination block
+      bool waiting = false; //!< in waiting queue
+      bool dwelling = false;
+      boost::asio::steady_timer dwellTimer;
+
+      Entry();
+    };
+
+    TrainList& m_trainList;
+    World& m_world;
+    bool m_retryScheduled = false;
+    std::unordered_map<const Train*, std::unique_ptr<Entry>> m_entries;
+    std::deque<std::weak_ptr<Train>> m_waiting;
+    std::unordered_map<const BlockPath*, Train*> m_reservedBy; //!< reserved paths ahead of a train, for route setter events
+    boost::signals2::connection m_routeSet;
+    boost::signals2::connection m_routeFailed;
+
+    Entry* find(const Train& train) const;
+    std::shared_ptr<BlockRailTile> frontier(const Entry& entry, const Train& train) const;
+    bool plan(Entry& entry, const Train& train);
+    void dispatch(Entry& entry, Train& train);
+    void arrived(Entry& entry, Train& train, const BlockRailTile& block);
+    void stopInBlock(Train& train, const BlockRailTile& block);
+    void releasePaths(Entry& entry);
+    void forgetReserved(const Entry& entry);
+    void connectRouteSetter();
+    void routeSet(const std::shared_ptr<BlockPath>& path);
+    void routeFailed(const std::shared_ptr<BlockPath>& path);
+    static size_t setCount(const Entry& entry); //!< number of reserved paths ahead that are set, counted from the train
+    static void setSpeed(Train& train, size_t reservedAhead);
+
+  public:
+    TrainDispatcher(TrainList& trainList, World& world);
+    TrainDispatcher(const TrainDispatcher&) = delete;
+    TrainDispatcher& operator =(const TrainDispatcher&) = delete;
+    ~TrainDispatcher();
+
+    //! \brief Number of trains with a timetable
+    size_t size() const
+    {
+      return m_entries.size();
+    }
+
+    //! \brief Number of trains waiting for a block path to become available
+    size_t waitingCount() const
+    {
+      return m_waiting.size();
+    }
+
+    /**
+     * \brief Let \a train drive along \a stops, train must be in automatic mode and assigned to a block
+     * \param[in] repeat Restart at the first stop after the last one is reached
+     * \return \c true if the timetable is set, \c false if the train isn't in automatic mode or not in a block
+     */
+    bool setTimetable(Train& train, std::vector<Stop> stops, bool repeat = false);
+
+    //! \brief Remove the timetable of \a train and stop it, paths the train passed are released, paths ahead stay reserved
+    void clear(Train& train);
+
+    //! \brief Forget \a train without touching its state, used when it is destroyed
+    void remove(const Train& train);
+
+    //! \brief Number of reserved paths ahead of \a train
+    size_t reservedCount(const Train& train) const;
+
+    //! \brief Index of the stop \a train is heading for
+    size_t stopIndex(const Train& train) const;
+
+    //! \brief Called by \a train when it enters \a block
+    void blockEntered(Train& train, const BlockRailTile& block);
+
+    //! \brief Called by \a train when it left \a block
+    void blockLeft(Train& train, const BlockRailTile& block);
+
+    //! \brief Called when a block becomes free, waiting trains are retried in the next event loop iteration
+    void blockFreed();
+
+    //! \brief Retry up to \ref retryMax waiting trains, in the order they started waiting
+    void retryWaiting();
+};
+
+#endif
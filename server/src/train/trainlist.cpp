@@ -3,7 +3,7 @@
  *
  * This file is part of the traintastic source code.
  *
- * Copyright (C) 2019-2021,2023 Reinder Feenstra
+ * Copyright (C) 2019-2021,2023-2024 Reinder Feenstra
  *
  * This program is free software; you can redistribute it and/or
  * modify it under the terms of the GNU General Public License
@@ -32,6 +32,9 @@
 
 TrainList::TrainList(Object& _parent, std::string_view parentPropertyName) :
   ObjectList<Train>(_parent, parentPropertyName),
+  m_dispatcher{*this, getWorld(_parent)},
+  m_simulator{*this, getWorld(_parent)},
+  m_motionScheduler{getWorld(_parent)},
   create{*this, "create",
     [this]()
     {
@@ -60,6 +63,13 @@ TableModelPtr TrainList::getModel()
   return std::make_shared<TrainListTableModel>(*this);
 }
 
+void TrainList::worldEvent(WorldState state, WorldEvent event)
+{
+  ObjectList<Train>::worldEvent(state, event);
+
+  m_simulator.worldEvent(state);
+}
+
 bool TrainList::isListedProperty(std::string_view name)
 {
   return TrainListTableModel::isListedProperty(name);
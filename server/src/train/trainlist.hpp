@@ -3,7 +3,7 @@
  *
  * This file is part of the traintastic source code.
  *
- * Copyright (C) 2019-2021,2023 Reinder Feenstra
+ * Copyright (C) 2019-2021,2023-2024 Reinder Feenstra
  *
  * This program is free software; you can redistribute it and/or
  * modify it under the terms of the GNU General Public License
@@ -25,12 +25,21 @@
 
 #include "../core/objectlist.hpp"
 #include "../core/method.hpp"
+#include "traindispatcher.hpp"
+#include "trainsimulator.hpp"
+#include "motionscheduler.hpp"
 
 class Train;
 
 class TrainList : public ObjectList<Train>
 {
+  private:
+    TrainDispatcher m_dispatcher;
+    TrainSimulator m_simulator;
+    MotionScheduler m_motionScheduler;
+
   protected:
+    void worldEvent(WorldState state, WorldEvent event) final;
     bool isListedProperty(std::string_view name) final;
 
   public:
@@ -42,6 +51,21 @@ class TrainList : public ObjectList<Train>
     TrainList(Object& _parent, std::string_view parentPropertyName);
 
     TableModelPtr getModel() final;
+
+    TrainDispatcher& dispatcher()
+    {
+      return m_dispatcher;
+    }
+
+    TrainSimulator& simulator()
+    {
+      return m_simulator;
+    }
+
+    MotionScheduler& motionScheduler()
+    {
+      return m_motionScheduler;
+    }
 };
 
 #endif
@@ -0,0 +1,423 @@
+/**
+ * server/src/train/trainsimulator.cpp
+ *
+ * This file is part of the traintastic source code.
+ *
+ * Copyright (C) 2024 Reinder Feenstra
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include "trainsimulator.hpp"
+#include <algorithm>
+#include <unordered_set>
+#include "train.hpp"
+#include "trainlist.hpp"
+#include "trainblockstatus.hpp"
+#include "trainvehiclelist.hpp"
+#include "../board/map/blockpath.hpp"
+#include "../board/tile/rail/blockrailtile.hpp"
+#include "../core/eventloop.hpp"
+#include "../core/objectproperty.tpp"
+#include "../hardware/decoder/decoder.hpp"
+#include "../hardware/input/input.hpp"
+#include "../hardware/input/map/blockinputmap.hpp"
+#include "../hardware/input/map/blockinputmapitem.hpp"
+#include "../vehicle/rail/poweredrailvehicle.hpp"
+#include "../world/world.hpp"
+
+TrainSimulator::TrainSimulator(TrainList& trainList, World& world)
+  : m_trainList{trainList}
+  , m_world{world}
+  , m_timer{EventLoop::ioContext}
+{
+}
+
+TrainSimulator::~TrainSimulator() = default;
+
+uint16_t TrainSimulator::timeWarp() const
+{
+  return std::clamp(m_world.simulationTimeWarp.value(), timeWarpMin, timeWarpMax);
+}
+
+void TrainSimulator::worldEvent(WorldState state)
+{
+  if(contains(state, WorldState::Simulation) && contains(state, WorldState::Run))
+  {
+    start();
+  }
+  else
+  {
+    stop();
+  }
+}
+
+void TrainSimulator::start()
+{
+  if(m_running)
+  {
+    return;
+  }
+
+  m_running = true;
+  m_timer.expires_after(tickInterval);
+  m_timer.async_wait(std::bind(&TrainSimulator::tick, this, std::placeholders::_1));
+}
+
+void TrainSimulator::stop()
+{
+  if(!m_running)
+  {
+    return;
+  }
+
+  m_running = false;
+  m_timer.cancel();
+}
+
+void TrainSimulator::advance(std::chrono::milliseconds duration)
+{
+  sync();
+  for(auto steps = duration / stepInterval; steps > 0; steps--)
+  {
+    step();
+  }
+}
+
+std::shared_ptr<BlockRailTile> TrainSimulator::headBlock(const Train& train) const
+{
+  if(auto it = m_trains.find(&train); it != m_trains.end())
+  {
+    return it->second.segments.front().block;
+  }
+  return {};
+}
+
+bool TrainSimulator::isOccupied(const BlockRailTile& block) const
+{
+  return m_occupancy.find(&block) != m_occupancy.end();
+}
+
+double TrainSimulator::blockLength(const BlockRailTile& block)
+{
+  return std::max(block.width.value(), block.height.value()) * tileLength;
+}
+
+double TrainSimulator::speed(const Train& train)
+{
+  // the slowest powered vehicle determines the speed, like Train::updateSpeedMax:
+  double kmph = -1;
+  for(const auto& vehicle : *train.vehicles)
+  {
+    if(dynamic_cast<const PoweredRailVehicle*>(vehicle.get()) && vehicle->decoder)
+    {
+      const auto& decoder = *vehicle->decoder;
+      const double v = decoder.emergencyStop ? 0 : decoder.throttle * vehicle->speedMax.getValue(SpeedUnit::KiloMeterPerHour);
+      kmph = (kmph < 0) ? v : std::min(kmph, v);
+    }
+  }
+  return std::max(kmph, 0.);
+}
+
+Direction TrainSimulator::direction(const Train& train)
+{
+  // the train sets the same direction for all powered vehicles:
+  for(const auto& vehicle : *train.vehicles)
+  {
+    if(dynamic_cast<const PoweredRailVehicle*>(vehicle.get()) && vehicle->decoder)
+    {
+      return vehicle->decoder->direction;
+    }
+  }
+  return Direction::Unknown;
+}
+
+void TrainSimulator::tick(const boost::system::error_code& ec)
+{
+  if(ec || !m_running)
+  {
+    return;
+  }
+
+  advance(tickInterval * timeWarp());
+
+  m_timer.expires_after(tickInterval);
+  m_timer.async_wait(std::bind(&TrainSimulator::tick, this, std::placeholders::_1));
+}
+
+void TrainSimulator::sync()
+{
+  std::unordered_set<const Train*> trains;
+
+  for(const auto& train : m_trainList)
+  {
+    if(!train->active || train->blocks.empty())
+    {
+      continue;
+    }
+
+    trains.emplace(train.get());
+    if(m_trains.find(train.get()) != m_trains.end())
+    {
+      continue;
+    }
+
+    // place virtual train in the middle of the block its head is in:
+    const auto& status = *train->blocks[0];
+    auto block = status.block.value();
+    auto& virtualTrain = m_trains[train.get()];
+    virtualTrain.segments.push_back({block, nullptr, blockLength(*block), (status.direction.value() == BlockTrainDirection::TowardsA) ? BlockSide::A : BlockSide::B});
+    virtualTrain.headOffset = virtualTrain.segments.front().length / 2;
+    virtualTrain.direction = direction(*train);
+    occupy(block);
+  }
+
+  for(auto it = m_trains.begin(); it != m_trains.end();)
+  {
+    if(trains.find(it->first) == trains.end())
+    {
+      for(const auto& segment : it->second.segments)
+      {
+        if(segment.block)
+        {
+          vacate(segment.block);
+        }
+      }
+      it = m_trains.erase(it);
+    }
+    else
+    {
+      ++it;
+    }
+  }
+}
+
+void TrainSimulator::step()
+{
+  m_time += stepInterval;
+
+  const double scaleRatio = std::max(m_world.scaleRatio.value(), 1.);
+  const double seconds = std::chrono::duration<double>(stepInterval).count();
+
+  for(const auto& train : m_trainList) // fixed order, keeps the simulation deterministic
+  {
+    auto it = m_trains.find(train.get());
+    if(it == m_trains.end())
+    {
+      continue;
+    }
+
+    const double trainLength = train->lob.getValue(LengthUnit::Meter) / scaleRatio;
+
+    if(const auto value = direction(*train); value != it->second.direction)
+    {
+      if(value != Direction::Unknown && it->second.direction != Direction::Unknown)
+      {
+        reverse(it->second, trainLength);
+      }
+      it->second.direction = value;
+    }
+
+    const double kmph = speed(*train);
+    if(kmph <= 0)
+    {
+      continue;
+    }
+
+    const double distance = kmph / 3.6 / scaleRatio * seconds;
+    move(it->second, distance, trainLength);
+  }
+}
+
+void TrainSimulator::move(VirtualTrain& virtualTrain, double distance, double trainLength)
+{
+  auto& segments = virtualTrain.segments;
+
+  while(distance > 0)
+  {
+    const double remaining = segments.front().length - virtualTrain.headOffset;
+    if(distance < remaining)
+    {
+      virtualTrain.headOffset += distance;
+      break;
+    }
+
+    distance -= remaining;
+    virtualTrain.headOffset = segments.front().length;
+
+    if(!extend(virtualTrain))
+    {
+      virtualTrain.stalled = true;
+      break;
+    }
+    virtualTrain.stalled = false;
+  }
+
+  // release segments the tail has passed:
+  size_t needed = 1;
+  for(double end = virtualTrain.headOffset; needed < segments.size() && end < trainLength; needed++)
+  {
+    end += segments[needed].length;
+  }
+  while(segments.size() > needed)
+  {
+    if(segments.back().block)
+    {
+      vacate(segments.back().block);
+    }
+    segments.pop_back();
+  }
+}
+
+void TrainSimulator::reverse(VirtualTrain& virtualTrain, double trainLength)
+{
+  auto& segments = virtualTrain.segments;
+
+  // tail position in the last segment, a train longer than its segments has its tail at the start:
+  double tail = virtualTrain.headOffset - trainLength;
+  for(size_t i = 1; i < segments.size(); i++)
+  {
+    tail += segments[i].length;
+  }
+  tail = std::clamp(tail, 0., segments.back().length);
+
+  for(auto& segment : segments)
+  {
+    if(segment.block)
+    {
+      segment.exitSide = ~segment.exitSide;
+    }
+    else // use the path in the opposite direction, if there is none the train can't continue on it
+    {
+      const auto& path = *segment.path;
+      auto toBlock = path.toBlock();
+      std::shared_ptr<BlockPath> opposite;
+      if(toBlock)
+      {
+        const auto& paths = toBlock->paths();
+        auto it = std::find_if(paths.begin(), paths.end(),
+          [&path](const auto& item)
+          {
+            return item->fromSide() == path.toSide() && item->toBlock().get() == &path.fromBlock() && item->toSide() == path.fromSide();
+          });
+        if(it != paths.end())
+        {
+          opposite = *it;
+        }
+      }
+      segment.path = opposite;
+    }
+  }
+
+  std::reverse(segments.begin(), segments.end());
+  virtualTrain.headOffset = segments.front().length - tail;
+  virtualTrain.stalled = false;
+}
+
+bool TrainSimulator::extend(VirtualTrain& virtualTrain)
+{
+  const auto& head = virtualTrain.segments.front();
+  std::shared_ptr<BlockPath> path;
+
+  if(head.block)
+  {
+    const auto& paths = head.block->paths();
+    auto it = std::find_if(paths.begin(), paths.end(),
+      [side=head.exitSide](const auto& item)
+      {
+        return item->fromSide() == side && item->isSet();
+      });
+    if(it == paths.end())
+    {
+      return false; // nowhere to go
+    }
+    path = *it;
+
+    if(path->length() != 0)
+    {
+      virtualTrain.segments.push_front({nullptr, path, path->length() * tileLength});
+      virtualTrain.headOffset = 0;
+      return true;
+    }
+  }
+  else if(head.path)
+  {
+    path = head.path;
+  }
+  else
+  {
+    return false; // reversed on a path that can't be travelled in the opposite direction
+  }
+
+  auto block = path->toBlock();
+  if(!block)
+  {
+    return false;
+  }
+  virtualTrain.segments.push_front({block, nullptr, blockLength(*block), ~path->toSide()}); // enters at toSide and leaves at the opposite side
+  virtualTrain.headOffset = 0;
+  occupy(block);
+  return true;
+}
+
+void TrainSimulator::occupy(const std::shared_ptr<BlockRailTile>& block)
+{
+  if(m_occupancy[block.get()]++ == 0)
+  {
+    setSensors(*block, true);
+  }
+}
+
+void TrainSimulator::vacate(const std::shared_ptr<BlockRailTile>& block)
+{
+  auto it = m_occupancy.find(block.get());
+  if(it != m_occupancy.end() && --it->second == 0)
+  {
+    m_occupancy.erase(it);
+    setSensors(*block, false);
+  }
+}
+
+void TrainSimulator::setSensors(BlockRailTile& block, bool occupied)
+{
+  if(!m_world.simulation)
+  {
+    return;
+  }
+
+  for(const auto& item : *block.inputMap)
+  {
+    const auto& input = item->input.value();
+    if(!input)
+    {
+      continue;
+    }
+
+    switch(item->type.value())
+    {
+      case SensorType::OccupancyDetector:
+        input->simulateChange((occupied != item->invert) ? SimulateInputAction::SetTrue : SimulateInputAction::SetFalse);
+        break;
+
+      case SensorType::ReedSwitch:
+        if(occupied) // pulse when the head passes
+        {
+          input->simulateChange(item->invert ? SimulateInputAction::SetFalse : SimulateInputAction::SetTrue);
+          input->simulateChange(item->invert ? SimulateInputAction::SetTrue : SimulateInputAction::SetFalse);
+        }
+        break;
+    }
+  }
+}
@@ -0,0 +1,149 @@
+/**
+ * server/src/train/trainsimulator.hpp
+ *
+ * This file is part of the traintastic source code.
+ *
+ * Copyright (C) 2024 Reinder Feenstra
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef TRAINTASTIC_SERVER_TRAIN_TRAINSIMULATOR_HPP
+#define TRAINTASTIC_SERVER_TRAIN_TRAINSIMULATOR_HPP
+
+#include <memory>
+#include <deque>
+#include <chrono>
+#include <unordered_map>
+#include <boost/asio/steady_timer.hpp>
+#include <traintastic/set/worldstate.hpp>
+#include "../enum/blockside.hpp"
+#include "../enum/direction.hpp"
+
+class World;
+class Train;
+class TrainList;
+class BlockRailTile;
+class BlockPath;
+
+/**
+ * \brief Moves virtual trains over the layout and reports them to the block sensors
+ *
+ * Every active train that is assigned to a block gets a virtual counterpart. Its speed and direction
+ * follow the throttle and direction of the decoders of its powered vehicles, when the direction
+ * changes the tail becomes the head. It leaves a block along the block path whose turnouts are set
+ * and occupies blocks over its full length. When a virtual train enters or leaves
+ * a block the occupancy detectors of the block input map are changed and reed switches are
+ * triggered, using Input::simulateChange so the interface simulation handles them like real
+ * feedback.
+ *
+ * Tiles have no physical length, each tile counts as \ref tileLength at layout scale, speeds and
+ * train lengths are scaled by the world scale ratio. Time advances in fixed steps of \ref stepInterval,
+ * so a run is deterministic. While the world is running in simulation mode the simulator is updated
+ * every \ref tickInterval, advancing time warp times as much simulated time, see World::simulationTimeWarp.
+ */
+class TrainSimulator
+{
+  public:
+    static constexpr double tileLength = 0.1; //!< meter at layout scale
+    static constexpr std::chrono::milliseconds stepInterval{50}; //!< simulated time per step
+    static constexpr std::chrono::milliseconds tickInterval{100}; //!< real time between updates while running
+    static constexpr uint16_t timeWarpMin = 1;
+    static constexpr uint16_t timeWarpMax = 1000;
+
+  private:
+    struct Segment
+    {
+      std::shared_ptr<BlockRailTile> block; //!< set if segment is a block
+      std::shared_ptr<BlockPath> path; //!< set if segment is the track between two blocks
+      double length;
+      BlockSide exitSide = BlockSide::A; //!< side the train leaves the block, only for blocks
+    };
+
+    struct VirtualTrain
+    {
+      std::deque<Segment> segments; //!< occupied segments, head of train first
+      double headOffset; //!< distance travelled in the first segment
+      Direction direction; //!< decoder direction the segments are ordered for
+      bool stalled = false; //!< no path set ahead, waiting at the end of the block
+    };
+
+    TrainList& m_trainList;
+    World& m_world;
+    boost::asio::steady_timer m_timer;
+    bool m_running = false;
+    std::chrono::milliseconds m_time{0};
+    std::unordered_map<const Train*, VirtualTrain> m_trains;
+    std::unordered_map<const BlockRailTile*, uint32_t> m_occupancy; //!< number of virtual trains per block
+
+    static double speed(const Train& train); //!< km/h, from decoder throttle
+    static Direction direction(const Train& train); //!< from decoder direction
+
+    void tick(const boost::system::error_code& ec);
+    void sync();
+    void step();
+    void move(VirtualTrain& virtualTrain, double distance, double trainLength);
+    void reverse(VirtualTrain& virtualTrain, double trainLength);
+    bool extend(VirtualTrain& virtualTrain);
+    void occupy(const std::shared_ptr<BlockRailTile>& block);
+    void vacate(const std::shared_ptr<BlockRailTile>& block);
+    void setSensors(BlockRailTile& block, bool occupied);
+
+  public:
+    //! \brief Length of \a block in meter at layout scale, see \ref tileLength
+    static double blockLength(const BlockRailTile& block);
+
+    TrainSimulator(TrainList& trainList, World& world);
+    TrainSimulator(const TrainSimulator&) = delete;
+    TrainSimulator& operator =(const TrainSimulator&) = delete;
+    ~TrainSimulator();
+
+    //! \brief Number of virtual trains
+    size_t size() const
+    {
+      return m_trains.size();
+    }
+
+    bool isRunning() const
+    {
+      return m_running;
+    }
+
+    //! \brief Simulated time since the simulator was created
+    std::chrono::milliseconds time() const
+    {
+      return m_time;
+    }
+
+    //! \brief Number of simulated seconds per real second, set by the world simulation time warp property
+    uint16_t timeWarp() const;
+
+    //! \brief Start or stop the simulator, it only runs while the world is running in simulation mode
+    void worldEvent(WorldState state);
+
+    void start();
+    void stop();
+
+    //! \brief Advance simulated time by \a duration, rounded down to whole steps, without waiting
+    void advance(std::chrono::milliseconds duration);
+
+    //! \brief Block the head of the virtual train of \a train is in, \c nullptr if between blocks or no virtual train
+    std::shared_ptr<BlockRailTile> headBlock(const Train& train) const;
+
+    //! \brief \c true if a virtual train occupies \a block
+    bool isOccupied(const BlockRailTile& block) const;
+};
+
+#endif
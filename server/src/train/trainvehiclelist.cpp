@@ -109,9 +109,14 @@ void TrainVehicleList::propertyChanged(BaseProperty& property)
   if(property.name() == "lob")
     train().updateLength();
   else if(property.name() == "total_weight")
+  {
     train().updateWeight();
+    train().updateDynamics();
+  }
   else if(property.name() == "speed_max")
     train().updateSpeedMax();
+  else if(property.name() == "power" || property.name() == "tractive_effort" || property.name() == "braking_percentage")
+    train().updateDynamics();
 }
 
 Train& TrainVehicleList::train()
@@ -3,7 +3,7 @@
  *
  * This file is part of the traintastic source code.
  *
- * Copyright (C) 2019-2023 Reinder Feenstra
+ * Copyright (C) 2019-2024 Reinder Feenstra
  *
  * This program is free software; you can redistribute it and/or
  * modify it under the terms of the GNU General Public License
@@ -41,6 +41,7 @@ Settings::PreStart Settings::getPreStartSettings(const std::filesystem::path& pa
     PreStart preStart;
     preStart.memoryLoggerSize = settings.value(Name::memoryLoggerSize, Default::memoryLoggerSize);
     preStart.enableFileLogger = settings.value(Name::enableFileLogger, Default::enableFileLogger);
+    preStart.enableBinaryLogger = settings.value(Name::enableBinaryLogger, Default::enableBinaryLogger);
     return preStart;
   }
   return PreStart();
@@ -61,6 +62,7 @@ Settings::Settings(const std::filesystem::path& path)
   , allowClientServerShutdown{this, "allow_client_server_shutdown", false, PropertyFlags::ReadWrite | PropertyFlags::Internal, [this](const bool& /*value*/){ saveToFile(); }}
   , memoryLoggerSize{this, Name::memoryLoggerSize, Default::memoryLoggerSize, PropertyFlags::ReadWrite, [this](const uint32_t& /*value*/){ saveToFile(); }}
   , enableFileLogger{this, Name::enableFileLogger, Default::enableFileLogger, PropertyFlags::ReadWrite, [this](const bool& /*value*/){ saveToFile(); }}
+  , enableBinaryLogger{this, Name::enableBinaryLogger, Default::enableBinaryLogger, PropertyFlags::ReadWrite, [this](const bool& /*value*/){ saveToFile(); }}
 {
   m_interfaceItems.add(lastWorld);
   m_interfaceItems.add(loadLastWorldOnStartup);
@@ -84,6 +86,8 @@ Settings::Settings(const std::filesystem::path& path)
   m_interfaceItems.add(memoryLoggerSize);
   Attributes::addCategory(enableFileLogger, Category::log);
   m_interfaceItems.add(enableFileLogger);
+  Attributes::addCategory(enableBinaryLogger, Category::log);
+  m_interfaceItems.add(enableBinaryLogger);
 
   Attributes::addCategory(saveWorldUncompressed, Category::developer);
   m_interfaceItems.add(saveWorldUncompressed);
@@ -3,7 +3,7 @@
  *
  * This file is part of the traintastic source code.
  *
- * Copyright (C) 2019-2022 Reinder Feenstra
+ * Copyright (C) 2019-2022,2024 Reinder Feenstra
  *
  * This program is free software; you can redistribute it and/or
  * modify it under the terms of the GNU General Public License
@@ -37,12 +37,14 @@ class Settings : public Object
     {
       static constexpr const char* memoryLoggerSize = "memory_logger_size";
       static constexpr const char* enableFileLogger = "enable_file_logger";
+      static constexpr const char* enableBinaryLogger = "enable_binary_logger";
     };
 
     struct Default
     {
       static constexpr uint32_t memoryLoggerSize = 1000;
       static constexpr bool enableFileLogger = false;
+      static constexpr bool enableBinaryLogger = false;
     };
 
     const std::filesystem::path m_filename;
@@ -57,6 +59,7 @@ class Settings : public Object
     {
       uint32_t memoryLoggerSize = Default::memoryLoggerSize;
       bool enableFileLogger = Default::enableFileLogger;
+      bool enableBinaryLogger = Default::enableBinaryLogger;
     };
 
     static constexpr std::string_view id = classId;
@@ -76,6 +79,7 @@ class Settings : public Object
     Property<bool> allowClientServerShutdown;
     Property<uint32_t> memoryLoggerSize;
     Property<bool> enableFileLogger;
+    Property<bool> enableBinaryLogger;
 
     Settings(const std::filesystem::path& path);
 
@@ -41,6 +41,7 @@
 #include "../log/log.hpp"
 #include "../log/logmessageexception.hpp"
 #include "../lua/getversion.hpp"
+#include "../lua/bytecodecache.hpp"
 
 using nlohmann::json;
 
@@ -206,6 +207,7 @@ Traintastic::RunStatus Traintastic::run(const std::string& worldUUID, bool simul
   Attributes::setEnabled(shutdown, settings->allowClientServerShutdown);
 
   worldList = std::make_shared<WorldList>(worldDir());
+  Lua::BytecodeCache::setDirectory(worldDir() / Lua::BytecodeCache::directoryName);
 
   if(!worldUUID.empty())
   {
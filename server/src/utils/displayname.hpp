@@ -102,6 +102,7 @@ namespace DisplayName
   {
     namespace Rail
     {
+      constexpr std::string_view brakingPercentage = "vehicle.rail:braking_percentage";
       constexpr std::string_view cargoCapacity = "vehicle.rail:cargo_capacity";
       constexpr std::string_view cargoLoaded = "vehicle.rail:cargo_loaded";
       constexpr std::string_view lob = "vehicle.rail:lob";
@@ -109,6 +110,7 @@ namespace DisplayName
       constexpr std::string_view speedMax = "vehicle.rail:speed_max";
       constexpr std::string_view decoder = "vehicle.rail:decoder";
       constexpr std::string_view totalWeight = "vehicle.rail:total_weight";
+      constexpr std::string_view tractiveEffort = "vehicle.rail:tractive_effort";
       constexpr std::string_view train = "vehicle.rail:train";
       constexpr std::string_view weight = "vehicle.rail:weight";
     }
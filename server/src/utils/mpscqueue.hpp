@@ -0,0 +1,98 @@
+/**
+ * server/src/utils/mpscqueue.hpp
+ *
+ * This file is part of the traintastic source code.
+ *
+ * Copyright (C) 2024 Reinder Feenstra
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef TRAINTASTIC_SERVER_UTILS_MPSCQUEUE_HPP
+#define TRAINTASTIC_SERVER_UTILS_MPSCQUEUE_HPP
+
+#include <atomic>
+#include <utility>
+
+/**
+ * \brief Lock-free multiple producer, single consumer queue
+ *
+ * Producers push items one by one, the consumer takes all queued items at once in push order.
+ */
+template<class T>
+class MPSCQueue
+{
+  private:
+    struct Node
+    {
+      Node* next;
+      T value;
+    };
+
+    std::atomic<Node*> m_head = nullptr;
+
+  public:
+    MPSCQueue() = default;
+    MPSCQueue(const MPSCQueue&) = delete;
+    MPSCQueue& operator =(const MPSCQueue&) = delete;
+
+    ~MPSCQueue()
+    {
+      consume([](T&&){});
+    }
+
+    bool empty() const
+    {
+      return m_head.load(std::memory_order_relaxed) == nullptr;
+    }
+
+    //! \brief Push an item, can be called from any thread
+    void push(T value)
+    {
+      Node* node = new Node{m_head.load(std::memory_order_relaxed), std::move(value)};
+      while(!m_head.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    //! \brief Take all queued items and call \a f for each item, may only be called from the consumer thread
+    //! \return Number of items consumed
+    template<class F>
+    size_t consume(F&& f)
+    {
+      Node* node = m_head.exchange(nullptr, std::memory_order_acquire);
+
+      // list is in LIFO order, reverse it:
+      Node* fifo = nullptr;
+      while(node)
+      {
+        Node* next = node->next;
+        node->next = fifo;
+        fifo = node;
+        node = next;
+      }
+
+      size_t count = 0;
+      while(fifo)
+      {
+        Node* next = fifo->next;
+        f(std::move(fifo->value));
+        delete fifo;
+        fifo = next;
+        count++;
+      }
+      return count;
+    }
+};
+
+#endif
@@ -24,6 +24,17 @@
 #include <fstream>
 #include <boost/uuid/detail/sha1.hpp>
 
+std::string Sha1::Digest::toString() const
+{
+  static constexpr char digits[] = "0123456789abcdef";
+  std::string s;
+  s.reserve(sizeof(m_hash) * 2);
+  for(unsigned int word : m_hash)
+    for(int shift = 28; shift >= 0; shift -= 4)
+      s += digits[(word >> shift) & 0xF];
+  return s;
+}
+
 Sha1::Digest Sha1::of(const std::string& value)
 {
   boost::uuids::detail::sha1 sha1;
@@ -56,6 +56,9 @@ struct Sha1
       {
         return !operator ==(other);
       }
+
+      //! \brief Hexadecimal representation of the digest
+      std::string toString() const;
   };
 
   static Digest of(const std::string& value);
@@ -3,7 +3,7 @@
  *
  * This file is part of the traintastic source code.
  *
- * Copyright (C) 2023 Reinder Feenstra
+ * Copyright (C) 2023-2024 Reinder Feenstra
  *
  * This program is free software; you can redistribute it and/or
  * modify it under the terms of the GNU General Public License
@@ -34,12 +34,18 @@
 PoweredRailVehicle::PoweredRailVehicle(World& world, std::string_view id_)
   : RailVehicle(world, id_)
   , power{*this, "power", 0, PowerUnit::KiloWatt, PropertyFlags::ReadWrite | PropertyFlags::Store}
+  , tractiveEffort{this, "tractive_effort", 0, PropertyFlags::ReadWrite | PropertyFlags::Store}
 {
   const bool editable = contains(m_world.state.value(), WorldState::Edit);
 
   Attributes::addDisplayName(power, DisplayName::Vehicle::Rail::power);
   Attributes::addEnabled(power, editable);
   m_interfaceItems.add(power);
+
+  Attributes::addDisplayName(tractiveEffort, DisplayName::Vehicle::Rail::tractiveEffort);
+  Attributes::addEnabled(tractiveEffort, editable);
+  Attributes::addMinMax(tractiveEffort, 0., 1000.);
+  m_interfaceItems.add(tractiveEffort);
 }
 
 void PoweredRailVehicle::setDirection(Direction value)
@@ -72,11 +78,9 @@ void PoweredRailVehicle::setSpeed(double kmph)
     const double max = speedMax.getValue(SpeedUnit::KiloMeterPerHour);
     if(max > 0)
     {
-      const uint8_t steps = decoder->speedSteps;
-      if(steps == Decoder::speedStepsAuto)
-        decoder->throttle.setValue(kmph / max);
-      else
-        decoder->throttle.setValue(std::round(kmph / max * steps) / steps);
+      // quantize, the throttle (and the decoder command) only changes if the speed step changes:
+      const uint8_t steps = (decoder->speedSteps == Decoder::speedStepsAuto) ? speedStepsAutoResolution : decoder->speedSteps.value();
+      decoder->throttle.setValue(std::round(kmph / max * steps) / steps);
     }
     else
       decoder->throttle.setValue(0);
@@ -90,4 +94,5 @@ void PoweredRailVehicle::worldEvent(WorldState state, WorldEvent event)
   const bool editable = contains(state, WorldState::Edit);
 
   Attributes::setEnabled(power, editable);
+  Attributes::setEnabled(tractiveEffort, editable);
 }
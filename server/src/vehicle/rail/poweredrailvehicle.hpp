@@ -3,7 +3,7 @@
  *
  * This file is part of the traintastic source code.
  *
- * Copyright (C) 2023 Reinder Feenstra
+ * Copyright (C) 2023-2024 Reinder Feenstra
  *
  * This program is free software; you can redistribute it and/or
  * modify it under the terms of the GNU General Public License
@@ -35,7 +35,10 @@ class PoweredRailVehicle : public RailVehicle
     void worldEvent(WorldState state, WorldEvent event) override;
 
   public:
+    static constexpr uint8_t speedStepsAutoResolution = 126; //!< speed steps used if the decoder speed steps is auto
+
     PowerProperty power;
+    Property<double> tractiveEffort; //!< maximum tractive effort in kN, 0 if unknown
 
     void setDirection(Direction value);
     void setEmergencyStop(bool value);
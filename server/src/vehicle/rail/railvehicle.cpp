@@ -40,6 +40,7 @@ RailVehicle::RailVehicle(World& world, std::string_view _id) :
   speedMax{*this, "speed_max", 0, SpeedUnit::KiloMeterPerHour, PropertyFlags::ReadWrite | PropertyFlags::Store},
   weight{*this, "weight", 0, WeightUnit::Ton, PropertyFlags::ReadWrite | PropertyFlags::Store, [this](double /*value*/, WeightUnit /*unit*/){ updateTotalWeight(); }},
   totalWeight{*this, "total_weight", 0, WeightUnit::Ton, PropertyFlags::ReadOnly | PropertyFlags::NoStore},
+  brakingPercentage{*this, "braking_percentage", 0, RatioUnit::Percent, PropertyFlags::ReadWrite | PropertyFlags::Store},
   activeTrain{this, "active_train", nullptr, PropertyFlags::ReadOnly | PropertyFlags::ScriptReadOnly | PropertyFlags::StoreState}
   , trains{*this, "trains", {}, PropertyFlags::ReadOnly | PropertyFlags::ScriptReadOnly | PropertyFlags::NoStore}
 {
@@ -66,6 +67,11 @@ RailVehicle::RailVehicle(World& world, std::string_view _id) :
   Attributes::addDisplayName(totalWeight, DisplayName::Vehicle::Rail::totalWeight);
   m_interfaceItems.insertBefore(totalWeight, notes);
 
+  Attributes::addDisplayName(brakingPercentage, DisplayName::Vehicle::Rail::brakingPercentage);
+  Attributes::addEnabled(brakingPercentage, editable);
+  Attributes::addMinMax(brakingPercentage, 0., 250., RatioUnit::Percent);
+  m_interfaceItems.insertBefore(brakingPercentage, notes);
+
   Attributes::addDisplayName(activeTrain, DisplayName::Vehicle::Rail::train); //TODO: "Active"
   Attributes::addEnabled(activeTrain, true);
   m_interfaceItems.insertBefore(activeTrain, notes);
@@ -109,6 +115,7 @@ void RailVehicle::worldEvent(WorldState state, WorldEvent event)
   Attributes::setEnabled(lob, editable);
   Attributes::setEnabled(speedMax, editable);
   Attributes::setEnabled(weight, editable);
+  Attributes::setEnabled(brakingPercentage, editable);
 }
 
 double RailVehicle::calcTotalWeight(WeightUnit unit) const
@@ -27,6 +27,7 @@
 #include "../../core/objectproperty.hpp"
 #include "../../core/objectvectorproperty.hpp"
 #include "../../core/lengthproperty.hpp"
+#include "../../core/ratioproperty.hpp"
 #include "../../core/speedproperty.hpp"
 #include "../../core/weightproperty.hpp"
 
@@ -52,6 +53,7 @@ class RailVehicle : public Vehicle
     SpeedProperty speedMax;
     WeightProperty weight;
     WeightProperty totalWeight;
+    RatioProperty brakingPercentage; //!< braked weight percentage, 0 if unknown
 
     ObjectProperty<Train> activeTrain;
     ObjectVectorProperty<Train> trains;
@@ -3,7 +3,7 @@
  *
  * This file is part of the traintastic source code.
  *
- * Copyright (C) 2021-2022 Reinder Feenstra
+ * Copyright (C) 2021-2023 Reinder Feenstra
  *
  * This program is free software; you can redistribute it and/or
  * modify it under the terms of the GNU General Public License
@@ -27,88 +27,116 @@
 
 using nlohmann::json;
 
-CTWReader::CTWReader() :
-  m_archive{archive_read_new(),
-    [](archive* a)
-    {
-      archive_read_close(a);
-      archive_read_free(a);
-    }}
+static void archiveFree(archive* a)
 {
-  if(archive_read_support_filter_xz(m_archive.get()) != ARCHIVE_OK)
-    throw LibArchiveError(m_archive.get());
-  if(archive_read_support_format_tar(m_archive.get()) != ARCHIVE_OK)
-    throw LibArchiveError(m_archive.get());
+  if(a)
+  {
+    archive_read_close(a);
+    archive_read_free(a);
+  }
 }
 
-CTWReader::CTWReader(const std::filesystem::path& filename)
-  : CTWReader()
+CTWReader::CTWReader(std::filesystem::path filename, const std::vector<std::byte>* memory)
+  : m_filename{std::move(filename)}
+  , m_memory{memory}
+  , m_archive{nullptr, archiveFree}
 {
-  if(archive_read_open_filename(m_archive.get(), filename.string().c_str(), 10240) != ARCHIVE_OK)
-    throw LibArchiveError(m_archive.get());
+  open();
+}
 
-  readFiles();
+CTWReader::CTWReader(const std::filesystem::path& filename)
+  : CTWReader(filename, nullptr)
+{
 }
 
 CTWReader::CTWReader(const std::vector<std::byte>& memory)
-  : CTWReader()
+  : CTWReader({}, &memory)
 {
-  if(archive_read_open_memory(m_archive.get(), memory.data(), memory.size()) != ARCHIVE_OK)
+}
+
+void CTWReader::open()
+{
+  m_archive.reset(archive_read_new());
+  m_position = 0;
+
+  if(archive_read_support_filter_xz(m_archive.get()) != ARCHIVE_OK)
+    throw LibArchiveError(m_archive.get());
+  if(archive_read_support_format_tar(m_archive.get()) != ARCHIVE_OK)
     throw LibArchiveError(m_archive.get());
 
-  readFiles();
+  if(m_memory)
+  {
+    if(archive_read_open_memory(m_archive.get(), m_memory->data(), m_memory->size()) != ARCHIVE_OK)
+      throw LibArchiveError(m_archive.get());
+  }
+  else if(archive_read_open_filename(m_archive.get(), m_filename.string().c_str(), 10240) != ARCHIVE_OK)
+    throw LibArchiveError(m_archive.get());
 }
 
-void CTWReader::readFiles()
+archive_entry* CTWReader::find(const std::string& filename)
 {
-  // load everything in memory:
+  if(auto it = m_index.find(filename); it != m_index.end())
+  {
+    if(it->second < m_position) // already passed, start over:
+      open();
+  }
+  else if(m_indexComplete)
+    return nullptr;
+
   archive_entry* entry = nullptr;
   while(true)
   {
     const int r = archive_read_next_header(m_archive.get(), &entry);
     if(r == ARCHIVE_EOF)
-      break;
+    {
+      m_indexComplete = true;
+      return nullptr;
+    }
     if(r < ARCHIVE_OK)
       throw LibArchiveError(m_archive.get());
 
-    std::vector<std::byte> data;
-    data.resize(archive_entry_size(entry));
+    std::string pathname{archive_entry_pathname(entry)};
+    m_index.emplace(pathname, m_position);
+    m_position++;
 
-    size_t pos = 0;
-    while(pos < data.size())
-    {
-      const auto count = archive_read_data(m_archive.get(), data.data() + pos, data.size() - pos);
-      if(count < 0)
-        throw LibArchiveError(m_archive.get());
-      if(count == 0)
-        break; // should not happen
-      pos += static_cast<size_t>(count);
-    }
+    if(pathname == filename)
+      return entry;
+
+    if(archive_read_data_skip(m_archive.get()) < ARCHIVE_OK)
+      throw LibArchiveError(m_archive.get());
+  }
+}
+
+bool CTWReader::readData(archive_entry* entry, std::string& data)
+{
+  data.resize(static_cast<size_t>(archive_entry_size(entry)));
 
-    if(pos == data.size())
-      m_files.emplace(archive_entry_pathname(entry), std::move(data));
+  size_t pos = 0;
+  while(pos < data.size())
+  {
+    const auto count = archive_read_data(m_archive.get(), data.data() + pos, data.size() - pos);
+    if(count < 0)
+      throw LibArchiveError(m_archive.get());
+    if(count == 0)
+      break; // should not happen
+    pos += static_cast<size_t>(count);
   }
 
-  m_archive.reset();
+  return pos == data.size();
 }
 
 bool CTWReader::readFile(const std::filesystem::path& filename, nlohmann::json& data)
 {
-  auto it = m_files.find(filename.string());
-  if(it == m_files.end())
+  std::string text;
+  if(!readFile(filename, text))
     return false;
 
-  std::string_view sv{reinterpret_cast<const char*>(it->second.data()), it->second.size()};
-  data = json::parse(sv.begin(), sv.end());
+  data = json::parse(text);
   return true;
 }
 
 bool CTWReader::readFile(const std::filesystem::path& filename, std::string& text)
 {
-  auto it = m_files.find(filename.generic_string());
-  if(it == m_files.end())
-    return false;
-
-  text.assign(reinterpret_cast<const char*>(it->second.data()), it->second.size());
-  return true;
+  archive_entry* entry = find(filename.generic_string());
+  return entry && readData(entry, text);
 }
@@ -3,7 +3,7 @@
  *
  * This file is part of the traintastic source code.
  *
- * Copyright (C) 2021-2022 Reinder Feenstra
+ * Copyright (C) 2021-2023 Reinder Feenstra
  *
  * This program is free software; you can redistribute it and/or
  * modify it under the terms of the GNU General Public License
@@ -30,22 +30,38 @@
 #include <nlohmann/json.hpp>
 
 struct archive;
+struct archive_entry;
 
+/**
+ * \brief Traintastic CTW (compressed world) reader
+ *
+ * Entries are located and decompressed on request, only the entry being read is held in memory.
+ * Reading entries in archive order is the fastest, seeking backwards requires the archive to be reopened.
+ */
 class CTWReader
 {
   private:
+    const std::filesystem::path m_filename;
+    const std::vector<std::byte>* m_memory = nullptr;
     std::unique_ptr<archive, void(*)(archive*)> m_archive;
-    std::unordered_map<std::string, std::vector<std::byte>> m_files;
+    std::unordered_map<std::string, size_t> m_index; //!< entry name to entry number
+    size_t m_position = 0; //!< number of the next entry header
+    bool m_indexComplete = false;
 
-    CTWReader();
-    void readFiles();
+    CTWReader(std::filesystem::path filename, const std::vector<std::byte>* memory);
+    void open();
+    archive_entry* find(const std::string& filename);
+    bool readData(archive_entry* entry, std::string& data);
 
   public:
     CTWReader(const std::filesystem::path& filename);
+    /**
+     * \param[in] memory CTW data, must stay valid for the lifetime of the reader
+     */
     CTWReader(const std::vector<std::byte>& memory);
 
     bool readFile(const std::filesystem::path& filename, nlohmann::json& data);
     bool readFile(const std::filesystem::path& filename, std::string& text);
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -220,11 +220,13 @@ World::World(Private /*unused*/) :
     {
       event(value ? WorldEvent::NoSmoke : WorldEvent::Smoke);
     }},
+  motionTickInterval{this, "motion_tick_interval", MotionScheduler::tickIntervalDefault, PropertyFlags::ReadWrite | PropertyFlags::Store | PropertyFlags::ScriptReadOnly},
   simulation{this, "simulation", false, PropertyFlags::ReadWrite | PropertyFlags::NoStore,
     [this](bool value)
     {
       event(value ? WorldEvent::SimulationEnabled : WorldEvent::SimulationDisabled);
     }},
+  simulationTimeWarp{this, "simulation_time_warp", TrainSimulator::timeWarpMin, PropertyFlags::ReadWrite | PropertyFlags::Store | PropertyFlags::ScriptReadOnly},
   save{*this, "save", MethodFlags::NoScript,
     [this]()
     {
@@ -371,9 +373,15 @@ World::World(Private /*unused*/) :
   m_interfaceItems.add(mute);
   Attributes::addObjectEditor(noSmoke, false);
   m_interfaceItems.add(noSmoke);
+  Attributes::addEnabled(motionTickInterval, false);
+  Attributes::addMinMax(motionTickInterval, MotionScheduler::tickIntervalMin, MotionScheduler::tickIntervalMax);
+  m_interfaceItems.add(motionTickInterval);
   Attributes::addEnabled(simulation, false);
   Attributes::addObjectEditor(simulation, false);
   m_interfaceItems.add(simulation);
+  Attributes::addEnabled(simulationTimeWarp, false);
+  Attributes::addMinMax(simulationTimeWarp, TrainSimulator::timeWarpMin, TrainSimulator::timeWarpMax);
+  m_interfaceItems.add(simulationTimeWarp);
 
   Attributes::addObjectEditor(save, false);
   m_interfaceItems.add(save);
@@ -492,6 +500,8 @@ void World::worldEvent(WorldState worldState, WorldEvent worldEvent)
 
   Attributes::setEnabled(scale, editState && !runState);
   Attributes::setEnabled(scaleRatio, editState && !runState);
+  Attributes::setEnabled(motionTickInterval, editState);
+  Attributes::setEnabled(simulationTimeWarp, editState);
 
   fireEvent(onEvent, worldState, worldEvent);
 }
@@ -60,6 +60,7 @@ class ControllerList;
 
 namespace Lua {
   class ScriptList;
+  class WorldSnapshot;
 }
 
 class World : public Object
@@ -69,6 +70,7 @@ class World : public Object
   friend class Traintastic;
   friend class WorldLoader;
   friend class WorldSaver;
+  friend class Lua::WorldSnapshot;
 
   private:
     struct Private {};
@@ -136,7 +138,9 @@ class World : public Object
     Method<void()> stop;
     Property<bool> mute;
     Property<bool> noSmoke;
+    Property<uint16_t> motionTickInterval; //!< ms between speed updates of accelerating and braking trains, see MotionScheduler
     Property<bool> simulation;
+    Property<uint16_t> simulationTimeWarp; //!< simulated seconds per real second, see TrainSimulator
 
     Method<void()> save;
 
@@ -23,6 +23,13 @@
 #include "worldlist.hpp"
 #include <fstream>
 #include <boost/uuid/string_generator.hpp>
+#include <boost/uuid/uuid_io.hpp>
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+#include "../core/eventloop.hpp"
+#include "../utils/writefile.hpp"
 #include "../traintastic/traintastic.hpp"
 #include "../log/log.hpp"
 #include "worldlisttablemodel.hpp"
@@ -31,13 +38,35 @@
 
 using nlohmann::json;
 
+#ifdef __linux__
+static constexpr auto rescanDelay = std::chrono::milliseconds(500);
+#endif
+
 WorldList::WorldList(const std::filesystem::path& path) :
   m_path{path}
+#ifdef __linux__
+  , m_inotify{EventLoop::ioContext}
+  , m_rescanTimer{EventLoop::ioContext}
+#endif
 {
   if(!std::filesystem::is_directory(m_path))
     std::filesystem::create_directories(m_path);
 
+  loadIndex();
   buildIndex();
+
+#ifdef __linux__
+  startWatch();
+#endif
+}
+
+WorldList::~WorldList()
+{
+#ifdef __linux__
+  m_rescanTimer.cancel();
+  boost::system::error_code ec;
+  m_inotify.close(ec);
+#endif
 }
 
 const WorldList::WorldInfo* WorldList::find(const boost::uuids::uuid& uuid)
@@ -55,12 +84,44 @@ void WorldList::buildIndex()
 
   m_items.clear();
 
+  // only keep index entries of worlds that still exist:
+  std::unordered_map<std::string, IndexEntry> index;
+  bool indexChanged = false;
+
   WorldInfo info;
   for(const auto& it : std::filesystem::directory_iterator(m_path))
   {
     info.path = it.path();
 
-    if(info.path.extension() == World::dotCTW)
+    const bool isCTW = info.path.extension() == World::dotCTW;
+    const auto worldFile = info.path / World::filename;
+    if(!isCTW && !(std::filesystem::is_directory(info.path) && std::filesystem::is_regular_file(worldFile)))
+      continue;
+
+    int64_t mtime;
+    uintmax_t size;
+    if(!getFileStamp(isCTW ? info.path : worldFile, mtime, size))
+      continue;
+
+#ifdef __linux__
+    if(!isCTW)
+      watchWorld(info.path);
+#endif
+
+    const auto key = info.path.filename().string();
+    if(auto entry = m_index.find(key); entry != m_index.end() && entry->second.mtime == mtime && entry->second.size == size)
+    {
+      // unchanged since last scan, no need to open it:
+      info.uuid = entry->second.uuid;
+      info.name = entry->second.name;
+      m_items.push_back(info);
+      index.emplace(key, std::move(entry->second));
+      continue;
+    }
+
+    indexChanged = true;
+
+    if(isCTW)
     {
       try
       {
@@ -69,39 +130,51 @@ void WorldList::buildIndex()
         json world;
         if(ctw.readFile(World::filename, world) && readInfo(world, info))
           m_items.push_back(info);
+        else
+          continue;
       }
       catch(const LibArchiveError& e)
       {
         Log::log(Traintastic::classId, LogMessage::W1003_READING_WORLD_X_FAILED_LIBARCHIVE_ERROR_X_X, info.path.filename(), e.errorCode, e.what());
+        continue;
       }
-      continue;
     }
-
-    const auto worldFile = info.path / World::filename;
-    if(std::filesystem::is_directory(info.path) && std::filesystem::is_regular_file(worldFile))
+    else
     {
       std::ifstream file(worldFile);
-      if(file.is_open())
+      if(!file.is_open())
+        continue;
+
+      try
+      {
+        json world = json::parse(file);
+
+        if(readInfo(world, info))
+          m_items.push_back(info);
+        else
+          continue;
+      }
+      catch(const std::exception& e)
       {
-        try
-        {
-          json world = json::parse(file);
-
-          if(readInfo(world, info))
-            m_items.push_back(info);
-        }
-        catch(const std::exception& e)
-        {
-          Log::log(Traintastic::classId, LogMessage::C1004_READING_WORLD_FAILED_X_X, e, worldFile);
-        }
+        Log::log(Traintastic::classId, LogMessage::C1004_READING_WORLD_FAILED_X_X, e, worldFile);
+        continue;
       }
     }
+
+    index.emplace(key, IndexEntry{mtime, size, info.uuid, info.name});
   }
 
+  if(index.size() != m_index.size())
+    indexChanged = true;
+
+  m_index = std::move(index);
+
+  if(indexChanged)
+    saveIndex();
+
   std::sort(m_items.begin(), m_items.end(), [](const WorldInfo& a, const WorldInfo& b) -> bool { return a > b; });
 
-  //for(auto& model : m_models)
-  //  model->setRowCount(m_items.size());
+  updateModels();
 }
 
 void WorldList::update(World& world, const std::filesystem::path& path)
@@ -117,7 +190,140 @@ void WorldList::update(World& world, const std::filesystem::path& path)
   {
     m_items.emplace_back(WorldInfo{uuid, world.name.value(), path});
   }
+
+  updateModels();
+}
+
+void WorldList::loadIndex()
+{
+  m_index.clear();
+
+  std::ifstream file(indexFilename());
+  if(!file.is_open())
+    return;
+
+  try
+  {
+    const json index = json::parse(file);
+    if(!index.is_object())
+      return;
+
+    for(const auto& [key, value] : index.items())
+    {
+      IndexEntry entry;
+      entry.mtime = value.value<int64_t>("mtime", 0);
+      entry.size = value.value<uintmax_t>("size", 0);
+      entry.uuid = boost::uuids::string_generator()(value.value<std::string>("uuid", ""));
+      entry.name = value.value<std::string>("name", "");
+      if(!entry.uuid.is_nil())
+        m_index.emplace(key, std::move(entry));
+    }
+  }
+  catch(const std::exception&)
+  {
+    m_index.clear(); // corrupt index, will be rebuilt
+  }
+}
+
+void WorldList::saveIndex()
+{
+  json index = json::object();
+  for(const auto& [key, entry] : m_index)
+  {
+    index[key] = {
+      {"mtime", entry.mtime},
+      {"size", entry.size},
+      {"uuid", to_string(entry.uuid)},
+      {"name", entry.name}};
+  }
+  writeFileJSON(indexFilename(), index);
+}
+
+void WorldList::updateModels()
+{
+  for(auto* model : m_models)
+    model->worldListChanged();
+}
+
+bool WorldList::getFileStamp(const std::filesystem::path& path, int64_t& mtime, uintmax_t& size)
+{
+  std::error_code ec;
+  const auto lastWriteTime = std::filesystem::last_write_time(path, ec);
+  if(ec)
+    return false;
+  size = std::filesystem::file_size(path, ec);
+  if(ec)
+    return false;
+  mtime = static_cast<int64_t>(lastWriteTime.time_since_epoch().count());
+  return true;
+}
+
+#ifdef __linux__
+void WorldList::startWatch()
+{
+  const int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if(fd < 0)
+    return; // no change notification, index is only rebuilt on restart
+
+  if(inotify_add_watch(fd, m_path.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE | IN_CREATE) < 0)
+  {
+    ::close(fd);
+    return;
+  }
+
+  m_inotify.assign(fd);
+
+  // world directories found by the initial scan, later ones are added by buildIndex:
+  for(const auto& info : m_items)
+    if(std::filesystem::is_directory(info.path))
+      watchWorld(info.path);
+
+  watchRead();
+}
+
+void WorldList::watchWorld(const std::filesystem::path& path)
+{
+  // saving a world rewrites the files inside its directory, the top level watch doesn't see that.
+  // Adding an existing watch again is a no-op, watches of removed directories are dropped by the kernel.
+  if(m_inotify.is_open())
+    inotify_add_watch(m_inotify.native_handle(), path.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE | IN_CREATE);
+}
+
+void WorldList::watchRead()
+{
+  m_inotify.async_read_some(boost::asio::buffer(m_inotifyBuffer),
+    [this](const boost::system::error_code& ec, std::size_t bytesTransferred)
+    {
+      if(ec)
+        return; // closed or failed, stop watching
+
+      bool rescan = false;
+      std::size_t pos = 0;
+      while(pos + sizeof(inotify_event) <= bytesTransferred)
+      {
+        const auto* event = reinterpret_cast<const inotify_event*>(m_inotifyBuffer.data() + pos);
+        // ignore hidden files, e.g. the index file itself:
+        if(event->len == 0 || event->name[0] != '.')
+          rescan = true;
+        pos += sizeof(inotify_event) + event->len;
+      }
+
+      if(rescan)
+      {
+        // worlds are written in several steps, wait until things settle down:
+        m_rescanTimer.expires_after(rescanDelay);
+        m_rescanTimer.async_wait(
+          [this](const boost::system::error_code& timerEc)
+          {
+            if(!timerEc)
+              buildIndex();
+          });
+      }
+
+      watchRead();
+    });
 }
+#endif
 
 TableModelPtr WorldList::getModel()
 {
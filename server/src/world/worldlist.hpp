@@ -27,7 +27,13 @@
 #include "../core/table.hpp"
 #include <traintastic/utils/stdfilesystem.hpp>
 #include <vector>
+#include <array>
+#include <unordered_map>
 #include <boost/uuid/uuid.hpp>
+#ifdef __linux__
+#include <boost/asio/posix/stream_descriptor.hpp>
+#include <boost/asio/steady_timer.hpp>
+#endif
 
 class World;
 class WorldListTableModel;
@@ -50,18 +56,45 @@ class WorldList : public Object, public Table
     };
 
   protected:
+    //! \brief Cached world info, used to skip unchanged worlds when building the index
+    struct IndexEntry
+    {
+      int64_t mtime;
+      uintmax_t size;
+      boost::uuids::uuid uuid;
+      std::string name;
+    };
+
     static bool readInfo(const nlohmann::json& world, WorldInfo& info);
+    static bool getFileStamp(const std::filesystem::path& path, int64_t& mtime, uintmax_t& size);
 
     const std::filesystem::path m_path;
     std::vector<WorldInfo> m_items;
     std::vector<WorldListTableModel*> m_models;
+    std::unordered_map<std::string, IndexEntry> m_index;
+#ifdef __linux__
+    boost::asio::posix::stream_descriptor m_inotify;
+    boost::asio::steady_timer m_rescanTimer;
+    alignas(uint32_t) std::array<char, 4096> m_inotifyBuffer;
+
+    void startWatch();
+    void watchWorld(const std::filesystem::path& path);
+    void watchRead();
+#endif
+
+    std::filesystem::path indexFilename() const { return m_path / indexFile; }
+    void loadIndex();
+    void saveIndex();
+    void updateModels();
 
   public:
     CLASS_ID("world_list");
 
     static constexpr std::string_view id = classId;
+    static constexpr std::string_view indexFile = ".worldindex.json";
 
     WorldList(const std::filesystem::path& path);
+    ~WorldList() override;
 
     std::string getObjectId() const final { return std::string(id); }
 
@@ -70,3 +70,9 @@ std::string WorldListTableModel::getText(uint32_t column, uint32_t row) const
   return "";
 }
 
+void WorldListTableModel::worldListChanged()
+{
+  setRowCount(static_cast<uint32_t>(m_worldList->m_items.size()));
+  if(rowCount() != 0 && updateRegion)
+    rowsChanged(0, rowCount() - 1);
+}
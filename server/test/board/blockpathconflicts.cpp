@@ -0,0 +1,186 @@
+/**
+ * server/test/board/blockpathconflicts.cpp
+ *
+ * This file is part of the traintastic test suite.
+ *
+ * Copyright (C) 2024 Reinder Feenstra
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+#include <catch2/catch.hpp>
+#include "layout.hpp"
+#include <chrono>
+#include "../../src/world/world.hpp"
+#include "../../src/core/method.tpp"
+#include "../../src/core/objectproperty.tpp"
+#include "../../src/board/board.hpp"
+#include "../../src/board/boardlist.hpp"
+#include "../../src/board/map/blockpath.hpp"
+#include "../../src/board/map/blockpathconflicts.hpp"
+#include "../../src/hardware/decoder/decoder.hpp"
+
+// Board, repeated n times:
+// +--------+                     +--------+
+// | block  |--(nx)--\---/--(nx)--| block  |
+// +--------+         \ /         +--------+
+//                     X
+// +--------+         / \         +--------+
+// | block  |--(nx)--/---\--(nx)--| block  |
+// +--------+                     +--------+
+static void addLayout(Board& board, size_t n)
+{
+  int16_t x = 0;
+  for(size_t i = 0; i < n; ++i, x += 6)
+  {
+    addCrossover(board, x);
+  }
+  REQUIRE(board.addTile(x, 0, TileRotate::Deg90, BlockRailTile::classId, false));
+  REQUIRE(board.addTile(x, 2, TileRotate::Deg90, BlockRailTile::classId, false));
+}
+
+static std::shared_ptr<BlockPath> getPath(const BlockRailTile& from, const std::shared_ptr<BlockRailTile>& to)
+{
+  for(const auto& path : from.paths())
+  {
+    if(path->toBlock() == to)
+    {
+      return path;
+    }
+  }
+  FAIL("no path");
+  return {};
+}
+
+TEST_CASE("Board: Block path conflicts", "[board][board-blockpathconflicts]")
+{
+  auto world = World::create();
+  auto board = world->boards->create();
+  addLayout(*board, 1);
+
+  const auto block1 = getBlock(*board, 0, 0);
+  const auto block2 = getBlock(*board, 6, 0);
+  const auto block3 = getBlock(*board, 0, 2);
+  const auto block4 = getBlock(*board, 6, 2);
+
+  world->edit = true;
+  world->edit = false; // update paths
+
+  auto& conflicts = world->boards->blockPathConflicts();
+  REQUIRE(conflicts.size() == 8); // each block has a path to both blocks on the other side
+
+  const auto path12 = getPath(*block1, block2);
+  const auto path14 = getPath(*block1, block4);
+  const auto path21 = getPath(*block2, block1);
+  const auto path32 = getPath(*block3, block2);
+  const auto path34 = getPath(*block3, block4);
+
+  REQUIRE(conflicts.conflicts(*path12, *path14)); // turnout
+  REQUIRE(conflicts.conflicts(*path14, *path12));
+  REQUIRE(conflicts.conflicts(*path12, *path21)); // same tiles
+  REQUIRE(conflicts.conflicts(*path14, *path34)); // turnout
+  REQUIRE_FALSE(conflicts.conflicts(*path12, *path34)); // parallel
+  REQUIRE_FALSE(conflicts.conflicts(*path14, *path32)); // other bridge track
+
+  REQUIRE(conflicts.isFree(*path12));
+  conflicts.reserve(*path14);
+  REQUIRE_FALSE(conflicts.isFree(*path12));
+  REQUIRE_FALSE(conflicts.isFree(*path34));
+  REQUIRE(conflicts.isFree(*path32));
+  REQUIRE(conflicts.conflictsWithReserved(*path12));
+  REQUIRE_FALSE(conflicts.conflictsWithReserved(*path32));
+  conflicts.release(*path14);
+  REQUIRE(conflicts.isFree(*path12));
+  REQUIRE_FALSE(conflicts.conflictsWithReserved(*path12));
+
+  // remove straight between block 1 and 2, removes paths 1->2 and 2->1:
+  world->edit = true;
+  REQUIRE(board->deleteTile(3, 0));
+  world->edit = false;
+  REQUIRE(conflicts.size() == 6);
+  REQUIRE_FALSE(conflicts.conflicts(*path12, *path14));
+  REQUIRE(conflicts.conflicts(*getPath(*block1, block4), *getPath(*block3, block4)));
+}
+
+TEST_CASE("Board: Block path conflicts: benchmark", "[.][board][board-blockpathconflicts][board-benchmark]")
+{
+  constexpr size_t crossovers = 249; // 500 blocks
+
+  auto world = World::create();
+  auto board = world->boards->create();
+  addLayout(*board, crossovers);
+
+  world->edit = true;
+  const auto buildStart = std::chrono::steady_clock::now();
+  world->edit = false; // update paths and conflicts
+  const auto buildDuration = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - buildStart);
+
+  std::vector<std::shared_ptr<BlockPath>> paths;
+  for(int16_t x = 0; x <= static_cast<int16_t>(crossovers * 6); x += 6)
+  {
+    for(int16_t y : {0, 2})
+    {
+      auto block = getBlock(*board, x, y);
+      REQUIRE(block->setStateFree());
+      paths.insert(paths.end(), block->paths().begin(), block->paths().end());
+    }
+  }
+
+  auto& conflicts = world->boards->blockPathConflicts();
+  REQUIRE(conflicts.size() == paths.size());
+
+  // reserve every fourth path, if possible:
+  for(size_t i = 0; i < paths.size(); i += 4)
+  {
+    if(conflicts.isFree(*paths[i]))
+    {
+      conflicts.reserve(*paths[i]);
+    }
+  }
+
+  constexpr size_t iterations = 100;
+  size_t free = 0;
+
+  const auto bitsetStart = std::chrono::steady_clock::now();
+  for(size_t n = 0; n < iterations; ++n)
+  {
+    for(const auto& path : paths)
+    {
+      if(conflicts.isFree(*path))
+      {
+        free++;
+      }
+    }
+  }
+  const auto bitsetDuration = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - bitsetStart);
+  REQUIRE(free > 0);
+
+  const std::shared_ptr<Train> noTrain;
+  const auto dryRunStart = std::chrono::steady_clock::now();
+  for(size_t n = 0; n < iterations; ++n)
+  {
+    for(const auto& path : paths)
+    {
+      path->reserve(noTrain, true);
+    }
+  }
+  const auto dryRunDuration = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - dryRunStart);
+
+  const auto checks = iterations * paths.size();
+  WARN("block path conflicts: " << paths.size() << " paths, build " << buildDuration.count() << " us, "
+    << "isFree " << (bitsetDuration.count() / checks) << " ns per path, "
+    << "dry run reserve " << (dryRunDuration.count() / checks) << " ns per path");
+}
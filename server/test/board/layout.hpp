@@ -0,0 +1,89 @@
+/**
+ * server/test/board/layout.hpp
+ *
+ * This file is part of the traintastic test suite.
+ *
+ * Copyright (C) 2024 Reinder Feenstra
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef TRAINTASTIC_SERVER_TEST_BOARD_LAYOUT_HPP
+#define TRAINTASTIC_SERVER_TEST_BOARD_LAYOUT_HPP
+
+#include <catch2/catch.hpp>
+#include "../../src/board/board.hpp"
+#include "../../src/board/tile/rail/blockrailtile.hpp"
+#include "../../src/board/tile/rail/bridge90railtile.hpp"
+#include "../../src/board/tile/rail/nxbuttonrailtile.hpp"
+#include "../../src/board/tile/rail/straightrailtile.hpp"
+#include "../../src/board/tile/rail/turnout/turnoutleft45railtile.hpp"
+#include "../../src/board/tile/rail/turnout/turnoutright45railtile.hpp"
+
+// Crossover at column x, the blocks at the right side must be added by the next crossover or the caller:
+// +--------+                     +--------+
+// | block  |--(nx)--\---/--(nx)--| block  |
+// +--------+         \ /         +--------+
+//                     X
+// +--------+         / \         +--------+
+// | block  |--(nx)--/---\--(nx)--| block  |
+// +--------+                     +--------+
+// x        x+1     x+2 x+3 x+4   x+5     x+6
+inline void addCrossover(Board& board, int16_t x)
+{
+  for(int16_t y : {0, 2})
+  {
+    REQUIRE(board.addTile(x, y, TileRotate::Deg90, BlockRailTile::classId, false));
+    REQUIRE(board.addTile(x + 1, y, TileRotate::Deg90, NXButtonRailTile::classId, false));
+    REQUIRE(board.addTile(x + 3, y, TileRotate::Deg90, StraightRailTile::classId, false));
+    REQUIRE(board.addTile(x + 5, y, TileRotate::Deg90, NXButtonRailTile::classId, false));
+  }
+  REQUIRE(board.addTile(x + 2, 0, TileRotate::Deg90, TurnoutRight45RailTile::classId, false));
+  REQUIRE(board.addTile(x + 4, 0, TileRotate::Deg270, TurnoutLeft45RailTile::classId, false));
+  REQUIRE(board.addTile(x + 3, 1, TileRotate::Deg45, Bridge90RailTile::classId, false));
+  REQUIRE(board.addTile(x + 2, 2, TileRotate::Deg90, TurnoutLeft45RailTile::classId, false));
+  REQUIRE(board.addTile(x + 4, 2, TileRotate::Deg270, TurnoutRight45RailTile::classId, false));
+}
+
+// Blocks in a straight line, from west to east:
+// +---+   +---+       +---+
+// |   |---|   |- ... -|   |
+// +---+   +---+       +---+
+inline std::vector<std::shared_ptr<BlockRailTile>> addStraightLine(Board& board, int16_t blockCount)
+{
+  std::vector<std::shared_ptr<BlockRailTile>> blocks;
+  const int16_t xMax = 2 * (blockCount - 1);
+  for(int16_t x = 0; x <= xMax; x += 2)
+  {
+    REQUIRE(board.addTile(x, 0, TileRotate::Deg90, BlockRailTile::classId, false));
+    if(x < xMax)
+    {
+      REQUIRE(board.addTile(x + 1, 0, TileRotate::Deg90, StraightRailTile::classId, false));
+    }
+    auto block = std::dynamic_pointer_cast<BlockRailTile>(board.getTile({x, 0}));
+    REQUIRE(block);
+    blocks.emplace_back(block);
+  }
+  return blocks;
+}
+
+inline std::shared_ptr<BlockRailTile> getBlock(Board& board, int16_t x, int16_t y)
+{
+  auto block = std::dynamic_pointer_cast<BlockRailTile>(board.getTile({x, y}));
+  REQUIRE(block);
+  return block;
+}
+
+#endif
@@ -0,0 +1,228 @@
+/**
+ * server/test/board/modified.cpp
+ *
+ * This file is part of the traintastic test suite.
+ *
+ * Copyright (C) 2024 Reinder Feenstra
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <catch2/catch.hpp>
+#include "../../src/core/eventloop.hpp"
+#include "../../src/world/world.hpp"
+#include "../../src/core/method.tpp"
+#include "../../src/core/objectproperty.tpp"
+#include "../../src/board/board.hpp"
+#include "../../src/board/boardlist.hpp"
+#include "../../src/board/map/blockpath.hpp"
+#include "../../src/board/tile/rail/blockrailtile.hpp"
+#include "../../src/board/tile/rail/linkrailtile.hpp"
+#include "../../src/board/tile/rail/signal/signal3aspectrailtile.hpp"
+#include "../../src/board/tile/rail/straightrailtile.hpp"
+
+TEST_CASE("Board: Update block paths after modification", "[board][board-modified]")
+{
+  auto world = World::create();
+  world->edit = true;
+
+  // Board:
+  // +--------+               +--------+
+  // | block1 |---------------| block2 |
+  // +--------+               +--------+
+  //
+  // +--------+               +--------+
+  // | block3 |---------------| block4 |
+  // +--------+               +--------+
+  auto board = world->boards->create();
+
+  for(int16_t y : {0, 2})
+  {
+    REQUIRE(board->addTile(0, y, TileRotate::Deg90, BlockRailTile::classId, false));
+    REQUIRE(board->addTile(1, y, TileRotate::Deg90, StraightRailTile::classId, false));
+    REQUIRE(board->addTile(2, y, TileRotate::Deg90, StraightRailTile::classId, false));
+    REQUIRE(board->addTile(3, y, TileRotate::Deg90, BlockRailTile::classId, false));
+  }
+
+  auto block1 = std::dynamic_pointer_cast<BlockRailTile>(board->getTile({0, 0}));
+  REQUIRE(block1);
+  auto block2 = std::dynamic_pointer_cast<BlockRailTile>(board->getTile({3, 0}));
+  REQUIRE(block2);
+  auto block3 = std::dynamic_pointer_cast<BlockRailTile>(board->getTile({0, 2}));
+  REQUIRE(block3);
+  auto block4 = std::dynamic_pointer_cast<BlockRailTile>(board->getTile({3, 2}));
+  REQUIRE(block4);
+
+  world->edit = false;
+  REQUIRE(block1->paths().size() == 1);
+  REQUIRE(block1->paths()[0]->toBlock() == block2);
+  REQUIRE(block2->paths().size() == 1);
+  REQUIRE(block2->paths()[0]->toBlock() == block1);
+  REQUIRE(block3->paths().size() == 1);
+  REQUIRE(block4->paths().size() == 1);
+  const auto block3Path = block3->paths()[0];
+
+  // Delete tile between block 1 and 2:
+  world->edit = true;
+  REQUIRE(board->deleteTile(2, 0));
+  BlockPath::findCount = 0;
+  world->edit = false;
+  REQUIRE(BlockPath::findCount == 2); // only block 1 and 2 are updated
+  REQUIRE(block1->paths().empty());
+  REQUIRE(block2->paths().empty());
+  REQUIRE(block3->paths().size() == 1);
+  REQUIRE(block3->paths()[0] == block3Path); // not affected
+  REQUIRE(block4->paths().size() == 1);
+
+  // Add it again:
+  world->edit = true;
+  REQUIRE(board->addTile(2, 0, TileRotate::Deg90, StraightRailTile::classId, false));
+  BlockPath::findCount = 0;
+  world->edit = false;
+  REQUIRE(BlockPath::findCount == 2);
+  REQUIRE(block1->paths().size() == 1);
+  REQUIRE(block1->paths()[0]->toBlock() == block2);
+  REQUIRE(block2->paths().size() == 1);
+  REQUIRE(block2->paths()[0]->toBlock() == block1);
+
+  // Move block 2 away:
+  world->edit = true;
+  REQUIRE(board->moveTile(3, 0, 5, 0, TileRotate::Deg90, false));
+  BlockPath::findCount = 0;
+  world->edit = false;
+  REQUIRE(BlockPath::findCount == 2); // block 1 and 2 (which has no neighbours anymore)
+  REQUIRE(block1->paths().empty());
+  REQUIRE(block2->paths().empty());
+
+  // Move it back:
+  world->edit = true;
+  REQUIRE(board->moveTile(5, 0, 3, 0, TileRotate::Deg90, false));
+  world->edit = false;
+  REQUIRE(block1->paths().size() == 1);
+  REQUIRE(block1->paths()[0]->toBlock() == block2);
+  REQUIRE(block2->paths().size() == 1);
+  REQUIRE(block3->paths().size() == 1);
+  REQUIRE(block3->paths()[0] == block3Path);
+}
+
+TEST_CASE("Board: Update block paths after changing a link", "[board][board-modified]")
+{
+  auto world = World::create();
+  world->edit = true;
+
+  // Board 1:                   Board 2:
+  // +--------+                 +--------+
+  // | block1 |------- link1    link2 -------| block2 |
+  // +--------+                 +--------+
+  //
+  // Board 1 also has an unrelated block3/block4 pair.
+  auto board1 = world->boards->create();
+  REQUIRE(board1->addTile(0, 0, TileRotate::Deg90, BlockRailTile::classId, false));
+  REQUIRE(board1->addTile(1, 0, TileRotate::Deg90, StraightRailTile::classId, false));
+  REQUIRE(board1->addTile(2, 0, TileRotate::Deg90, LinkRailTile::classId, false));
+  REQUIRE(board1->addTile(0, 2, TileRotate::Deg90, BlockRailTile::classId, false));
+  REQUIRE(board1->addTile(1, 2, TileRotate::Deg90, StraightRailTile::classId, false));
+  REQUIRE(board1->addTile(2, 2, TileRotate::Deg90, BlockRailTile::classId, false));
+
+  auto board2 = world->boards->create();
+  REQUIRE(board2->addTile(0, 0, TileRotate::Deg270, LinkRailTile::classId, false));
+  REQUIRE(board2->addTile(1, 0, TileRotate::Deg90, StraightRailTile::classId, false));
+  REQUIRE(board2->addTile(2, 0, TileRotate::Deg90, BlockRailTile::classId, false));
+
+  auto block1 = std::dynamic_pointer_cast<BlockRailTile>(board1->getTile({0, 0}));
+  auto link1 = std::dynamic_pointer_cast<LinkRailTile>(board1->getTile({2, 0}));
+  auto block3 = std::dynamic_pointer_cast<BlockRailTile>(board1->getTile({0, 2}));
+  auto link2 = std::dynamic_pointer_cast<LinkRailTile>(board2->getTile({0, 0}));
+  auto block2 = std::dynamic_pointer_cast<BlockRailTile>(board2->getTile({2, 0}));
+  REQUIRE(block1);
+  REQUIRE(link1);
+  REQUIRE(block3);
+  REQUIRE(link2);
+  REQUIRE(block2);
+
+  world->edit = false;
+  REQUIRE(block1->paths().empty());
+  REQUIRE(block2->paths().empty());
+  REQUIRE(block3->paths().size() == 1);
+
+  // Connect the links, both boards are modified:
+  world->edit = true;
+  link1->link = link2;
+  BlockPath::findCount = 0;
+  world->edit = false;
+  REQUIRE(BlockPath::findCount == 2); // only block 1 and 2 are updated
+  REQUIRE(block1->paths().size() == 1);
+  REQUIRE(block1->paths()[0]->toBlock() == block2);
+  REQUIRE(block2->paths().size() == 1);
+  REQUIRE(block2->paths()[0]->toBlock() == block1);
+
+  // Disconnect from the other end:
+  world->edit = true;
+  link2->link = nullptr;
+  world->edit = false;
+  REQUIRE(block1->paths().empty());
+  REQUIRE(block2->paths().empty());
+  REQUIRE(block3->paths().size() == 1);
+}
+
+TEST_CASE("Board: Update signal path after modification beyond the first block", "[board][board-modified]")
+{
+  auto world = World::create();
+  world->edit = true;
+
+  // Board:
+  // +--------+      +--------+               +--------+
+  // | block0 |--|>--| block1 |---------------| block2 |
+  // +--------+      +--------+               +--------+
+  //            3-aspect signal, looks two blocks ahead
+  auto board = world->boards->create();
+  REQUIRE(board->addTile(0, 0, TileRotate::Deg90, BlockRailTile::classId, false));
+  REQUIRE(board->addTile(1, 0, TileRotate::Deg90, Signal3AspectRailTile::classId, false));
+  REQUIRE(board->addTile(2, 0, TileRotate::Deg90, BlockRailTile::classId, false));
+  REQUIRE(board->addTile(3, 0, TileRotate::Deg90, StraightRailTile::classId, false));
+  REQUIRE(board->addTile(4, 0, TileRotate::Deg90, StraightRailTile::classId, false));
+  REQUIRE(board->addTile(5, 0, TileRotate::Deg90, BlockRailTile::classId, false));
+
+  auto signal = std::dynamic_pointer_cast<Signal3AspectRailTile>(board->getTile({1, 0}));
+  REQUIRE(signal);
+  auto block1 = std::dynamic_pointer_cast<BlockRailTile>(board->getTile({2, 0}));
+  REQUIRE(block1);
+  auto block2 = std::dynamic_pointer_cast<BlockRailTile>(board->getTile({5, 0}));
+  REQUIRE(block2);
+
+  world->edit = false; // builds the signal path
+  REQUIRE(block1->setStateFree());
+  REQUIRE(block2->setStateFree());
+  EventLoop::ioContext.restart();
+  EventLoop::ioContext.poll();
+  REQUIRE(signal->aspect.value() == SignalAspect::Proceed);
+
+  // Delete tile between block 1 and 2, the signal can't see block 2 anymore:
+  world->edit = true;
+  REQUIRE(board->deleteTile(4, 0));
+  world->edit = false;
+  EventLoop::ioContext.restart();
+  EventLoop::ioContext.poll();
+  REQUIRE(block1->state.value() == BlockState::Free);
+  REQUIRE(signal->aspect.value() == SignalAspect::ProceedReducedSpeed);
+
+  // Add it again:
+  world->edit = true;
+  REQUIRE(board->addTile(4, 0, TileRotate::Deg90, StraightRailTile::classId, false));
+  world->edit = false;
+  EventLoop::ioContext.restart();
+  EventLoop::ioContext.poll();
+  REQUIRE(signal->aspect.value() == SignalAspect::Proceed);
+}
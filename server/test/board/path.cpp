@@ -26,10 +26,12 @@
 #include "../../src/core/objectproperty.tpp"
 #include "../../src/board/board.hpp"
 #include "../../src/board/boardlist.hpp"
+#include "../../src/board/map/blockpath.hpp"
 #include "../../src/board/nx/nxmanager.hpp"
 #include "../../src/board/tile/rail/blockrailtile.hpp"
 #include "../../src/board/tile/rail/bridge90railtile.hpp"
 #include "../../src/board/tile/rail/nxbuttonrailtile.hpp"
+#include "../../src/board/tile/rail/straightrailtile.hpp"
 #include "../../src/board/tile/rail/turnout/turnoutleft45railtile.hpp"
 #include "../../src/board/tile/rail/turnout/turnoutright45railtile.hpp"
 #include "../../src/hardware/decoder/decoder.hpp"
@@ -157,3 +159,70 @@ TEST_CASE("Board: Bridge path resevation using NX", "[board][board-path]")
   REQUIRE(train1.expired());
   REQUIRE(train2.expired());
 }
+
+TEST_CASE("Board: Block paths are kept if unchanged", "[board][board-path]")
+{
+  auto world = World::create();
+
+  // Board:
+  // +--------+   +--------+   +--------+
+  // | block1 |---| block2 |---| block3 |
+  // +--------+   +--------+   +--------+
+  auto board = world->boards->create();
+  for(int16_t x : {0, 2, 4})
+    REQUIRE(board->addTile(x, 0, TileRotate::Deg90, BlockRailTile::classId, false));
+  for(int16_t x : {1, 3})
+    REQUIRE(board->addTile(x, 0, TileRotate::Deg90, StraightRailTile::classId, false));
+
+  auto block1 = std::dynamic_pointer_cast<BlockRailTile>(board->getTile({0, 0}));
+  auto block2 = std::dynamic_pointer_cast<BlockRailTile>(board->getTile({2, 0}));
+  auto block3 = std::dynamic_pointer_cast<BlockRailTile>(board->getTile({4, 0}));
+  REQUIRE(block1);
+  REQUIRE(block2);
+  REQUIRE(block3);
+
+  BlockPath::findCount = 0;
+  world->edit = true;
+  world->edit = false;
+  REQUIRE(BlockPath::findCount == 3);
+
+  const auto paths1 = block1->paths();
+  const auto paths2 = block2->paths();
+  const auto paths3 = block3->paths();
+  REQUIRE(paths1.size() == 1);
+  REQUIRE(paths2.size() == 2);
+  REQUIRE(paths3.size() == 1);
+  REQUIRE(paths1[0]->toBlock() == block2);
+  REQUIRE(paths1[0]->length() == 1);
+
+  // move a tile away and back, block 2 and 3 are updated, the found paths are equal so the existing are kept:
+  world->edit = true;
+  REQUIRE(board->moveTile(3, 0, 3, 2, TileRotate::Deg90, false));
+  REQUIRE(board->moveTile(3, 2, 3, 0, TileRotate::Deg90, false));
+  BlockPath::findCount = 0;
+  world->edit = false;
+  REQUIRE(BlockPath::findCount == 2);
+  REQUIRE(block1->paths() == paths1);
+  REQUIRE(block2->paths() == paths2);
+  REQUIRE(block3->paths() == paths3);
+
+  // disconnect block2 and block3, block1 can't reach the change:
+  world->edit = true;
+  REQUIRE(board->deleteTile(3, 0));
+  BlockPath::findCount = 0;
+  world->edit = false;
+  REQUIRE(BlockPath::findCount == 2);
+  REQUIRE(block1->paths() == paths1);
+  REQUIRE(block2->paths().size() == 1);
+  REQUIRE(block3->paths().empty());
+
+  // a new tile at the same location, the paths are equal in shape but use another tile:
+  world->edit = true;
+  REQUIRE(board->addTile(3, 0, TileRotate::Deg90, StraightRailTile::classId, false));
+  BlockPath::findCount = 0;
+  world->edit = false;
+  REQUIRE(BlockPath::findCount == 2);
+  REQUIRE(block2->paths().size() == 2);
+  REQUIRE(block2->paths() != paths2);
+  REQUIRE(block3->paths().size() == 1);
+}
@@ -0,0 +1,160 @@
+/**
+ * server/test/board/routegraph.cpp
+ *
+ * This file is part of the traintastic test suite.
+ *
+ * Copyright (C) 2024 Reinder Feenstra
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+#include <catch2/catch.hpp>
+#include "layout.hpp"
+#include "../../src/world/world.hpp"
+#include "../../src/core/method.tpp"
+#include "../../src/core/objectproperty.tpp"
+#include "../../src/board/board.hpp"
+#include "../../src/board/boardlist.hpp"
+#include "../../src/board/map/blockpath.hpp"
+#include "../../src/board/map/routegraph.hpp"
+#include "../../src/board/nx/nxmanager.hpp"
+#include "../../src/hardware/decoder/decoder.hpp"
+#include "../../src/vehicle/rail/railvehiclelist.hpp"
+#include "../../src/vehicle/rail/locomotive.hpp"
+#include "../../src/train/trainlist.hpp"
+#include "../../src/train/train.hpp"
+#include "../../src/train/trainvehiclelist.hpp"
+#include "../../src/train/trainblockstatus.hpp"
+
+// Board:
+// +--------+                     +--------+                     +--------+
+// | block1 |--(nx)--\---/--(nx)--| block2 |--(nx)--\---/--(nx)--| block5 |
+// +--------+         \ /         +--------+         \ /         +--------+
+//                     X                              X
+// +--------+         / \         +--------+         / \         +--------+
+// | block3 |--(nx)--/---\--(nx)--| block4 |--(nx)--/---\--(nx)--| block6 |
+// +--------+                     +--------+                     +--------+
+TEST_CASE("Board: Route graph", "[board][board-routegraph]")
+{
+  auto world = World::create();
+  auto board = world->boards->create();
+  addCrossover(*board, 0);
+  addCrossover(*board, 6);
+  REQUIRE(board->addTile(12, 0, TileRotate::Deg90, BlockRailTile::classId, false));
+  REQUIRE(board->addTile(12, 2, TileRotate::Deg90, BlockRailTile::classId, false));
+
+  const auto block1 = getBlock(*board, 0, 0);
+  const auto block2 = getBlock(*board, 6, 0);
+  const auto block4 = getBlock(*board, 6, 2);
+  const auto block5 = getBlock(*board, 12, 0);
+
+  world->edit = true;
+  world->edit = false; // update paths
+
+  const auto& routeGraph = world->boards->routeGraph();
+  REQUIRE(routeGraph.size() == 6);
+
+  SECTION("shortest")
+  {
+    auto route = routeGraph.shortest(*block1, *block5);
+    REQUIRE(route);
+    REQUIRE(route->paths.size() == 2);
+    REQUIRE(&route->paths[0]->fromBlock() == block1.get());
+    REQUIRE(route->paths[1]->toBlock() == block5);
+    REQUIRE(route->turnouts == 4);
+    REQUIRE(route->cost == route->length + 2 + 4 * RouteGraph::turnoutCost);
+
+    // only one side of block 1 is connected:
+    REQUIRE(routeGraph.shortest(*block1, *block5, BlockSide::A).has_value() != routeGraph.shortest(*block1, *block5, BlockSide::B).has_value());
+
+    REQUIRE(routeGraph.shortest(*block5, *block1)); // reverse direction
+    REQUIRE_FALSE(routeGraph.shortest(*block1, *block1));
+  }
+
+  SECTION("k-shortest")
+  {
+    auto routes = routeGraph.kShortest(*block1, *block5, 4);
+    REQUIRE(routes.size() == 2); // via block 2 and via block 4
+    REQUIRE(routes[0].cost <= routes[1].cost);
+    REQUIRE(routes[0].paths[0]->toBlock() != routes[1].paths[0]->toBlock());
+    for(const auto& route : routes)
+    {
+      REQUIRE(route.paths.size() == 2);
+      const auto via = route.paths[0]->toBlock();
+      REQUIRE((via == block2 || via == block4));
+      REQUIRE(route.paths[1]->toBlock() == block5);
+    }
+
+    REQUIRE(routeGraph.kShortest(*block1, *block5, 1).size() == 1);
+  }
+
+  SECTION("incremental update")
+  {
+    // remove straight between block 1 and 2, only the route via block 4 is left:
+    world->edit = true;
+    REQUIRE(board->deleteTile(3, 0));
+    world->edit = false;
+
+    auto routes = routeGraph.kShortest(*block1, *block5, 4);
+    REQUIRE(routes.size() == 1);
+    REQUIRE(routes[0].paths[0]->toBlock() == block4);
+
+    // remove block 4, no route left:
+    world->edit = true;
+    REQUIRE(board->deleteTile(6, 2));
+    world->edit = false;
+
+    REQUIRE(routeGraph.size() == 5);
+    REQUIRE_FALSE(routeGraph.shortest(*block1, *block5));
+  }
+}
+
+TEST_CASE("Board: NX route via multiple blocks", "[board][board-routegraph]")
+{
+  auto world = World::create();
+  auto board = world->boards->create();
+  addCrossover(*board, 0);
+  addCrossover(*board, 6);
+  REQUIRE(board->addTile(12, 0, TileRotate::Deg90, BlockRailTile::classId, false));
+  REQUIRE(board->addTile(12, 2, TileRotate::Deg90, BlockRailTile::classId, false));
+
+  const auto block1 = getBlock(*board, 0, 0);
+  const auto block5 = getBlock(*board, 12, 0);
+  auto nxFrom = std::dynamic_pointer_cast<NXButtonRailTile>(board->getTile({1, 0}));
+  REQUIRE(nxFrom);
+  auto nxTo = std::dynamic_pointer_cast<NXButtonRailTile>(board->getTile({11, 0}));
+  REQUIRE(nxTo);
+
+  for(auto [x, y] : {std::pair<int16_t, int16_t>{6, 0}, {6, 2}, {12, 0}, {12, 2}})
+  {
+    REQUIRE(getBlock(*board, x, y)->setStateFree());
+  }
+
+  std::shared_ptr<RailVehicle> locomotive = world->railVehicles->create(Locomotive::classId);
+  std::shared_ptr<Train> train = world->trains->create();
+  train->vehicles->add(locomotive);
+
+  block1->assignTrain(train);
+  REQUIRE(block1->state == BlockState::Reserved);
+  block1->flipTrain();
+
+  world->run();
+
+  world->nxManager->select(nxFrom, nxTo);
+  REQUIRE(block5->state == BlockState::Reserved);
+  REQUIRE(block5->trains.size() == 1);
+  REQUIRE(block5->trains[0]->train.value() == train);
+}
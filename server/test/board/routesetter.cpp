@@ -0,0 +1,237 @@
+/**
+ * server/test/board/routesetter.cpp
+ *
+ * This file is part of the traintastic test suite.
+ *
+ * Copyright (C) 2024 Reinder Feenstra
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <catch2/catch.hpp>
+#include "layout.hpp"
+#include "../../src/world/world.hpp"
+#include "../../src/core/eventloop.hpp"
+#include "../../src/core/method.tpp"
+#include "../../src/core/objectproperty.tpp"
+#include "../../src/board/board.hpp"
+#include "../../src/board/boardlist.hpp"
+#include "../../src/board/map/blockpath.hpp"
+#include "../../src/board/map/routesetter.hpp"
+#include "../../src/board/nx/nxmanager.hpp"
+#include "../../src/hardware/decoder/decoder.hpp"
+#include "../../src/vehicle/rail/railvehiclelist.hpp"
+#include "../../src/vehicle/rail/locomotive.hpp"
+#include "../../src/train/trainlist.hpp"
+#include "../../src/train/train.hpp"
+#include "../../src/train/trainvehiclelist.hpp"
+
+// Board:
+// +--------+                     +--------+
+// | block1 |--(nx)--\---/--(nx)--| block2 |
+// +--------+         \ /         +--------+
+//                     X
+// +--------+         / \         +--------+
+// | block3 |--(nx)--/---\--(nx)--| block4 |
+// +--------+                     +--------+
+
+static std::shared_ptr<TurnoutRailTile> getTurnout(Board& board, int16_t x, int16_t y)
+{
+  auto turnout = std::dynamic_pointer_cast<TurnoutRailTile>(board.getTile({x, y}));
+  REQUIRE(turnout);
+  return turnout;
+}
+
+TEST_CASE("Board: Route setter", "[board][board-routesetter]")
+{
+  auto world = World::create();
+  auto board = world->boards->create();
+  addCrossover(*board, 0);
+  REQUIRE(board->addTile(6, 0, TileRotate::Deg90, BlockRailTile::classId, false));
+  REQUIRE(board->addTile(6, 2, TileRotate::Deg90, BlockRailTile::classId, false));
+
+  world->edit = true;
+  world->edit = false; // update paths
+
+  const auto block1 = getBlock(*board, 0, 0);
+  const auto block2 = getBlock(*board, 6, 0);
+  const auto turnout1 = getTurnout(*board, 2, 0);
+  const auto turnout2 = getTurnout(*board, 4, 0);
+  REQUIRE(block2->setStateFree());
+
+  std::shared_ptr<RailVehicle> locomotive = world->railVehicles->create(Locomotive::classId);
+  std::shared_ptr<Train> train = world->trains->create();
+  train->vehicles->add(locomotive);
+  block1->assignTrain(train);
+  block1->flipTrain();
+
+  std::shared_ptr<BlockPath> path;
+  for(const auto& item : block1->paths())
+  {
+    if(item->toBlock() == block2)
+    {
+      path = item;
+    }
+  }
+  REQUIRE(path);
+
+  auto& routeSetter = world->boards->routeSetter();
+  std::vector<std::shared_ptr<BlockPath>> routesSet;
+  routeSetter.routeSet.connect(
+    [&routesSet](const std::shared_ptr<BlockPath>& item)
+    {
+      routesSet.emplace_back(item);
+    });
+  std::vector<std::shared_ptr<BlockPath>> routesFailed;
+  routeSetter.routeFailed.connect(
+    [&routesFailed](const std::shared_ptr<BlockPath>& item)
+    {
+      routesFailed.emplace_back(item);
+    });
+
+  SECTION("set turnouts")
+  {
+    REQUIRE_FALSE(path->isSet());
+    REQUIRE(path->reserve(train));
+
+    // commands are sent in the next event loop iteration:
+    REQUIRE(turnout1->position == TurnoutPosition::Unknown);
+    REQUIRE(turnout2->position == TurnoutPosition::Unknown);
+    REQUIRE(routeSetter.pendingCount() == 1);
+
+    EventLoop::ioContext.restart();
+    EventLoop::ioContext.poll();
+
+    REQUIRE(turnout1->position == TurnoutPosition::Straight);
+    REQUIRE(turnout2->position == TurnoutPosition::Straight);
+    REQUIRE(path->isSet());
+    REQUIRE(routeSetter.commandCount() == 2);
+    REQUIRE(routeSetter.skippedCount() == 0);
+    REQUIRE(routeSetter.pendingCount() == 0);
+    REQUIRE(routesSet.size() == 1);
+    REQUIRE(routesSet[0] == path);
+  }
+
+  SECTION("skip turnouts in position")
+  {
+    REQUIRE(turnout1->setPosition(TurnoutPosition::Straight));
+    REQUIRE(turnout2->setPosition(TurnoutPosition::Straight));
+    REQUIRE(path->isSet());
+
+    REQUIRE(path->reserve(train));
+    REQUIRE(routeSetter.skippedCount() == 2);
+
+    EventLoop::ioContext.restart();
+    EventLoop::ioContext.poll();
+
+    REQUIRE(routeSetter.commandCount() == 0);
+    REQUIRE(routeSetter.pendingCount() == 0);
+    REQUIRE(routesSet.size() == 1);
+  }
+
+  SECTION("release cancels commands")
+  {
+    REQUIRE(path->reserve(train));
+    REQUIRE(routeSetter.isPending(*path));
+    REQUIRE(path->release());
+    REQUIRE_FALSE(routeSetter.isPending(*path));
+    REQUIRE(routeSetter.pendingCount() == 0);
+
+    EventLoop::ioContext.restart();
+    EventLoop::ioContext.poll();
+
+    REQUIRE(turnout1->position == TurnoutPosition::Unknown);
+    REQUIRE(turnout2->position == TurnoutPosition::Unknown);
+    REQUIRE(routeSetter.commandCount() == 0);
+    REQUIRE(routesSet.empty());
+    REQUIRE(routesFailed.empty());
+  }
+
+  SECTION("turnout can't be set")
+  {
+    routeSetter.set(path, {{turnout1, TurnoutPosition::Left}}); // right turnout has no left position
+
+    EventLoop::ioContext.restart();
+    EventLoop::ioContext.poll();
+
+    REQUIRE(turnout1->position == TurnoutPosition::Unknown);
+    REQUIRE(routeSetter.commandCount() == 0);
+    REQUIRE(routeSetter.pendingCount() == 0);
+    REQUIRE(routesSet.empty());
+    REQUIRE(routesFailed.size() == 1);
+    REQUIRE(routesFailed[0] == path);
+  }
+
+  world.reset();
+}
+
+TEST_CASE("Board: Route setter, NX route", "[board][board-routesetter]")
+{
+  auto world = World::create();
+  auto board = world->boards->create();
+  addCrossover(*board, 0);
+  REQUIRE(board->addTile(6, 0, TileRotate::Deg90, BlockRailTile::classId, false));
+  REQUIRE(board->addTile(6, 2, TileRotate::Deg90, BlockRailTile::classId, false));
+
+  world->edit = true;
+  world->edit = false; // update paths
+
+  const auto block1 = getBlock(*board, 0, 0);
+  const auto block2 = getBlock(*board, 6, 0);
+  const auto nx1 = std::dynamic_pointer_cast<NXButtonRailTile>(board->getTile({1, 0}));
+  const auto nx2 = std::dynamic_pointer_cast<NXButtonRailTile>(board->getTile({5, 0}));
+  REQUIRE(nx1);
+  REQUIRE(nx2);
+  REQUIRE(block2->setStateFree());
+
+  std::shared_ptr<RailVehicle> locomotive = world->railVehicles->create(Locomotive::classId);
+  std::shared_ptr<Train> train = world->trains->create();
+  train->vehicles->add(locomotive);
+  block1->assignTrain(train);
+  block1->flipTrain();
+
+  world->run(); // required for selecting paths using NX buttons
+
+  // path is reserved, the turnouts are set in the next event loop iteration:
+  world->nxManager->select(nx1, nx2);
+  REQUIRE(block2->state == BlockState::Reserved);
+  REQUIRE(world->nxManager->pendingCount() == 1);
+
+  auto path = block1->getReservedPath(BlockSide::B);
+  REQUIRE(path);
+  REQUIRE(path->toBlock() == block2);
+
+  SECTION("set")
+  {
+    EventLoop::ioContext.restart();
+    EventLoop::ioContext.poll();
+
+    REQUIRE(path->isSet());
+    REQUIRE(world->nxManager->pendingCount() == 0);
+    REQUIRE(block2->state == BlockState::Reserved);
+  }
+
+  SECTION("failed")
+  {
+    world->boards->routeSetter().routeFailed(path);
+
+    REQUIRE(world->nxManager->pendingCount() == 0);
+    REQUIRE(block2->state == BlockState::Free);
+    REQUIRE_FALSE(block1->getReservedPath(BlockSide::B));
+    REQUIRE_FALSE(world->boards->routeSetter().isPending(*path));
+  }
+
+  world.reset();
+}
@@ -0,0 +1,77 @@
+/**
+ * server/test/board/signalengine.cpp
+ *
+ * This file is part of the traintastic test suite.
+ *
+ * Copyright (C) 2024 Reinder Feenstra
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <catch2/catch.hpp>
+#include "../../src/core/eventloop.hpp"
+#include "../../src/world/world.hpp"
+#include "../../src/core/method.tpp"
+#include "../../src/board/board.hpp"
+#include "../../src/board/boardlist.hpp"
+#include "../../src/board/tile/rail/blockrailtile.hpp"
+#include "../../src/board/tile/rail/signal/signal2aspectrailtile.hpp"
+
+TEST_CASE("Board: Signal engine evaluates each signal once per event loop iteration", "[board][board-signalengine]")
+{
+  auto world = World::create();
+  world->edit = true;
+
+  // Board:
+  // +--------+          +--------+
+  // | block1 |--|>--|>--| block2 |
+  // +--------+          +--------+
+  auto board = world->boards->create();
+  REQUIRE(board->addTile(0, 0, TileRotate::Deg90, BlockRailTile::classId, false));
+  REQUIRE(board->addTile(1, 0, TileRotate::Deg90, Signal2AspectRailTile::classId, false));
+  REQUIRE(board->addTile(2, 0, TileRotate::Deg90, Signal2AspectRailTile::classId, false));
+  REQUIRE(board->addTile(3, 0, TileRotate::Deg90, BlockRailTile::classId, false));
+
+  auto block1 = std::dynamic_pointer_cast<BlockRailTile>(board->getTile({0, 0}));
+  REQUIRE(block1);
+  auto block2 = std::dynamic_pointer_cast<BlockRailTile>(board->getTile({3, 0}));
+  REQUIRE(block2);
+
+  world->edit = false; // builds the signal paths
+
+  auto& engine = world->boards->signalEngine();
+  engine.process();
+  REQUIRE(engine.pendingCount() == 0);
+  const auto evaluations = engine.evaluationCount();
+
+  // multiple changes of the same blocks, both signals depend on them:
+  REQUIRE(block1->setStateFree());
+  REQUIRE(block2->setStateFree());
+  REQUIRE(block1->state == BlockState::Free);
+  REQUIRE(block2->state == BlockState::Free);
+  REQUIRE(engine.pendingCount() == 2);
+
+  // evaluated in the next event loop iteration, each signal once,
+  // the signal ahead first so its aspect change doesn't cause a second evaluation of the other signal:
+  EventLoop::ioContext.restart();
+  EventLoop::ioContext.poll();
+  REQUIRE(engine.pendingCount() == 0);
+  REQUIRE(engine.evaluationCount() == evaluations + 2);
+
+  // nothing changed, nothing to evaluate:
+  EventLoop::ioContext.restart();
+  EventLoop::ioContext.poll();
+  REQUIRE(engine.evaluationCount() == evaluations + 2);
+}
@@ -0,0 +1,101 @@
+/**
+ * server/test/board/tilegrid.cpp
+ *
+ * This file is part of the traintastic test suite.
+ *
+ * Copyright (C) 2024 Reinder Feenstra
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <catch2/catch.hpp>
+#include "../../src/world/world.hpp"
+#include "../../src/core/method.tpp"
+#include "../../src/board/board.hpp"
+#include "../../src/board/boardlist.hpp"
+#include "../../src/board/tile/rail/blockrailtile.hpp"
+#include "../../src/board/tile/rail/straightrailtile.hpp"
+
+TEST_CASE("Board: Tile grid", "[board][board-tilegrid]")
+{
+  auto world = World::create();
+  world->edit = true;
+
+  auto board = world->boards->create();
+  const auto& grid = board->tileGrid();
+
+  // tiles around chunk boundaries, including negative coordinates:
+  constexpr int16_t c = TileGrid::chunkSize;
+  static_assert(c == 32);
+  for(int16_t v : {-33, -32, -1, 0, 31, 32})
+    REQUIRE(board->addTile(v, v, TileRotate::Deg0, StraightRailTile::classId, false));
+  REQUIRE(grid.size() == 6);
+
+  for(int16_t v : {-33, -32, -1, 0, 31, 32})
+  {
+    auto tile = board->getTile({v, v});
+    REQUIRE(tile);
+    REQUIRE(tile->location() == TileLocation{v, v});
+    REQUIRE_FALSE(board->getTile({v, static_cast<int16_t>(v + 1)}));
+  }
+
+  // block crossing a chunk boundary, occupies multiple locations but is stored once:
+  REQUIRE(board->addTile(c - 2, 0, TileRotate::Deg90, BlockRailTile::classId, false));
+  auto block = board->getTile({c - 2, 0});
+  REQUIRE(block);
+  REQUIRE(board->resizeTile(c - 2, 0, 4, 1));
+  REQUIRE(grid.size() == 7);
+  for(int16_t x = c - 2; x < c + 2; x++)
+    REQUIRE(board->getTile({x, 0}) == block);
+  REQUIRE_FALSE(board->getTile({c + 2, 0}));
+  REQUIRE(board->right.value() == c + 1);
+
+  REQUIRE(board->resizeTile(c - 2, 0, 2, 1));
+  REQUIRE(board->getTile({c - 1, 0}) == block);
+  REQUIRE_FALSE(board->getTile({c, 0}));
+  REQUIRE(grid.size() == 7);
+
+  // range query returns each tile once:
+  {
+    TileGrid::Tiles tiles;
+    grid.getTiles({-c, -c}, {c - 1, c - 1}, tiles);
+    REQUIRE(tiles.size() == 4); // (-c,-c), (-1,-1), (0,0), (c-1,c-1)
+    tiles.clear();
+    grid.getTiles({0, 0}, {c, 0}, tiles);
+    REQUIRE(tiles.size() == 2); // (0,0) and the block
+  }
+
+  // removing a tile keeps the dense list and the grid consistent:
+  REQUIRE(board->deleteTile(-c - 1, -c - 1));
+  REQUIRE(grid.size() == 6);
+  REQUIRE_FALSE(board->getTile({-c - 1, -c - 1}));
+  for(const auto& tile : grid.tiles())
+    REQUIRE(board->getTile(tile->location()) == tile);
+
+  // move the block:
+  REQUIRE(board->moveTile(c - 2, 0, -c, 2, TileRotate::Deg90, false));
+  REQUIRE_FALSE(board->getTile({c - 2, 0}));
+  REQUIRE(board->getTile({-c, 2}) == block);
+  REQUIRE(board->getTile({-c + 1, 2}) == block);
+  REQUIRE(grid.size() == 6);
+
+  while(!grid.empty())
+  {
+    const auto l = grid.tiles().front()->location();
+    REQUIRE(board->deleteTile(l.x, l.y));
+  }
+  REQUIRE_FALSE(board->getTile({0, 0}));
+  REQUIRE_FALSE(board->getTile({-c, 2}));
+}
@@ -0,0 +1,87 @@
+/**
+ * server/test/log/binarylogrecord.cpp
+ *
+ * This file is part of the traintastic test suite.
+ *
+ * Copyright (C) 2024 Reinder Feenstra
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+#include <catch2/catch.hpp>
+#include <cstring>
+#include "../../src/log/binarylogrecord.hpp"
+
+namespace {
+
+template<class T>
+T readAt(const std::string& record, size_t offset)
+{
+  REQUIRE(offset + sizeof(T) <= record.size());
+  T value;
+  std::memcpy(&value, record.data() + offset, sizeof(value));
+  return le_to_host(value);
+}
+
+constexpr size_t objectIdLengthOffset = sizeof(uint32_t) + sizeof(int64_t) + sizeof(uint32_t);
+
+}
+
+TEST_CASE("Binary log record: typed arguments", "[log][log-binary]")
+{
+  const auto record = BinaryLogRecord::encode(std::chrono::system_clock::now(), "obj", LogMessage::I1005_BUILDING_WORLD_INDEX, -7, 12345u, 1.5, std::string("abc"));
+
+  REQUIRE(readAt<uint32_t>(record, 0) == record.size() - sizeof(uint32_t));
+  REQUIRE(readAt<uint16_t>(record, objectIdLengthOffset) == 3);
+
+  size_t pos = objectIdLengthOffset + sizeof(uint16_t) + 3;
+  REQUIRE(static_cast<uint8_t>(record[pos++]) == 4);
+
+  REQUIRE(static_cast<BinaryLogRecord::ArgType>(record[pos++]) == BinaryLogRecord::ArgType::Int);
+  REQUIRE(static_cast<int64_t>(readAt<uint64_t>(record, pos)) == -7);
+  pos += sizeof(int64_t);
+
+  REQUIRE(static_cast<BinaryLogRecord::ArgType>(record[pos++]) == BinaryLogRecord::ArgType::UInt);
+  REQUIRE(readAt<uint64_t>(record, pos) == 12345);
+  pos += sizeof(uint64_t);
+
+  REQUIRE(static_cast<BinaryLogRecord::ArgType>(record[pos++]) == BinaryLogRecord::ArgType::Double);
+  const uint64_t bits = readAt<uint64_t>(record, pos);
+  double d;
+  std::memcpy(&d, &bits, sizeof(d));
+  REQUIRE(d == 1.5);
+  pos += sizeof(double);
+
+  REQUIRE(static_cast<BinaryLogRecord::ArgType>(record[pos++]) == BinaryLogRecord::ArgType::String);
+  REQUIRE(readAt<uint32_t>(record, pos) == 3);
+  pos += sizeof(uint32_t);
+  REQUIRE(record.substr(pos) == "abc");
+}
+
+TEST_CASE("Binary log record: long object id and many arguments", "[log][log-binary]")
+{
+  const std::string objectId(100000, 'x');
+  const std::vector<std::string> args(300, "a");
+  const auto record = BinaryLogRecord::encode(std::chrono::system_clock::now(), objectId, LogMessage::I1005_BUILDING_WORLD_INDEX, args);
+
+  REQUIRE(readAt<uint32_t>(record, 0) == record.size() - sizeof(uint32_t));
+  REQUIRE(readAt<uint16_t>(record, objectIdLengthOffset) == BinaryLogRecord::objectIdLengthMax);
+
+  size_t pos = objectIdLengthOffset + sizeof(uint16_t) + BinaryLogRecord::objectIdLengthMax;
+  REQUIRE(static_cast<uint8_t>(record[pos++]) == BinaryLogRecord::argCountMax);
+
+  // exactly argCountMax arguments follow:
+  const size_t argSize = sizeof(uint8_t) + sizeof(uint32_t) + 1;
+  REQUIRE(record.size() - pos == BinaryLogRecord::argCountMax * argSize);
+}
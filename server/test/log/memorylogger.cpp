@@ -0,0 +1,97 @@
+/**
+ * server/test/log/memorylogger.cpp
+ *
+ * This file is part of the traintastic test suite.
+ *
+ * Copyright (C) 2024 Reinder Feenstra
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+#include <catch2/catch.hpp>
+#include "../../src/log/memorylogger.hpp"
+#include "../../src/core/eventloop.hpp"
+
+namespace {
+
+std::string firstArg(const MemoryLogger::Log& log)
+{
+  std::string arg;
+  MemoryLogger::forEachArg(log, [&arg](std::string_view value) { if(arg.empty()) arg = value; });
+  return arg;
+}
+
+struct EventLoopThread
+{
+  const std::thread::id restore = EventLoop::threadId;
+
+  EventLoopThread()
+  {
+    EventLoop::threadId = std::this_thread::get_id();
+  }
+
+  ~EventLoopThread()
+  {
+    // run posted change notifications before the logger is gone:
+    EventLoop::ioContext.restart();
+    EventLoop::ioContext.poll();
+    EventLoop::threadId = restore;
+  }
+};
+
+}
+
+TEST_CASE("Memory logger: wrap around with a gap after the head", "[log][log-memory]")
+{
+  static_assert(MemoryLogger::arenaBytesPerLog == 32);
+  const auto now = std::chrono::system_clock::now();
+  constexpr auto message = LogMessage::I1005_BUILDING_WORLD_INDEX;
+
+  MemoryLogger logger(8); // arena: 256 bytes, each argument uses 2 bytes extra
+  EventLoopThread eventLoopThread; // must be destroyed before the logger
+
+  logger.log(now, "a", message, {std::string(218, 'a')}); // [0, 220)
+  logger.log(now, "x", message, {std::string(28, 'x')}); // [220, 250)
+  logger.log(now, "y", message, {std::string(48, 'y')}); // wraps: [0, 50), removes a, gap [50, 220)
+  REQUIRE(logger.size() == 2);
+  REQUIRE(logger.get(logger.first()).objectId == "x");
+  REQUIRE(logger.get(logger.first() + 1).objectId == "y");
+
+  // doesn't fit behind the head, wraps to [0, 210), doesn't overlap x but y must be removed too:
+  logger.log(now, "z", message, {std::string(208, 'z')});
+  REQUIRE(logger.size() == 1);
+  const auto log = logger.get(logger.first());
+  REQUIRE(log.objectId == "z");
+  REQUIRE(firstArg(log) == std::string(208, 'z'));
+}
+
+TEST_CASE("Memory logger: object ids of removed logs are released", "[log][log-memory]")
+{
+  const auto now = std::chrono::system_clock::now();
+  constexpr auto message = LogMessage::I1005_BUILDING_WORLD_INDEX;
+
+  MemoryLogger logger(4);
+  EventLoopThread eventLoopThread; // must be destroyed before the logger
+
+  for(int i = 0; i < 100; i++)
+    logger.log(now, "obj" + std::to_string(i % 10), message, {std::to_string(i)});
+
+  REQUIRE(logger.size() == 4);
+  for(uint64_t sequence = logger.first(); sequence < logger.next(); sequence++)
+  {
+    const auto log = logger.get(sequence);
+    const auto i = std::stoi(firstArg(log));
+    REQUIRE(log.objectId == "obj" + std::to_string(i % 10));
+  }
+}
@@ -0,0 +1,80 @@
+/**
+ * server/test/lua/allocator.cpp
+ *
+ * This file is part of the traintastic test suite.
+ *
+ * Copyright (C) 2024 Reinder Feenstra
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <catch2/catch.hpp>
+#include <cstring>
+#include "../../src/lua/allocator.hpp"
+
+using Lua::Allocator;
+
+TEST_CASE("Lua allocator: shrink across size classes", "[lua][lua-allocator]")
+{
+  Allocator allocator;
+
+  const size_t largeSize = 4 * Allocator::poolBlockSizeMax;
+  auto* p = static_cast<char*>(Allocator::alloc(&allocator, nullptr, 0, largeSize));
+  REQUIRE(p);
+  memset(p, 'x', largeSize);
+  REQUIRE(allocator.usage() == largeSize);
+
+  // malloc block to pool block:
+  p = static_cast<char*>(Allocator::alloc(&allocator, p, largeSize, 100));
+  REQUIRE(p);
+  REQUIRE(allocator.usage() == 100);
+  REQUIRE(p[0] == 'x');
+  REQUIRE(p[99] == 'x');
+
+  // pool block to a smaller size class:
+  p = static_cast<char*>(Allocator::alloc(&allocator, p, 100, 10));
+  REQUIRE(p);
+  REQUIRE(allocator.usage() == 10);
+  REQUIRE(p[9] == 'x');
+
+  // and grow again:
+  p = static_cast<char*>(Allocator::alloc(&allocator, p, 10, largeSize));
+  REQUIRE(p);
+  REQUIRE(allocator.usage() == largeSize);
+  REQUIRE(p[9] == 'x');
+
+  REQUIRE(Allocator::alloc(&allocator, p, largeSize, 0) == nullptr);
+  REQUIRE(allocator.usage() == 0);
+  REQUIRE(allocator.allocations() == 1);
+}
+
+TEST_CASE("Lua allocator: shrink is not limited", "[lua][lua-allocator]")
+{
+  Allocator allocator(1024);
+  allocator.setLimitEnabled(true);
+
+  void* p = Allocator::alloc(&allocator, nullptr, 0, 1000);
+  REQUIRE(p);
+  REQUIRE(Allocator::alloc(&allocator, nullptr, 0, 100) == nullptr);
+  REQUIRE(allocator.limitExceeded());
+
+  allocator.setLimit(10); // usage is above the limit now, shrinking must still succeed
+  p = Allocator::alloc(&allocator, p, 1000, 16);
+  REQUIRE(p);
+  REQUIRE(allocator.usage() == 16);
+
+  REQUIRE(Allocator::alloc(&allocator, p, 16, 0) == nullptr);
+  REQUIRE(allocator.usage() == 0);
+}
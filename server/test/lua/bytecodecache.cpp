@@ -0,0 +1,147 @@
+/**
+ * server/test/lua/bytecodecache.cpp
+ *
+ * This file is part of the traintastic test suite.
+ *
+ * Copyright (C) 2024 Reinder Feenstra
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <catch2/catch.hpp>
+#include <chrono>
+#include "../../src/core/method.tpp"
+#include "../../src/core/objectproperty.tpp"
+#include "../../src/lua/bytecodecache.hpp"
+#include "../../src/lua/scriptlist.hpp"
+#include "../../src/world/world.hpp"
+
+static size_t countCacheFiles(const std::filesystem::path& path)
+{
+  size_t count = 0;
+  for(const auto& entry : std::filesystem::directory_iterator(path))
+    if(entry.path().extension() == Lua::BytecodeCache::dotLuac)
+      count++;
+  return count;
+}
+
+TEST_CASE("Lua bytecode cache: start script cold and warm", "[lua][lua-bytecode-cache]")
+{
+  const auto path = std::filesystem::temp_directory_path() / "traintastic-x4lq2e";
+  std::filesystem::remove_all(path);
+  Lua::BytecodeCache::setDirectory(path);
+  {
+    auto world = World::create();
+    REQUIRE(world);
+    auto script = world->luaScripts->create();
+    REQUIRE(script);
+
+    script->code = "local t = {} for i = 1, 10 do t[i] = i end assert(#t == 10)";
+
+    script->start();
+    INFO(script->error.value());
+    REQUIRE(script->state.value() == LuaScriptState::Running);
+    script->stop();
+    REQUIRE(countCacheFiles(path) == 1);
+
+    script->start(); // from cache
+    REQUIRE(script->state.value() == LuaScriptState::Running);
+    script->stop();
+    REQUIRE(countCacheFiles(path) == 1);
+
+    script->code = "error('error on line 1')";
+    script->start();
+    REQUIRE(script->state.value() == LuaScriptState::Error);
+    REQUIRE(countCacheFiles(path) == 2);
+
+    script->start(); // from cache, debug info must be preserved
+    REQUIRE(script->state.value() == LuaScriptState::Error);
+    REQUIRE(script->error.value().find(":1:") != std::string::npos);
+
+    script->code = "syntax error";
+    script->start();
+    REQUIRE(script->state.value() == LuaScriptState::Error);
+    REQUIRE(countCacheFiles(path) == 2);
+  }
+  Lua::BytecodeCache::setDirectory({});
+  std::filesystem::remove_all(path);
+}
+
+TEST_CASE("Lua bytecode cache: binary code is rejected", "[lua][lua-bytecode-cache]")
+{
+  auto world = World::create();
+  REQUIRE(world);
+  auto script = world->luaScripts->create();
+  REQUIRE(script);
+
+  script->code = std::string(LUA_SIGNATURE) + "garbage";
+  script->start();
+  REQUIRE(script->state.value() == LuaScriptState::Error);
+}
+
+TEST_CASE("Lua bytecode cache: benchmark", "[.][lua][lua-bytecode-cache][lua-benchmark]")
+{
+  constexpr size_t scriptCount = 100;
+  constexpr size_t handlerCount = 50;
+
+  // generate some code which is expensive to parse:
+  std::string code;
+  for(size_t i = 0; i < handlerCount; i++)
+  {
+    const auto n = std::to_string(i);
+    code.append("local function handler_").append(n).append("(a, b, c)\n")
+      .append("  local t = {a = a, b = b, c = c, n = ").append(n).append("}\n")
+      .append("  if t.a and t.b then return t.a + t.b * t.n elseif t.c then return string.format('%d', t.c) end\n")
+      .append("  return nil\n")
+      .append("end\n");
+  }
+
+  auto startAll = [](World& world)
+  {
+    const auto start = std::chrono::steady_clock::now();
+    for(const auto& script : *world.luaScripts)
+      script->start();
+    const auto duration = std::chrono::steady_clock::now() - start;
+    for(const auto& script : *world.luaScripts)
+    {
+      REQUIRE(script->state.value() == LuaScriptState::Running);
+      script->stop();
+    }
+    return std::chrono::duration_cast<std::chrono::microseconds>(duration);
+  };
+
+  const auto path = std::filesystem::temp_directory_path() / "traintastic-7pw3mc";
+  std::filesystem::remove_all(path);
+  {
+    auto world = World::create();
+    REQUIRE(world);
+    for(size_t i = 0; i < scriptCount; i++)
+    {
+      auto script = world->luaScripts->create();
+      script->code = std::string("-- script ").append(std::to_string(i)).append("\n").append(code);
+    }
+
+    Lua::BytecodeCache::setDirectory({});
+    const auto uncached = startAll(*world);
+
+    Lua::BytecodeCache::setDirectory(path);
+    const auto cold = startAll(*world);
+    const auto warm = startAll(*world);
+
+    WARN("start " << scriptCount << " scripts: uncached " << uncached.count() << " us, cold cache " << cold.count() << " us, warm cache " << warm.count() << " us");
+  }
+  Lua::BytecodeCache::setDirectory({});
+  std::filesystem::remove_all(path);
+}
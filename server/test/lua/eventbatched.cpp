@@ -0,0 +1,89 @@
+/**
+ * server/test/lua/eventbatched.cpp
+ *
+ * This file is part of the traintastic test suite.
+ *
+ * Copyright (C) 2024 Reinder Feenstra
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <catch2/catch.hpp>
+#include "sandbox.hpp"
+#include "../../src/core/eventloop.hpp"
+#include "../../src/core/method.tpp"
+#include "../../src/core/objectproperty.tpp"
+#include "../../src/lua/sandbox.hpp"
+#include "../../src/lua/scriptlist.hpp"
+#include "../../src/world/world.hpp"
+
+TEST_CASE("Lua event: connect_batched", "[lua][lua-event]")
+{
+  auto world = World::create();
+  REQUIRE(world);
+  auto script = world->luaScripts->create();
+  REQUIRE(script);
+  Lua::SandboxPtr sandbox = Lua::Sandbox::create(*script);
+  lua_State* L = sandbox.get();
+
+  REQUIRE(runSandboxed(L,
+    "single = 0\n"
+    "batches = 0\n"
+    "batched = 0\n"
+    "world.on_event:connect(function() single = single + 1 end)\n"
+    "world.on_event:connect_batched(\n"
+    "  function(events, userdata)\n"
+    "    assert(userdata == 42)\n"
+    "    batches = batches + 1\n"
+    "    for _, event in ipairs(events) do\n"
+    "      assert(#event == 2)\n"
+    "      batched = batched + 1\n"
+    "    end\n"
+    "  end, 42)\n"));
+
+  world->powerOn();
+  world->run();
+  world->stop();
+  world->powerOff();
+
+  const lua_Integer single = getGlobalInteger(L, "single");
+  REQUIRE(single >= 4);
+  REQUIRE(getGlobalInteger(L, "batches") == 0); // delivered from the event loop
+
+  runEventLoop([L]() { return getGlobalInteger(L, "batches") != 0; });
+
+  REQUIRE(getGlobalInteger(L, "batches") == 1);
+  REQUIRE(getGlobalInteger(L, "batched") == single);
+}
+
+TEST_CASE("Lua event: connect_batched, disconnect before delivery", "[lua][lua-event]")
+{
+  auto world = World::create();
+  REQUIRE(world);
+  auto script = world->luaScripts->create();
+  REQUIRE(script);
+  Lua::SandboxPtr sandbox = Lua::Sandbox::create(*script);
+  lua_State* L = sandbox.get();
+
+  REQUIRE(runSandboxed(L,
+    "batches = 0\n"
+    "id = world.on_event:connect_batched(function() batches = batches + 1 end)\n"));
+
+  world->powerOn();
+  REQUIRE(runSandboxed(L, "assert(world.on_event:disconnect(id))"));
+
+  runEventLoop([]() { return false; }, std::chrono::milliseconds(50));
+  REQUIRE(getGlobalInteger(L, "batches") == 0);
+}
@@ -0,0 +1,178 @@
+/**
+ * server/test/lua/hotreload.cpp
+ *
+ * This file is part of the traintastic test suite.
+ *
+ * Copyright (C) 2024 Reinder Feenstra
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+#include <catch2/catch.hpp>
+#include "sandbox.hpp"
+#include "../../src/core/eventloop.hpp"
+#include "../../src/core/method.tpp"
+#include "../../src/core/objectproperty.tpp"
+#include "../../src/lua/sandbox.hpp"
+#include "../../src/lua/script.hpp"
+#include "../../src/lua/scriptlist.hpp"
+#include "../../src/world/world.hpp"
+
+static bool runChunk(lua_State* L, std::string_view code, bool reload)
+{
+  auto& stateData = Lua::Sandbox::getStateData(L);
+  stateData.beginChunk(reload);
+  const bool success =
+    luaL_loadbuffer(L, code.data(), code.size(), "=") == LUA_OK &&
+    Lua::Sandbox::pcall(L, 0, 0) == LUA_OK;
+  stateData.endChunk(success);
+  if(!success)
+    lua_pop(L, 1); // error message
+  return success;
+}
+
+TEST_CASE("Lua hot-reload: swap handler functions", "[lua][lua-hotreload]")
+{
+  auto world = World::create();
+  REQUIRE(world);
+  auto script = world->luaScripts->create();
+  REQUIRE(script);
+  Lua::SandboxPtr sandbox = Lua::Sandbox::create(*script);
+  lua_State* L = sandbox.get();
+
+  REQUIRE(runChunk(L,
+    "count = count or 0\n"
+    "removed = 0\n"
+    "id = world.on_event:connect(function() count = count + 1 end)\n"
+    "id_removed = world.on_event:connect(function() removed = removed + 1 end)\n",
+    false));
+  const lua_Integer id = getGlobalInteger(L, "id");
+  const lua_Integer idRemoved = getGlobalInteger(L, "id_removed");
+
+  world->powerOn();
+  const lua_Integer count = getGlobalInteger(L, "count");
+  REQUIRE(count >= 1);
+  REQUIRE(getGlobalInteger(L, "removed") == count);
+
+  REQUIRE(runChunk(L,
+    "count = count or 0\n"
+    "id = world.on_event:connect(function() count = count + 10 end)\n",
+    true));
+  REQUIRE(getGlobalInteger(L, "id") == id); // same handler, new function
+  REQUIRE(getGlobalInteger(L, "count") == count); // state is kept
+  REQUIRE_FALSE(Lua::Sandbox::getStateData(L).getEventHandler(idRemoved));
+
+  world->powerOff();
+  const lua_Integer delta = getGlobalInteger(L, "count") - count;
+  REQUIRE(delta >= 10);
+  REQUIRE(delta % 10 == 0); // only the new function is called
+  REQUIRE(getGlobalInteger(L, "removed") == count); // removed handler is disconnected
+}
+
+TEST_CASE("Lua hot-reload: error keeps previous handlers", "[lua][lua-hotreload]")
+{
+  auto world = World::create();
+  REQUIRE(world);
+  auto script = world->luaScripts->create();
+  REQUIRE(script);
+  Lua::SandboxPtr sandbox = Lua::Sandbox::create(*script);
+  lua_State* L = sandbox.get();
+
+  REQUIRE(runChunk(L,
+    "count = 0\n"
+    "id = world.on_event:connect(function() count = count + 1 end)\n",
+    false));
+  const lua_Integer id = getGlobalInteger(L, "id");
+
+  REQUIRE_FALSE(runChunk(L, "error('oops')", true));
+  REQUIRE(Lua::Sandbox::getStateData(L).getEventHandler(id));
+
+  world->powerOn();
+  REQUIRE(getGlobalInteger(L, "count") >= 1);
+
+  // handler can still be reused by the next reload:
+  REQUIRE(runChunk(L, "id = world.on_event:connect(function() count = count + 10 end)\n", true));
+  REQUIRE(getGlobalInteger(L, "id") == id);
+}
+
+TEST_CASE("Lua hot-reload: top-level timers", "[lua][lua-hotreload]")
+{
+  auto world = World::create();
+  REQUIRE(world);
+  auto script = world->luaScripts->create();
+  REQUIRE(script);
+  Lua::SandboxPtr sandbox = Lua::Sandbox::create(*script);
+  lua_State* L = sandbox.get();
+
+  REQUIRE(runChunk(L,
+    "old = 0\n"
+    "new = 0\n"
+    "removed = 0\n"
+    "id = timer.periodic(10, function() old = old + 1 end)\n"
+    "id_removed = timer.periodic(10, function() removed = removed + 1 end)\n",
+    false));
+  const lua_Integer id = getGlobalInteger(L, "id");
+  auto& timers = *Lua::Sandbox::getStateData(L).timers;
+  REQUIRE(timers.size() == 2);
+
+  runEventLoop([L]() { return getGlobalInteger(L, "old") >= 1 && getGlobalInteger(L, "removed") >= 1; });
+  REQUIRE(getGlobalInteger(L, "old") >= 1);
+  REQUIRE(getGlobalInteger(L, "removed") >= 1);
+
+  REQUIRE(runChunk(L, "id = timer.periodic(10, function() new = new + 1 end)\n", true));
+  const lua_Integer old = getGlobalInteger(L, "old");
+  const lua_Integer removed = getGlobalInteger(L, "removed");
+  REQUIRE(getGlobalInteger(L, "id") == id); // same timer, new function
+  REQUIRE(timers.size() == 1); // timer not added again by the chunk is cancelled
+  REQUIRE_FALSE(timers.contains(getGlobalInteger(L, "id_removed")));
+
+  runEventLoop([L]() { return getGlobalInteger(L, "new") >= 3; });
+  REQUIRE(getGlobalInteger(L, "new") >= 3);
+  REQUIRE(getGlobalInteger(L, "old") == old); // old function isn't called anymore
+  REQUIRE(getGlobalInteger(L, "removed") == removed);
+
+  // a failed reload keeps the timer, it can be reused by the next reload:
+  REQUIRE_FALSE(runChunk(L, "error('oops')", true));
+  REQUIRE(timers.size() == 1);
+  REQUIRE(runChunk(L, "id = timer.periodic(10, function() new = new + 1 end)\n", true));
+  REQUIRE(getGlobalInteger(L, "id") == id);
+  REQUIRE(timers.size() == 1);
+}
+
+TEST_CASE("Lua hot-reload: script", "[lua][lua-hotreload]")
+{
+  auto world = World::create();
+  REQUIRE(world);
+  auto script = world->luaScripts->create();
+  REQUIRE(script);
+
+  script->code = "world.on_event:connect(function() end)";
+  script->start();
+  REQUIRE(script->state.value() == LuaScriptState::Running);
+
+  script->code = "syntax error";
+  script->reload();
+  REQUIRE(script->state.value() == LuaScriptState::Running);
+  REQUIRE_FALSE(script->error.value().empty());
+
+  script->code = "world.on_event:connect(function() end)";
+  script->reload();
+  REQUIRE(script->state.value() == LuaScriptState::Running);
+  REQUIRE(script->error.value().empty());
+
+  script->stop();
+  REQUIRE(script->state.value() == LuaScriptState::Stopped);
+}
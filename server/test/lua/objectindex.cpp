@@ -0,0 +1,107 @@
+/**
+ * server/test/lua/objectindex.cpp
+ *
+ * This file is part of the traintastic test suite.
+ *
+ * Copyright (C) 2024 Reinder Feenstra
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <catch2/catch.hpp>
+#include <chrono>
+#include "../../src/core/method.tpp"
+#include "../../src/core/objectproperty.tpp"
+#include "../../src/lua/sandbox.hpp"
+#include "../../src/lua/scriptlist.hpp"
+#include "../../src/world/world.hpp"
+
+//! \brief Load \a code and call it with the world object as argument, leaves results on the stack
+static bool callWithWorld(lua_State* L, std::string_view code, int nresults)
+{
+  if(luaL_loadbuffer(L, code.data(), code.size(), "=") != LUA_OK)
+    return false;
+  Lua::Sandbox::getGlobal(L, "world");
+  return lua_pcall(L, 1, nresults, 0) == LUA_OK;
+}
+
+TEST_CASE("Lua object index: cached property returns current value", "[lua][lua-object-index]")
+{
+  auto world = World::create();
+  REQUIRE(world);
+  auto script = world->luaScripts->create();
+  REQUIRE(script);
+  Lua::SandboxPtr sandbox = Lua::Sandbox::create(*script);
+  lua_State* L = sandbox.get();
+
+  constexpr std::string_view code = "local w = ...; return w.scale_ratio";
+
+  world->scaleRatio = 87;
+  REQUIRE(callWithWorld(L, code, 1));
+  REQUIRE(lua_tointeger(L, -1) == 87);
+  lua_pop(L, 1);
+
+  world->scaleRatio = 160;
+  REQUIRE(callWithWorld(L, code, 1));
+  REQUIRE(lua_tointeger(L, -1) == 160);
+  lua_pop(L, 1);
+}
+
+TEST_CASE("Lua object index: cached method, event and hidden items", "[lua][lua-object-index]")
+{
+  auto world = World::create();
+  REQUIRE(world);
+  auto script = world->luaScripts->create();
+  REQUIRE(script);
+  Lua::SandboxPtr sandbox = Lua::Sandbox::create(*script);
+  lua_State* L = sandbox.get();
+
+  REQUIRE(callWithWorld(L,
+    "local w = ...\n"
+    "assert(w.stop ~= nil and w.stop == w.stop)\n"
+    "assert(w.on_event ~= nil and w.on_event == w.on_event)\n"
+    "assert(w.save == nil and w.save == nil)\n" // not script callable
+    "assert(w.lua_scripts == nil and w.lua_scripts == nil)\n" // not script readable
+    "assert(w.does_not_exist == nil and w.does_not_exist == nil)\n", 0));
+}
+
+TEST_CASE("Lua object index: benchmark", "[.][lua][lua-object-index][lua-benchmark]")
+{
+  auto world = World::create();
+  REQUIRE(world);
+  auto script = world->luaScripts->create();
+  REQUIRE(script);
+  Lua::SandboxPtr sandbox = Lua::Sandbox::create(*script);
+  lua_State* L = sandbox.get();
+
+  constexpr lua_Integer iterations = 1000000;
+  const std::string code = std::string(
+    "local w = ...\n"
+    "local n = 0\n"
+    "for i = 1, ").append(std::to_string(iterations)).append(" do\n"
+    "  if w.scale_ratio > 0 and w.name and w.stop then\n"
+    "    n = n + 1\n"
+    "  end\n"
+    "end\n"
+    "return n\n");
+
+  const auto start = std::chrono::steady_clock::now();
+  REQUIRE(callWithWorld(L, code, 1));
+  const auto duration = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+  REQUIRE(lua_tointeger(L, -1) == iterations);
+  lua_pop(L, 1);
+
+  WARN("object index: " << (duration.count() / (3 * iterations)) << " ns per access");
+}
@@ -0,0 +1,65 @@
+/**
+ * server/test/lua/sandbox.hpp
+ *
+ * This file is part of the traintastic test suite.
+ *
+ * Copyright (C) 2024 Reinder Feenstra
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#ifndef TRAINTASTIC_SERVER_TEST_LUA_SANDBOX_HPP
+#define TRAINTASTIC_SERVER_TEST_LUA_SANDBOX_HPP
+
+#include <chrono>
+#include <string_view>
+#include <lua.hpp>
+#include "../../src/core/eventloop.hpp"
+#include "../../src/lua/sandbox.hpp"
+
+inline bool runSandboxed(lua_State* L, std::string_view code)
+{
+  return
+    luaL_loadbuffer(L, code.data(), code.size(), "=") == LUA_OK &&
+    Lua::Sandbox::pcall(L, 0, 0) == LUA_OK;
+}
+
+inline bool getGlobalBoolean(lua_State* L, const char* name)
+{
+  Lua::Sandbox::getGlobal(L, name);
+  const bool value = lua_toboolean(L, -1);
+  lua_pop(L, 1);
+  return value;
+}
+
+inline lua_Integer getGlobalInteger(lua_State* L, const char* name)
+{
+  Lua::Sandbox::getGlobal(L, name);
+  const lua_Integer value = lua_tointeger(L, -1);
+  lua_pop(L, 1);
+  return value;
+}
+
+//! \brief Run the event loop until \a done returns true or the timeout expires
+template<class F>
+void runEventLoop(F&& done, std::chrono::milliseconds timeout = std::chrono::seconds(2))
+{
+  const auto end = std::chrono::steady_clock::now() + timeout;
+  EventLoop::ioContext.restart();
+  while(!done() && std::chrono::steady_clock::now() < end)
+    EventLoop::ioContext.run_one_for(std::chrono::milliseconds(10));
+}
+
+#endif
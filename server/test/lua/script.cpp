@@ -21,6 +21,7 @@
  */
 
 #include <catch2/catch.hpp>
+#include "../../src/core/eventloop.hpp"
 #include "../../src/world/world.hpp"
 #include "../../src/core/method.tpp"
 #include "../../src/core/objectproperty.tpp"
@@ -56,3 +57,67 @@ TEST_CASE("Lua script: no code, start/stop, disable", "[lua][lua-script]")
   script.reset();
   world.reset();
 }
+
+TEST_CASE("Lua script: memory limit", "[lua][lua-script]")
+{
+  auto world = World::create();
+  REQUIRE(world);
+
+  auto script = world->luaScripts->create();
+  REQUIRE(script);
+
+  script->memoryLimit = 1024 * 1024;
+  REQUIRE(script->memoryLimit.value() == 1024 * 1024);
+
+  script->code = "local s = string.rep('x', 512 * 1024)";
+  script->start();
+  INFO(script->error.value());
+  REQUIRE(script->state.value() == LuaScriptState::Running);
+  REQUIRE(script->memoryPeak.value() >= 512 * 1024);
+  script->stop();
+  REQUIRE(script->state.value() == LuaScriptState::Stopped);
+
+  script->code = "local s = string.rep('x', 2 * 1024 * 1024)";
+  script->start();
+  REQUIRE(script->state.value() == LuaScriptState::Error);
+  REQUIRE_FALSE(script->error.value().empty());
+
+  script.reset();
+  world.reset();
+}
+
+TEST_CASE("Lua script: memory limit, event handler", "[lua][lua-script]")
+{
+  auto world = World::create();
+  REQUIRE(world);
+
+  auto script = world->luaScripts->create();
+  REQUIRE(script);
+
+  script->memoryLimit = 1024 * 1024;
+  script->code =
+    "local n = 0\n"
+    "world.on_event:connect(\n"
+    "  function()\n"
+    "    n = n + 1\n"
+    "    if n == 1 then\n"
+    "      local s = string.rep('x', 2 * 1024 * 1024)\n"
+    "    end\n"
+    "    local t = {n}\n" // successful allocation after the one exceeding the limit
+    "  end)\n";
+  script->start();
+  INFO(script->error.value());
+  REQUIRE(script->state.value() == LuaScriptState::Running);
+
+  world->powerOn(); // first event exceeds the limit, the stop is posted to the event loop
+  world->run();
+  REQUIRE(script->state.value() == LuaScriptState::Running);
+
+  EventLoop::ioContext.restart();
+  EventLoop::ioContext.poll();
+  REQUIRE(script->state.value() == LuaScriptState::Error);
+  REQUIRE_FALSE(script->error.value().empty());
+
+  script.reset();
+  world.reset();
+}
@@ -0,0 +1,92 @@
+/**
+ * server/test/lua/timers.cpp
+ *
+ * This file is part of the traintastic test suite.
+ *
+ * Copyright (C) 2024 Reinder Feenstra
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <catch2/catch.hpp>
+#include "sandbox.hpp"
+#include "../../src/core/eventloop.hpp"
+#include "../../src/core/method.tpp"
+#include "../../src/core/objectproperty.tpp"
+#include "../../src/lua/sandbox.hpp"
+#include "../../src/lua/scriptlist.hpp"
+#include "../../src/world/world.hpp"
+
+TEST_CASE("Lua timer: once and periodic", "[lua][lua-timer]")
+{
+  auto world = World::create();
+  REQUIRE(world);
+  auto script = world->luaScripts->create();
+  REQUIRE(script);
+  Lua::SandboxPtr sandbox = Lua::Sandbox::create(*script);
+  lua_State* L = sandbox.get();
+
+  REQUIRE(runSandboxed(L,
+    "fired = false\n"
+    "count = 0\n"
+    "timer.once(0, function() fired = true end)\n"
+    "periodic_id = timer.periodic(10, function(step) count = count + step; if count == 3 then timer.cancel(periodic_id) end end, 1)\n"));
+
+  REQUIRE(Lua::Sandbox::getStateData(L).timers);
+  REQUIRE(Lua::Sandbox::getStateData(L).timers->size() == 2);
+
+  runEventLoop([L]() { return getGlobalInteger(L, "count") >= 3; });
+
+  REQUIRE(getGlobalBoolean(L, "fired"));
+  REQUIRE(getGlobalInteger(L, "count") == 3);
+  REQUIRE(Lua::Sandbox::getStateData(L).timers->size() == 0);
+}
+
+TEST_CASE("Lua timer: cancel", "[lua][lua-timer]")
+{
+  auto world = World::create();
+  REQUIRE(world);
+  auto script = world->luaScripts->create();
+  REQUIRE(script);
+  Lua::SandboxPtr sandbox = Lua::Sandbox::create(*script);
+  lua_State* L = sandbox.get();
+
+  REQUIRE(runSandboxed(L,
+    "fired = false\n"
+    "local id = timer.once(10, function() fired = true end)\n"
+    "assert(timer.cancel(id))\n"
+    "assert(not timer.cancel(id))\n"));
+
+  REQUIRE(Lua::Sandbox::getStateData(L).timers->size() == 0);
+  runEventLoop([]() { return false; }, std::chrono::milliseconds(50));
+  REQUIRE_FALSE(getGlobalBoolean(L, "fired"));
+}
+
+TEST_CASE("Lua timer: invalid arguments", "[lua][lua-timer]")
+{
+  auto world = World::create();
+  REQUIRE(world);
+  auto script = world->luaScripts->create();
+  REQUIRE(script);
+  Lua::SandboxPtr sandbox = Lua::Sandbox::create(*script);
+  lua_State* L = sandbox.get();
+
+  REQUIRE_FALSE(runSandboxed(L, "timer.once(-1, function() end)"));
+  lua_pop(L, 1);
+  REQUIRE_FALSE(runSandboxed(L, "timer.periodic(0, function() end)"));
+  lua_pop(L, 1);
+  REQUIRE_FALSE(runSandboxed(L, "timer.once(100, 42)"));
+  lua_pop(L, 1);
+}
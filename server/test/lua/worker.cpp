@@ -0,0 +1,170 @@
+/**
+ * server/test/lua/worker.cpp
+ *
+ * This file is part of the traintastic test suite.
+ *
+ * Copyright (C) 2024 Reinder Feenstra
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+
+#include <catch2/catch.hpp>
+#include "sandbox.hpp"
+#include "../../src/core/eventloop.hpp"
+#include "../../src/core/method.tpp"
+#include "../../src/core/objectproperty.tpp"
+#include "../../src/lua/script.hpp"
+#include "../../src/lua/scriptlist.hpp"
+#include "../../src/train/train.hpp"
+#include "../../src/train/trainlist.hpp"
+#include "../../src/world/world.hpp"
+
+TEST_CASE("Lua worker: snapshot and commands", "[lua][lua-worker]")
+{
+  auto world = World::create();
+  REQUIRE(world);
+  std::weak_ptr<Train> train = world->trains->create();
+  REQUIRE(train.lock()->emergencyStop.value());
+
+  auto script = world->luaScripts->create();
+  REQUIRE(script);
+  script->worker = true;
+  script->code =
+    "assert(world == nil)\n"
+    "command.subscribe('train', 'emergency_stop')\n"
+    "function update(snapshot)\n"
+    "  for id, object in pairs(snapshot) do\n"
+    "    assert(object.class_id == 'train') -- only subscribed objects\n"
+    "    assert(object.name == nil) -- only subscribed properties\n"
+    "    if object.emergency_stop then\n"
+    "      command.set(id, 'emergency_stop', false)\n"
+    "    end\n"
+    "  end\n"
+    "end\n";
+  script->start();
+  REQUIRE(script->state.value() == LuaScriptState::Running);
+
+  runEventLoop([&train]() { return !train.lock()->emergencyStop.value(); });
+  REQUIRE_FALSE(train.lock()->emergencyStop.value());
+  REQUIRE(script->state.value() == LuaScriptState::Running);
+
+  script->stop();
+  REQUIRE(script->state.value() == LuaScriptState::Stopped);
+
+  script.reset();
+  world.reset();
+}
+
+TEST_CASE("Lua worker: subscribe by object id", "[lua][lua-worker]")
+{
+  auto world = World::create();
+  REQUIRE(world);
+  std::weak_ptr<Train> train1 = world->trains->create();
+  std::weak_ptr<Train> train2 = world->trains->create();
+  REQUIRE(train1.lock()->emergencyStop.value());
+  REQUIRE(train2.lock()->emergencyStop.value());
+
+  auto script = world->luaScripts->create();
+  REQUIRE(script);
+  script->worker = true;
+  script->code =
+    "command.subscribe('" + train2.lock()->id.value() + "')\n"
+    "function update(snapshot)\n"
+    "  for id, object in pairs(snapshot) do\n"
+    "    assert(object.name ~= nil) -- all properties\n"
+    "    if object.emergency_stop then\n"
+    "      command.set(id, 'emergency_stop', false)\n"
+    "    end\n"
+    "  end\n"
+    "end\n";
+  script->start();
+  REQUIRE(script->state.value() == LuaScriptState::Running);
+
+  runEventLoop([&train2]() { return !train2.lock()->emergencyStop.value(); });
+  REQUIRE_FALSE(train2.lock()->emergencyStop.value());
+  REQUIRE(train1.lock()->emergencyStop.value());
+  REQUIRE(script->state.value() == LuaScriptState::Running);
+
+  script->stop();
+  script.reset();
+  world.reset();
+}
+
+TEST_CASE("Lua worker: error", "[lua][lua-worker]")
+{
+  auto world = World::create();
+  REQUIRE(world);
+
+  auto script = world->luaScripts->create();
+  REQUIRE(script);
+  script->worker = true;
+  script->code = "function update(snapshot) error('failed') end";
+  script->start();
+  REQUIRE(script->state.value() == LuaScriptState::Running); // code is executed by the worker thread
+
+  runEventLoop([&script]() { return script->state.value() != LuaScriptState::Running; });
+  REQUIRE(script->state.value() == LuaScriptState::Error);
+  REQUIRE_FALSE(script->error.value().empty());
+
+  script.reset();
+  world.reset();
+}
+
+TEST_CASE("Lua worker: memory error while pushing snapshot", "[lua][lua-worker]")
+{
+  auto world = World::create();
+  REQUIRE(world);
+  std::weak_ptr<Train> train = world->trains->create();
+  constexpr uint32_t memoryLimit = 1024 * 1024; // minimum
+  train.lock()->name = std::string(2 * memoryLimit, 'x'); // doesn't fit in the snapshot table
+
+  auto script = world->luaScripts->create();
+  REQUIRE(script);
+  script->worker = true;
+  script->memoryLimit = memoryLimit;
+  script->code =
+    "command.subscribe('" + train.lock()->id.value() + "', 'name')\n"
+    "function update(snapshot) end\n";
+  script->start();
+  REQUIRE(script->state.value() == LuaScriptState::Running);
+
+  // reported as script error instead of a Lua panic:
+  runEventLoop([&script]() { return script->state.value() != LuaScriptState::Running; });
+  REQUIRE(script->state.value() == LuaScriptState::Error);
+
+  script.reset();
+  world.reset();
+}
+
+TEST_CASE("Lua worker: stop long running script", "[lua][lua-worker]")
+{
+  auto world = World::create();
+  REQUIRE(world);
+
+  auto script = world->luaScripts->create();
+  REQUIRE(script);
+  script->worker = true;
+  script->code = "function update(snapshot) while true do end end";
+  script->start();
+  REQUIRE(script->state.value() == LuaScriptState::Running);
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  script->stop(); // aborts the running update() and joins the worker thread
+  REQUIRE(script->state.value() == LuaScriptState::Stopped);
+
+  script.reset();
+  world.reset();
+}
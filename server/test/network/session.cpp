@@ -0,0 +1,247 @@
+/**
+ * server/test/network/session.cpp
+ *
+ * This file is part of the traintastic test suite.
+ *
+ * Copyright (C) 2024 Reinder Feenstra
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <catch2/catch.hpp>
+#include <thread>
+#include "../../src/network/session.hpp"
+#include "../../src/core/eventloop.hpp"
+#include "../../src/core/method.tpp"
+#include "../../src/world/world.hpp"
+#include "../../src/board/board.hpp"
+#include "../../src/board/boardlist.hpp"
+#include "../../src/board/tile/rail/blockrailtile.hpp"
+#include "../../src/board/tile/rail/straightrailtile.hpp"
+
+namespace {
+
+//! \brief Session without connection, keeps the messages instead of sending them
+class TestSession : public Session
+{
+  public:
+    std::vector<std::unique_ptr<Message>> messages;
+
+    TestSession() :
+      Session(nullptr)
+    {
+    }
+
+    Handle addBoard(const std::shared_ptr<Board>& board)
+    {
+      auto message = Message::newEvent(Message::Command::ObjectPropertyChanged);
+      writeObject(*message, board); // subscribes to tile changes
+      return m_handles.getHandle(board);
+    }
+
+    void setViewport(Handle handle, const Board& board, TileLocation topLeft, TileLocation bottomRight)
+    {
+      boardSetViewport(handle, board, topLeft, bottomRight);
+    }
+
+  protected:
+    void sendMessage(std::unique_ptr<Message> message) final
+    {
+      messages.emplace_back(std::move(message));
+    }
+};
+
+struct Region
+{
+  uint32_t handle;
+  TileLocation topLeft;
+  TileLocation bottomRight;
+  std::vector<std::pair<TileLocation, TileData>> tiles;
+};
+
+Region readRegion(const Message& message)
+{
+  REQUIRE(message.command() == Message::Command::BoardTileDataRegion);
+  Region region;
+  message.read(region.handle);
+  message.read(region.topLeft);
+  message.read(region.bottomRight);
+  while(!message.endOfMessage())
+  {
+    const auto location = message.read<TileLocation>();
+    const auto data = message.read<TileData>();
+    if(data.isActive())
+    {
+      message.readBlock(); // object
+      message.readBlockEnd();
+    }
+    region.tiles.emplace_back(location, data);
+  }
+  return region;
+}
+
+std::pair<TileLocation, TileData> readTileDataChanged(const Message& message, uint32_t handle)
+{
+  REQUIRE(message.command() == Message::Command::BoardTileDataChanged);
+  REQUIRE(message.read<uint32_t>() == handle);
+  const auto location = message.read<TileLocation>();
+  return {location, message.read<TileData>()};
+}
+
+struct EventLoopThread
+{
+  const std::thread::id restore = EventLoop::threadId;
+
+  EventLoopThread()
+  {
+    EventLoop::threadId = std::this_thread::get_id();
+  }
+
+  ~EventLoopThread()
+  {
+    EventLoop::threadId = restore;
+  }
+};
+
+}
+
+TEST_CASE("Session: board viewport", "[network][session]")
+{
+  EventLoopThread eventLoopThread;
+  auto world = World::create();
+  auto board = world->boards->create();
+  for(int16_t x = 0; x <= 30; x++)
+  {
+    REQUIRE(board->addTile(x, 0, TileRotate::Deg90, StraightRailTile::classId, false));
+  }
+
+  auto session = std::make_shared<TestSession>();
+  const auto handle = session->addBoard(board);
+  REQUIRE(handle != 0);
+
+  // all tiles within the area including the margin, the tile at the edge included:
+  session->setViewport(handle, *board, {0, 0}, {10, 0});
+  REQUIRE(session->messages.size() == 1);
+  {
+    const auto region = readRegion(*session->messages.back());
+    REQUIRE(region.handle == handle);
+    REQUIRE(region.topLeft == TileLocation{-8, -8});
+    REQUIRE(region.bottomRight == TileLocation{18, 8});
+    REQUIRE(region.tiles.size() == 19);
+    for(const auto& [location, data] : region.tiles)
+    {
+      REQUIRE(location.y == 0);
+      REQUIRE(location.x >= 0);
+      REQUIRE(location.x <= 18);
+      REQUIRE(data.id() == TileId::RailStraight);
+    }
+  }
+
+  // within the subscribed area, nothing to send:
+  session->setViewport(handle, *board, {5, -3}, {15, 3});
+  REQUIRE(session->messages.size() == 1);
+
+  // only the tiles the client doesn't know yet:
+  session->setViewport(handle, *board, {10, 0}, {20, 0});
+  REQUIRE(session->messages.size() == 2);
+  {
+    const auto region = readRegion(*session->messages.back());
+    REQUIRE(region.topLeft == TileLocation{2, -8});
+    REQUIRE(region.bottomRight == TileLocation{28, 8});
+    REQUIRE(region.tiles.size() == 10);
+    for(const auto& [location, data] : region.tiles)
+    {
+      REQUIRE(location.x >= 19);
+      REQUIRE(location.x <= 28);
+    }
+  }
+
+  // changes outside the area are suppressed:
+  REQUIRE(board->addTile(29, 1, TileRotate::Deg0, StraightRailTile::classId, false));
+  REQUIRE(session->messages.size() == 2);
+
+  // changes at the edge of the area are sent:
+  REQUIRE(board->addTile(28, 1, TileRotate::Deg0, StraightRailTile::classId, false));
+  REQUIRE(session->messages.size() == 3);
+  {
+    const auto [location, data] = readTileDataChanged(*session->messages.back(), handle);
+    REQUIRE(location == TileLocation{28, 1});
+    REQUIRE(data.id() == TileId::RailStraight);
+  }
+
+  // removals are always sent:
+  REQUIRE(board->deleteTile(29, 1));
+  REQUIRE(session->messages.size() == 4);
+  {
+    const auto [location, data] = readTileDataChanged(*session->messages.back(), handle);
+    REQUIRE(location == TileLocation{29, 1});
+    REQUIRE_FALSE(data);
+  }
+
+  session.reset();
+  board.reset();
+  world.reset();
+}
+
+TEST_CASE("Session: board viewport, large tile with origin outside the area", "[network][session]")
+{
+  EventLoopThread eventLoopThread;
+  auto world = World::create();
+  auto board = world->boards->create();
+  REQUIRE(board->addTile(-12, 0, TileRotate::Deg90, BlockRailTile::classId, false));
+  REQUIRE(board->resizeTile(-12, 0, 5, 1)); // -12 .. -8
+
+  auto session = std::make_shared<TestSession>();
+  const auto handle = session->addBoard(board);
+
+  // area is -8,-8 .. 8,8:
+  session->setViewport(handle, *board, {0, 0}, {0, 0});
+  REQUIRE(session->messages.size() == 1);
+  {
+    const auto region = readRegion(*session->messages.back());
+    REQUIRE(region.tiles.size() == 1);
+    REQUIRE(region.tiles[0].first == TileLocation{-12, 0});
+    REQUIRE(region.tiles[0].second.id() == TileId::RailBlock);
+    REQUIRE(region.tiles[0].second.width() == 5);
+  }
+
+  // tile is partly within the area, so changes are sent:
+  REQUIRE(board->resizeTile(-12, 0, 6, 1));
+  REQUIRE(session->messages.size() == 2);
+  {
+    const auto [location, data] = readTileDataChanged(*session->messages.back(), handle);
+    REQUIRE(location == TileLocation{-12, 0});
+    REQUIRE(data.width() == 6);
+  }
+
+  // tile is completely outside the area:
+  REQUIRE(board->addTile(-20, 0, TileRotate::Deg90, BlockRailTile::classId, false));
+  REQUIRE(board->resizeTile(-20, 0, 4, 1)); // -20 .. -17
+  REQUIRE(session->messages.size() == 2);
+
+  // moving the area reveals it, the already known tile isn't sent again:
+  session->setViewport(handle, *board, {-10, 0}, {-10, 0});
+  REQUIRE(session->messages.size() == 3);
+  {
+    const auto region = readRegion(*session->messages.back());
+    REQUIRE(region.tiles.size() == 1);
+    REQUIRE(region.tiles[0].first == TileLocation{-20, 0});
+    REQUIRE(region.tiles[0].second.width() == 4);
+  }
+
+  session.reset();
+  board.reset();
+  world.reset();
+}
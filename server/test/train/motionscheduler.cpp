@@ -0,0 +1,229 @@
+/**
+ * server/test/train/motionscheduler.cpp
+ *
+ * This file is part of the traintastic test suite.
+ *
+ * Copyright (C) 2024 Reinder Feenstra
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <catch2/catch.hpp>
+#include "../../src/core/method.tpp"
+#include "../../src/core/objectproperty.tpp"
+#include "../../src/world/world.hpp"
+#include "../../src/hardware/decoder/decoder.hpp"
+#include "../../src/hardware/decoder/decoderchangeflags.hpp"
+#include "../../src/hardware/decoder/list/decoderlist.hpp"
+#include "../../src/vehicle/rail/railvehiclelist.hpp"
+#include "../../src/vehicle/rail/locomotive.hpp"
+#include "../../src/vehicle/rail/poweredrailvehicle.hpp"
+#include "../../src/train/trainlist.hpp"
+#include "../../src/train/train.hpp"
+#include "../../src/train/trainvehiclelist.hpp"
+#include "../../src/train/motionscheduler.hpp"
+
+TEST_CASE("Motion scheduler: accelerate and brake trains", "[train][train-motionscheduler]")
+{
+  using namespace std::chrono_literals;
+
+  auto world = World::create();
+  auto& scheduler = world->trains->motionScheduler();
+
+  // two trains, 100 km/h at full throttle:
+  std::vector<std::shared_ptr<Train>> trains;
+  std::vector<std::shared_ptr<Decoder>> decoders;
+  size_t throttleChanges = 0;
+  for(int i = 0; i < 2; i++)
+  {
+    auto decoder = world->decoders->create();
+    decoder->decoderChanged.connect(
+      [&throttleChanges](Decoder&, DecoderChangeFlags changes, uint32_t)
+      {
+        if(has(changes, DecoderChangeFlags::Throttle))
+          throttleChanges++;
+      });
+    auto locomotive = world->railVehicles->create(Locomotive::classId);
+    locomotive->speedMax.setValue(100);
+    locomotive->decoder = decoder;
+    auto train = world->trains->create();
+    train->vehicles->add(locomotive);
+    train->active = true;
+    REQUIRE(train->active);
+    train->emergencyStop = false;
+    trains.emplace_back(train);
+    decoders.emplace_back(decoder);
+  }
+
+  REQUIRE(scheduler.size() == 0);
+  REQUIRE_FALSE(scheduler.isRunning());
+
+  // both trains accelerate to 36 km/h (10 m/s), at 1 m/s^2 that takes 10 s:
+  for(const auto& train : trains)
+  {
+    train->throttleSpeed.setValue(36);
+  }
+  REQUIRE(scheduler.size() == 2);
+  REQUIRE(scheduler.isRunning()); // one timer for all trains
+
+  for(int i = 0; i < 50; i++)
+  {
+    scheduler.update(100ms);
+  }
+  REQUIRE(scheduler.size() == 2);
+  for(const auto& train : trains)
+  {
+    REQUIRE(train->speed.value() == Approx(18));
+    REQUIRE_FALSE(train->isStopped);
+  }
+
+  for(int i = 0; i < 51; i++) // one extra to absorb rounding
+  {
+    scheduler.update(100ms);
+  }
+  REQUIRE(scheduler.size() == 0);
+  for(size_t i = 0; i < trains.size(); i++)
+  {
+    REQUIRE(trains[i]->speed.value() == Approx(36));
+    REQUIRE(decoders[i]->throttle.value() == Approx(45.0f / PoweredRailVehicle::speedStepsAutoResolution));
+  }
+
+  // a decoder update only if the speed step changes, 45 steps per train instead of one per tick:
+  REQUIRE(throttleChanges == 2 * 45);
+
+  // emergency stop removes the train from the scheduler:
+  trains[0]->throttleSpeed.setValue(0);
+  trains[1]->throttleSpeed.setValue(0);
+  REQUIRE(scheduler.size() == 2);
+  trains[0]->emergencyStop = true;
+  REQUIRE(scheduler.size() == 1);
+  REQUIRE(trains[0]->speed.value() == 0);
+
+  // braking at 0.5 m/s^2 takes 20 s:
+  for(int i = 0; i < 201; i++)
+  {
+    scheduler.update(100ms);
+  }
+  REQUIRE(scheduler.size() == 0);
+  REQUIRE(trains[1]->speed.value() == 0);
+  REQUIRE(trains[1]->isStopped);
+  REQUIRE(decoders[1]->throttle.value() == 0);
+}
+
+TEST_CASE("Motion scheduler: tractive effort, braking percentage and stopping point", "[train][train-motionscheduler]")
+{
+  using namespace std::chrono_literals;
+
+  auto world = World::create();
+  auto& scheduler = world->trains->motionScheduler();
+
+  // 80 t, 1000 kW, 200 kN, 100% braking percentage:
+  auto decoder = world->decoders->create();
+  auto locomotive = world->railVehicles->create(Locomotive::classId);
+  auto powered = std::dynamic_pointer_cast<PoweredRailVehicle>(locomotive);
+  REQUIRE(powered);
+  locomotive->speedMax.setValue(160);
+  locomotive->weight.setValue(80);
+  locomotive->brakingPercentage.setValue(100);
+  powered->power.setValue(1000);
+  powered->tractiveEffort.setValue(200);
+  locomotive->decoder = decoder;
+  auto train = world->trains->create();
+  train->vehicles->add(locomotive);
+  train->active = true;
+  REQUIRE(train->active);
+  train->emergencyStop = false;
+
+  const double resistance = MotionScheduler::rollingResistance * MotionScheduler::gravity;
+  const double braking = MotionScheduler::brakingDecelerationFull + resistance;
+  REQUIRE(MotionScheduler::brakingDeceleration(*train) == Approx(braking));
+
+  // starting, limited by tractive effort:
+  train->throttleSpeed.setValue(144); // 40 m/s
+  scheduler.update(100ms);
+  REQUIRE(train->speed.getValue(SpeedUnit::MeterPerSecond) == Approx((200e3 / 80e3 - resistance) * 0.1));
+
+  // at speed, limited by power:
+  while(train->speed.getValue(SpeedUnit::MeterPerSecond) < 20)
+  {
+    scheduler.update(100ms);
+  }
+  const double speed = train->speed.getValue(SpeedUnit::MeterPerSecond);
+  scheduler.update(100ms);
+  REQUIRE(train->speed.getValue(SpeedUnit::MeterPerSecond) - speed == Approx((1000e3 / speed / 80e3 - resistance) * 0.1));
+
+  SECTION("brake")
+  {
+    const double before = train->speed.getValue(SpeedUnit::MeterPerSecond);
+    train->throttleSpeed.setValue(0);
+    scheduler.update(100ms);
+    REQUIRE(before - train->speed.getValue(SpeedUnit::MeterPerSecond) == Approx(braking * 0.1));
+  }
+
+  SECTION("stop at stopping point")
+  {
+    const double distance = GENERATE(400., 100.); // longer and shorter than the braking distance
+    REQUIRE(MotionScheduler::brakingDistance(*train) > 100);
+    REQUIRE(MotionScheduler::brakingDistance(*train) < 400);
+
+    REQUIRE_FALSE(scheduler.stopAt(*train, 0));
+    REQUIRE(scheduler.stopAt(*train, distance));
+    REQUIRE(train->throttleSpeed.value() == 0);
+
+    double travelled = 0;
+    double previous = train->speed.getValue(SpeedUnit::MeterPerSecond);
+    while(scheduler.contains(*train))
+    {
+      travelled += train->speed.getValue(SpeedUnit::MeterPerSecond) * 0.1;
+      scheduler.update(100ms);
+      if(distance > 200) // far away: keeps speed until the braking curve is met
+      {
+        REQUIRE(train->speed.getValue(SpeedUnit::MeterPerSecond) <= previous);
+      }
+      previous = train->speed.getValue(SpeedUnit::MeterPerSecond);
+    }
+    REQUIRE(train->speed.value() == 0);
+    REQUIRE(train->isStopped);
+    REQUIRE(travelled == Approx(distance).margin(0.1));
+  }
+}
+
+TEST_CASE("Motion scheduler: tick interval", "[train][train-motionscheduler]")
+{
+  using namespace std::chrono_literals;
+
+  auto world = World::create();
+  auto& scheduler = world->trains->motionScheduler();
+
+  REQUIRE(world->motionTickInterval.value() == MotionScheduler::tickIntervalDefault);
+  REQUIRE(scheduler.tickInterval() == 100ms);
+
+  // only editable in edit mode:
+  REQUIRE_FALSE(world->motionTickInterval.getAttribute<bool>(AttributeName::Enabled));
+  world->edit = true;
+  REQUIRE(world->motionTickInterval.getAttribute<bool>(AttributeName::Enabled));
+
+  world->motionTickInterval = 250;
+  REQUIRE(scheduler.tickInterval() == 250ms);
+
+  // out of range values are clamped:
+  world->motionTickInterval.setValueInternal(1);
+  REQUIRE(scheduler.tickInterval() == 20ms);
+  world->motionTickInterval.setValueInternal(60000);
+  REQUIRE(scheduler.tickInterval() == 1000ms);
+
+  world->edit = false;
+  REQUIRE_FALSE(world->motionTickInterval.getAttribute<bool>(AttributeName::Enabled));
+}
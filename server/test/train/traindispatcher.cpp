@@ -0,0 +1,312 @@
+/**
+ * server/test/train/traindispatcher.cpp
+ *
+ * This file is part of the traintastic test suite.
+ *
+ * Copyright (C) 2024 Reinder Feenstra
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <catch2/catch.hpp>
+#include "../board/layout.hpp"
+#include "../../src/core/eventloop.hpp"
+#include "../../src/core/method.tpp"
+#include "../../src/core/objectproperty.tpp"
+#include "../../src/core/objectvectorproperty.tpp"
+#include "../../src/world/world.hpp"
+#include "../../src/board/board.hpp"
+#include "../../src/board/boardlist.hpp"
+#include "../../src/board/map/blockpath.hpp"
+#include "../../src/board/map/routesetter.hpp"
+#include "../../src/hardware/decoder/decoder.hpp"
+#include "../../src/hardware/decoder/list/decoderlist.hpp"
+#include "../../src/vehicle/rail/railvehiclelist.hpp"
+#include "../../src/vehicle/rail/locomotive.hpp"
+#include "../../src/train/trainlist.hpp"
+#include "../../src/train/train.hpp"
+#include "../../src/train/trainvehiclelist.hpp"
+#include "../../src/train/trainblockstatus.hpp"
+#include "../../src/train/traintracking.hpp"
+#include "../../src/train/traindispatcher.hpp"
+#include "../../src/train/motionscheduler.hpp"
+#include "../../src/train/trainsimulator.hpp"
+
+static std::shared_ptr<Train> createTrain(World& world, const std::shared_ptr<BlockRailTile>& block)
+{
+  auto locomotive = world.railVehicles->create(Locomotive::classId);
+  locomotive->speedMax.setValue(100);
+  auto train = world.trains->create();
+  train->vehicles->add(locomotive);
+  REQUIRE(train->speedMax.value() == 100);
+  train->mode = TrainMode::Automatic;
+  block->assignTrain(train);
+  block->flipTrain(); // heading east
+  return train;
+}
+
+static void enterNext(const std::shared_ptr<Train>& train, const std::shared_ptr<BlockRailTile>& block)
+{
+  REQUIRE(!block->trains.empty());
+  REQUIRE(block->trains.front()->train.value() == train);
+  TrainTracking::enter(block->trains.front());
+  if(train->blocks.size() > 1) // tail not released by tracking
+  {
+    TrainTracking::left(train->blocks.back());
+  }
+  REQUIRE(train->blocks.size() == 1);
+}
+
+TEST_CASE("Train dispatcher: look-ahead reservation", "[train][train-dispatcher]")
+{
+  auto world = World::create();
+
+  // Board:
+  // +---+   +---+   +---+   +---+   +---+
+  // | A |---| B |---| C |---| D |---| E |
+  // +---+   +---+   +---+   +---+   +---+
+  auto board = world->boards->create();
+  const auto blocks = addStraightLine(*board, 5);
+  const auto& blockA = blocks[0];
+  const auto& blockB = blocks[1];
+  const auto& blockC = blocks[2];
+  const auto& blockD = blocks[3];
+  const auto& blockE = blocks[4];
+
+  world->edit = true;
+  world->edit = false; // update paths
+
+  for(const auto& block : blocks)
+  {
+    REQUIRE(block->setStateFree());
+  }
+
+  auto& dispatcher = world->trains->dispatcher();
+
+  auto train1 = createTrain(*world, blockB);
+  auto train2 = createTrain(*world, blockA);
+
+  // train 1 reserves two blocks ahead and drives at full speed:
+  REQUIRE(dispatcher.setTimetable(*train1, {{blockE}}));
+  REQUIRE(dispatcher.reservedCount(*train1) == TrainDispatcher::lookAhead);
+  REQUIRE(blockC->state.value() == BlockState::Reserved);
+  REQUIRE(blockD->state.value() == BlockState::Reserved);
+  REQUIRE(blockE->state.value() == BlockState::Free);
+  REQUIRE(train1->throttleSpeed.value() == 0); // paths are reserved, but not set yet
+  EventLoop::ioContext.restart();
+  EventLoop::ioContext.poll();
+  REQUIRE(train1->throttleSpeed.value() == 100);
+
+  // train 2 is blocked by train 1:
+  REQUIRE(dispatcher.setTimetable(*train2, {{blockD}}));
+  REQUIRE(dispatcher.reservedCount(*train2) == 0);
+  REQUIRE(dispatcher.waitingCount() == 1);
+  REQUIRE(train2->throttleSpeed.value() == 0);
+
+  // train 1 moves to C, path from B is released and the next one is reserved:
+  enterNext(train1, blockC);
+  REQUIRE(dispatcher.reservedCount(*train1) == TrainDispatcher::lookAhead);
+  REQUIRE(blockE->state.value() == BlockState::Reserved);
+  REQUIRE_FALSE(blockB->getReservedPath(BlockSide::B));
+  REQUIRE(train1->throttleSpeed.value() == 100 * TrainDispatcher::approachSpeedFactor); // path to E isn't set yet
+
+  // block B is reported free, train 2 gets it in the next event loop iteration and approaches train 1:
+  REQUIRE(blockB->setStateFree());
+  EventLoop::ioContext.restart();
+  EventLoop::ioContext.poll();
+  REQUIRE(dispatcher.reservedCount(*train2) == 1);
+  REQUIRE(dispatcher.waitingCount() == 1); // waiting for C
+  REQUIRE(train1->throttleSpeed.value() == 100);
+  REQUIRE(train2->throttleSpeed.value() == 100 * TrainDispatcher::approachSpeedFactor);
+
+  // train 1 arrives at its destination and stops:
+  enterNext(train1, blockD);
+  REQUIRE(dispatcher.reservedCount(*train1) == 1);
+  REQUIRE(train1->throttleSpeed.value() == 100 * TrainDispatcher::approachSpeedFactor);
+  enterNext(train1, blockE);
+  REQUIRE(dispatcher.reservedCount(*train1) == 0);
+  REQUIRE(dispatcher.stopIndex(*train1) == 1);
+  REQUIRE(train1->throttleSpeed.value() == 0);
+
+  dispatcher.clear(*train1);
+  dispatcher.clear(*train2);
+  REQUIRE(dispatcher.size() == 0);
+}
+
+TEST_CASE("Train dispatcher: throttle speed unit", "[train][train-dispatcher]")
+{
+  auto world = World::create();
+
+  // Board:
+  // +---+   +---+   +---+
+  // | A |---| B |---| C |
+  // +---+   +---+   +---+
+  auto board = world->boards->create();
+  const auto blocks = addStraightLine(*board, 3);
+
+  world->edit = true;
+  world->edit = false; // update paths
+
+  for(const auto& block : blocks)
+  {
+    REQUIRE(block->setStateFree());
+  }
+
+  auto& dispatcher = world->trains->dispatcher();
+
+  auto train = createTrain(*world, blocks[0]);
+  train->throttleSpeed.setUnit(SpeedUnit::MilePerHour);
+  REQUIRE(train->speedMax.unit() == SpeedUnit::KiloMeterPerHour);
+
+  REQUIRE(dispatcher.setTimetable(*train, {{blocks[2]}}));
+  REQUIRE(dispatcher.reservedCount(*train) == TrainDispatcher::lookAhead);
+  EventLoop::ioContext.restart();
+  EventLoop::ioContext.poll(); // set paths
+  REQUIRE(train->throttleSpeed.unit() == SpeedUnit::MilePerHour);
+  REQUIRE(train->throttleSpeed.value() == Approx(train->speedMax.getValue(SpeedUnit::MilePerHour)));
+
+  dispatcher.clear(*train);
+}
+
+TEST_CASE("Train dispatcher: route failed", "[train][train-dispatcher]")
+{
+  auto world = World::create();
+
+  // Board:
+  // +---+   +---+   +---+
+  // | A |---| B |---| C |
+  // +---+   +---+   +---+
+  auto board = world->boards->create();
+  const auto blocks = addStraightLine(*board, 3);
+  const auto& blockA = blocks[0];
+  const auto& blockB = blocks[1];
+  const auto& blockC = blocks[2];
+
+  world->edit = true;
+  world->edit = false; // update paths
+
+  for(const auto& block : blocks)
+  {
+    REQUIRE(block->setStateFree());
+  }
+
+  auto& dispatcher = world->trains->dispatcher();
+
+  auto train = createTrain(*world, blockA);
+  REQUIRE(dispatcher.setTimetable(*train, {{blockC}}));
+  REQUIRE(dispatcher.reservedCount(*train) == TrainDispatcher::lookAhead);
+  EventLoop::ioContext.restart();
+  EventLoop::ioContext.poll();
+  REQUIRE(train->throttleSpeed.value() == 100);
+
+  // a turnout of the path from B to C can't be set, the path is released and the train approaches B:
+  const auto path = blockB->getReservedPath(BlockSide::B);
+  REQUIRE(path);
+  REQUIRE(path->toBlock() == blockC);
+  world->boards->routeSetter().routeFailed(path);
+  REQUIRE(dispatcher.reservedCount(*train) == 1);
+  REQUIRE(dispatcher.waitingCount() == 1);
+  REQUIRE(blockC->state.value() == BlockState::Free);
+  REQUIRE_FALSE(blockB->getReservedPath(BlockSide::B));
+  REQUIRE(train->throttleSpeed.value() == 100 * TrainDispatcher::approachSpeedFactor);
+
+  // retry reserves the path again:
+  dispatcher.retryWaiting();
+  REQUIRE(dispatcher.reservedCount(*train) == TrainDispatcher::lookAhead);
+  REQUIRE(dispatcher.waitingCount() == 0);
+  EventLoop::ioContext.restart();
+  EventLoop::ioContext.poll();
+  REQUIRE(train->throttleSpeed.value() == 100);
+
+  dispatcher.clear(*train);
+}
+
+TEST_CASE("Train dispatcher: stop at the end of the stop block", "[train][train-dispatcher]")
+{
+  using namespace std::chrono_literals;
+
+  auto world = World::create();
+
+  // Board:
+  // +---+   +---+   +---+
+  // | A |---| B |---| C |
+  // +---+   +---+   +---+
+  auto board = world->boards->create();
+  const auto blocks = addStraightLine(*board, 3);
+  const auto& blockA = blocks[0];
+  const auto& blockB = blocks[1];
+  const auto& blockC = blocks[2];
+
+  world->edit = true;
+  world->edit = false; // update paths
+
+  for(const auto& block : blocks)
+  {
+    REQUIRE(block->setStateFree());
+  }
+
+  auto& dispatcher = world->trains->dispatcher();
+  auto& scheduler = world->trains->motionScheduler();
+
+  // an active train, so it actually moves:
+  auto decoder = world->decoders->create();
+  auto locomotive = world->railVehicles->create(Locomotive::classId);
+  locomotive->speedMax.setValue(100);
+  locomotive->decoder = decoder;
+  auto train = world->trains->create();
+  train->vehicles->add(locomotive);
+  train->active = true;
+  REQUIRE(train->active);
+  train->emergencyStop = false;
+  train->mode = TrainMode::Automatic;
+  blockA->assignTrain(train);
+  blockA->flipTrain(); // heading east
+
+  REQUIRE(dispatcher.setTimetable(*train, {{blockC}}));
+  EventLoop::ioContext.restart();
+  EventLoop::ioContext.poll(); // route setter sets the paths
+  REQUIRE(train->throttleSpeed.value() == 100);
+
+  for(int i = 0; i < 40; i++)
+  {
+    scheduler.update(100ms);
+  }
+  REQUIRE(train->speed.getValue(SpeedUnit::MeterPerSecond) == Approx(4)); // no weight, default acceleration
+
+  enterNext(train, blockB);
+  REQUIRE(train->throttleSpeed.value() == 100 * TrainDispatcher::approachSpeedFactor);
+
+  // arrives at its last stop, it brakes to the end of the block instead of stopping as soon as possible:
+  enterNext(train, blockC);
+  REQUIRE(dispatcher.stopIndex(*train) == 1);
+  REQUIRE(train->throttleSpeed.value() == 0);
+  REQUIRE(scheduler.contains(*train));
+
+  const double distance = TrainSimulator::blockLength(*blockC) * world->scaleRatio.value();
+  REQUIRE(MotionScheduler::brakingDistance(*train) > distance);
+
+  double travelled = 0;
+  while(scheduler.contains(*train))
+  {
+    travelled += train->speed.getValue(SpeedUnit::MeterPerSecond) * 0.1;
+    scheduler.update(100ms);
+  }
+  REQUIRE(train->speed.value() == 0);
+  REQUIRE(train->isStopped);
+  REQUIRE(travelled == Approx(distance).margin(0.1));
+
+  dispatcher.clear(*train);
+  REQUIRE(dispatcher.size() == 0);
+}
@@ -0,0 +1,307 @@
+/**
+ * server/test/train/trainsimulator.cpp
+ *
+ * This file is part of the traintastic test suite.
+ *
+ * Copyright (C) 2024 Reinder Feenstra
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <catch2/catch.hpp>
+#include "../board/layout.hpp"
+#include "../lua/sandbox.hpp"
+#include "../../src/core/method.tpp"
+#include "../../src/core/objectproperty.tpp"
+#include "../../src/world/world.hpp"
+#include "../../src/board/board.hpp"
+#include "../../src/board/boardlist.hpp"
+#include "../../src/hardware/decoder/decoder.hpp"
+#include "../../src/hardware/decoder/list/decoderlist.hpp"
+#include "../../src/hardware/input/input.hpp"
+#include "../../src/hardware/input/list/inputlist.hpp"
+#include "../../src/hardware/input/map/blockinputmap.hpp"
+#include "../../src/hardware/input/map/blockinputmapitem.hpp"
+#include "../../src/hardware/interface/interface.hpp"
+#include "../../src/lua/scriptlist.hpp"
+#include "../../src/hardware/input/inputcontroller.hpp"
+#include "../../src/vehicle/rail/railvehiclelist.hpp"
+#include "../../src/vehicle/rail/locomotive.hpp"
+#include "../../src/train/trainlist.hpp"
+#include "../../src/train/train.hpp"
+#include "../../src/train/trainvehiclelist.hpp"
+#include "../../src/train/trainsimulator.hpp"
+
+namespace {
+
+//! \brief Input interface that handles simulated changes like the interface kernels do in simulation mode
+class SimulationInputInterface final
+  : public Interface
+  , public InputController
+{
+  CLASS_ID("interface.test_simulation_input")
+  DEFAULT_ID("test")
+  CREATE(SimulationInputInterface)
+
+  protected:
+    void addToWorld() final
+    {
+      Interface::addToWorld();
+      InputController::addToWorld(InputListColumn::Id | InputListColumn::Address);
+    }
+
+    void destroying() final
+    {
+      InputController::destroying();
+      Interface::destroying();
+    }
+
+    bool setOnline(bool& /*value*/, bool /*simulation*/) final
+    {
+      return true;
+    }
+
+  public:
+    std::vector<std::pair<uint32_t, TriState>> changes; //!< address and value
+
+    SimulationInputInterface(World& world, std::string_view _id)
+      : Interface(world, _id)
+      , InputController(static_cast<IdObject&>(*this))
+    {
+    }
+
+    std::pair<uint32_t, uint32_t> inputAddressMinMax(uint32_t /*channel*/) const final
+    {
+      return {1, 16};
+    }
+
+    void inputSimulateChange(uint32_t channel, uint32_t address, SimulateInputAction action) final
+    {
+      auto it = m_inputs.find({channel, address});
+      REQUIRE(it != m_inputs.end());
+      const TriState current = it->second->value;
+
+      TriState value;
+      switch(action)
+      {
+        case SimulateInputAction::SetFalse:
+          value = TriState::False;
+          break;
+
+        case SimulateInputAction::SetTrue:
+          value = TriState::True;
+          break;
+
+        case SimulateInputAction::Toggle:
+        default:
+          value = (current == TriState::True) ? TriState::False : TriState::True;
+          break;
+      }
+
+      if(value != current)
+      {
+        changes.emplace_back(address, value);
+        updateInputValue(channel, address, value);
+      }
+    }
+};
+
+}
+
+TEST_CASE("Train simulator: virtual train moves through blocks", "[train][train-simulator]")
+{
+  using namespace std::chrono_literals;
+
+  auto world = World::create();
+  REQUIRE(world->scaleRatio.value() == 87);
+
+  // Board:
+  // +---+   +---+   +---+
+  // | A |---| B |---| C |
+  // +---+   +---+   +---+
+  auto board = world->boards->create();
+  const auto blocks = addStraightLine(*board, 3);
+  for(const auto& block : blocks)
+  {
+    REQUIRE(block->setStateFree());
+  }
+  const auto& blockA = blocks[0];
+  const auto& blockB = blocks[1];
+  const auto& blockC = blocks[2];
+
+  world->edit = true;
+  world->edit = false; // update paths
+
+  // 100 km/h at full throttle, 15 tiles long at scale 1:87:
+  auto decoder = world->decoders->create();
+  auto locomotive = world->railVehicles->create(Locomotive::classId);
+  locomotive->speedMax.setValue(100);
+  locomotive->lob.setValue(13050);
+  locomotive->decoder = decoder;
+  auto train = world->trains->create();
+  train->vehicles->add(locomotive);
+  blockA->assignTrain(train);
+  blockA->flipTrain(); // heading east
+  REQUIRE(train->active);
+
+  auto& simulator = world->trains->simulator();
+  REQUIRE_FALSE(simulator.isRunning());
+
+  // virtual train is placed in the block the train is assigned to:
+  simulator.advance(0ms);
+  REQUIRE(simulator.size() == 1);
+  REQUIRE(simulator.headBlock(*train) == blockA);
+  REQUIRE(simulator.isOccupied(*blockA));
+
+  // no throttle, no movement:
+  decoder->emergencyStop = false;
+  simulator.advance(1s);
+  REQUIRE(simulator.headBlock(*train) == blockA);
+
+  // full throttle, ~0.016 m per step:
+  decoder->throttle = 1;
+  simulator.advance(600ms); // head in B, tail still in A
+  REQUIRE(simulator.headBlock(*train) == blockB);
+  REQUIRE(simulator.isOccupied(*blockA));
+  REQUIRE(simulator.isOccupied(*blockB));
+
+  simulator.advance(200ms); // head between B and C, tail left A
+  REQUIRE_FALSE(simulator.headBlock(*train));
+  REQUIRE_FALSE(simulator.isOccupied(*blockA));
+  REQUIRE(simulator.isOccupied(*blockB));
+
+  simulator.advance(10s); // no path after C, train waits at the end of the block
+  REQUIRE(simulator.headBlock(*train) == blockC);
+  REQUIRE_FALSE(simulator.isOccupied(*blockB));
+  REQUIRE(simulator.isOccupied(*blockC));
+
+  REQUIRE(simulator.time() == 11800ms);
+
+  // reversing makes the tail, between B and C, the head:
+  decoder->throttle = 0;
+  decoder->direction = Direction::Reverse;
+  simulator.advance(100ms);
+  REQUIRE_FALSE(simulator.headBlock(*train));
+  REQUIRE_FALSE(simulator.isOccupied(*blockB));
+  REQUIRE(simulator.isOccupied(*blockC));
+
+  decoder->throttle = 1;
+  simulator.advance(200ms); // head in B, tail still in C
+  REQUIRE(simulator.headBlock(*train) == blockB);
+  REQUIRE(simulator.isOccupied(*blockB));
+  REQUIRE(simulator.isOccupied(*blockC));
+
+  simulator.advance(10s); // no path after A, train waits at the end of the block
+  REQUIRE(simulator.headBlock(*train) == blockA);
+  REQUIRE(simulator.isOccupied(*blockA));
+  REQUIRE_FALSE(simulator.isOccupied(*blockB));
+  REQUIRE_FALSE(simulator.isOccupied(*blockC));
+
+  // removing the train from the block removes the virtual train:
+  blockA->removeTrain(); // train tracking has no sensors, train is still in A
+  simulator.advance(0ms);
+  REQUIRE(simulator.size() == 0);
+  REQUIRE_FALSE(simulator.isOccupied(*blockA));
+}
+
+TEST_CASE("Train simulator: block sensors", "[train][train-simulator]")
+{
+  using namespace std::chrono_literals;
+
+  auto world = World::create();
+  world->simulation = true;
+
+  // Board:
+  // +---+   +---+   +---+
+  // | A |---| B |---| C |
+  // +---+   +---+   +---+
+  auto board = world->boards->create();
+  const auto blocks = addStraightLine(*board, 3);
+  for(const auto& block : blocks)
+  {
+    REQUIRE(block->setStateFree());
+  }
+  const auto& blockA = blocks[0];
+  const auto& blockB = blocks[1];
+
+  world->edit = true;
+  world->edit = false; // update paths
+
+  // block B has an occupancy detector and a reed switch:
+  auto interface = SimulationInputInterface::create(*world, "test");
+  auto occupancyDetector = interface->inputs->create();
+  REQUIRE(occupancyDetector->address.value() == 1);
+  auto reedSwitch = interface->inputs->create();
+  REQUIRE(reedSwitch->address.value() == 2);
+
+  blockB->inputMap->create();
+  blockB->inputMap->create();
+  REQUIRE(blockB->inputMap->items.size() == 2);
+  blockB->inputMap->items[0]->input = occupancyDetector;
+  blockB->inputMap->items[0]->type = SensorType::OccupancyDetector;
+  blockB->inputMap->items[1]->input = reedSwitch;
+  blockB->inputMap->items[1]->type = SensorType::ReedSwitch;
+
+  // 100 km/h at full throttle, 15 tiles long at scale 1:87:
+  auto decoder = world->decoders->create();
+  auto locomotive = world->railVehicles->create(Locomotive::classId);
+  locomotive->speedMax.setValue(100);
+  locomotive->lob.setValue(13050);
+  locomotive->decoder = decoder;
+  auto train = world->trains->create();
+  train->vehicles->add(locomotive);
+  blockA->assignTrain(train);
+  blockA->flipTrain(); // heading east
+
+  auto& simulator = world->trains->simulator();
+  decoder->emergencyStop = false;
+  decoder->throttle = 1;
+
+  simulator.advance(600ms); // head in B, tail still in A
+  REQUIRE(simulator.headBlock(*train) == blockB);
+  REQUIRE(occupancyDetector->value.value() == TriState::True);
+  REQUIRE(reedSwitch->value.value() == TriState::False);
+  REQUIRE(interface->changes == std::vector<std::pair<uint32_t, TriState>>{{1, TriState::True}, {2, TriState::True}, {2, TriState::False}}); // reed switch pulsed
+
+  simulator.advance(10s); // train left B
+  REQUIRE_FALSE(simulator.isOccupied(*blockB));
+  REQUIRE(occupancyDetector->value.value() == TriState::False);
+  REQUIRE(reedSwitch->value.value() == TriState::False);
+  REQUIRE(interface->changes.size() == 4);
+  REQUIRE(interface->changes.back() == std::pair<uint32_t, TriState>{1, TriState::False});
+}
+
+TEST_CASE("Train simulator: time warp", "[train][train-simulator]")
+{
+  auto world = World::create();
+  auto& simulator = world->trains->simulator();
+  REQUIRE(world->simulationTimeWarp.value() == TrainSimulator::timeWarpMin);
+  REQUIRE(simulator.timeWarp() == TrainSimulator::timeWarpMin);
+
+  // stored world setting, editable in edit mode:
+  REQUIRE_FALSE(world->simulationTimeWarp.getAttribute<bool>(AttributeName::Enabled));
+  world->edit = true;
+  REQUIRE(world->simulationTimeWarp.getAttribute<bool>(AttributeName::Enabled));
+  world->simulationTimeWarp = 60;
+  world->edit = false;
+  REQUIRE(simulator.timeWarp() == 60);
+
+  // readable by scripts:
+  auto script = world->luaScripts->create();
+  Lua::SandboxPtr sandbox = Lua::Sandbox::create(*script);
+  REQUIRE(runSandboxed(sandbox.get(), "assert(world.simulation_time_warp == 60)"));
+  REQUIRE_FALSE(runSandboxed(sandbox.get(), "world.simulation_time_warp = 1"));
+  REQUIRE(simulator.timeWarp() == 60);
+}
@@ -0,0 +1,93 @@
+/**
+ * server/test/world/ctwreader.cpp
+ *
+ * This file is part of the traintastic test suite.
+ *
+ * Copyright (C) 2024 Reinder Feenstra
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301, USA.
+ */
+
+#include <catch2/catch.hpp>
+#include "../../src/world/ctwreader.hpp"
+#include "../../src/world/ctwwriter.hpp"
+
+static std::vector<std::byte> createArchive()
+{
+  std::vector<std::byte> memory;
+  {
+    CTWWriter writer(memory);
+    writer.writeFile("traintastic.json", std::string("{\"version\":1}"));
+    writer.writeFile("world.json", std::string("world"));
+    writer.writeFile("state.json", std::string("state"));
+    writer.writeFile("lua/1.lua", std::string("log.info('1')"));
+  } // archive is finalized when the writer is destroyed
+  REQUIRE_FALSE(memory.empty());
+  return memory;
+}
+
+TEST_CASE("CTWReader: read entries out of order", "[world][ctw]")
+{
+  const auto memory = createArchive();
+  CTWReader reader(memory);
+  std::string text;
+
+  REQUIRE(reader.readFile("state.json", text));
+  REQUIRE(text == "state");
+
+  // world.json is before state.json, requires the archive to be reopened:
+  REQUIRE(reader.readFile("world.json", text));
+  REQUIRE(text == "world");
+
+  REQUIRE(reader.readFile("lua/1.lua", text));
+  REQUIRE(text == "log.info('1')");
+
+  nlohmann::json data;
+  REQUIRE(reader.readFile("traintastic.json", data));
+  REQUIRE(data["version"] == 1);
+}
+
+TEST_CASE("CTWReader: read same entry twice", "[world][ctw]")
+{
+  const auto memory = createArchive();
+  CTWReader reader(memory);
+  std::string text;
+
+  REQUIRE(reader.readFile("world.json", text));
+  REQUIRE(text == "world");
+
+  text.clear();
+  REQUIRE(reader.readFile("world.json", text));
+  REQUIRE(text == "world");
+}
+
+TEST_CASE("CTWReader: read missing entry", "[world][ctw]")
+{
+  const auto memory = createArchive();
+  CTWReader reader(memory);
+  std::string text;
+
+  // scans the whole archive:
+  REQUIRE_FALSE(reader.readFile("missing.json", text));
+
+  // present entries can still be read:
+  REQUIRE(reader.readFile("world.json", text));
+  REQUIRE(text == "world");
+
+  // missing is answered from the index:
+  REQUIRE_FALSE(reader.readFile("missing.json", text));
+  REQUIRE(reader.readFile("state.json", text));
+  REQUIRE(text == "state");
+}
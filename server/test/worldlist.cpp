@@ -21,6 +21,10 @@
  */
 
 #include <catch2/catch.hpp>
+#include <fstream>
+#include <boost/uuid/string_generator.hpp>
+#include "../src/core/eventloop.hpp"
+#include "../src/world/world.hpp"
 #include "../src/world/worldlist.hpp"
 
 TEST_CASE("Create worldlist and model => destroy worldlist", "[worldlist]")
@@ -69,3 +73,42 @@ TEST_CASE("Create worldlist and model => destroy model", "[worldlist]")
   }
   std::filesystem::remove_all(path);
 }
+
+#ifdef __linux__
+TEST_CASE("Worldlist: rescan when a world is saved over", "[worldlist]")
+{
+  const auto path = std::filesystem::temp_directory_path() / "traintastic-q3v8ks";
+  const auto uuid = boost::uuids::string_generator()(std::string("0b8b5a4e-8e55-4d3a-9c39-3c6a7c5e2f11"));
+  const auto worldFile = path / "myworld" / World::filename;
+
+  const auto writeWorld =
+    [&worldFile](std::string_view name)
+    {
+      std::ofstream file(worldFile);
+      file << R"({"uuid":"0b8b5a4e-8e55-4d3a-9c39-3c6a7c5e2f11","name":")" << name << R"("})";
+    };
+
+  std::filesystem::remove_all(path);
+  std::filesystem::create_directories(worldFile.parent_path());
+  writeWorld("before");
+  {
+    auto worldList = std::make_shared<WorldList>(path);
+    const auto* info = worldList->find(uuid);
+    REQUIRE(info);
+    REQUIRE(info->name == "before");
+
+    // only the world file inside the world directory changes:
+    writeWorld("after");
+
+    const auto end = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    EventLoop::ioContext.restart();
+    while((!(info = worldList->find(uuid)) || info->name != "after") && std::chrono::steady_clock::now() < end)
+      EventLoop::ioContext.run_one_for(std::chrono::milliseconds(10));
+
+    info = worldList->find(uuid);
+    REQUIRE(info);
+    REQUIRE(info->name == "after");
+  }
+  std::filesystem::remove_all(path);
+}
+#endif
@@ -131,6 +131,7 @@ enum class LogMessage : uint32_t
   N3001_ASSIGNED_TRAIN_X_TO_BLOCK_X = LogMessageOffset::notice + 3001,
   N3002_REMOVED_TRAIN_X_FROM_BLOCK_X = LogMessageOffset::notice + 3002,
   N9001_STARTING_SCRIPT = LogMessageOffset::notice + 9001,
+  N9002_RELOADING_SCRIPT = LogMessageOffset::notice + 9002,
   N9999_X = LogMessageOffset::notice + 9999,
 
   // Warning:
@@ -188,6 +189,10 @@ enum class LogMessage : uint32_t
   E3001_CANT_DELETE_RAIL_VEHICLE_WHEN_IN_ACTIVE_TRAIN = LogMessageOffset::error + 3001,
   E3002_CANT_DELETE_ACTIVE_TRAIN = LogMessageOffset::error + 3002,
   E9001_X_DURING_EXECUTION_OF_X_EVENT_HANDLER = LogMessageOffset::error + 9001,
+  E9002_EXCEEDED_MEMORY_LIMIT_OF_X_BYTES = LogMessageOffset::error + 9002,
+  E9003_X_DURING_EXECUTION_OF_TIMER_CALLBACK = LogMessageOffset::error + 9003,
+  E9004_X_DURING_EXECUTION_OF_WORKER_COMMAND_X = LogMessageOffset::error + 9004,
+  E9005_RELOADING_SCRIPT_FAILED_X = LogMessageOffset::error + 9005,
   E9999_X = LogMessageOffset::error + 9999,
 
   // Critical:
@@ -78,6 +78,8 @@ class Message
       BoardGetTileData = 37,
       BoardTileDataChanged = 38,
       BoardGetTileInfo = 43,
+      BoardSetViewport = 47,
+      BoardTileDataRegion = 48,
 
       ObjectGetObjectPropertyObject = 44,
       ObjectGetObjectVectorPropertyObject = 45,